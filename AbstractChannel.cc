@@ -0,0 +1,152 @@
+/*
+ * AbstractChannel.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "AbstractChannel.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("calibrated-channel");
+
+NS_OBJECT_ENSURE_REGISTERED(CalibratedChannel);
+
+// IPv4与UDP头长度，校准按应用层消息长度分箱
+static const uint32_t HEADER_BYTES = 28;
+
+TypeId CalibratedChannel::GetTypeId(void) {
+  static TypeId tid = TypeId("CalibratedChannel")
+    .SetParent<SimpleChannel>()
+    .AddConstructor<CalibratedChannel>();
+  return tid;
+}
+
+CalibratedChannel::CalibratedChannel()
+  : m_faults(NULL)
+{
+  m_uniform = CreateObject<UniformRandomVariable>();
+}
+
+CalibratedChannel::~CalibratedChannel()
+{
+}
+
+void CalibratedChannel::DoDispose(void)
+{
+  m_devices.clear();
+  m_uniform = 0;
+  SimpleChannel::DoDispose();
+}
+
+void CalibratedChannel::SetFaultPlan(const FaultPlan* plan, const std::string& baseQuality)
+{
+  m_faults = plan;
+  m_baseQuality = baseQuality;
+}
+
+void CalibratedChannel::SetDegradedCalibration(const std::string& quality, const LinkCalibration& calibration)
+{
+  m_degraded[quality] = calibration;
+}
+
+const LinkCalibration& CalibratedChannel::GetActiveCalibration() const
+{
+  if (m_faults == NULL) {
+    return m_calibration;
+  }
+  std::map<std::string, LinkCalibration>::const_iterator it =
+    m_degraded.find(m_faults->GetQuality(Simulator::Now().GetSeconds(), m_baseQuality));
+  return it != m_degraded.end() ? it->second : m_calibration;
+}
+
+void CalibratedChannel::Add(Ptr<SimpleNetDevice> device)
+{
+  m_devices.push_back(device);
+}
+
+uint32_t CalibratedChannel::GetNDevices(void) const
+{
+  return m_devices.size();
+}
+
+Ptr<NetDevice> CalibratedChannel::GetDevice(uint32_t i) const
+{
+  return m_devices[i];
+}
+
+double CalibratedChannel::GetDistance(Ptr<SimpleNetDevice> a, Ptr<SimpleNetDevice> b)
+{
+  Ptr<MobilityModel> ma = a->GetNode()->GetObject<MobilityModel>();
+  Ptr<MobilityModel> mb = b->GetNode()->GetObject<MobilityModel>();
+  if (ma == 0 || mb == 0) {
+    return 0;
+  }
+  return ma->GetDistanceFrom(mb);
+}
+
+Vector CalibratedChannel::GetPosition(Ptr<SimpleNetDevice> device)
+{
+  Ptr<MobilityModel> mobility = device->GetNode()->GetObject<MobilityModel>();
+  return mobility != 0 ? mobility->GetPosition() : Vector();
+}
+
+void CalibratedChannel::Send(Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
+                             Ptr<SimpleNetDevice> sender)
+{
+  bool unicast = !to.IsBroadcast() && !to.IsGroup();
+  uint32_t bytes = p->GetSize() > HEADER_BYTES ? p->GetSize() - HEADER_BYTES : 0;
+  const LinkCalibration& calibration = GetActiveCalibration();
+  double now = Simulator::Now().GetSeconds();
+  uint32_t senderIndex = 0;
+  double senderPosition[3] = { 0, 0, 0 };
+  bool faults = m_faults != NULL && m_faults->HasLinkFaults();
+  if (faults) {
+    senderIndex = std::find(m_devices.begin(), m_devices.end(), sender) - m_devices.begin();
+    Vector position = GetPosition(sender);
+    senderPosition[0] = position.x;
+    senderPosition[1] = position.y;
+    senderPosition[2] = position.z;
+  }
+
+  for (uint32_t i = 0; i < m_devices.size(); i++) {
+    Ptr<SimpleNetDevice> device = m_devices[i];
+    if (device == sender) {
+      continue;
+    }
+    if (unicast && Mac48Address::ConvertFrom(device->GetAddress()) != to) {
+      continue;
+    }
+    if (faults) {
+      Vector position = GetPosition(device);
+      double receiverPosition[3] = { position.x, position.y, position.z };
+      if (m_faults->IsLinkBlocked(senderIndex, i, senderPosition, receiverPosition, now)) {
+        continue;
+      }
+    }
+    double distance = GetDistance(sender, device);
+    if (m_uniform->GetValue() >= calibration.GetDeliveryProbability(distance, bytes, unicast)) {
+      NS_LOG_INFO("抽象信道丢弃: 距离" << distance << "m, 长度" << bytes);
+      continue;
+    }
+    Time delay = Seconds(calibration.GetDelay(distance, bytes, unicast));
+    Simulator::ScheduleWithContext(device->GetNode()->GetId(), delay,
+                                   &SimpleNetDevice::Receive, device, p->Copy(), protocol, to, from);
+  }
+}
+
+NetDeviceContainer InstallCalibratedChannel(NodeContainer& nodes, const LinkCalibration& calibration)
+{
+  Ptr<CalibratedChannel> channel = CreateObject<CalibratedChannel>();
+  channel->SetCalibration(calibration);
+
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN(); i++) {
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    device->SetAddress(Mac48Address::Allocate());
+    device->SetChannel(channel);
+    nodes.Get(i)->AddDevice(device);
+    devices.Add(device);
+  }
+  return devices;
+}
@@ -0,0 +1,70 @@
+/*
+ * AbstractChannel.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef ABSTRACT_CHANNEL_H
+#define ABSTRACT_CHANNEL_H
+
+#include "LinkCalibration.h"
+#include "FaultPlan.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * 抽象信道：跳过WiFi的PHY/MAC，按LinkCalibration给出的成功率和时延直接投递整条消息
+ *
+ * 节点安装SimpleNetDevice并接入该信道。每次发送时对每个目标接收方
+ * 按双方当前距离和消息长度抽样一次是否收到，收到的在对应时延后交给接收方设备。
+ * 不模拟信道竞争与冲突，这部分影响已经包含在校准样本的统计值中。
+ * 设置了故障计划时，被隔断的接收方不再抽样，degrade期间改用对应链路质量的校准。
+ */
+class CalibratedChannel : public SimpleChannel
+{
+public:
+  static TypeId GetTypeId(void);
+  CalibratedChannel();
+  virtual ~CalibratedChannel();
+
+  void SetCalibration(const LinkCalibration& calibration) { m_calibration = calibration; }
+  const LinkCalibration& GetCalibration() const { return m_calibration; }
+  // 按plan注入链路故障，设备按加入的顺序对应节点编号；plan不属于本类，NULL为不注入
+  void SetFaultPlan(const FaultPlan* plan, const std::string& baseQuality);
+  // 链路质量变为quality时使用的校准
+  void SetDegradedCalibration(const std::string& quality, const LinkCalibration& calibration);
+
+  virtual void Send(Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
+                    Ptr<SimpleNetDevice> sender);
+  virtual void Add(Ptr<SimpleNetDevice> device);
+  virtual uint32_t GetNDevices(void) const;
+  virtual Ptr<NetDevice> GetDevice(uint32_t i) const;
+
+protected:
+  virtual void DoDispose(void);
+
+private:
+  static double GetDistance(Ptr<SimpleNetDevice> a, Ptr<SimpleNetDevice> b);
+  static Vector GetPosition(Ptr<SimpleNetDevice> device);
+  // 当前时刻使用的校准
+  const LinkCalibration& GetActiveCalibration() const;
+
+  std::vector<Ptr<SimpleNetDevice> > m_devices;
+  LinkCalibration m_calibration;
+  const FaultPlan* m_faults;
+  std::string m_baseQuality;
+  std::map<std::string, LinkCalibration> m_degraded;
+  Ptr<UniformRandomVariable> m_uniform;
+};
+
+// 为所有节点安装接入同一个抽象信道的SimpleNetDevice
+NetDeviceContainer InstallCalibratedChannel(NodeContainer& nodes, const LinkCalibration& calibration);
+
+#endif /* ABSTRACT_CHANNEL_H */
@@ -5,6 +5,7 @@
  *      Author: Zhang Zhan
  */
 #include "AdhocUdpApplication.h"
+#include "Profiler.h"
 
 #include <ostream>
 #include <iostream>
@@ -46,21 +47,33 @@ TypeId AppSender::GetTypeId(void) {
 					MakeUintegerChecker<uint32_t>()).AddAttribute("Interval",
 					"Delay between transmissions.", UintegerValue(1),
 					MakeUintegerAccessor(&AppSender::m_interval),
-					MakeUintegerChecker<uint32_t>());
+					MakeUintegerChecker<uint32_t>())
+					.AddTraceSource("Tx", "A message is handed to the socket.",
+					MakeTraceSourceAccessor(&AppSender::m_txTrace),
+					"AppSender::TxTracedCallback");
 	return tid;
 }
 
+uint32_t AppSender::s_liveCount = 0;
+
 // 代码含义：
 AppSender::AppSender() {
-    m_sendCounter = 0;
     m_nodeId = 0;
     m_networkSize = 0;
-    m_neighborList = new std::vector<Ipv4Address>();
+    m_protocol = NULL;
+    m_sessions = NULL;
+    m_baseline = NULL;
     m_periodicInterval = 0.1; 
+    m_queuedSends = 0;
+    m_queuedSendBytes = 0;
+    m_crashed = false;
+    s_liveCount++;
 }
 
 // 析构函数
-AppSender::~AppSender() {}
+AppSender::~AppSender() {
+    s_liveCount--;
+}
 
 void AppSender::SetNodeId(uint32_t id) {
     m_nodeId = id;
@@ -68,49 +81,57 @@ void AppSender::SetNodeId(uint32_t id) {
 
 void AppSender::SetNetworkSize(uint32_t size) {
     m_networkSize = size;
-    // 初始化KeyMatrix
-    m_keyMatrix.InitializeMatrix(size, m_nodeId);
+}
+
+void AppSender::SetProtocol(RegkaProtocol* protocol) {
+    m_protocol = protocol;
+}
+
+void AppSender::SetSessions(SessionMux* sessions) {
+    m_sessions = sessions;
+}
+
+void AppSender::SetBaseline(BaselineProtocol* baseline) {
+    m_baseline = baseline;
+}
+
+uint32_t AppSender::GetSentPackets() const {
+    if (m_sessions != NULL) {
+        return m_sessions->GetSentCount();
+    }
+    if (m_baseline != NULL) {
+        return m_baseline->GetSentCount();
+    }
+    return m_protocol != NULL ? m_protocol->GetSentCount() : 0;
 }
 
 // 设置发包计数器
 void AppSender::SetSendCounter(Ptr<CounterCalculator<> > calc) {
-	m_sendCounter = 0;
 }   
 
 
 void AppSender::DoDispose(void) {
 	m_Socket = 0;
+	m_protocol = NULL;
+	m_sessions = NULL;
+	m_baseline = NULL;
 	Application::DoDispose();
 }
 
 void AppSender::PeriodicBroadcast() {
-    // 检查是否已经收齐所有密钥贡献
-    if (m_keyMatrix.IsFull1()) {
-        NS_LOG_INFO("所有节点已收齐所有密钥贡献，KeyMatrix全为1");
+    REGKA_PROFILE_SCOPE(PROFILE_PERIODIC_BROADCAST, m_nodeId);
+    if (m_crashed) {
         return;
     }
-
-    // 初始化转发字符串，初始为未收到的贡献为0，已收到的贡献为1
-    std::string forwardingContributions = std::string(m_networkSize, '0');
-    
-    // 遍历所有节点，如果已经收到某节点的密钥贡献，则该位置为1，通过AppReceiver的m_keyMatrix判断
-    for (uint32_t i = 0; i < m_networkSize; i++) {
-        // 获取AppReceiver的m_keyMatrix
-        Ptr<AppReceiver> receiver = DynamicCast<AppReceiver>(GetNode()->GetApplication(1));
-        if (receiver->GetKeyMatrix().HasKeyContribution(m_nodeId, i)) {
-            forwardingContributions[i] = '1';
-        }
+    if (m_sessions != NULL) {
+        m_sessions->OnTimer();
+        return;
     }
-    
-    // 构建数据包，内容为节点ID+转发字符串+本地的KeyMatrix
-    std::ostringstream packetContent;
-    packetContent << m_nodeId << " " << forwardingContributions << " " << m_keyMatrix.MatrixToString();
-    std::string content = packetContent.str();
-    
-    SendPacket(m_destAddr, content);
-    
-    // 周期后广播
-    m_periodicEvent = Simulator::Schedule(Seconds(m_periodicInterval), &AppSender::PeriodicBroadcast, this);
+    if (m_baseline != NULL) {
+        m_baseline->OnTimer();
+        return;
+    }
+    m_protocol->OnTimer();
 }
 
 // 启动应用
@@ -123,7 +144,6 @@ void AppSender::StartApplication() {
 
 	// 设置目的地址和端口
 	InetSocketAddress dataRemote = InetSocketAddress(m_destAddr, m_destPort);
-    // InetSocketAddress neighborRemote = InetSocketAddress(m_destAddr, m_neighborPort);
 	
     // 设置广播
 	m_Socket->SetAllowBroadcast(true);
@@ -131,58 +151,75 @@ void AppSender::StartApplication() {
     // 初始化链接
 	m_Socket->Connect(dataRemote);
 
-    // 初始化转发字符串,初始化为全0
-    std::string forwardingContributions = std::string(m_networkSize, '0');
-    // 第ID位为1
-    forwardingContributions[m_nodeId] = '1';    
-    std::ostringstream packetContent;
-    packetContent << m_nodeId << " " << forwardingContributions << " " << m_keyMatrix.MatrixToString();
-    std::string content = packetContent.str();
-
-    // 发送数据包
-    m_sendEvent = Simulator::Schedule(Seconds(0.005), &AppSender::SendPacket, this, m_destAddr, content);
+    // 广播首次数据包，1.1秒后开始周期性广播
+    if (m_sessions != NULL) {
+        m_sessions->SetPeriodicInterval(m_periodicInterval);
+        m_sessions->Start();
+    } else if (m_baseline != NULL) {
+        m_baseline->SetPeriodicInterval(m_periodicInterval);
+        m_baseline->Start();
+    } else {
+        m_protocol->SetPeriodicInterval(m_periodicInterval);
+        m_protocol->Start();
+    }
     NS_LOG_INFO("节点" << m_nodeId << "开始发送首次数据包");
-    
-    // 1.1秒后开始周期性广播
-    m_periodicEvent = Simulator::Schedule(Seconds(1.1), &AppSender::PeriodicBroadcast, this);
 }
 
 void AppSender::StopApplication() {
-	Simulator::Cancel(m_sendEvent);
     Simulator::Cancel(m_periodicEvent);
 }
 
+void AppSender::Crash() {
+    m_crashed = true;
+    Simulator::Cancel(m_periodicEvent);
+}
+
+Ipv4Address AppSender::GetNodeAddress(uint32_t nodeId) const {
+    if (nodeId == RegkaProtocol::BROADCAST) {
+        return m_destAddr;
+    }
+    Ipv4Address local = GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+    return Ipv4Address((local.Get() & 0xffffff00) | (nodeId + 1));
+}
+
+void AppSender::Send(uint32_t destination, const std::string& content, double delay) {
+    m_queuedSends++;
+    m_queuedSendBytes += content.size();
+    Simulator::Schedule(Seconds(delay), &AppSender::DoSendPacket, this, GetNodeAddress(destination), content);
+}
+
+void AppSender::ScheduleTimer(double delay) {
+    m_periodicEvent = Simulator::Schedule(Seconds(delay), &AppSender::PeriodicBroadcast, this);
+}
 
 void AppSender::SendPacket(Ipv4Address neighborAddress, std::string packetContent) {
-    Simulator::Schedule(MilliSeconds(5), &AppSender::DoSendPacket, this, neighborAddress, packetContent);
+    m_queuedSends++;
+    m_queuedSendBytes += packetContent.size();
+    Simulator::Schedule(Seconds(RegkaProtocol::SEND_DELAY), &AppSender::DoSendPacket, this, neighborAddress, packetContent);
 }
 
 void AppSender::DoSendPacket(Ipv4Address neighborAddress, std::string packetContent) {
-    std::ostringstream msg;
-    msg << packetContent;
-
-    int numContributions = 0;
-    // 找到转发字符串
-    std::string forwardingContributions = packetContent.substr(packetContent.find(" ") + 1, packetContent.find(" ", packetContent.find(" ") + 1) - packetContent.find(" ") - 1);
-    // 如果转发字符串为全1，则设置numContributions=1
-    if (forwardingContributions == std::string(m_networkSize, '1')) {
-        numContributions = 1;
+    REGKA_PROFILE_SCOPE(PROFILE_SEND_PACKET, m_nodeId);
+    m_queuedSends--;
+    m_queuedSendBytes -= packetContent.size();
+    if (m_crashed) {
+        return;
+    }
+    // 附加填充字节
+    uint32_t padding;
+    if (m_sessions != NULL) {
+        padding = m_sessions->Transmit(packetContent);
+    } else if (m_baseline != NULL) {
+        padding = m_baseline->Transmit(packetContent);
     } else {
-        numContributions = std::count(forwardingContributions.begin(), forwardingContributions.end(), '1');
+        padding = m_protocol->Transmit(packetContent);
     }
-    // 计算额外字节数
-    int additionalBytes = 8*(160 + 64 * (std::ceil(log2(numContributions)) + 1));
-    
-    // 添加填充字节
-    std::string padding(additionalBytes, '0');
-    msg << padding;
-
-    std::string content = msg.str();
+    std::string content = packetContent + std::string(padding, '0');
     Ptr<Packet> packet = Create<Packet>((uint8_t*) content.c_str(), content.size());
     InetSocketAddress remote = InetSocketAddress(neighborAddress, m_destPort);
     m_Socket->Connect(remote);
+    m_txTrace(packet, neighborAddress);
     m_Socket->Send(packet);
-    m_sendCounter++;
 }
 
 
@@ -200,23 +237,78 @@ TypeId AppReceiver::GetTypeId(void) {
 					.AddAttribute("Destination", "Target host address.",
 							Ipv4AddressValue("255.255.255.255"),
 							MakeIpv4AddressAccessor(&AppReceiver::m_destAddr),
-							MakeIpv4AddressChecker());
+							MakeIpv4AddressChecker())
+					.AddTraceSource("Rx", "A message is received.",
+							MakeTraceSourceAccessor(&AppReceiver::m_rxTrace),
+							"AppReceiver::RxTracedCallback");
 	return tid;
 }
 
+uint32_t AppReceiver::s_liveCount = 0;
+
 AppReceiver::AppReceiver() {
-    m_packetBuffer = new std::map<std::string, int>;
+    s_liveCount++;
+    m_sessions = NULL;
+    m_baseline = NULL;
+    m_duplicates = NULL;
+    m_duplicateCount = 0;
     m_keyAgreementDelay = 0;
-    m_receivedCounter = 0;   
-    m_isCompleted = false;
+    m_crashed = false;
     m_nodeId = 0;
     m_networkSize = 0;
-    m_neighborList = new std::vector<Ipv4Address>();
-    // KeyMatrix在SetNetworkSize时初始化
+    // 协议引擎在SetNetworkSize时初始化
 }
 
 AppReceiver::~AppReceiver() {
-    delete m_packetBuffer;
+    delete m_sessions;
+    delete m_baseline;
+    delete m_duplicates;
+    s_liveCount--;
+}
+
+uint64_t AppReceiver::GetPacketBufferBytes() const {
+    return m_duplicates != NULL ? m_duplicates->GetMemoryBytes() : 0;
+}
+
+void AppReceiver::SetDuplicateWindow(double window) {
+    delete m_duplicates;
+    m_duplicates = window > 0 ? new DuplicateCache(1024, window) : NULL;
+}
+
+void AppReceiver::SetSessions(uint32_t count) {
+    delete m_sessions;
+    m_sessions = NULL;
+    if (count == 0) {
+        return;
+    }
+    m_sessions = new SessionMux();
+    m_sessions->Initialize(m_networkSize, m_nodeId);
+    std::vector<bool> members(m_networkSize, true);
+    for (uint32_t k = 0; k < count; k++) {
+        m_sessions->AddSession(k, members);
+    }
+}
+
+bool AppReceiver::SetStrategy(const std::string& name) {
+    delete m_baseline;
+    m_baseline = NULL;
+    if (name == "regka") {
+        return true;
+    }
+    BaselineProtocol::Scheme scheme;
+    if (!BaselineProtocol::ParseScheme(name, scheme)) {
+        return false;
+    }
+    m_baseline = new BaselineProtocol();
+    m_baseline->Initialize(scheme, m_networkSize, m_nodeId);
+    return true;
+}
+
+const KeyMatrix& AppReceiver::GetKeyMatrix() const {
+    if (m_sessions != NULL) {
+        return m_sessions->GetSession(0)->GetKeyMatrix();
+    }
+    return m_protocol.GetKeyMatrix();
 }
 
 // 设置节点数量
@@ -232,19 +324,24 @@ void AppReceiver::SetNodeId(uint32_t id) {
 // 设置网络大小
 void AppReceiver::SetNetworkSize(uint32_t size) {
     m_networkSize = size;
-    // 初始化KeyMatrix
-    m_keyMatrix.InitializeMatrix(size, m_nodeId);
+    // 初始化协议引擎的密钥矩阵
+    m_protocol.Initialize(size, m_nodeId);
 }
 
 // 设置收包计数器
 void AppReceiver::SetReceiveCounter(Ptr<CounterCalculator<> > calc){
-    m_receivedCounter = 0;
 }
 
 
 // 获取收包计数器
 uint32_t AppReceiver::GetReceivedPackets() const {
-    return m_receivedCounter;
+    if (m_sessions != NULL) {
+        return m_sessions->GetReceivedCount() + m_duplicateCount;
+    }
+    if (m_baseline != NULL) {
+        return m_baseline->GetReceivedCount() + m_duplicateCount;
+    }
+    return m_protocol.GetReceivedCount() + m_duplicateCount;
 }
 
 // 获取密钥协商完成时间
@@ -254,34 +351,30 @@ double AppReceiver::GetKeyAgreementDelay() const {
 
 // 判断是否完成
 bool AppReceiver::IsCompleted() const {
-    return m_isCompleted;
+    if (m_sessions != NULL) {
+        return m_sessions->IsCompleted();
+    }
+    if (m_baseline != NULL) {
+        return m_baseline->IsCompleted();
+    }
+    return m_protocol.IsCompleted();
 }
 
 
 // 用于释放资源
 void AppReceiver::DoDispose(void) {
 	m_socket = 0;
-    // m_neighborSocket = 0;    
+	m_protocol.SetHost(NULL);
+	if (m_sessions != NULL) {
+		m_sessions->SetHost(NULL);
+	}
+	if (m_baseline != NULL) {
+		m_baseline->SetHost(NULL);
+	}
 	// chain up
 	Application::DoDispose();
 }
 
-// 更新邻居列表，只保留最新的N/2个邻居,N为节点数量
-void AppReceiver::UpdateNeighborList(Ipv4Address neighborAddress) {
-    // 如果该邻居在邻居列表中，则不添加
-    if (std::find(m_neighborList->begin(), m_neighborList->end(), neighborAddress) != m_neighborList->end()) {
-        // 将该邻居在邻居列表中的位置，移动到列表的末尾
-        m_neighborList->erase(std::find(m_neighborList->begin(), m_neighborList->end(), neighborAddress));
-        m_neighborList->push_back(neighborAddress);
-    } else {
-        // 否则添加邻居，只保留最新的N/2个邻居
-        m_neighborList->push_back(neighborAddress);
-        if (m_neighborList->size() > m_networkSize / 2) {
-            m_neighborList->erase(m_neighborList->begin());
-        }
-    }
-}
-
 // 启动应用
 void AppReceiver::StartApplication() {
 	TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
@@ -294,6 +387,19 @@ void AppReceiver::StartApplication() {
 	m_socket->Bind(local);
     NS_LOG_INFO("节点" << m_nodeId << "开始监听: " << address << ":" << m_port);
     m_socket->SetRecvCallback(MakeCallback(&AppReceiver::Receive, this));
+
+    // 协议引擎通过本节点的发送者应用收发消息
+    Ptr<AppSender> sender = DynamicCast<AppSender>(GetNode()->GetApplication(0));
+    sender->SetProtocol(&m_protocol);
+    m_protocol.SetHost(PeekPointer(sender));
+    if (m_sessions != NULL) {
+        sender->SetSessions(m_sessions);
+        m_sessions->SetHost(PeekPointer(sender));
+    }
+    if (m_baseline != NULL) {
+        sender->SetBaseline(m_baseline);
+        m_baseline->SetHost(PeekPointer(sender));
+    }
 }
 
 void AppReceiver::StopApplication() {
@@ -302,95 +408,45 @@ void AppReceiver::StopApplication() {
 	}
 }
 
+void AppReceiver::Crash() {
+    m_crashed = true;
+    StopApplication();
+    Ptr<AppSender> sender = DynamicCast<AppSender>(GetNode()->GetApplication(0));
+    sender->Crash();
+}
+
 void AppReceiver::Receive(Ptr<Socket> socket) {
+    REGKA_PROFILE_SCOPE(PROFILE_RECEIVE, m_nodeId);
     Ptr<Packet> packet;
     Address from;
 
     while ((packet = socket->RecvFrom(from))) {
-        m_receivedCounter++;
-        // 获取发送方地址
+        m_rxTrace(packet, from);
+        // 发送方ID就是发送方IP地址的最后一位减1
         Ipv4Address senderAddr = InetSocketAddress::ConvertFrom(from).GetIpv4();
-        // 将发送方地址添加到邻居列表
-        UpdateNeighborList(senderAddr);
-               
+        uint8_t ipBytes[4];
+        senderAddr.Serialize(ipBytes);
+        uint32_t senderId = ipBytes[3] - 1;
+
         // 从packet中提取数据
         uint8_t *buffer = new uint8_t[packet->GetSize()];
         packet->CopyData(buffer, packet->GetSize());
+        // 重复消息不含新的状态，不再解析、合并与转发
+        if (m_duplicates != NULL
+            && m_duplicates->IsDuplicate(senderId, buffer, packet->GetSize(), Simulator::Now().GetSeconds())) {
+            m_duplicateCount++;
+            delete[] buffer;
+            continue;
+        }
         std::string msg = std::string((char*)buffer, packet->GetSize());
         delete[] buffer;
 
-        // 从msg中提取发送节点ID - 使用string流替代std::stoi
-        std::istringstream senderIdStream(msg.substr(0, msg.find(" ")));
-        uint32_t senderId;
-        senderIdStream >> senderId;
-
-        std::string ReceivedKeyContributions = msg.substr(msg.find(" ") + 1, msg.find(" ", msg.find(" ") + 1) - msg.find(" ") - 1);
-
-
-        std::string ReceivedKeyMatrixString = msg.substr(msg.find(" ", msg.find(" ") + 1) + 1, m_networkSize * m_networkSize);
-
-        // 创建接收矩阵
-        KeyMatrix ReceivedMatrix = m_keyMatrix.StringToMatrix(ReceivedKeyMatrixString);
-
-        for (uint32_t i = 0; i < ReceivedKeyContributions.size(); i++) {
-            // 检查本地是否拥有该密钥贡献
-            if (m_keyMatrix.HasKeyContribution(m_nodeId, i)) {
-                continue;
-            } else {
-                // 接受该密钥贡献
-                m_keyMatrix.ReceiveKeyContribution(i);
-                // 记录日志
-                NS_LOG_INFO("节点" << m_nodeId << "未拥有密钥贡献" << i << "，接受该密钥贡献");
-            }   
-        }   
-
-        m_keyMatrix.MergeMatrix(ReceivedMatrix);	
-
-
-        // 如果自己已经收齐所有密钥贡献，则设置m_isCompleted为true
-        if(m_keyMatrix.SelfIsFull1()) {
-            // NS_LOG_INFO("节点" << m_nodeId << "已收齐所有密钥贡献");
-            m_isCompleted = true;
-        }
-
-       
-
-        // 遍历所有邻居
-        for (uint32_t i = 0; i < m_neighborList->size(); i++) {     
-            // 获取邻居的IP地址
-            Ipv4Address neighborAddr = m_neighborList->at(i);
-            // 获取邻居ID，邻居ID就是邻居的IP地址的最后一位，255.255.255.1 -> 1
-            uint8_t ipBytes[4];
-            neighborAddr.Serialize(ipBytes);
-            uint32_t neighborId = ipBytes[3]-1;
-
-            // 获取该邻居节点的转发字符串
-            std::string forwardingContributions = m_keyMatrix.GetForwardingContributions(neighborId);
-
-            // 如果字符串不为全0，则转发
-            if (forwardingContributions != std::string(m_networkSize, '0')) {               
-                // 构建数据包内容
-                std::ostringstream msg;
-                // 数据包内容    
-                msg << m_nodeId << " " << forwardingContributions << " " << m_keyMatrix.MatrixToString();
-                std::string content = msg.str();
-                
-                // 通过发送者应用转发
-                Ptr<AppSender> sender = DynamicCast<AppSender>(GetNode()->GetApplication(0));
-                sender->SendPacket(neighborAddr, content);
-            }
+        if (m_sessions != NULL) {
+            m_sessions->OnReceive(senderId, msg);
+        } else if (m_baseline != NULL) {
+            m_baseline->OnReceive(senderId, msg);
+        } else {
+            m_protocol.OnReceive(senderId, msg);
         }
     }
 }
-
-
-
-
-
-
-
-
-
-
-
-
@@ -9,6 +9,10 @@
 #define ADHOC_UDP_APPLICATION_H_
 
 #include "KeyMatrix.h"
+#include "RegkaProtocol.h"
+#include "DuplicateCache.h"
+#include "SessionMux.h"
+#include "BaselineProtocol.h"
 // #include "AdhocUdpHeader.h"
 #include "ns3/core-module.h"
 #include "ns3/application.h"
@@ -24,9 +28,9 @@
 using namespace ns3;
 
 /**
- * 发包应用
+ * 发包应用：为协议引擎提供发送与定时服务
  */
-class AppSender: public Application {
+class AppSender: public Application, public RegkaHost {
 public:
 	static TypeId GetTypeId(void);
 	AppSender();
@@ -34,21 +38,38 @@ public:
 	void SetSendCounter(Ptr<CounterCalculator<> > sendCounter); // 设置发包计数器，Ptr<CounterCalculator<> > 是一个智能指针，指向一个CounterCalculator对象
 	void SetNodeId(uint32_t id); // 设置节点ID
 	void SetNetworkSize(uint32_t size); // 设置网络大小
-	void AddNeighbor(Ipv4Address neighbor); // 添加邻居
-	void UpdateNeighborList(Ipv4Address neighborAddress); // 更新邻居列表
+	void SetProtocol(RegkaProtocol* protocol); // 设置本节点的协议引擎，由AppReceiver启动时设置
+	void SetSessions(SessionMux* sessions); // 多会话时代替协议引擎，由AppReceiver启动时设置
+	void SetBaseline(BaselineProtocol* baseline); // 基线方案时代替协议引擎，由AppReceiver启动时设置
 	void SendPacket(Ipv4Address neighborAddress, std::string packetContent); // 向指定邻居发送数据包
 	void DoSendPacket(Ipv4Address neighborAddress, std::string packetContent); // 向指定邻居发送数据包
+
+	// RegkaHost
+	virtual void Send(uint32_t destination, const std::string& content, double delay);
+	virtual void ScheduleTimer(double delay);
+	virtual double Now() const { return Simulator::Now().GetSeconds(); }
 	
-	// 获取发送的数据包数量
-	uint32_t GetSentPackets() const { return m_sendCounter; }
-	// 获取邻居列表
-	std::vector<Ipv4Address>* GetNeighborList() { return m_neighborList; }
+	// 获取发送的数据包数量（多会话时按会话消息计）
+	uint32_t GetSentPackets() const;
 	// 设置周期性广播间隔（秒）
 	void SetPeriodicBroadcastInterval(double interval) { m_periodicInterval = interval; }
 
 	// 周期性广播当前密钥贡献
 	void PeriodicBroadcast();
 
+	// 节点崩溃：取消定时，之后不再发出任何消息（已调度的消息到时丢弃）
+	void Crash();
+	bool IsCrashed() const { return m_crashed; }
+
+	// 已调度但尚未发出的消息数及其内容字节数（绑定在DoSendPacket事件中）
+	uint32_t GetQueuedSends() const { return m_queuedSends; }
+	uint64_t GetQueuedSendBytes() const { return m_queuedSendBytes; }
+	// 当前进程中尚未析构的AppSender数，用于检查批量运行之间的泄漏
+	static uint32_t GetLiveCount() { return s_liveCount; }
+
+	// 发送消息的跟踪回调签名：数据包、目的地址
+	typedef void (*TxTracedCallback)(Ptr<const Packet> packet, Ipv4Address destination);
+
 protected:
 	virtual void DoDispose(void);
 
@@ -56,27 +77,36 @@ private:
 	virtual void StartApplication(void);
 	virtual void StopApplication(void);
 
+	// 节点ID对应的IP地址：与节点ID等于IP最后一位减1的约定相反
+	Ipv4Address GetNodeAddress(uint32_t nodeId) const;
+
 	uint32_t m_pktSize;		// 包大小
 	Ipv4Address m_destAddr;	// 目的地址
 	uint16_t m_destPort;		// 目的端口
 	uint32_t m_interval;       // 发送间隔
 
 	Ptr<Socket> m_Socket; 	// 用于发送数据
-	EventId m_sendEvent;			// 发送事件
 	EventId m_periodicEvent;     // 周期性发送事件
 
-	uint32_t m_sendCounter;		// 发包计数器
 	uint32_t m_nodeId;			// 节点ID
-	std::vector<Ipv4Address>* m_neighborList;	// 邻居列表
 	uint32_t m_networkSize;		// 网络大小
-	KeyMatrix m_keyMatrix;		// 密钥矩阵
+	RegkaProtocol* m_protocol;	// 协议引擎，属于AppReceiver
+	SessionMux* m_sessions;		// 多会话，属于AppReceiver，单会话时为NULL
+	BaselineProtocol* m_baseline;	// 基线方案，属于AppReceiver，运行RE-GKA时为NULL
 	double m_periodicInterval;  // 周期性广播间隔（秒）
+	uint32_t m_queuedSends;     // 已调度未发出的消息数
+	uint64_t m_queuedSendBytes; // 已调度未发出的消息字节数
+	bool m_crashed;             // 是否已崩溃
+
+	TracedCallback<Ptr<const Packet>, Ipv4Address> m_txTrace; // 每条消息交给socket时触发
+
+	static uint32_t s_liveCount;
 };
 
 // -------------------------------------------------------------------
 
 /**
- * 收包应用
+ * 收包应用：持有本节点的协议引擎，把socket收到的消息交给它
  */
 class AppReceiver: public Application {
 public:
@@ -87,22 +117,33 @@ public:
 	void SetNumNodes(uint32_t num);
 	void SetNodeId(uint32_t id);
 	void SetNetworkSize(uint32_t size);
-	// void SetReceivedPackets(uint32_t receivedPackets); // 设置接收到的数据包数量
-	uint32_t GetReceivedPackets() const; // 获取接收到的数据包数量
+	uint32_t GetReceivedPackets() const; // 获取接收到的数据包数量（含被丢弃的重复消息）
+	// 重复消息缓存的时间窗口 (s)：窗口内同一发送方的相同消息在解析前丢弃，0为不丢弃
+	void SetDuplicateWindow(double window);
+	uint32_t GetDuplicateCount() const { return m_duplicateCount; }
+	// 同时运行count个覆盖全部节点的会话，需在SetNetworkSize之后调用，0为单会话
+	void SetSessions(uint32_t count);
+	const SessionMux* GetSessions() const { return m_sessions; }
+	// 按名称选择协商方案：regka或BaselineProtocol的基线方案，需在SetNetworkSize之后调用，未知名称返回false
+	bool SetStrategy(const std::string& name);
+	const BaselineProtocol* GetBaseline() const { return m_baseline; }
 	bool IsCompleted() const; // 是否收齐所有节点的包
+	// 节点崩溃：停止收包并让本节点的AppSender停止发送，由故障计划在崩溃时刻调用
+	void Crash();
+	bool IsCrashed() const { return m_crashed; }
 	double GetKeyAgreementDelay() const; // 获取密钥协商完成时间
-	// 获取密钥矩阵
-	const KeyMatrix& GetKeyMatrix() const { return m_keyMatrix; }
-
-	// 辅助方法：生成随机数
-	double GetRandomValue();
-	// 辅助方法：将数字转换为字符串
-	std::string ToString(uint32_t value);
-
-	std::string ContributionsToString(const std::vector<bool>& contributions) const;
-
-	// 辅助方法：更新邻居列表
-	void UpdateNeighborList(Ipv4Address neighborAddress);
+	// 获取密钥矩阵，多会话时为会话0的矩阵
+	const KeyMatrix& GetKeyMatrix() const;
+	// 获取协议引擎
+	RegkaProtocol& GetProtocol() { return m_protocol; }
+	const RegkaProtocol& GetProtocol() const { return m_protocol; }
+	// 数据包缓冲区（重复消息缓存）占用的堆内存字节数
+	uint64_t GetPacketBufferBytes() const;
+	// 当前进程中尚未析构的AppReceiver数
+	static uint32_t GetLiveCount() { return s_liveCount; }
+
+	// 收到消息的跟踪回调签名：数据包、发送方地址
+	typedef void (*RxTracedCallback)(Ptr<const Packet> packet, const Address& from);
 
 protected:
 	virtual void DoDispose(void);
@@ -118,26 +159,30 @@ private:
 
 	uint16_t m_port; // 数据通信端口
 
-	// 收包计数器
-	Ptr<CounterCalculator<> > receivedCounter;
 	// 网络总节点数
 	uint32_t m_numNodes;
 	// 网络节点ID
 	uint32_t m_nodeId;
-	// 是否收齐所有节点的包
-	bool m_isCompleted;
 	// 网络大小
 	uint32_t m_networkSize;
-	// 密钥矩阵
-	KeyMatrix m_keyMatrix;
-	// 收包计数器
-	uint32_t m_receivedCounter;
-	// 邻居列表
-	std::vector<Ipv4Address>* m_neighborList;
-	// 数据包缓冲区
-	std::map<std::string, int>* m_packetBuffer;
+	// 协议引擎
+	RegkaProtocol m_protocol;
+	// 多会话，单会话时为NULL
+	SessionMux* m_sessions;
+	// 基线方案，运行RE-GKA时为NULL
+	BaselineProtocol* m_baseline;
+	// 重复消息缓存，未启用时为NULL
+	DuplicateCache* m_duplicates;
+	// 被丢弃的重复消息数
+	uint32_t m_duplicateCount;
 	// 密钥协商完成时间
 	double m_keyAgreementDelay;
+	// 是否已崩溃
+	bool m_crashed;
+	// 每收到一条消息触发
+	TracedCallback<Ptr<const Packet>, const Address&> m_rxTrace;
+
+	static uint32_t s_liveCount;
 };
 
 
@@ -0,0 +1,342 @@
+/*
+ * BaselineProtocol.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "BaselineProtocol.h"
+#include <cstdlib>
+#include <sstream>
+
+const uint32_t BaselineProtocol::LEADER = 0;
+
+BaselineProtocol::BaselineProtocol()
+  : m_host(NULL),
+    m_scheme(FLOODING),
+    m_nodeId(0),
+    m_networkSize(0),
+    m_periodicInterval(0.1),
+    m_levels(0),
+    m_treeLevel(0),
+    m_contributions(0),
+    m_sentCount(0),
+    m_receivedCount(0),
+    m_isCompleted(false)
+{
+}
+
+bool BaselineProtocol::ParseScheme(const std::string& name, Scheme& scheme)
+{
+  if (name == "flooding") {
+    scheme = FLOODING;
+  } else if (name == "tgdh") {
+    scheme = TREE_DH;
+  } else if (name == "centralized") {
+    scheme = CENTRALIZED;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string BaselineProtocol::GetSchemeName(Scheme scheme)
+{
+  switch (scheme) {
+    case FLOODING:
+      return "flooding";
+    case TREE_DH:
+      return "tgdh";
+    case CENTRALIZED:
+      return "centralized";
+  }
+  return "";
+}
+
+void BaselineProtocol::Initialize(Scheme scheme, uint32_t networkSize, uint32_t nodeId)
+{
+  m_scheme = scheme;
+  m_networkSize = networkSize;
+  m_nodeId = nodeId;
+  m_known.clear();
+  m_items.clear();
+  m_outgoing.clear();
+  m_levels = 0;
+  while ((static_cast<uint64_t>(1) << m_levels) < networkSize) {
+    m_levels++;
+  }
+  m_treeLevel = 0;
+  m_contributions = 0;
+  m_sentCount = 0;
+  m_receivedCount = 0;
+  m_isCompleted = false;
+  m_computation.Initialize(nodeId);
+}
+
+std::string BaselineProtocol::ContributionItem(uint32_t node)
+{
+  std::ostringstream item;
+  item << "c" << node;
+  return item.str();
+}
+
+std::string BaselineProtocol::TreeItem(uint32_t level, uint32_t subtree)
+{
+  std::ostringstream item;
+  item << "t" << level << "." << subtree;
+  return item.str();
+}
+
+bool BaselineProtocol::Learn(const std::string& item)
+{
+  if (item.empty() || Knows(item)) {
+    return false;
+  }
+  if (item[0] == 'c') {
+    if (std::strtoul(item.c_str() + 1, NULL, 10) >= m_networkSize) {
+      return false;
+    }
+    m_contributions++;
+  }
+  m_known.insert(item);
+  m_items.push_back(item);
+  m_outgoing.push_back(item);
+  return true;
+}
+
+double BaselineProtocol::ComputeDelay() const
+{
+  if (!GroupKeyComputation::IsEnabled()) {
+    return 0;
+  }
+  return m_computation.GetRemainingTime(m_host->Now());
+}
+
+std::string BaselineProtocol::BuildMessage(char tag, const std::vector<std::string>& items) const
+{
+  // 结尾的";"把最后一个条目与之后附加的填充分开
+  std::ostringstream message;
+  message << tag << " " << items.size();
+  for (uint32_t k = 0; k < items.size(); k++) {
+    message << " " << items[k];
+  }
+  message << " ;";
+  return message.str();
+}
+
+void BaselineProtocol::FlushOutgoing(uint32_t destination, double delay)
+{
+  if (m_outgoing.empty()) {
+    return;
+  }
+  m_host->Send(destination, BuildMessage('B', m_outgoing), delay + ComputeDelay());
+  m_outgoing.clear();
+}
+
+void BaselineProtocol::Start()
+{
+  if (GroupKeyComputation::IsEnabled()) {
+    m_computation.GenerateContribution(m_host->Now());
+  }
+  Learn(m_scheme == TREE_DH ? TreeItem(0, m_nodeId) : ContributionItem(m_nodeId));
+  // 自己的贡献不需要处理
+  Advance(std::vector<uint32_t>());
+  FlushOutgoing(RegkaProtocol::BROADCAST, RegkaProtocol::START_DELAY + RegkaProtocol::SEND_DELAY);
+  m_host->ScheduleTimer(RegkaProtocol::PERIODIC_START);
+}
+
+void BaselineProtocol::OnTimer()
+{
+  if (m_isCompleted) {
+    return;
+  }
+  m_host->Send(RegkaProtocol::BROADCAST, BuildMessage('P', m_items), RegkaProtocol::SEND_DELAY + ComputeDelay());
+  m_host->ScheduleTimer(m_periodicInterval);
+}
+
+void BaselineProtocol::OnReceive(uint32_t from, const std::string& message)
+{
+  m_receivedCount++;
+  if (message.size() < 2 || (message[0] != 'B' && message[0] != 'P')) {
+    return;
+  }
+  bool periodic = message[0] == 'P';
+  std::istringstream in(message.substr(2));
+  uint32_t count = 0;
+  if (!(in >> count)) {
+    return;
+  }
+  std::set<std::string> theirs;
+  std::vector<uint32_t> newContributions;
+  std::string item;
+  for (uint32_t k = 0; k < count && in >> item; k++) {
+    if (periodic) {
+      theirs.insert(item);
+    }
+    if (Learn(item) && item[0] == 'c') {
+      newContributions.push_back(std::strtoul(item.c_str() + 1, NULL, 10));
+    }
+  }
+  Advance(newContributions);
+  FlushOutgoing(RegkaProtocol::BROADCAST, RegkaProtocol::SEND_DELAY);
+
+  // 周期广播来自未完成的节点，单播补齐它缺少的条目
+  if (periodic) {
+    for (uint32_t k = 0; k < m_items.size(); k++) {
+      if (theirs.count(m_items[k]) == 0) {
+        m_outgoing.push_back(m_items[k]);
+      }
+    }
+    FlushOutgoing(from, RegkaProtocol::SEND_DELAY);
+  }
+}
+
+void BaselineProtocol::Advance(const std::vector<uint32_t>& newContributions)
+{
+  bool compute = GroupKeyComputation::IsEnabled();
+  switch (m_scheme) {
+    case FLOODING:
+      if (compute && !newContributions.empty()) {
+        m_computation.ProcessContributions(newContributions, m_host->Now());
+      }
+      if (!m_isCompleted && m_contributions == m_networkSize) {
+        Complete();
+      }
+      break;
+    case CENTRALIZED:
+      if (m_nodeId == LEADER) {
+        // 领导者与每个成员求成对密钥，收齐后为每个成员加密一份组密钥
+        if (compute && !newContributions.empty()) {
+          m_computation.ProcessContributions(newContributions, m_host->Now());
+        }
+        if (!m_isCompleted && m_contributions == m_networkSize) {
+          Complete();
+          Learn("k");
+        }
+      } else if (!m_isCompleted && Knows("k")) {
+        // 成员用与领导者的成对密钥解密
+        if (compute) {
+          m_computation.ProcessContributions(std::vector<uint32_t>(1, LEADER), m_host->Now());
+        }
+        Complete();
+      }
+      break;
+    case TREE_DH:
+      AdvanceTree();
+      break;
+  }
+}
+
+void BaselineProtocol::AdvanceTree()
+{
+  bool compute = GroupKeyComputation::IsEnabled();
+  while (m_treeLevel < m_levels) {
+    uint32_t sibling = (m_nodeId >> m_treeLevel) ^ 1;
+    // 兄弟子树为空时子树密钥直接上移
+    if ((static_cast<uint64_t>(sibling) << m_treeLevel) < m_networkSize) {
+      if (!Knows(TreeItem(m_treeLevel, sibling))) {
+        break;
+      }
+      // 用兄弟子树的盲化密钥求上一层的子树密钥
+      if (compute) {
+        m_computation.ProcessContributions(std::vector<uint32_t>(1, sibling << m_treeLevel), m_host->Now());
+      }
+    }
+    m_treeLevel++;
+    uint32_t subtree = m_nodeId >> m_treeLevel;
+    if (m_treeLevel < m_levels && (subtree << m_treeLevel) == m_nodeId) {
+      // 子树的发起者公布子树的盲化密钥
+      if (compute) {
+        m_computation.GenerateContribution(m_host->Now());
+      }
+      Learn(TreeItem(m_treeLevel, subtree));
+    }
+  }
+  if (!m_isCompleted && m_treeLevel == m_levels) {
+    Complete();
+  }
+}
+
+void BaselineProtocol::Complete()
+{
+  if (GroupKeyComputation::IsEnabled()) {
+    std::vector<uint32_t> slots(m_networkSize);
+    for (uint32_t i = 0; i < m_networkSize; i++) {
+      slots[i] = i;
+    }
+    m_computation.DeriveKey(slots, m_host->Now());
+  }
+  m_isCompleted = true;
+}
+
+uint32_t BaselineProtocol::Transmit(const std::string& message)
+{
+  m_sentCount++;
+  return GetPaddingBytes(message, m_networkSize);
+}
+
+uint32_t BaselineProtocol::GetPaddingBytes(const std::string& message, uint32_t networkSize)
+{
+  std::istringstream in(message.size() > 2 ? message.substr(2) : std::string());
+  uint32_t count = 0;
+  in >> count;
+  uint32_t elements = 0;
+  std::string item;
+  for (uint32_t k = 0; k < count && in >> item; k++) {
+    elements += item == "k" ? networkSize : 1;
+  }
+  return 8 * (160 + 64 * elements);
+}
+
+uint64_t BaselineProtocol::CountLearnedContributions() const
+{
+  switch (m_scheme) {
+    case FLOODING:
+      return m_contributions;
+    case CENTRALIZED:
+      if (m_nodeId == LEADER) {
+        return m_contributions;
+      }
+      return Knows("k") ? 1 : 0;
+    case TREE_DH:
+      break;
+  }
+  uint64_t learned = 0;
+  for (uint32_t level = 0; level < m_levels; level++) {
+    uint32_t sibling = (m_nodeId >> level) ^ 1;
+    if ((static_cast<uint64_t>(sibling) << level) < m_networkSize && Knows(TreeItem(level, sibling))) {
+      learned++;
+    }
+  }
+  return learned;
+}
+
+uint64_t BaselineProtocol::CountExpectedContributions() const
+{
+  switch (m_scheme) {
+    case FLOODING:
+      return m_networkSize;
+    case CENTRALIZED:
+      return m_nodeId == LEADER ? m_networkSize : 1;
+    case TREE_DH:
+      break;
+  }
+  uint64_t expected = 0;
+  for (uint32_t level = 0; level < m_levels; level++) {
+    uint32_t sibling = (m_nodeId >> level) ^ 1;
+    if ((static_cast<uint64_t>(sibling) << level) < m_networkSize) {
+      expected++;
+    }
+  }
+  return expected;
+}
+
+uint64_t BaselineProtocol::GetStateBytes() const
+{
+  // 每个条目在集合与列表中各有一份字符串，另有32字节的密钥材料
+  uint64_t bytes = 0;
+  for (uint32_t k = 0; k < m_items.size(); k++) {
+    bytes += 2 * (sizeof(std::string) + m_items[k].capacity()) + 32;
+  }
+  return bytes;
+}
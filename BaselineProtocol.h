@@ -0,0 +1,111 @@
+/*
+ * BaselineProtocol.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef BASELINE_PROTOCOL_H
+#define BASELINE_PROTOCOL_H
+
+#include "RegkaProtocol.h"
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * 与RE-GKA对比的基线密钥协商方案，不依赖ns-3，宿主接口与RegkaProtocol相同
+ *
+ * 三种方案都按条目泛洪：条目为贡献 "c节点ID"、盲化密钥 "t层.子树" 或组密钥分发 "k"，
+ * 消息格式为 "B 条目数 条目 ... ;"，节点第一次得到某个条目时把它放进下一条广播（每个条目只转发一次）。
+ * 未完成的节点周期广播 "P 条目数 条目 ... ;"（自己已知的全部条目），收到的节点若有对方缺少的条目，
+ * 向对方单播一条 "B" 消息补齐，弥补泛洪中丢失的消息。
+ * 每个条目按一个群元素计填充，组密钥分发按N个（为每个成员加密一份），
+ * 填充为 8 * (160 + 64 * 群元素数) 字节，与RE-GKA的计法一致。
+ *
+ * - flooding：盲泛洪，每个节点广播自己的贡献，收齐N个贡献时完成。
+ * - tgdh：树形群DH（TGDH），节点按ID排成完全二叉树，第l层子树的发起者（子树中ID最小的节点）
+ *   在算出子树密钥后公布其盲化密钥 "t l.子树"；节点沿路径逐层取得兄弟子树的盲化密钥，
+ *   到达根时完成。
+ * - centralized：集中式，节点0为领导者，成员的贡献泛洪到领导者，
+ *   领导者收齐后公布组密钥分发 "k"，成员收到即完成。
+ *
+ * 启用了GroupKeyComputation时按方案计入计算：生成贡献或盲化密钥为固定基点运算，
+ * 处理贡献、逐层求子树密钥、解密组密钥各为一次可变基点运算，完成时求组密钥。
+ */
+class BaselineProtocol
+{
+public:
+  enum Scheme
+  {
+    FLOODING,
+    TREE_DH,
+    CENTRALIZED
+  };
+  static const uint32_t LEADER;  ///< 集中式方案的领导者
+
+  BaselineProtocol();
+
+  // 按名称解析方案：flooding、tgdh、centralized
+  static bool ParseScheme(const std::string& name, Scheme& scheme);
+  static std::string GetSchemeName(Scheme scheme);
+
+  void Initialize(Scheme scheme, uint32_t networkSize, uint32_t nodeId);
+  void SetHost(RegkaHost* host) { m_host = host; }
+  void SetPeriodicInterval(double interval) { m_periodicInterval = interval; }
+
+  // 与RegkaProtocol相同的宿主接口
+  void Start();
+  void OnTimer();
+  void OnReceive(uint32_t from, const std::string& message);
+  uint32_t Transmit(const std::string& message);
+
+  // 消息发出时需要附加的填充字节数
+  static uint32_t GetPaddingBytes(const std::string& message, uint32_t networkSize);
+
+  Scheme GetScheme() const { return m_scheme; }
+  bool IsCompleted() const { return m_isCompleted; }
+  // 本节点完成所需的条目中已知与应知的个数
+  uint64_t CountLearnedContributions() const;
+  uint64_t CountExpectedContributions() const;
+  uint32_t GetSentCount() const { return m_sentCount; }
+  uint32_t GetReceivedCount() const { return m_receivedCount; }
+  // 已知条目占用的堆内存字节数（估计值）
+  uint64_t GetStateBytes() const;
+  double GetKeyReadyTime() const { return m_computation.GetKeyReadyTime(); }
+  const GroupKeyComputation& GetComputation() const { return m_computation; }
+
+private:
+  static std::string ContributionItem(uint32_t node);
+  static std::string TreeItem(uint32_t level, uint32_t subtree);
+  bool Knows(const std::string& item) const { return m_known.count(item) > 0; }
+  // 记录条目，第一次得到时加入待转发列表并返回true
+  bool Learn(const std::string& item);
+  // 按方案处理已知条目：生成新条目、判断完成
+  void Advance(const std::vector<uint32_t>& newContributions);
+  void AdvanceTree();
+  void Complete();
+  // 把待转发列表中的条目作为一条消息在delay秒（另加计算时间）后发出
+  void FlushOutgoing(uint32_t destination, double delay);
+  std::string BuildMessage(char tag, const std::vector<std::string>& items) const;
+  double ComputeDelay() const;
+
+  RegkaHost* m_host;
+  Scheme m_scheme;
+  uint32_t m_nodeId;
+  uint32_t m_networkSize;
+  double m_periodicInterval;
+  std::set<std::string> m_known;
+  std::vector<std::string> m_items;     ///< 已知条目，按得到的先后
+  std::vector<std::string> m_outgoing;  ///< 待转发的条目
+  uint32_t m_levels;                    ///< 树的层数 ceil(log2 N)
+  uint32_t m_treeLevel;                 ///< 已算出的子树密钥所在的层
+  uint32_t m_contributions;             ///< 已知的贡献条目数
+  uint32_t m_sentCount;
+  uint32_t m_receivedCount;
+  bool m_isCompleted;
+  GroupKeyComputation m_computation;    ///< 未启用时不使用
+};
+
+#endif /* BASELINE_PROTOCOL_H */
@@ -0,0 +1,143 @@
+/*
+ * CalibrationRecorder.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "CalibrationRecorder.h"
+#include <sstream>
+#include <cstdlib>
+
+CalibrationRecorder::CalibrationRecorder()
+{
+}
+
+void CalibrationRecorder::Install(const NodeContainer& nodes)
+{
+  m_nodes = nodes;
+  for (uint32_t i = 0; i < nodes.GetN(); i++) {
+    // 上下文为节点ID
+    std::ostringstream context;
+    context << i;
+    nodes.Get(i)->GetApplication(0)->TraceConnect("Tx", context.str(),
+        MakeCallback(&CalibrationRecorder::Sent, this));
+    nodes.Get(i)->GetApplication(1)->TraceConnect("Rx", context.str(),
+        MakeCallback(&CalibrationRecorder::Received, this));
+  }
+}
+
+double CalibrationRecorder::GetDistance(uint32_t a, uint32_t b) const
+{
+  Ptr<MobilityModel> ma = m_nodes.Get(a)->GetObject<MobilityModel>();
+  Ptr<MobilityModel> mb = m_nodes.Get(b)->GetObject<MobilityModel>();
+  if (ma == 0 || mb == 0) {
+    return 0;
+  }
+  return ma->GetDistanceFrom(mb);
+}
+
+void CalibrationRecorder::Sent(std::string context, Ptr<const Packet> packet, Ipv4Address destination)
+{
+  uint32_t sender = std::strtoul(context.c_str(), NULL, 10);
+  Transmission& tx = m_transmissions[packet->GetUid()];
+  tx.time = Simulator::Now().GetSeconds();
+  tx.sender = sender;
+  tx.destination = LinkTrace::BROADCAST;
+  tx.bytes = packet->GetSize();
+  tx.unicast = !destination.IsBroadcast();
+
+  if (tx.unicast) {
+    // 节点ID为IP地址最后一位减1
+    uint8_t ipBytes[4];
+    destination.Serialize(ipBytes);
+    uint32_t receiver = ipBytes[3] - 1;
+    tx.destination = receiver;
+    if (receiver < m_nodes.GetN()) {
+      tx.receivers.push_back(std::make_pair(receiver, GetDistance(sender, receiver)));
+    }
+  } else {
+    for (uint32_t i = 0; i < m_nodes.GetN(); i++) {
+      if (i != sender) {
+        tx.receivers.push_back(std::make_pair(i, GetDistance(sender, i)));
+      }
+    }
+  }
+}
+
+void CalibrationRecorder::Received(std::string context, Ptr<const Packet> packet, const Address& from)
+{
+  std::map<uint64_t, Transmission>::iterator it = m_transmissions.find(packet->GetUid());
+  if (it == m_transmissions.end()) {
+    return;
+  }
+  uint32_t receiver = std::strtoul(context.c_str(), NULL, 10);
+  // 只记录第一次收到的时延
+  if (it->second.deliveries.find(receiver) == it->second.deliveries.end()) {
+    it->second.deliveries[receiver] = Simulator::Now().GetSeconds() - it->second.time;
+  }
+}
+
+void CalibrationRecorder::Finish(LinkCalibration& calibration, double guard) const
+{
+  double end = Simulator::Now().GetSeconds() - guard;
+  for (std::map<uint64_t, Transmission>::const_iterator it = m_transmissions.begin();
+       it != m_transmissions.end(); ++it) {
+    const Transmission& tx = it->second;
+    if (tx.time > end) {
+      continue;
+    }
+    for (uint32_t i = 0; i < tx.receivers.size(); i++) {
+      std::map<uint32_t, double>::const_iterator d = tx.deliveries.find(tx.receivers[i].first);
+      bool delivered = (d != tx.deliveries.end());
+      calibration.AddSample(tx.receivers[i].second, tx.bytes, tx.unicast, delivered, delivered ? d->second : 0);
+    }
+  }
+}
+
+void CalibrationRecorder::SamplePositions(double interval)
+{
+  LinkTrace::Sample sample;
+  sample.time = Simulator::Now().GetSeconds();
+  sample.positions.resize(m_nodes.GetN());
+  for (uint32_t i = 0; i < m_nodes.GetN(); i++) {
+    Ptr<MobilityModel> mobility = m_nodes.Get(i)->GetObject<MobilityModel>();
+    Vector position = mobility != 0 ? mobility->GetPosition() : Vector();
+    sample.positions[i].x = position.x;
+    sample.positions[i].y = position.y;
+    sample.positions[i].z = position.z;
+  }
+  m_samples.push_back(sample);
+  Simulator::Schedule(Seconds(interval), &CalibrationRecorder::SamplePositions, this, interval);
+}
+
+void CalibrationRecorder::Finish(LinkTrace& trace, double guard) const
+{
+  trace.SetNumNodes(m_nodes.GetN());
+  for (uint32_t i = 0; i < m_samples.size(); i++) {
+    trace.AddSample(m_samples[i]);
+  }
+  double end = Simulator::Now().GetSeconds() - guard;
+  // 数据包uid按创建顺序递增，即按发送时间排序
+  for (std::map<uint64_t, Transmission>::const_iterator it = m_transmissions.begin();
+       it != m_transmissions.end(); ++it) {
+    const Transmission& tx = it->second;
+    if (tx.time > end) {
+      continue;
+    }
+    LinkTrace::Transmission record;
+    record.time = tx.time;
+    record.sender = tx.sender;
+    record.destination = tx.destination;
+    record.bytes = tx.bytes;
+    for (uint32_t i = 0; i < tx.receivers.size(); i++) {
+      std::map<uint32_t, double>::const_iterator d = tx.deliveries.find(tx.receivers[i].first);
+      LinkTrace::Reception reception;
+      reception.node = tx.receivers[i].first;
+      reception.distance = tx.receivers[i].second;
+      reception.delay = (d != tx.deliveries.end()) ? d->second : -1;
+      record.receivers.push_back(reception);
+    }
+    trace.AddTransmission(record);
+  }
+}
@@ -0,0 +1,65 @@
+/*
+ * CalibrationRecorder.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef CALIBRATION_RECORDER_H
+#define CALIBRATION_RECORDER_H
+
+#include "LinkCalibration.h"
+#include "LinkTrace.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * 在完整WiFi仿真中记录链路样本，用于校准抽象信道和生成离线重放的链路轨迹
+ *
+ * 连接AppSender的Tx和AppReceiver的Rx跟踪源，按数据包uid匹配发送与接收。
+ * 发送时记录每个目标接收方（广播为其他所有节点，单播为目的节点）的距离，
+ * 仿真结束后每个（发送，接收方）对生成一个校准样本或一条轨迹记录。
+ */
+class CalibrationRecorder
+{
+public:
+  CalibrationRecorder();
+
+  // 连接所有节点的应用跟踪源，节点的应用0为AppSender、应用1为AppReceiver
+  void Install(const NodeContainer& nodes);
+  // 每隔interval秒采样一次所有节点的位置，写入链路轨迹
+  void SamplePositions(double interval);
+  // 把样本加入校准表；结束前guard秒内发出的消息可能仍在传输中，不计入
+  void Finish(LinkCalibration& calibration, double guard = 0.5) const;
+  // 生成链路轨迹，guard含义同上
+  void Finish(LinkTrace& trace, double guard = 0.5) const;
+
+private:
+  struct Transmission
+  {
+    double time;                                 ///< 发送时刻 (s)
+    uint32_t sender;
+    uint32_t destination;                        ///< 节点ID或LinkTrace::BROADCAST
+    uint32_t bytes;                              ///< 应用层消息长度
+    bool unicast;
+    std::vector<std::pair<uint32_t, double> > receivers; ///< 目标接收方及其距离
+    std::map<uint32_t, double> deliveries;       ///< 收到的接收方及时延
+  };
+
+  void Sent(std::string context, Ptr<const Packet> packet, Ipv4Address destination);
+  void Received(std::string context, Ptr<const Packet> packet, const Address& from);
+  double GetDistance(uint32_t a, uint32_t b) const;
+
+  NodeContainer m_nodes;
+  std::map<uint64_t, Transmission> m_transmissions; ///< 以数据包uid为键
+  std::vector<LinkTrace::Sample> m_samples;
+};
+
+#endif /* CALIBRATION_RECORDER_H */
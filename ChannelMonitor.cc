@@ -0,0 +1,138 @@
+/*
+ * ChannelMonitor.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ChannelMonitor.h"
+#include <algorithm>
+#include <sstream>
+#include <cstdlib>
+
+ChannelMonitor::ChannelMonitor()
+  : m_start(0),
+    m_phyRxDrops(0),
+    m_macRetries(0),
+    m_collisions(0)
+{
+}
+
+void ChannelMonitor::Install(const NodeContainer& nodes, double start)
+{
+  m_start = start;
+  m_flowMonitor = m_flowHelper.Install(nodes);
+  m_phys.assign(nodes.GetN(), Ptr<WifiPhy>());
+  m_receiving.assign(nodes.GetN(), 0);
+  m_isReceiving.assign(nodes.GetN(), false);
+  m_busy.assign(nodes.GetN(), 0);
+  for (uint32_t i = 0; i < nodes.GetN(); i++) {
+    Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(nodes.Get(i)->GetDevice(0));
+    if (device == 0) {
+      continue;
+    }
+    // 上下文为节点ID
+    std::ostringstream context;
+    context << i;
+    Ptr<WifiPhy> phy = device->GetPhy();
+    m_phys[i] = phy;
+    phy->TraceConnect("PhyRxBegin", context.str(), MakeCallback(&ChannelMonitor::PhyRxBegin, this));
+    phy->TraceConnect("PhyRxEnd", context.str(), MakeCallback(&ChannelMonitor::PhyRxEnd, this));
+    phy->TraceConnect("PhyRxDrop", context.str(), MakeCallback(&ChannelMonitor::PhyRxDrop, this));
+    PointerValue state;
+    phy->GetAttribute("State", state);
+    state.Get<WifiPhyStateHelper>()->TraceConnect("State", context.str(),
+        MakeCallback(&ChannelMonitor::PhyState, this));
+    device->GetRemoteStationManager()->TraceConnect("MacTxDataFailed", context.str(),
+        MakeCallback(&ChannelMonitor::MacTxDataFailed, this));
+  }
+}
+
+void ChannelMonitor::PhyRxBegin(std::string context, Ptr<const Packet> packet)
+{
+  uint32_t node = std::strtoul(context.c_str(), NULL, 10);
+  m_receiving[node] = packet->GetUid();
+  m_isReceiving[node] = true;
+}
+
+void ChannelMonitor::PhyRxEnd(std::string context, Ptr<const Packet> packet)
+{
+  uint32_t node = std::strtoul(context.c_str(), NULL, 10);
+  m_isReceiving[node] = false;
+}
+
+void ChannelMonitor::PhyRxDrop(std::string context, Ptr<const Packet> packet)
+{
+  uint32_t node = std::strtoul(context.c_str(), NULL, 10);
+  m_phyRxDrops++;
+  if (m_isReceiving[node] && m_receiving[node] == packet->GetUid()) {
+    // 正在接收的帧解码失败
+    m_isReceiving[node] = false;
+    return;
+  }
+  Ptr<WifiPhy> phy = m_phys[node];
+  if (phy->IsStateRx() || phy->IsStateTx() || phy->IsStateSwitching()) {
+    m_collisions++;
+  }
+}
+
+void ChannelMonitor::PhyState(std::string context, Time start, Time duration, WifiPhy::State state)
+{
+  if (state == WifiPhy::IDLE || state == WifiPhy::SLEEP) {
+    return;
+  }
+  uint32_t node = std::strtoul(context.c_str(), NULL, 10);
+  double begin = std::max(start.GetSeconds(), m_start);
+  double end = (start + duration).GetSeconds();
+  if (end > begin) {
+    m_busy[node] += end - begin;
+  }
+}
+
+void ChannelMonitor::MacTxDataFailed(std::string context, Mac48Address address)
+{
+  m_macRetries++;
+}
+
+ChannelMetrics ChannelMonitor::Finish()
+{
+  ChannelMetrics metrics;
+  metrics.collected = true;
+
+  m_flowMonitor->CheckForLostPackets();
+  const FlowMonitor::FlowStatsContainer& stats = m_flowMonitor->GetFlowStats();
+  double delaySum = 0;
+  double jitterSum = 0;
+  uint64_t txPackets = 0;
+  uint64_t rxPackets = 0;
+  uint64_t jitterSamples = 0;
+  for (FlowMonitor::FlowStatsContainer::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+    const FlowMonitor::FlowStats& flow = it->second;
+    delaySum += flow.delaySum.GetSeconds();
+    jitterSum += flow.jitterSum.GetSeconds();
+    txPackets += flow.txPackets;
+    rxPackets += flow.rxPackets;
+    if (flow.rxPackets > 1) {
+      jitterSamples += flow.rxPackets - 1;
+    }
+  }
+  metrics.flowDelay = rxPackets > 0 ? delaySum / rxPackets : 0;
+  metrics.flowJitter = jitterSamples > 0 ? jitterSum / jitterSamples : 0;
+  // 仿真结束时仍在传输中的数据包也计为丢失
+  metrics.flowLoss = txPackets > 0 ? (double)(txPackets - std::min(rxPackets, txPackets)) / txPackets * 100 : 0;
+
+  metrics.phyRxDrops = m_phyRxDrops;
+  metrics.macRetries = m_macRetries;
+  metrics.collisions = m_collisions;
+  double window = Simulator::Now().GetSeconds() - m_start;
+  uint32_t phys = 0;
+  double busy = 0;
+  for (uint32_t i = 0; i < m_phys.size(); i++) {
+    if (m_phys[i] != 0) {
+      phys++;
+      busy += m_busy[i];
+    }
+  }
+  metrics.channelBusy = phys > 0 && window > 0 ? std::min(busy / phys / window, 1.0) * 100 : 0;
+  return metrics;
+}
@@ -0,0 +1,63 @@
+/*
+ * ChannelMonitor.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef CHANNEL_MONITOR_H
+#define CHANNEL_MONITOR_H
+
+#include "Scenario.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/flow-monitor-module.h"
+#include <vector>
+#include <stdint.h>
+
+using namespace ns3;
+
+/**
+ * 统计一次仿真的信道层指标，用于判断收敛慢是协议本身的原因还是转发风暴造成的信道饱和
+ *
+ * 在所有节点上安装FlowMonitor，得到各流的平均时延、抖动与丢失比例。ns-3的Ipv4FlowProbe
+ * 不跟踪广播，流指标只覆盖单播（周期广播后的补齐消息），广播的丢失反映在PHY丢帧中。
+ * 对WifiNetDevice连接PHY的PhyRxBegin/PhyRxEnd/PhyRxDrop、PHY状态机的State
+ * 与远端站管理器的MacTxDataFailed跟踪源：
+ * - PHY丢帧：PhyRxDrop的次数，包括信噪比不足的解码失败与冲突；
+ * - 冲突：丢弃时PHY正在接收另一帧或正在发送，即与其他帧在时间上重叠；
+ * - MAC重传：单播数据帧未收到ACK的次数；
+ * - 信道忙：PHY处于发送、接收、CCA忙或切换状态的时间占统计区间的比例。
+ * 抽象信道没有WiFi设备，只统计FlowMonitor。
+ */
+class ChannelMonitor
+{
+public:
+  ChannelMonitor();
+
+  // 需在安装协议栈之后调用；信道忙时间从start秒起统计（节点开始发送的时刻）
+  void Install(const NodeContainer& nodes, double start);
+  // 仿真结束后、Simulator::Destroy之前调用
+  ChannelMetrics Finish();
+
+private:
+  void PhyRxBegin(std::string context, Ptr<const Packet> packet);
+  void PhyRxEnd(std::string context, Ptr<const Packet> packet);
+  void PhyRxDrop(std::string context, Ptr<const Packet> packet);
+  void PhyState(std::string context, Time start, Time duration, WifiPhy::State state);
+  void MacTxDataFailed(std::string context, Mac48Address address);
+
+  FlowMonitorHelper m_flowHelper;
+  Ptr<FlowMonitor> m_flowMonitor;
+  std::vector<Ptr<WifiPhy> > m_phys;   ///< 按节点编号，非WiFi设备为0
+  std::vector<uint64_t> m_receiving;   ///< 每个PHY正在接收的帧的uid
+  std::vector<bool> m_isReceiving;
+  std::vector<double> m_busy;          ///< 每个PHY在统计区间内的忙时间 (s)
+  double m_start;
+  uint64_t m_phyRxDrops;
+  uint64_t m_macRetries;
+  uint64_t m_collisions;
+};
+
+#endif /* CHANNEL_MONITOR_H */
@@ -0,0 +1,231 @@
+/*
+ * ClusterAgreement.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ClusterAgreement.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+// 同一时刻的判断精度 (s)
+static const double TIME_EPSILON = 1e-9;
+
+ClusterPlan ClusterAgreement::FormClusters(const std::vector<std::vector<uint32_t> >& neighbors,
+                                           const std::vector<double>& x, const std::vector<double>& y,
+                                           const std::vector<double>& z, uint32_t maxClusterSize)
+{
+  uint32_t numNodes = neighbors.size();
+  ClusterPlan plan;
+  plan.clusterOf.assign(numNodes, 0);
+  plan.localIndex.assign(numNodes, 0);
+  std::vector<bool> assigned(numNodes, false);
+  maxClusterSize = std::max<uint32_t>(maxClusterSize, 1);
+
+  // 邻居多的节点优先成为簇头，相同时编号小的优先
+  std::vector<std::pair<int64_t, uint32_t> > order(numNodes);
+  for (uint32_t i = 0; i < numNodes; i++) {
+    order[i] = std::make_pair(-static_cast<int64_t>(neighbors[i].size()), i);
+  }
+  std::sort(order.begin(), order.end());
+
+  for (uint32_t k = 0; k < numNodes; k++) {
+    uint32_t head = order[k].second;
+    if (assigned[head]) {
+      continue;
+    }
+    uint32_t cluster = plan.members.size();
+    plan.members.push_back(std::vector<uint32_t>(1, head));
+    assigned[head] = true;
+    plan.clusterOf[head] = cluster;
+    plan.localIndex[head] = 0;
+
+    std::vector<std::pair<double, uint32_t> > candidates;
+    for (uint32_t n = 0; n < neighbors[head].size(); n++) {
+      uint32_t j = neighbors[head][n];
+      if (!assigned[j]) {
+        double dx = x[j] - x[head];
+        double dy = y[j] - y[head];
+        double dz = z[j] - z[head];
+        candidates.push_back(std::make_pair(dx * dx + dy * dy + dz * dz, j));
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (uint32_t n = 0; n < candidates.size() && plan.members[cluster].size() < maxClusterSize; n++) {
+      uint32_t j = candidates[n].second;
+      assigned[j] = true;
+      plan.clusterOf[j] = cluster;
+      plan.localIndex[j] = plan.members[cluster].size();
+      plan.members[cluster].push_back(j);
+    }
+  }
+  return plan;
+}
+
+void ClusterAgreement::LevelHost::Send(uint32_t destination, const std::string& content, double delay)
+{
+  ClusterAgreement* owner = m_owner;
+  uint32_t node = RegkaProtocol::BROADCAST;
+  if (destination != RegkaProtocol::BROADCAST) {
+    node = m_level == 0 ? owner->m_clusterMembers[destination] : owner->m_lastHeard[destination];
+  }
+  std::ostringstream message;
+  message << "H" << m_level + 1 << " " << owner->m_cluster << " " << content;
+  owner->m_host->Send(node, message.str(), delay);
+}
+
+void ClusterAgreement::LevelHost::ScheduleTimer(double delay)
+{
+  m_owner->ScheduleLevelTimer(m_level, delay);
+}
+
+ClusterAgreement::ClusterAgreement()
+  : m_host(NULL),
+    m_nodeId(0),
+    m_cluster(0),
+    m_clusterCount(0),
+    m_globalStarted(false)
+{
+  m_timerDue[0] = -1;
+  m_timerDue[1] = -1;
+}
+
+void ClusterAgreement::Initialize(const ClusterPlan& plan, uint32_t nodeId)
+{
+  m_nodeId = nodeId;
+  m_cluster = plan.clusterOf[nodeId];
+  m_clusterCount = plan.GetClusterCount();
+  m_clusterMembers = plan.members[m_cluster];
+  m_clusterOf = plan.clusterOf;
+  m_localIndex = plan.localIndex;
+  m_lastHeard.assign(m_clusterCount, RegkaProtocol::BROADCAST);
+  m_local.Initialize(m_clusterMembers.size(), plan.localIndex[nodeId]);
+  m_global.Initialize(m_clusterCount, m_cluster);
+  for (uint32_t level = 0; level < 2; level++) {
+    m_hosts[level].Attach(this, level);
+    m_timerDue[level] = -1;
+  }
+  m_local.SetHost(&m_hosts[0]);
+  m_global.SetHost(&m_hosts[1]);
+  m_globalStarted = false;
+  m_timers.clear();
+}
+
+void ClusterAgreement::SetPeriodicInterval(double interval)
+{
+  m_local.SetPeriodicInterval(interval);
+  m_global.SetPeriodicInterval(interval);
+}
+
+void ClusterAgreement::Start()
+{
+  m_local.Start();
+  StartGlobalIfReady();
+}
+
+void ClusterAgreement::StartGlobalIfReady()
+{
+  if (!m_globalStarted && IsLocalCompleted()) {
+    m_globalStarted = true;
+    m_global.Start();
+  }
+}
+
+void ClusterAgreement::ScheduleLevelTimer(uint32_t level, double delay)
+{
+  double due = m_host->Now() + delay;
+  m_timerDue[level] = due;
+  for (uint32_t i = 0; i < m_timers.size(); i++) {
+    if (std::fabs(m_timers[i] - due) < TIME_EPSILON) {
+      return;
+    }
+  }
+  m_timers.push_back(due);
+  m_host->ScheduleTimer(delay);
+}
+
+void ClusterAgreement::OnTimer()
+{
+  double now = m_host->Now();
+  for (uint32_t i = 0; i < m_timers.size();) {
+    if (m_timers[i] <= now + TIME_EPSILON) {
+      m_timers[i] = m_timers.back();
+      m_timers.pop_back();
+    } else {
+      i++;
+    }
+  }
+  if (m_timerDue[0] >= 0 && m_timerDue[0] <= now + TIME_EPSILON) {
+    m_timerDue[0] = -1;
+    m_local.OnTimer();
+  }
+  if (m_timerDue[1] >= 0 && m_timerDue[1] <= now + TIME_EPSILON) {
+    m_timerDue[1] = -1;
+    m_global.OnTimer();
+  }
+}
+
+void ClusterAgreement::OnReceive(uint32_t from, const std::string& message)
+{
+  if (message.size() < 4 || message[0] != 'H') {
+    return;
+  }
+  const char* begin = message.c_str();
+  char* end = NULL;
+  uint32_t level = std::strtoul(begin + 1, &end, 10);
+  uint32_t cluster = std::strtoul(end, &end, 10);
+  std::string inner = message.substr(end - begin + 1);
+  if (from >= m_clusterOf.size()) {
+    return;
+  }
+
+  if (level == 1) {
+    // 其他簇的簇内消息直接忽略
+    if (cluster != m_cluster) {
+      return;
+    }
+    m_local.OnReceive(m_localIndex[from], inner);
+    StartGlobalIfReady();
+  } else if (level == 2 && cluster < m_clusterCount) {
+    m_lastHeard[cluster] = from;
+    // 第一级完成前还没有本簇的聚合贡献，不参与第二级
+    if (m_globalStarted) {
+      m_global.OnReceive(cluster, inner);
+    }
+  }
+}
+
+uint32_t ClusterAgreement::Transmit(const std::string& message)
+{
+  std::string::size_type space = message.find(' ', message.find(' ') + 1);
+  std::string inner = message.substr(space + 1);
+  return message.compare(0, 2, "H1") == 0 ? m_local.Transmit(inner) : m_global.Transmit(inner);
+}
+
+bool ClusterAgreement::IsLocalCompleted() const
+{
+  // 单节点的簇不需要协商
+  return m_local.GetKeyMatrix().SelfIsFull1();
+}
+
+bool ClusterAgreement::IsCompleted() const
+{
+  return m_globalStarted && m_global.GetKeyMatrix().SelfIsFull1();
+}
+
+uint64_t ClusterAgreement::CountLearnedContributions() const
+{
+  if (!m_globalStarted) {
+    return 0;
+  }
+  uint64_t learned = 0;
+  for (uint32_t j = 0; j < m_clusterCount; j++) {
+    if (m_global.GetKeyMatrix().HasKeyContribution(m_cluster, j)) {
+      learned++;
+    }
+  }
+  return learned;
+}
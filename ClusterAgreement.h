@@ -0,0 +1,105 @@
+/*
+ * ClusterAgreement.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef CLUSTER_AGREEMENT_H
+#define CLUSTER_AGREEMENT_H
+
+#include "RegkaProtocol.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 分簇结果
+struct ClusterPlan
+{
+  std::vector<uint32_t> clusterOf;                 ///< 每个节点所属的簇
+  std::vector<uint32_t> localIndex;                ///< 每个节点在簇内的序号
+  std::vector<std::vector<uint32_t> > members;     ///< 每个簇的成员，簇头在第0位
+
+  uint32_t GetClusterCount() const { return members.size(); }
+};
+
+/**
+ * 两级分簇的密钥协商，不依赖ns-3
+ *
+ * 第一级在簇内运行RE-GKA，槽位为簇内序号，每个节点只保存k×k的矩阵；
+ * 节点收齐簇内贡献后即得到本簇的聚合贡献，开始第二级协商。
+ * 第二级以簇为槽位，本簇所有成员都代表本簇的槽位收发，每个节点只保存C×C的矩阵，
+ * 簇头之间通常不在通信范围内，由成员转发跨簇的消息。
+ * 两级消息格式为 "H级别 簇号 内层消息"，内层消息与RegkaProtocol相同；
+ * 第一级只处理本簇的消息，第二级在本节点第一级完成后才处理。
+ * 第二级的单播目的地是最近一次收到该簇消息的节点。
+ * 两级都收齐贡献时节点完成。
+ */
+class ClusterAgreement
+{
+public:
+  ClusterAgreement();
+
+  // 按邻居表与位置分簇：未分簇节点中邻居最多的成为簇头，按距离由近到远吸收未分簇的邻居，
+  // 每个簇不超过maxClusterSize个节点
+  static ClusterPlan FormClusters(const std::vector<std::vector<uint32_t> >& neighbors,
+                                  const std::vector<double>& x, const std::vector<double>& y,
+                                  const std::vector<double>& z, uint32_t maxClusterSize);
+
+  void Initialize(const ClusterPlan& plan, uint32_t nodeId);
+  void SetHost(RegkaHost* host) { m_host = host; }
+  void SetPeriodicInterval(double interval);
+
+  // 与RegkaProtocol相同的宿主接口
+  void Start();
+  void OnTimer();
+  void OnReceive(uint32_t from, const std::string& message);
+  uint32_t Transmit(const std::string& message);
+
+  bool IsLocalCompleted() const;
+  bool IsCompleted() const;
+  // 第二级中本节点已知与应知的簇贡献数
+  uint64_t CountLearnedContributions() const;
+  uint64_t CountExpectedContributions() const { return m_clusterCount; }
+  uint32_t GetSentCount() const { return m_local.GetSentCount() + m_global.GetSentCount(); }
+  uint32_t GetReceivedCount() const { return m_local.GetReceivedCount() + m_global.GetReceivedCount(); }
+  // 两级矩阵占用的堆内存字节数
+  uint64_t GetMatrixBytes() const { return m_local.GetMatrixBytes() + m_global.GetMatrixBytes(); }
+
+private:
+  // 为一级协商转接宿主服务，并在簇内序号、簇号与节点ID之间转换
+  class LevelHost : public RegkaHost
+  {
+  public:
+    LevelHost() : m_owner(NULL), m_level(0) {}
+    void Attach(ClusterAgreement* owner, uint32_t level) { m_owner = owner; m_level = level; }
+    virtual void Send(uint32_t destination, const std::string& content, double delay);
+    virtual void ScheduleTimer(double delay);
+    virtual double Now() const { return m_owner->m_host->Now(); }
+
+  private:
+    ClusterAgreement* m_owner;
+    uint32_t m_level;
+  };
+
+  void ScheduleLevelTimer(uint32_t level, double delay);
+  // 第一级完成后启动第二级
+  void StartGlobalIfReady();
+
+  RegkaHost* m_host;
+  uint32_t m_nodeId;
+  uint32_t m_cluster;
+  uint32_t m_clusterCount;
+  std::vector<uint32_t> m_clusterMembers;  ///< 本簇成员的节点ID，按簇内序号
+  std::vector<uint32_t> m_clusterOf;       ///< 每个节点所属的簇
+  std::vector<uint32_t> m_localIndex;      ///< 每个节点的簇内序号
+  std::vector<uint32_t> m_lastHeard;       ///< 每个簇最近一次发来第二级消息的节点，未收到为BROADCAST
+  RegkaProtocol m_local;                   ///< 第一级：簇内
+  RegkaProtocol m_global;                  ///< 第二级：簇间
+  LevelHost m_hosts[2];
+  bool m_globalStarted;
+  double m_timerDue[2];                    ///< 两级的周期定时到期时刻，-1为没有定时
+  std::vector<double> m_timers;            ///< 已向宿主安排、尚未到期的定时时刻
+};
+
+#endif /* CLUSTER_AGREEMENT_H */
@@ -0,0 +1,708 @@
+/*
+ * CryptoBackend.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "CryptoBackend.h"
+#include <algorithm>
+#include <cstring>
+#include <time.h>
+#ifdef REGKA_WITH_OPENSSL
+#include <openssl/evp.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// GF(2^255-19)的运算：16个16位的肢，按TweetNaCl的表示
+
+typedef int64_t Fe[16];
+
+static const Fe FE_121665 = {0xDB41, 1};
+// Edwards曲线的2d
+static const Fe FE_D2 = {0xf159, 0x26b2, 0x9b94, 0xebd6, 0xb156, 0x8283, 0x149a, 0x00e0,
+                         0xd130, 0xeef3, 0x80f2, 0x198e, 0xfce7, 0x56df, 0xd9dc, 0x2406};
+// Edwards基点，对应Montgomery基点u=9
+static const Fe FE_BX = {0xd51a, 0x8f25, 0x2d60, 0xc956, 0xa7b2, 0x9525, 0xc760, 0x692c,
+                         0xdc5c, 0xfdd6, 0xe231, 0xc0a4, 0x53fe, 0xcd6e, 0x36d3, 0x2169};
+static const Fe FE_BY = {0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
+                         0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666};
+
+static void FeCopy(Fe o, const Fe a)
+{
+  for (int i = 0; i < 16; i++) {
+    o[i] = a[i];
+  }
+}
+
+static void FeSet(Fe o, int64_t value)
+{
+  for (int i = 0; i < 16; i++) {
+    o[i] = 0;
+  }
+  o[0] = value;
+}
+
+static void FeCarry(Fe o)
+{
+  for (int i = 0; i < 16; i++) {
+    o[i] += (int64_t(1) << 16);
+    int64_t c = o[i] >> 16;
+    o[(i + 1) * (i < 15)] += c - 1 + 37 * (c - 1) * (i == 15);
+    o[i] -= c * 65536;
+  }
+}
+
+// b为1时交换p与q
+static void FeSwap(Fe p, Fe q, int64_t b)
+{
+  int64_t c = ~(b - 1);
+  for (int i = 0; i < 16; i++) {
+    int64_t t = c & (p[i] ^ q[i]);
+    p[i] ^= t;
+    q[i] ^= t;
+  }
+}
+
+static void FePack(uint8_t* o, const Fe n)
+{
+  Fe m, t;
+  FeCopy(t, n);
+  FeCarry(t);
+  FeCarry(t);
+  FeCarry(t);
+  for (int j = 0; j < 2; j++) {
+    m[0] = t[0] - 0xffed;
+    for (int i = 1; i < 15; i++) {
+      m[i] = t[i] - 0xffff - ((m[i - 1] >> 16) & 1);
+      m[i - 1] &= 0xffff;
+    }
+    m[15] = t[15] - 0x7fff - ((m[14] >> 16) & 1);
+    int64_t b = (m[15] >> 16) & 1;
+    m[14] &= 0xffff;
+    FeSwap(t, m, 1 - b);
+  }
+  for (int i = 0; i < 16; i++) {
+    o[2 * i] = t[i] & 0xff;
+    o[2 * i + 1] = (t[i] >> 8) & 0xff;
+  }
+}
+
+static void FeUnpack(Fe o, const uint8_t* n)
+{
+  for (int i = 0; i < 16; i++) {
+    o[i] = n[2 * i] + (int64_t(n[2 * i + 1]) << 8);
+  }
+  o[15] &= 0x7fff;
+}
+
+static void FeAdd(Fe o, const Fe a, const Fe b)
+{
+  for (int i = 0; i < 16; i++) {
+    o[i] = a[i] + b[i];
+  }
+}
+
+static void FeSub(Fe o, const Fe a, const Fe b)
+{
+  for (int i = 0; i < 16; i++) {
+    o[i] = a[i] - b[i];
+  }
+}
+
+static void FeMul(Fe o, const Fe a, const Fe b)
+{
+  int64_t t[31];
+  for (int i = 0; i < 31; i++) {
+    t[i] = 0;
+  }
+  for (int i = 0; i < 16; i++) {
+    for (int j = 0; j < 16; j++) {
+      t[i + j] += a[i] * b[j];
+    }
+  }
+  for (int i = 0; i < 15; i++) {
+    t[i] += 38 * t[i + 16];
+  }
+  for (int i = 0; i < 16; i++) {
+    o[i] = t[i];
+  }
+  FeCarry(o);
+  FeCarry(o);
+}
+
+static void FeSquare(Fe o, const Fe a)
+{
+  FeMul(o, a, a);
+}
+
+// 按费马小定理求逆：a^(p-2)
+static void FeInvert(Fe o, const Fe a)
+{
+  Fe c;
+  FeCopy(c, a);
+  for (int i = 253; i >= 0; i--) {
+    FeSquare(c, c);
+    if (i != 2 && i != 4) {
+      FeMul(c, c, a);
+    }
+  }
+  FeCopy(o, c);
+}
+
+static void Clamp(uint8_t* z, const CryptoKey& secret)
+{
+  std::memcpy(z, secret.bytes, 32);
+  z[0] &= 248;
+  z[31] = (z[31] & 127) | 64;
+}
+
+// Montgomery阶梯，结果为射影坐标x/z
+static void Ladder(Fe xOut, Fe zOut, const uint8_t* z, const Fe u)
+{
+  Fe a, b, c, d, e, f;
+  FeCopy(b, u);
+  FeSet(a, 1);
+  FeSet(c, 0);
+  FeSet(d, 1);
+  for (int i = 254; i >= 0; i--) {
+    int64_t r = (z[i >> 3] >> (i & 7)) & 1;
+    FeSwap(a, b, r);
+    FeSwap(c, d, r);
+    FeAdd(e, a, c);
+    FeSub(a, a, c);
+    FeAdd(c, b, d);
+    FeSub(b, b, d);
+    FeSquare(d, e);
+    FeSquare(f, a);
+    FeMul(a, c, a);
+    FeMul(c, b, e);
+    FeAdd(e, a, c);
+    FeSub(a, a, c);
+    FeSquare(b, a);
+    FeSub(c, d, f);
+    FeMul(a, c, FE_121665);
+    FeAdd(a, a, d);
+    FeMul(c, c, a);
+    FeMul(a, d, f);
+    FeMul(d, b, u);
+    FeSquare(b, e);
+    FeSwap(a, b, r);
+    FeSwap(c, d, r);
+  }
+  FeCopy(xOut, a);
+  FeCopy(zOut, c);
+}
+
+// ---------------------------------------------------------------------------
+// Edwards曲线上的固定基点倍点表
+
+// 扩展坐标 (X:Y:Z:T)，T = XY/Z
+struct EdPoint
+{
+  Fe x;
+  Fe y;
+  Fe z;
+  Fe t;
+};
+
+static void EdIdentity(EdPoint& p)
+{
+  FeSet(p.x, 0);
+  FeSet(p.y, 1);
+  FeSet(p.z, 1);
+  FeSet(p.t, 0);
+}
+
+// p += q，对a=-1的扭曲Edwards曲线是完备的
+static void EdAdd(EdPoint& p, const EdPoint& q)
+{
+  Fe a, b, c, d, t, e, f, g, h;
+  FeSub(a, p.y, p.x);
+  FeSub(t, q.y, q.x);
+  FeMul(a, a, t);
+  FeAdd(b, p.x, p.y);
+  FeAdd(t, q.x, q.y);
+  FeMul(b, b, t);
+  FeMul(c, p.t, q.t);
+  FeMul(c, c, FE_D2);
+  FeMul(d, p.z, q.z);
+  FeAdd(d, d, d);
+  FeSub(e, b, a);
+  FeSub(f, d, c);
+  FeAdd(g, d, c);
+  FeAdd(h, b, a);
+  FeMul(p.x, e, f);
+  FeMul(p.y, h, g);
+  FeMul(p.z, g, f);
+  FeMul(p.t, e, h);
+}
+
+static const uint32_t WINDOWS = 64;
+static const uint32_t WINDOW_POINTS = 16;
+
+// 第w个窗口的第j项为 j·16^w·B，首次使用时生成
+static const std::vector<EdPoint>& FixedBaseTable()
+{
+  static std::vector<EdPoint> table;
+  if (!table.empty()) {
+    return table;
+  }
+  table.resize(WINDOWS * WINDOW_POINTS);
+  EdPoint base;
+  FeCopy(base.x, FE_BX);
+  FeCopy(base.y, FE_BY);
+  FeSet(base.z, 1);
+  FeMul(base.t, FE_BX, FE_BY);
+  for (uint32_t w = 0; w < WINDOWS; w++) {
+    EdPoint* row = &table[w * WINDOW_POINTS];
+    EdIdentity(row[0]);
+    for (uint32_t j = 1; j < WINDOW_POINTS; j++) {
+      row[j] = row[j - 1];
+      EdAdd(row[j], base);
+    }
+    EdPoint next = row[WINDOW_POINTS - 1];
+    EdAdd(next, base);
+    base = next;
+  }
+  return table;
+}
+
+// ---------------------------------------------------------------------------
+// SHA-256
+
+static const uint32_t SHA_K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static uint32_t RotateRight(uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+static void ShaBlock(uint32_t* h, const uint8_t* block)
+{
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++) {
+    w[i] = (uint32_t(block[4 * i]) << 24) | (uint32_t(block[4 * i + 1]) << 16) |
+           (uint32_t(block[4 * i + 2]) << 8) | block[4 * i + 3];
+  }
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t v[8];
+  for (int i = 0; i < 8; i++) {
+    v[i] = h[i];
+  }
+  for (int i = 0; i < 64; i++) {
+    uint32_t s1 = RotateRight(v[4], 6) ^ RotateRight(v[4], 11) ^ RotateRight(v[4], 25);
+    uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+    uint32_t t1 = v[7] + s1 + ch + SHA_K[i] + w[i];
+    uint32_t s0 = RotateRight(v[0], 2) ^ RotateRight(v[0], 13) ^ RotateRight(v[0], 22);
+    uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+    uint32_t t2 = s0 + maj;
+    for (int k = 7; k > 0; k--) {
+      v[k] = v[k - 1];
+    }
+    v[4] += t1;
+    v[0] = t1 + t2;
+  }
+  for (int i = 0; i < 8; i++) {
+    h[i] += v[i];
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+CryptoBackend* CryptoBackend::Create(const std::string& name)
+{
+  if (name == "x25519") {
+    return new X25519Backend();
+  }
+#ifdef REGKA_WITH_OPENSSL
+  if (name == "openssl") {
+    return new OpenSslBackend();
+  }
+#endif
+  return NULL;
+}
+
+X25519Backend::X25519Backend()
+  : m_fixedBaseTable(true)
+{
+}
+
+CryptoKey X25519Backend::GenerateContribution(const CryptoKey& secret)
+{
+  uint8_t z[32];
+  Clamp(z, secret);
+  CryptoKey result;
+  if (!m_fixedBaseTable) {
+    Fe u, x, zz;
+    FeSet(u, 9);
+    Ladder(x, zz, z, u);
+    FeInvert(zz, zz);
+    FeMul(x, x, zz);
+    FePack(result.bytes, x);
+    return result;
+  }
+
+  const std::vector<EdPoint>& table = FixedBaseTable();
+  EdPoint p;
+  EdIdentity(p);
+  for (uint32_t w = 0; w < WINDOWS; w++) {
+    uint32_t digit = (z[w / 2] >> (4 * (w % 2))) & 0xf;
+    EdAdd(p, table[w * WINDOW_POINTS + digit]);
+  }
+  // Edwards到Montgomery：u = (Z+Y)/(Z-Y)
+  Fe n, d;
+  FeAdd(n, p.z, p.y);
+  FeSub(d, p.z, p.y);
+  FeInvert(d, d);
+  FeMul(n, n, d);
+  FePack(result.bytes, n);
+  return result;
+}
+
+void X25519Backend::Combine(const CryptoKey& secret, const std::vector<CryptoKey>& contributions,
+                            std::vector<CryptoKey>& results, bool batch)
+{
+  uint32_t count = contributions.size();
+  results.resize(count);
+  if (count == 0) {
+    return;
+  }
+  uint8_t z[32];
+  Clamp(z, secret);
+  std::vector<EdPoint> points(count);  // 只用x与z分量保存各次阶梯的射影坐标
+  for (uint32_t k = 0; k < count; k++) {
+    Fe u;
+    FeUnpack(u, contributions[k].bytes);
+    Ladder(points[k].x, points[k].z, z, u);
+    if (!batch) {
+      FeInvert(points[k].z, points[k].z);
+      FeMul(points[k].x, points[k].x, points[k].z);
+      FePack(results[k].bytes, points[k].x);
+    }
+  }
+  if (!batch) {
+    return;
+  }
+
+  // Montgomery技巧：t_k = z_0·…·z_k，只对t_{count-1}求逆，再逐个回推
+  for (uint32_t k = 0; k < count; k++) {
+    if (k == 0) {
+      FeCopy(points[k].t, points[k].z);
+    } else {
+      FeMul(points[k].t, points[k - 1].t, points[k].z);
+    }
+  }
+  Fe inverse;
+  FeInvert(inverse, points[count - 1].t);
+  for (uint32_t k = count; k-- > 0;) {
+    Fe zInverse;
+    if (k > 0) {
+      FeMul(zInverse, inverse, points[k - 1].t);
+      FeMul(inverse, inverse, points[k].z);
+    } else {
+      FeCopy(zInverse, inverse);
+    }
+    FeMul(points[k].x, points[k].x, zInverse);
+    FePack(results[k].bytes, points[k].x);
+  }
+}
+
+CryptoKey X25519Backend::Hash(const uint8_t* data, uint32_t length)
+{
+  uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  uint32_t full = length / 64;
+  for (uint32_t k = 0; k < full; k++) {
+    ShaBlock(h, data + 64 * k);
+  }
+  // 最后的1~2个块：剩余字节、0x80、补零与64位的比特长度
+  uint8_t tail[128];
+  uint32_t rest = length - full * 64;
+  std::memset(tail, 0, sizeof(tail));
+  if (rest > 0) {
+    std::memcpy(tail, data + full * 64, rest);
+  }
+  tail[rest] = 0x80;
+  uint32_t tailLength = rest + 9 <= 64 ? 64 : 128;
+  uint64_t bits = static_cast<uint64_t>(length) * 8;
+  for (int i = 0; i < 8; i++) {
+    tail[tailLength - 1 - i] = (bits >> (8 * i)) & 0xff;
+  }
+  for (uint32_t offset = 0; offset < tailLength; offset += 64) {
+    ShaBlock(h, tail + offset);
+  }
+
+  CryptoKey result;
+  for (int i = 0; i < 8; i++) {
+    result.bytes[4 * i] = h[i] >> 24;
+    result.bytes[4 * i + 1] = (h[i] >> 16) & 0xff;
+    result.bytes[4 * i + 2] = (h[i] >> 8) & 0xff;
+    result.bytes[4 * i + 3] = h[i] & 0xff;
+  }
+  return result;
+}
+
+#ifdef REGKA_WITH_OPENSSL
+CryptoKey OpenSslBackend::GenerateContribution(const CryptoKey& secret)
+{
+  CryptoKey result;
+  std::memset(result.bytes, 0, sizeof(result.bytes));
+  EVP_PKEY* key = EVP_PKEY_new_raw_private_key(EVP_PKEY_X25519, NULL, secret.bytes, 32);
+  size_t length = 32;
+  if (key != NULL) {
+    EVP_PKEY_get_raw_public_key(key, result.bytes, &length);
+    EVP_PKEY_free(key);
+  }
+  return result;
+}
+
+void OpenSslBackend::Combine(const CryptoKey& secret, const std::vector<CryptoKey>& contributions,
+                             std::vector<CryptoKey>& results, bool batch)
+{
+  results.resize(contributions.size());
+  EVP_PKEY* key = EVP_PKEY_new_raw_private_key(EVP_PKEY_X25519, NULL, secret.bytes, 32);
+  for (uint32_t k = 0; k < contributions.size(); k++) {
+    std::memset(results[k].bytes, 0, 32);
+    EVP_PKEY* peer = EVP_PKEY_new_raw_public_key(EVP_PKEY_X25519, NULL, contributions[k].bytes, 32);
+    EVP_PKEY_CTX* context = key != NULL ? EVP_PKEY_CTX_new(key, NULL) : NULL;
+    size_t length = 32;
+    if (context != NULL && peer != NULL && EVP_PKEY_derive_init(context) > 0
+        && EVP_PKEY_derive_set_peer(context, peer) > 0) {
+      EVP_PKEY_derive(context, results[k].bytes, &length);
+    }
+    EVP_PKEY_CTX_free(context);
+    EVP_PKEY_free(peer);
+  }
+  EVP_PKEY_free(key);
+}
+
+CryptoKey OpenSslBackend::Hash(const uint8_t* data, uint32_t length)
+{
+  CryptoKey result;
+  unsigned int size = 32;
+  EVP_Digest(data, length, result.bytes, &size, EVP_sha256(), NULL);
+  return result;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+
+static double CpuSeconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+CryptoCosts::CryptoCosts()
+  : fixedBase(0),
+    variableBase(0),
+    batchSetup(0),
+    batchPerOp(0),
+    hashPerByte(0)
+{
+}
+
+CryptoCosts CryptoCosts::Measure(CryptoBackend& backend, uint32_t repetitions)
+{
+  repetitions = std::max<uint32_t>(repetitions, 1);
+  // 批量的规模，用两种规模的差值分出固定部分与每个贡献的部分
+  const uint32_t BATCH = 16;
+  CryptoKey secret = backend.Hash(reinterpret_cast<const uint8_t*>("regka"), 5);
+  std::vector<CryptoKey> contributions(BATCH);
+  CryptoKey material = secret;
+  for (uint32_t k = 0; k < BATCH; k++) {
+    material = backend.Hash(material.bytes, 32);
+    contributions[k] = backend.GenerateContribution(material);
+  }
+  std::vector<CryptoKey> one(1, contributions[0]);
+  std::vector<CryptoKey> results;
+  // 预热：生成倍点表并让处理器进入稳定频率
+  backend.Combine(secret, contributions, results, false);
+
+  CryptoCosts costs;
+  double start = CpuSeconds();
+  for (uint32_t r = 0; r < repetitions; r++) {
+    secret = backend.GenerateContribution(secret);
+  }
+  costs.fixedBase = (CpuSeconds() - start) / repetitions;
+
+  // 与批量使用相同的规模，两者的差只来自求逆的次数
+  start = CpuSeconds();
+  for (uint32_t r = 0; r < repetitions; r++) {
+    backend.Combine(secret, contributions, results, false);
+  }
+  costs.variableBase = (CpuSeconds() - start) / repetitions / BATCH;
+
+  if (backend.SupportsBatch()) {
+    start = CpuSeconds();
+    for (uint32_t r = 0; r < repetitions; r++) {
+      backend.Combine(secret, one, results, true);
+    }
+    double single = (CpuSeconds() - start) / repetitions;
+    start = CpuSeconds();
+    for (uint32_t r = 0; r < repetitions; r++) {
+      backend.Combine(secret, contributions, results, true);
+    }
+    double full = (CpuSeconds() - start) / repetitions;
+    costs.batchPerOp = std::max(full - single, 0.0) / (BATCH - 1);
+    costs.batchSetup = std::max(single - costs.batchPerOp, 0.0);
+  } else {
+    costs.batchPerOp = costs.variableBase;
+  }
+
+  std::vector<uint8_t> data(32 * 1024, 0x5a);
+  start = CpuSeconds();
+  for (uint32_t r = 0; r < repetitions; r++) {
+    backend.Hash(&data[0], data.size());
+  }
+  costs.hashPerByte = (CpuSeconds() - start) / repetitions / data.size();
+  return costs;
+}
+
+CryptoCosts CryptoCosts::Scaled(double factor) const
+{
+  CryptoCosts costs = *this;
+  costs.fixedBase *= factor;
+  costs.variableBase *= factor;
+  costs.batchSetup *= factor;
+  costs.batchPerOp *= factor;
+  costs.hashPerByte *= factor;
+  return costs;
+}
+
+double CryptoCosts::Combine(uint32_t count, bool batch) const
+{
+  if (count == 0) {
+    return 0;
+  }
+  return batch ? batchSetup + count * batchPerOp : count * variableBase;
+}
+
+// ---------------------------------------------------------------------------
+
+CryptoBackend* GroupKeyComputation::s_backend = NULL;
+CryptoCosts GroupKeyComputation::s_costs;
+bool GroupKeyComputation::s_batch = false;
+uint64_t GroupKeyComputation::s_seed = 0;
+std::vector<CryptoKey> GroupKeyComputation::s_secrets;
+std::vector<CryptoKey> GroupKeyComputation::s_contributions;
+std::vector<bool> GroupKeyComputation::s_known;
+
+GroupKeyComputation::GroupKeyComputation()
+  : m_slot(0),
+    m_busyUntil(0),
+    m_busyTime(0),
+    m_keyReadyTime(-1),
+    m_scalarMults(0)
+{
+  std::memset(m_groupKey.bytes, 0, sizeof(m_groupKey.bytes));
+}
+
+void GroupKeyComputation::Configure(CryptoBackend* backend, const CryptoCosts& costs, bool batch, uint64_t seed)
+{
+  s_backend = backend;
+  s_costs = costs;
+  s_batch = batch && backend != NULL && backend->SupportsBatch();
+  s_seed = seed;
+  s_secrets.clear();
+  s_contributions.clear();
+  s_known.clear();
+}
+
+void GroupKeyComputation::Initialize(uint32_t slot)
+{
+  m_slot = slot;
+  m_busyUntil = 0;
+  m_busyTime = 0;
+  m_keyReadyTime = -1;
+  std::memset(m_groupKey.bytes, 0, sizeof(m_groupKey.bytes));
+  m_scalarMults = 0;
+}
+
+const CryptoKey& GroupKeyComputation::Secret(uint32_t slot)
+{
+  if (slot >= s_known.size()) {
+    s_secrets.resize(slot + 1);
+    s_contributions.resize(slot + 1);
+    s_known.resize(slot + 1, false);
+  }
+  if (!s_known[slot]) {
+    // 私钥由种子与槽位确定，同一场景的重复运行得到相同的密钥
+    uint8_t material[12];
+    for (int i = 0; i < 8; i++) {
+      material[i] = (s_seed >> (8 * i)) & 0xff;
+    }
+    for (int i = 0; i < 4; i++) {
+      material[8 + i] = (slot >> (8 * i)) & 0xff;
+    }
+    s_secrets[slot] = s_backend->Hash(material, sizeof(material));
+    s_contributions[slot] = s_backend->GenerateContribution(s_secrets[slot]);
+    s_known[slot] = true;
+  }
+  return s_secrets[slot];
+}
+
+const CryptoKey& GroupKeyComputation::Contribution(uint32_t slot)
+{
+  Secret(slot);
+  return s_contributions[slot];
+}
+
+double GroupKeyComputation::Charge(double cost, double now)
+{
+  m_busyUntil = std::max(m_busyUntil, now) + cost;
+  m_busyTime += cost;
+  return m_busyUntil;
+}
+
+double GroupKeyComputation::GenerateContribution(double now)
+{
+  // 登记表中的贡献是同一计算的结果，这里为本节点重新计算一次
+  CryptoKey contribution = s_backend->GenerateContribution(Secret(m_slot));
+  s_contributions[m_slot] = contribution;
+  m_scalarMults++;
+  return Charge(s_costs.fixedBase, now);
+}
+
+double GroupKeyComputation::ProcessContributions(const std::vector<uint32_t>& slots, double now)
+{
+  std::vector<CryptoKey> contributions;
+  contributions.reserve(slots.size());
+  for (uint32_t k = 0; k < slots.size(); k++) {
+    if (slots[k] != m_slot) {
+      contributions.push_back(Contribution(slots[k]));
+    }
+  }
+  if (contributions.empty()) {
+    return m_busyUntil;
+  }
+  std::vector<CryptoKey> results;
+  s_backend->Combine(Secret(m_slot), contributions, results, s_batch);
+  m_scalarMults += contributions.size();
+  return Charge(s_costs.Combine(contributions.size(), s_batch), now);
+}
+
+double GroupKeyComputation::DeriveKey(const std::vector<uint32_t>& slots, double now)
+{
+  std::vector<uint8_t> data(32 * slots.size());
+  for (uint32_t k = 0; k < slots.size(); k++) {
+    std::memcpy(&data[32 * k], Contribution(slots[k]).bytes, 32);
+  }
+  m_groupKey = s_backend->Hash(data.empty() ? NULL : &data[0], data.size());
+  m_keyReadyTime = Charge(s_costs.hashPerByte * data.size(), now);
+  return m_keyReadyTime;
+}
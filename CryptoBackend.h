@@ -0,0 +1,170 @@
+/*
+ * CryptoBackend.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef CRYPTO_BACKEND_H
+#define CRYPTO_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 32字节的标量、群元素或组密钥
+struct CryptoKey
+{
+  uint8_t bytes[32];
+};
+
+/**
+ * 密钥计算后端，不依赖ns-3
+ *
+ * 贡献为私钥与基点的标量乘（固定基点），处理收到的贡献为私钥与该贡献的标量乘（可变基点），
+ * 组密钥为按槽位顺序排列的全部贡献的SHA-256。
+ * 这一构造只为让仿真执行真实的计算量，不作为协议安全性的依据。
+ */
+class CryptoBackend
+{
+public:
+  virtual ~CryptoBackend() {}
+  virtual std::string GetName() const = 0;
+  // 由私钥生成贡献
+  virtual CryptoKey GenerateContribution(const CryptoKey& secret) = 0;
+  // 对每个贡献做可变基点标量乘，batch为true且后端支持时合并各次标量乘的求逆
+  virtual void Combine(const CryptoKey& secret, const std::vector<CryptoKey>& contributions,
+                       std::vector<CryptoKey>& results, bool batch) = 0;
+  virtual CryptoKey Hash(const uint8_t* data, uint32_t length) = 0;
+  virtual bool SupportsBatch() const { return false; }
+
+  // 按名称创建后端：x25519，定义REGKA_WITH_OPENSSL时另有openssl；未知名称返回NULL
+  static CryptoBackend* Create(const std::string& name);
+};
+
+/**
+ * 纯C++的X25519（Curve25519的Montgomery阶梯）与SHA-256
+ *
+ * 固定基点预计算时，贡献在等价的Edwards曲线上用4位窗口的倍点表（64×16个点）计算，
+ * 只需64次点加，再换算为Montgomery的u坐标；否则与可变基点一样走阶梯。
+ * 批量时各次阶梯的射影坐标用Montgomery技巧共用一次求逆。
+ * 查表不是常数时间的，只适用于仿真。
+ */
+class X25519Backend : public CryptoBackend
+{
+public:
+  X25519Backend();
+  virtual std::string GetName() const { return "x25519"; }
+  virtual CryptoKey GenerateContribution(const CryptoKey& secret);
+  virtual void Combine(const CryptoKey& secret, const std::vector<CryptoKey>& contributions,
+                       std::vector<CryptoKey>& results, bool batch);
+  virtual CryptoKey Hash(const uint8_t* data, uint32_t length);
+  virtual bool SupportsBatch() const { return true; }
+
+  // 是否使用固定基点的倍点表，默认使用
+  void SetFixedBaseTable(bool enabled) { m_fixedBaseTable = enabled; }
+  bool GetFixedBaseTable() const { return m_fixedBaseTable; }
+
+private:
+  bool m_fixedBaseTable;
+};
+
+#ifdef REGKA_WITH_OPENSSL
+/**
+ * 基于OpenSSL EVP接口的X25519与SHA-256，不支持批量
+ */
+class OpenSslBackend : public CryptoBackend
+{
+public:
+  virtual std::string GetName() const { return "openssl"; }
+  virtual CryptoKey GenerateContribution(const CryptoKey& secret);
+  virtual void Combine(const CryptoKey& secret, const std::vector<CryptoKey>& contributions,
+                       std::vector<CryptoKey>& results, bool batch);
+  virtual CryptoKey Hash(const uint8_t* data, uint32_t length);
+};
+#endif
+
+/**
+ * 各项计算的CPU时间 (s)
+ */
+struct CryptoCosts
+{
+  CryptoCosts();
+
+  // 在本机上测量backend，repetitions为每项的重复次数
+  static CryptoCosts Measure(CryptoBackend& backend, uint32_t repetitions);
+  // 所有代价乘以factor，例如用本机测量值估计较慢的机载处理器
+  CryptoCosts Scaled(double factor) const;
+
+  // 处理count个贡献的代价
+  double Combine(uint32_t count, bool batch) const;
+
+  double fixedBase;      ///< 生成一个贡献
+  double variableBase;   ///< 单独处理一个贡献
+  double batchSetup;     ///< 批量处理的固定部分（一次求逆）
+  double batchPerOp;     ///< 批量处理时每个贡献的代价
+  double hashPerByte;    ///< 组密钥哈希每字节的代价
+};
+
+/**
+ * 单个节点的组密钥计算与CPU占用
+ *
+ * 节点的CPU按先到先服务串行执行计算：每次计算从max(当前时刻, 上次计算结束)开始，
+ * 占用代价对应的时间；协议引擎把CPU忙碌的剩余时间加到之后的发送时延上，
+ * 因此完成时刻与协商时延包含计算时间。
+ * 消息中的密钥材料仍只以填充表示，收到的贡献取自进程内按槽位登记的真实贡献值。
+ * 后端、代价与私钥种子为进程内共用的设置，未设置后端时不计算，协议行为不变。
+ */
+class GroupKeyComputation
+{
+public:
+  GroupKeyComputation();
+
+  // backend为NULL时关闭计算；backend不属于本类；会清空登记的贡献
+  static void Configure(CryptoBackend* backend, const CryptoCosts& costs, bool batch, uint64_t seed);
+  static bool IsEnabled() { return s_backend != NULL; }
+  static CryptoBackend* GetBackend() { return s_backend; }
+  static const CryptoCosts& GetCosts() { return s_costs; }
+  static bool GetBatch() { return s_batch; }
+
+  void Initialize(uint32_t slot);
+  // 以下计算在now时刻提交，返回计算结束的时刻
+  double GenerateContribution(double now);
+  double ProcessContributions(const std::vector<uint32_t>& slots, double now);
+  // 对slots（含自己）按顺序的贡献求组密钥
+  double DeriveKey(const std::vector<uint32_t>& slots, double now);
+  // 重新协商时丢弃已得到的组密钥，CPU占用保留
+  void ResetKey() { m_keyReadyTime = -1; }
+
+  double GetBusyUntil() const { return m_busyUntil; }
+  // 计算结束前剩余的CPU时间
+  double GetRemainingTime(double now) const { return m_busyUntil > now ? m_busyUntil - now : 0; }
+  double GetBusyTime() const { return m_busyTime; }
+  // 得到组密钥的时刻，尚未得到时为-1
+  double GetKeyReadyTime() const { return m_keyReadyTime; }
+  const CryptoKey& GetGroupKey() const { return m_groupKey; }
+  uint32_t GetScalarMultCount() const { return m_scalarMults; }
+
+private:
+  double Charge(double cost, double now);
+  // 槽位的私钥与贡献，首次使用时计算
+  static const CryptoKey& Secret(uint32_t slot);
+  static const CryptoKey& Contribution(uint32_t slot);
+
+  uint32_t m_slot;
+  double m_busyUntil;
+  double m_busyTime;
+  double m_keyReadyTime;
+  CryptoKey m_groupKey;
+  uint32_t m_scalarMults;
+
+  static CryptoBackend* s_backend;
+  static CryptoCosts s_costs;
+  static bool s_batch;
+  static uint64_t s_seed;
+  static std::vector<CryptoKey> s_secrets;
+  static std::vector<CryptoKey> s_contributions;
+  static std::vector<bool> s_known;
+};
+
+#endif /* CRYPTO_BACKEND_H */
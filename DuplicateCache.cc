@@ -0,0 +1,85 @@
+/*
+ * DuplicateCache.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "DuplicateCache.h"
+
+const uint32_t DuplicateCache::PROBE_LENGTH;
+
+DuplicateCache::DuplicateCache(uint32_t capacity, double window)
+  : m_mask(0),
+    m_window(window),
+    m_hits(0),
+    m_misses(0)
+{
+  uint32_t size = PROBE_LENGTH;
+  while (size < capacity) {
+    size *= 2;
+  }
+  m_entries.resize(size);
+  m_mask = size - 1;
+  Clear();
+}
+
+void DuplicateCache::Clear()
+{
+  for (uint32_t i = 0; i < m_entries.size(); i++) {
+    m_entries[i].used = false;
+  }
+  m_hits = 0;
+  m_misses = 0;
+}
+
+// 64位FNV-1a，与ResultCache::Hash相同
+uint64_t DuplicateCache::Hash(const uint8_t* data, size_t size)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+bool DuplicateCache::IsDuplicate(uint32_t sender, const uint8_t* data, size_t size, double now)
+{
+  uint64_t digest = Hash(data, size);
+  // 把发送方混入摘要再取槽位，不同发送方的相同内容分散到不同位置
+  uint64_t key = digest ^ (static_cast<uint64_t>(sender) * 0x9e3779b97f4a7c15ULL);
+  uint32_t home = static_cast<uint32_t>(key ^ (key >> 32)) & m_mask;
+
+  // 优先使用第一个空槽或过期槽，没有时覆盖最旧的记录
+  Entry* victim = NULL;
+  bool victimLive = true;
+  for (uint32_t i = 0; i < PROBE_LENGTH; i++) {
+    Entry& entry = m_entries[(home + i) & m_mask];
+    bool live = entry.used && now - entry.time <= m_window;
+    if (live && entry.digest == digest && entry.sender == sender) {
+      m_hits++;
+      return true;
+    }
+    if (!live) {
+      if (victim == NULL || victimLive) {
+        victim = &entry;
+        victimLive = false;
+      }
+    } else if (victim == NULL || (victimLive && entry.time < victim->time)) {
+      victim = &entry;
+    }
+  }
+
+  victim->digest = digest;
+  victim->sender = sender;
+  victim->used = true;
+  victim->time = now;
+  m_misses++;
+  return false;
+}
+
+uint64_t DuplicateCache::GetMemoryBytes() const
+{
+  return m_entries.capacity() * sizeof(Entry);
+}
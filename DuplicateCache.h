@@ -0,0 +1,61 @@
+/*
+ * DuplicateCache.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef DUPLICATE_CACHE_H
+#define DUPLICATE_CACHE_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * 固定内存的重复消息缓存
+ *
+ * 以（发送方，消息内容的64位FNV-1a摘要）为键的开放寻址表，每个键只在其哈希位置起的
+ * PROBE_LENGTH个槽中查找与插入，不需要删除标记。记录超过时间窗口即视为空槽；
+ * 这些槽都被占用时覆盖其中最旧的记录，所以内存固定，被覆盖的消息再次到达时按新消息处理。
+ * 命中的记录不刷新时间，同一内容在窗口过后会再被处理一次。
+ */
+class DuplicateCache
+{
+public:
+  static const uint32_t PROBE_LENGTH = 8;
+
+  // capacity向上取为2的幂，window为记录的有效时间 (s)
+  DuplicateCache(uint32_t capacity = 1024, double window = 1.0);
+
+  void SetWindow(double window) { m_window = window; }
+  double GetWindow() const { return m_window; }
+
+  // now时刻收到sender发来的内容：窗口内见过则返回true，否则记录下来并返回false
+  bool IsDuplicate(uint32_t sender, const uint8_t* data, size_t size, double now);
+  void Clear();
+
+  uint64_t GetHits() const { return m_hits; }
+  uint64_t GetMisses() const { return m_misses; }
+  // 表占用的堆内存字节数
+  uint64_t GetMemoryBytes() const;
+
+  static uint64_t Hash(const uint8_t* data, size_t size);
+
+private:
+  struct Entry
+  {
+    uint64_t digest;
+    uint32_t sender;
+    bool used;
+    double time;
+  };
+
+  std::vector<Entry> m_entries;
+  uint32_t m_mask;
+  double m_window;
+  uint64_t m_hits;
+  uint64_t m_misses;
+};
+
+#endif /* DUPLICATE_CACHE_H */
@@ -0,0 +1,300 @@
+/*
+ * FaultPlan.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "FaultPlan.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// 去掉首尾空白
+static std::string Trim(const std::string& s)
+{
+  std::string::size_type begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  std::string::size_type end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+// 整个字符串是一个数时返回true
+static bool ParseNumber(const std::string& text, double& value)
+{
+  if (text.empty()) {
+    return false;
+  }
+  char* end = NULL;
+  value = std::strtod(text.c_str(), &end);
+  return *end == '\0';
+}
+
+static bool IsQuality(const std::string& quality)
+{
+  return quality == "high" || quality == "medium" || quality == "low" || quality == "very_poor";
+}
+
+FaultEvent::FaultEvent()
+  : type(CRASH), start(0), end(-1), fraction(-1), axis(0), split(0.5)
+{
+}
+
+bool FaultEvent::IsActive(double time) const
+{
+  return time >= start && (end < 0 || time < end);
+}
+
+FaultPlan::FaultPlan()
+{
+  m_area[0] = 0;
+  m_area[1] = 0;
+  m_area[2] = 0;
+}
+
+bool FaultPlan::Parse(const std::string& spec)
+{
+  m_spec = Trim(spec);
+  m_events.clear();
+  if (m_spec.empty() || m_spec == "none") {
+    return true;
+  }
+  std::istringstream in(m_spec);
+  std::string text;
+  while (std::getline(in, text, '+')) {
+    FaultEvent event;
+    if (!ParseEvent(Trim(text), event)) {
+      std::cerr << "无法解析故障事件: " << text << std::endl;
+      m_events.clear();
+      return false;
+    }
+    m_events.push_back(event);
+  }
+  return true;
+}
+
+bool FaultPlan::ParseEvent(const std::string& text, FaultEvent& event)
+{
+  std::string::size_type at = text.find('@');
+  std::string::size_type colon = text.find(':', at);
+  if (at == std::string::npos || colon == std::string::npos) {
+    return false;
+  }
+  std::string type = text.substr(0, at);
+  std::string times = text.substr(at + 1, colon - at - 1);
+  std::string argument = text.substr(colon + 1);
+
+  std::string::size_type dash = times.find('-');
+  if (!ParseNumber(times.substr(0, dash), event.start)) {
+    return false;
+  }
+  event.end = -1;
+  if (dash != std::string::npos && (!ParseNumber(times.substr(dash + 1), event.end) || event.end <= event.start)) {
+    return false;
+  }
+
+  if (type == "crash") {
+    event.type = FaultEvent::CRASH;
+    // 崩溃不会恢复
+    return dash == std::string::npos && ParseNodes(argument, event);
+  } else if (type == "blackout") {
+    event.type = FaultEvent::BLACKOUT;
+    return ParseNodes(argument, event);
+  } else if (type == "partition") {
+    event.type = FaultEvent::PARTITION;
+    std::string axes = "xyz";
+    if (argument.size() < 3 || axes.find(argument[0]) == std::string::npos || argument[1] != '<') {
+      return false;
+    }
+    event.axis = axes.find(argument[0]);
+    return ParseNumber(argument.substr(2), event.split) && event.split > 0 && event.split < 1;
+  } else if (type == "degrade") {
+    event.type = FaultEvent::DEGRADE;
+    event.quality = argument;
+    return IsQuality(argument);
+  }
+  return false;
+}
+
+bool FaultPlan::ParseNodes(const std::string& text, FaultEvent& event)
+{
+  if (!text.empty() && text[text.size() - 1] == '%') {
+    double percent = 0;
+    if (!ParseNumber(text.substr(0, text.size() - 1), percent) || percent <= 0 || percent > 100) {
+      return false;
+    }
+    event.fraction = percent / 100;
+    return true;
+  }
+  std::istringstream in(text);
+  std::string item;
+  while (std::getline(in, item, '_')) {
+    char* end = NULL;
+    uint32_t node = std::strtoul(item.c_str(), &end, 10);
+    if (item.empty() || *end != '\0') {
+      return false;
+    }
+    event.nodes.push_back(node);
+  }
+  return !event.nodes.empty();
+}
+
+void FaultPlan::Resolve(uint32_t numNodes, double areaLength, double areaWidth, double areaHeight, uint64_t seed)
+{
+  m_area[0] = areaLength;
+  m_area[1] = areaWidth;
+  m_area[2] = areaHeight;
+  for (uint32_t k = 0; k < m_events.size(); k++) {
+    FaultEvent& event = m_events[k];
+    if (event.fraction < 0) {
+      continue;
+    }
+    // 每个事件单独播种（xorshift64*），同一场景的选取可复现，不同事件互不影响
+    uint64_t state = (seed + 1) * 0x9E3779B97F4A7C15ULL + k + 1;
+    std::vector<uint32_t> order(numNodes);
+    for (uint32_t i = 0; i < numNodes; i++) {
+      order[i] = i;
+    }
+    uint32_t count = static_cast<uint32_t>(event.fraction * numNodes + 0.5);
+    count = std::min(std::max<uint32_t>(count, 1), numNodes);
+    for (uint32_t i = 0; i < count; i++) {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      uint64_t random = state * 2685821657736338717ULL;
+      std::swap(order[i], order[i + random % (numNodes - i)]);
+    }
+    event.nodes.assign(order.begin(), order.begin() + count);
+    std::sort(event.nodes.begin(), event.nodes.end());
+  }
+}
+
+bool FaultPlan::IsListed(const FaultEvent& event, uint32_t node)
+{
+  return std::find(event.nodes.begin(), event.nodes.end(), node) != event.nodes.end();
+}
+
+std::vector<std::pair<double, uint32_t> > FaultPlan::GetCrashes() const
+{
+  std::vector<std::pair<double, uint32_t> > crashes;
+  for (uint32_t k = 0; k < m_events.size(); k++) {
+    if (m_events[k].type == FaultEvent::CRASH) {
+      for (uint32_t i = 0; i < m_events[k].nodes.size(); i++) {
+        crashes.push_back(std::make_pair(m_events[k].start, m_events[k].nodes[i]));
+      }
+    }
+  }
+  return crashes;
+}
+
+bool FaultPlan::IsCrashed(uint32_t node, double time) const
+{
+  for (uint32_t k = 0; k < m_events.size(); k++) {
+    const FaultEvent& event = m_events[k];
+    if (event.type == FaultEvent::CRASH && event.IsActive(time) && IsListed(event, node)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FaultPlan::HasLinkFaults() const
+{
+  for (uint32_t k = 0; k < m_events.size(); k++) {
+    if (m_events[k].type != FaultEvent::DEGRADE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FaultPlan::IsLinkBlocked(uint32_t from, uint32_t to, const double fromPosition[3],
+                              const double toPosition[3], double time) const
+{
+  for (uint32_t k = 0; k < m_events.size(); k++) {
+    const FaultEvent& event = m_events[k];
+    if (!event.IsActive(time)) {
+      continue;
+    }
+    switch (event.type) {
+      case FaultEvent::CRASH:
+      case FaultEvent::BLACKOUT:
+        if (IsListed(event, from) || IsListed(event, to)) {
+          return true;
+        }
+        break;
+      case FaultEvent::PARTITION: {
+        double plane = event.split * m_area[event.axis];
+        if ((fromPosition[event.axis] < plane) != (toPosition[event.axis] < plane)) {
+          return true;
+        }
+        break;
+      }
+      case FaultEvent::DEGRADE:
+        break;
+    }
+  }
+  return false;
+}
+
+std::string FaultPlan::GetQuality(double time, const std::string& base) const
+{
+  std::string quality = base;
+  for (uint32_t k = 0; k < m_events.size(); k++) {
+    if (m_events[k].type == FaultEvent::DEGRADE && m_events[k].IsActive(time)) {
+      quality = m_events[k].quality;
+    }
+  }
+  return quality;
+}
+
+std::vector<std::string> FaultPlan::GetDegradeQualities() const
+{
+  std::vector<std::string> qualities;
+  for (uint32_t k = 0; k < m_events.size(); k++) {
+    const FaultEvent& event = m_events[k];
+    if (event.type == FaultEvent::DEGRADE
+        && std::find(qualities.begin(), qualities.end(), event.quality) == qualities.end()) {
+      qualities.push_back(event.quality);
+    }
+  }
+  return qualities;
+}
+
+// -------------------------------------------------------------------
+
+bool FaultLibrary::LoadFile(const std::string& path)
+{
+  std::ifstream in(path.c_str());
+  if (!in.is_open()) {
+    std::cerr << "无法打开故障计划文件: " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  uint32_t lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    line = Trim(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string::size_type space = line.find_first_of(" \t");
+    FaultPlan plan;
+    if (space == std::string::npos || !plan.Parse(line.substr(space + 1))) {
+      std::cerr << "故障计划文件第" << lineNo << "行格式错误: " << line << std::endl;
+      return false;
+    }
+    m_plans[line.substr(0, space)] = Trim(line.substr(space + 1));
+  }
+  return true;
+}
+
+bool FaultLibrary::Find(const std::string& name, FaultPlan& plan) const
+{
+  std::map<std::string, std::string>::const_iterator it = m_plans.find(name);
+  return plan.Parse(it != m_plans.end() ? it->second : name);
+}
@@ -0,0 +1,108 @@
+/*
+ * FaultPlan.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef FAULT_PLAN_H
+#define FAULT_PLAN_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 故障计划中的一个事件
+struct FaultEvent
+{
+  enum Type
+  {
+    CRASH,      ///< 节点崩溃
+    BLACKOUT,   ///< 节点的链路中断
+    PARTITION,  ///< 按平面分成两组，组间链路中断
+    DEGRADE     ///< 链路质量下降
+  };
+
+  FaultEvent();
+  // time时刻事件是否生效
+  bool IsActive(double time) const;
+
+  Type type;
+  double start;                 ///< 开始时刻 (s)
+  double end;                   ///< 结束时刻 (s)，不含，-1为持续到仿真结束
+  std::vector<uint32_t> nodes;  ///< crash与blackout的节点，按比例选取时在Resolve中确定
+  double fraction;              ///< 按节点数的比例选取节点，-1为使用nodes
+  uint32_t axis;                ///< partition的坐标轴，0/1/2为x/y/z
+  double split;                 ///< partition的分界面在区域尺寸中的比例
+  std::string quality;          ///< degrade后的链路质量
+};
+
+/**
+ * 按时间安排的故障注入计划，不依赖ns-3
+ *
+ * 计划由若干事件用"+"连接，事件写作 类型@时间:参数，时间为仿真时刻 (s)，
+ * 区间写作T1-T2（不含T2），只写T1时持续到仿真结束：
+ * - crash@T:节点          节点在T时刻崩溃，停止收发与定时且不再恢复，也不通知其他节点
+ * - blackout@T1-T2:节点   区间内这些节点收发的帧全部丢失，节点照常运行
+ * - partition@T1-T2:x<F   区间内以x（或y、z）方向区域尺寸F倍处的平面把节点分成两组，组间的帧全部丢失
+ * - degrade@T1-T2:质量    区间内链路质量变为high/medium/low/very_poor，多个同时生效时后写的优先
+ * 节点写作"_"分隔的ID列表（如3_7_9），或节点数的百分比（如10%，按场景的run随机选取）。
+ * 例如 crash@1.005:10%+partition@2-8:x<0.5。空串或none表示没有故障。
+ * 崩溃后的节点同时视为链路中断，WiFi的MAC不会再为它回复ACK。
+ */
+class FaultPlan
+{
+public:
+  FaultPlan();
+
+  // 解析计划，格式错误时返回false并输出原因
+  bool Parse(const std::string& spec);
+  // 按节点数与seed选取按比例指定的节点，按区域尺寸换算分界面，需在查询前调用
+  void Resolve(uint32_t numNodes, double areaLength, double areaWidth, double areaHeight, uint64_t seed);
+
+  bool IsEmpty() const { return m_events.empty(); }
+  const std::string& GetSpec() const { return m_spec; }
+  const std::vector<FaultEvent>& GetEvents() const { return m_events; }
+
+  // 节点崩溃的时刻与节点，按计划中的顺序
+  std::vector<std::pair<double, uint32_t> > GetCrashes() const;
+  bool IsCrashed(uint32_t node, double time) const;
+  // 是否有crash、blackout或partition（需要按链路丢帧）
+  bool HasLinkFaults() const;
+  // time时刻from发给to的帧是否丢失，位置为两节点当时的坐标 (m)
+  bool IsLinkBlocked(uint32_t from, uint32_t to, const double fromPosition[3], const double toPosition[3],
+                     double time) const;
+  // time时刻的链路质量，没有生效的degrade时为base
+  std::string GetQuality(double time, const std::string& base) const;
+  // 计划中degrade用到的链路质量（不重复）
+  std::vector<std::string> GetDegradeQualities() const;
+
+private:
+  static bool ParseEvent(const std::string& text, FaultEvent& event);
+  static bool ParseNodes(const std::string& text, FaultEvent& event);
+  static bool IsListed(const FaultEvent& event, uint32_t node);
+
+  std::string m_spec;
+  std::vector<FaultEvent> m_events;
+  double m_area[3];
+};
+
+/**
+ * 命名的故障计划
+ *
+ * 文件每行为"名称 计划"，允许#开头的注释行与空行；
+ * 扫描与命令行中既可以写名称，也可以直接写计划。
+ */
+class FaultLibrary
+{
+public:
+  bool LoadFile(const std::string& path);
+  // 按名称或计划文本得到计划（未Resolve），都无法解析时返回false
+  bool Find(const std::string& name, FaultPlan& plan) const;
+
+private:
+  std::map<std::string, std::string> m_plans;
+};
+
+#endif /* FAULT_PLAN_H */
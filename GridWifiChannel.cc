@@ -0,0 +1,215 @@
+/*
+ * GridWifiChannel.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "GridWifiChannel.h"
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE("grid-wifi-channel");
+
+NS_OBJECT_ENSURE_REGISTERED(GridWifiChannel);
+
+TypeId GridWifiChannel::GetTypeId(void) {
+  static TypeId tid = TypeId("GridWifiChannel")
+    .SetParent<YansWifiChannel>()
+    .AddConstructor<GridWifiChannel>()
+    .AddAttribute("Margin", "网格边长在最大通信距离之外的余量 (m)，应不小于两次CourseChange之间的移动距离",
+                  DoubleValue(100.0),
+                  MakeDoubleAccessor(&GridWifiChannel::m_margin),
+                  MakeDoubleChecker<double>(0));
+  return tid;
+}
+
+GridWifiChannel::GridWifiChannel()
+  : m_maxRange(0),
+    m_margin(100.0),
+    m_transmissions(0),
+    m_candidates(0),
+    m_rebuilds(0),
+    m_marginViolations(0)
+{
+}
+
+void GridWifiChannel::DoDispose(void)
+{
+  m_senders.clear();
+  m_cells.clear();
+  m_loss = 0;
+  m_delay = 0;
+  YansWifiChannel::DoDispose();
+}
+
+bool GridWifiChannel::Cell::operator<(const Cell& other) const
+{
+  if (x != other.x) {
+    return x < other.x;
+  }
+  if (y != other.y) {
+    return y < other.y;
+  }
+  return z < other.z;
+}
+
+bool GridWifiChannel::Cell::operator!=(const Cell& other) const
+{
+  return x != other.x || y != other.y || z != other.z;
+}
+
+GridWifiChannel::Cell GridWifiChannel::GetCell(const Vector& position) const
+{
+  double size = m_maxRange + m_margin;
+  Cell cell;
+  cell.x = static_cast<int32_t>(std::floor(position.x / size));
+  cell.y = static_cast<int32_t>(std::floor(position.y / size));
+  cell.z = static_cast<int32_t>(std::floor(position.z / size));
+  return cell;
+}
+
+void GridWifiChannel::Activate()
+{
+  if (m_maxRange <= 0 || !m_senders.empty()) {
+    return;
+  }
+  PointerValue loss;
+  GetAttribute("PropagationLossModel", loss);
+  m_loss = loss.Get<PropagationLossModel>();
+  PointerValue delay;
+  GetAttribute("PropagationDelayModel", delay);
+  m_delay = delay.Get<PropagationDelayModel>();
+
+  // 先确定全部发送方，回调绑定的是m_senders中元素的地址，之后不能再扩容
+  uint32_t count = GetNDevices();
+  m_senders.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(GetDevice(i));
+    Sender sender;
+    sender.owner = this;
+    sender.index = i;
+    if (device != 0) {
+      sender.phy = DynamicCast<YansWifiPhy>(device->GetPhy());
+      sender.mobility = device->GetNode()->GetObject<MobilityModel>();
+    }
+    sender.channelVersion = 0;
+    sender.receivers = 0;
+    if (sender.phy == 0 || sender.mobility == 0) {
+      NS_LOG_WARN("设备" << i << "不是带移动模型的YansWifiPhy，网格信道不启用");
+      m_senders.clear();
+      return;
+    }
+    m_senders.push_back(sender);
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    Sender& sender = m_senders[i];
+    sender.position = sender.mobility->GetPosition();
+    Register(sender, GetCell(sender.position));
+    sender.mobility->TraceConnectWithoutContext("CourseChange",
+                                                MakeBoundCallback(&GridWifiChannel::CourseChanged, &sender));
+    sender.phy->TraceConnectWithoutContext("PhyTxBegin", MakeBoundCallback(&GridWifiChannel::TxBegin, &sender));
+  }
+}
+
+void GridWifiChannel::Register(Sender& sender, const Cell& cell)
+{
+  CellMembers& members = m_cells[cell];
+  members.phys.push_back(sender.index);
+  members.version++;
+  sender.cell = cell;
+}
+
+void GridWifiChannel::Unregister(Sender& sender)
+{
+  CellMembers& members = m_cells[sender.cell];
+  std::vector<uint32_t>::iterator it = std::find(members.phys.begin(), members.phys.end(), sender.index);
+  if (it != members.phys.end()) {
+    members.phys.erase(it);
+  }
+  members.version++;
+}
+
+void GridWifiChannel::CourseChanged(Sender* sender, Ptr<const MobilityModel> mobility)
+{
+  GridWifiChannel* owner = sender->owner;
+  Vector position = mobility->GetPosition();
+  // 上次登记以来的移动超过余量时，这段时间内可能漏掉了范围内的接收方
+  if (CalculateDistance(position, sender->position) > owner->m_margin) {
+    owner->m_marginViolations++;
+    NS_LOG_WARN("节点" << sender->index << "在两次CourseChange之间移动超过网格余量" << owner->m_margin << " m");
+  }
+  sender->position = position;
+  Cell cell = owner->GetCell(position);
+  if (cell != sender->cell) {
+    owner->Unregister(*sender);
+    owner->Register(*sender, cell);
+  }
+}
+
+uint64_t GridWifiChannel::GetNeighborhoodVersion(const Cell& center) const
+{
+  // 各格的版本号只增不减，和不变即所有相邻格的成员都没有变化
+  uint64_t version = 0;
+  Cell cell;
+  for (cell.x = center.x - 1; cell.x <= center.x + 1; cell.x++) {
+    for (cell.y = center.y - 1; cell.y <= center.y + 1; cell.y++) {
+      for (cell.z = center.z - 1; cell.z <= center.z + 1; cell.z++) {
+        std::map<Cell, CellMembers>::const_iterator it = m_cells.find(cell);
+        if (it != m_cells.end()) {
+          version += it->second.version;
+        }
+      }
+    }
+  }
+  return version;
+}
+
+void GridWifiChannel::TxBegin(Sender* sender, Ptr<const Packet> /*packet*/)
+{
+  // PhyTxBegin在YansWifiPhy::SendPacket调用信道的Send之前触发，此时换上的子信道对本次发送生效
+  GridWifiChannel* owner = sender->owner;
+  Cell center = owner->GetCell(sender->mobility->GetPosition());
+  uint64_t version = owner->GetNeighborhoodVersion(center);
+  if (sender->channel == 0 || center != sender->channelCell || version != sender->channelVersion) {
+    owner->Rebuild(*sender, center, version);
+  }
+  owner->m_transmissions++;
+  owner->m_candidates += sender->receivers;
+}
+
+void GridWifiChannel::Rebuild(Sender& sender, const Cell& center, uint64_t version)
+{
+  std::vector<uint32_t> receivers;
+  Cell cell;
+  for (cell.x = center.x - 1; cell.x <= center.x + 1; cell.x++) {
+    for (cell.y = center.y - 1; cell.y <= center.y + 1; cell.y++) {
+      for (cell.z = center.z - 1; cell.z <= center.z + 1; cell.z++) {
+        std::map<Cell, CellMembers>::const_iterator it = m_cells.find(cell);
+        if (it != m_cells.end()) {
+          receivers.insert(receivers.end(), it->second.phys.begin(), it->second.phys.end());
+        }
+      }
+    }
+  }
+  // 与总信道相同的顺序
+  std::sort(receivers.begin(), receivers.end());
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel>();
+  channel->SetPropagationLossModel(m_loss);
+  channel->SetPropagationDelayModel(m_delay);
+  uint32_t count = 0;
+  for (uint32_t k = 0; k < receivers.size(); k++) {
+    if (receivers[k] != sender.index) {
+      channel->Add(m_senders[receivers[k]].phy);
+      count++;
+    }
+  }
+  // SetChannel把发送方自己也加入子信道，Send会跳过它
+  sender.phy->SetChannel(channel);
+  sender.channel = channel;
+  sender.channelCell = center;
+  sender.channelVersion = version;
+  sender.receivers = count;
+  m_rebuilds++;
+}
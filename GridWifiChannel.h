@@ -0,0 +1,111 @@
+/*
+ * GridWifiChannel.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef GRID_WIFI_CHANNEL_H
+#define GRID_WIFI_CHANNEL_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+using namespace ns3;
+
+/**
+ * 按空间网格只向附近PHY投递的WiFi信道
+ *
+ * ns-3.25的YansWifiChannel::Send每次发送都遍历所有PHY，为每个接收方计算传播损失并安排接收事件，
+ * 超出最大通信距离的也不例外。Send不是虚函数，YansWifiPhy又只接受YansWifiChannel，
+ * 派生类无法替换发送循环，因此本类作为所有PHY最初加入的总信道，Activate后为每个PHY建立
+ * 只含附近PHY的子信道（普通YansWifiChannel，共用总信道的损失与时延模型）并设为该PHY的信道。
+ *
+ * 节点按位置划分到边长为最大通信距离加余量的网格中，所在格在CourseChange时更新；
+ * 发送前（PhyTxBegin）取发送方当前所在格及相邻26格中的PHY，这些格的成员有变化时才重建子信道。
+ * 两次CourseChange之间移动不超过余量时，最大通信距离内的接收方都在这些格中。
+ * 子信道按总信道中的顺序加入PHY，损失链对范围内节点对的调用顺序不变，配合
+ * PrunedPropagationLossModel时结果与遍历全部PHY相同；只是超出距离的接收方不再收到-1000 dBm的帧，
+ * PHY的RxDrop计数随之减少。
+ * 每个子信道都登记在ChannelList中直到仿真结束，已安排的接收事件不会指向已释放的信道，
+ * 内存随重建次数增长（每次为附近PHY数个指针）。
+ */
+class GridWifiChannel : public YansWifiChannel
+{
+public:
+  static TypeId GetTypeId(void);
+  GridWifiChannel();
+
+  // 所有可能用到的损失链中最大的MaxRange，0为不启用网格
+  void SetMaxRange(double maxRange) { m_maxRange = maxRange; }
+  double GetMaxRange() const { return m_maxRange; }
+  // 设备与移动模型都安装之后调用，为每个PHY建立子信道
+  void Activate();
+
+  // 发送次数与各次发送遍历的接收方数之和
+  uint64_t GetTransmissionCount() const { return m_transmissions; }
+  uint64_t GetCandidateCount() const { return m_candidates; }
+  // 重建子信道的次数
+  uint64_t GetRebuildCount() const { return m_rebuilds; }
+  // 两次CourseChange之间的移动超过余量的次数，不为0时可能漏掉范围内的接收方
+  uint64_t GetMarginViolations() const { return m_marginViolations; }
+
+protected:
+  virtual void DoDispose(void);
+
+private:
+  struct Cell
+  {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    bool operator<(const Cell& other) const;
+    bool operator!=(const Cell& other) const;
+  };
+  struct CellMembers
+  {
+    CellMembers() : version(0) {}
+    std::vector<uint32_t> phys;
+    uint64_t version;  ///< 成员每变化一次加1
+  };
+  struct Sender
+  {
+    GridWifiChannel* owner;
+    uint32_t index;                  ///< 在总信道中的序号
+    Ptr<YansWifiPhy> phy;
+    Ptr<MobilityModel> mobility;
+    Cell cell;                       ///< 网格中登记的格
+    Vector position;                 ///< 登记时的位置
+    Ptr<YansWifiChannel> channel;    ///< 子信道
+    Cell channelCell;                ///< 建立子信道时发送方所在的格
+    uint64_t channelVersion;         ///< 建立子信道时相邻各格的版本号之和
+    uint32_t receivers;              ///< 子信道中的接收方数
+  };
+
+  static void CourseChanged(Sender* sender, Ptr<const MobilityModel> mobility);
+  static void TxBegin(Sender* sender, Ptr<const Packet> packet);
+
+  Cell GetCell(const Vector& position) const;
+  void Register(Sender& sender, const Cell& cell);
+  void Unregister(Sender& sender);
+  uint64_t GetNeighborhoodVersion(const Cell& center) const;
+  void Rebuild(Sender& sender, const Cell& center, uint64_t version);
+
+  double m_maxRange;
+  double m_margin;
+  std::vector<Sender> m_senders;
+  std::map<Cell, CellMembers> m_cells;
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<PropagationDelayModel> m_delay;
+  uint64_t m_transmissions;
+  uint64_t m_candidates;
+  uint64_t m_rebuilds;
+  uint64_t m_marginViolations;
+};
+
+#endif /* GRID_WIFI_CHANNEL_H */
@@ -6,13 +6,15 @@
  */
 
 #include "KeyMatrix.h"
+#include "Profiler.h"
 #include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <cstdlib> // 添加这个头文件以支持rand()函数
 #include <stdint.h>
 #include <cmath>
 
+double KeyMatrix::s_minimumCR = 0.8;
+
 // 生成(0,1)之间的随机数
 double KeyMatrix::RandomVariable() const
 { 
@@ -22,11 +24,12 @@ double KeyMatrix::RandomVariable() const
 }
 
 // 默认构造函数
-KeyMatrix::KeyMatrix() : m_networkSize(0), m_nodeId(0) {
+KeyMatrix::KeyMatrix() : m_networkSize(0), m_nodeId(0), m_activeCount(0) {
 }
 
 // 构造函数,具体的初始化。
-KeyMatrix::KeyMatrix(uint32_t networkSize, uint32_t nodeId) : m_networkSize(networkSize), m_nodeId(nodeId) {
+KeyMatrix::KeyMatrix(uint32_t networkSize, uint32_t nodeId)
+  : m_networkSize(networkSize), m_nodeId(nodeId), m_active(networkSize, true), m_activeCount(networkSize) {
   // 直接在构造函数中初始化矩阵
   m_matrix.resize(m_networkSize);
   for (uint32_t i = 0; i < m_networkSize; i++) {
@@ -45,6 +48,8 @@ KeyMatrix::~KeyMatrix() {
 void KeyMatrix::InitializeMatrix(uint32_t networkSize, uint32_t nodeId) {
   m_networkSize = networkSize;
   m_nodeId = nodeId;
+  m_active.assign(m_networkSize, true);
+  m_activeCount = m_networkSize;
   m_matrix.resize(m_networkSize);
   for (uint32_t i = 0; i < m_networkSize; i++) {
     m_matrix[i].resize(m_networkSize);
@@ -70,8 +75,11 @@ void KeyMatrix::ReceiveKeyContribution(uint32_t contributorId)
 bool KeyMatrix::IsFull1() const
 {
   for (uint32_t i = 0; i < m_networkSize; i++) {
+    if (!m_active[i]) {
+      continue;
+    }
     for (uint32_t j = 0; j < m_networkSize; j++) {
-      if (m_matrix[i][j] != true) {
+      if (m_matrix[i][j] != true && m_active[j]) {
         return false;   
       }
     }
@@ -80,12 +88,16 @@ bool KeyMatrix::IsFull1() const
 }   
 
 // 合并收到的矩阵到本地矩阵，ReceivedMatrix也是KeyMatrix
-void KeyMatrix::MergeMatrix(const KeyMatrix& ReceivedMatrix)
+void KeyMatrix::MergeMatrix(const KeyMatrix& ReceivedMatrix, const std::vector<bool>* skipColumns)
 {
+  REGKA_PROFILE_SCOPE(PROFILE_MERGE_MATRIX, m_nodeId);
   // 遍历接收到的矩阵的每一行
   for (uint32_t i = 0; i < m_networkSize; i++) {
     // 遍历接收到的矩阵的每一列
     for (uint32_t j = 0; j < m_networkSize; j++) {
+      if (skipColumns != NULL && (*skipColumns)[j]) {
+        continue;
+      }
       // 如果接收到的矩阵的元素为true，则合并到本地矩阵
       m_matrix[i][j] = m_matrix[i][j] || ReceivedMatrix.m_matrix[i][j];
     }
@@ -100,6 +112,10 @@ double KeyMatrix::CalculateCR(uint32_t NeighborId) const
 
   // 计算差集大小 - 仅在本地节点中存在的密钥贡献, 邻居节点中不存在的密钥贡献
   for (uint32_t j = 0; j < m_networkSize; j++) {
+    // 已离开成员的贡献不再计入
+    if (!m_active[j]) {
+      continue;
+    }
     if (m_matrix[m_nodeId][j] && !m_matrix[NeighborId][j]) {
       diffCount++;
     }
@@ -119,19 +135,19 @@ double KeyMatrix::CalculateFD(uint32_t ContributorId) const
   uint32_t receivedCount = 0; // 已接收到贡献的节点数  
   // 计算已接收到该贡献者密钥的节点数量,即对应列中为1的节点数量
   for (uint32_t i = 0; i < m_networkSize; i++) {
-    if (m_matrix[i][ContributorId]) {
+    if (m_matrix[i][ContributorId] && m_active[i]) {
       receivedCount++;
     }
   }
-  // 返回已接收节点数与总节点数的比值作为转发度
-  return static_cast<double>(receivedCount) / m_networkSize;
+  // 返回已接收节点数与当前成员数的比值作为转发度
+  return static_cast<double>(receivedCount) / m_activeCount;
 }
 
 // 检查自己是否拥有所有密钥贡献
 bool KeyMatrix::SelfIsFull1() const
 {
   for (uint32_t i = 0; i < m_networkSize; i++) {
-    if (!m_matrix[m_nodeId][i]) {
+    if (!m_matrix[m_nodeId][i] && m_active[i]) {
       return false;
     }
   }
@@ -140,20 +156,21 @@ bool KeyMatrix::SelfIsFull1() const
 
 std::string KeyMatrix::GetForwardingContributions(uint32_t NeighborId) const
 {
+  REGKA_PROFILE_SCOPE(PROFILE_FORWARDING, m_nodeId);
   // 初始化一个m_networkSize大小的bit串，每一位的0和1代表本次消息中是否拥有该密钥贡献
   std::string forwardingContributions(m_networkSize, '0');
 
   // 如果自己拥有所有密钥贡献，则全部转发
   if (SelfIsFull1()) {
     for (uint32_t i = 0; i < m_networkSize; i++) {
-      forwardingContributions[i] = '1';
+      forwardingContributions[i] = m_active[i] ? '1' : '0';
     }
   }  
   else {
 
-  double cr = std::max(CalculateCR(NeighborId), 0.8);
+  double cr = std::max(CalculateCR(NeighborId), s_minimumCR);
   for (uint32_t j = 0; j < m_networkSize; j++) {
-    if (m_matrix[m_nodeId][j] && !m_matrix[NeighborId][j] && RandomVariable() < cr) {
+    if (m_active[j] && m_matrix[m_nodeId][j] && !m_matrix[NeighborId][j] && RandomVariable() < cr) {
         forwardingContributions[j] = '1';
       }
     }
@@ -162,15 +179,25 @@ std::string KeyMatrix::GetForwardingContributions(uint32_t NeighborId) const
 }
 
 
+uint64_t KeyMatrix::GetMemoryBytes() const
+{
+  // vector<bool>按64位字存储
+  uint64_t bytes = m_matrix.capacity() * sizeof(std::vector<bool>) + (m_active.capacity() + 63) / 64 * 8;
+  for (uint32_t i = 0; i < m_matrix.size(); i++) {
+    bytes += (m_matrix[i].capacity() + 63) / 64 * 8;
+  }
+  return bytes;
+}
+
 // 将矩阵转换为字符串
 std::string KeyMatrix::MatrixToString() const {
+  REGKA_PROFILE_SCOPE(PROFILE_MATRIX_TO_STRING, m_nodeId);
+  // 逐个字符追加，不为每个元素构造ostringstream（N×N次流构造是转发时的主要开销）
   std::string matrixString;
+  matrixString.reserve(m_networkSize * m_networkSize);
   for (uint32_t i = 0; i < m_networkSize; i++) {
     for (uint32_t j = 0; j < m_networkSize; j++) {
-      // 使用std::ostringstream替代std::to_string
-      std::ostringstream ss;
-      ss << (m_matrix[i][j] ? 1 : 0);
-      matrixString += ss.str();
+      matrixString += m_matrix[i][j] ? '1' : '0';
     }
   }
   return matrixString;
@@ -178,6 +205,7 @@ std::string KeyMatrix::MatrixToString() const {
 
 // 将字符串转换为矩阵
 KeyMatrix KeyMatrix::StringToMatrix(const std::string& matrixString) const {
+  REGKA_PROFILE_SCOPE(PROFILE_STRING_TO_MATRIX, m_nodeId);
   KeyMatrix result;
   result.InitializeMatrix(m_networkSize, m_nodeId);
   
@@ -192,3 +220,75 @@ KeyMatrix KeyMatrix::StringToMatrix(const std::string& matrixString) const {
   }
   return result;
 }
+
+std::string KeyMatrix::RowsToString(uint32_t firstRow, uint32_t count) const {
+  std::string rows;
+  rows.reserve(count * m_networkSize);
+  for (uint32_t i = firstRow; i < firstRow + count && i < m_networkSize; i++) {
+    for (uint32_t j = 0; j < m_networkSize; j++) {
+      rows += m_matrix[i][j] ? '1' : '0';
+    }
+  }
+  return rows;
+}
+
+void KeyMatrix::MergeRows(uint32_t firstRow, const std::string& rows, uint32_t rowLength,
+                          const std::vector<bool>* skipColumns) {
+  REGKA_PROFILE_SCOPE(PROFILE_MERGE_MATRIX, m_nodeId);
+  if (rowLength == 0) {
+    rowLength = m_networkSize;
+  }
+  if (rowLength == 0) {
+    return;
+  }
+  uint32_t count = rows.size() / rowLength;
+  uint32_t columns = std::min(rowLength, m_networkSize);
+  for (uint32_t k = 0; k < count && firstRow + k < m_networkSize; k++) {
+    for (uint32_t j = 0; j < columns; j++) {
+      if (rows[k * rowLength + j] == '1' && (skipColumns == NULL || !(*skipColumns)[j])) {
+        m_matrix[firstRow + k][j] = true;
+      }
+    }
+  }
+}
+
+void KeyMatrix::Resize(uint32_t networkSize) {
+  if (networkSize <= m_networkSize) {
+    return;
+  }
+  // 新槽位为未加入的成员，只拥有自己的贡献
+  for (uint32_t i = 0; i < m_networkSize; i++) {
+    m_matrix[i].resize(networkSize, false);
+  }
+  m_matrix.resize(networkSize);
+  for (uint32_t i = m_networkSize; i < networkSize; i++) {
+    m_matrix[i].assign(networkSize, false);
+    m_matrix[i][i] = true;
+  }
+  m_active.resize(networkSize, false);
+  m_networkSize = networkSize;
+}
+
+void KeyMatrix::SetActive(uint32_t slot, bool active) {
+  Resize(slot + 1);
+  if (m_active[slot] != active) {
+    m_active[slot] = active;
+    if (active) {
+      m_activeCount++;
+    } else {
+      m_activeCount--;
+    }
+  }
+}
+
+void KeyMatrix::ResetContribution(uint32_t contributorId) {
+  for (uint32_t i = 0; i < m_networkSize; i++) {
+    m_matrix[i][contributorId] = (i == contributorId);
+  }
+}
+
+void KeyMatrix::ResetRow(uint32_t nodeId) {
+  for (uint32_t j = 0; j < m_networkSize; j++) {
+    m_matrix[nodeId][j] = (j == nodeId);
+  }
+}
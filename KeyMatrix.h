@@ -32,8 +32,8 @@ public:
   // 接收来自另一个节点的密钥贡献
   void ReceiveKeyContribution(uint32_t contributorId);
 
-  // 合并另一个节点的矩阵信息
-  void MergeMatrix(const KeyMatrix& ReceivedMatrix);
+  // 合并另一个节点的矩阵信息，skipColumns中为true的列不合并（NULL为全部合并）
+  void MergeMatrix(const KeyMatrix& ReceivedMatrix, const std::vector<bool>* skipColumns = NULL);
 
   // 计算与另一个节点的补充率
   double CalculateCR(uint32_t NeighborId) const;
@@ -43,6 +43,9 @@ public:
   double RandomVariable() const;
   // 获取需要转发的密钥贡献集合
   std::string GetForwardingContributions(uint32_t NeighborId) const;
+  // 转发概率的下限，默认0.8，所有节点共用
+  static void SetMinimumCR(double minimumCR) { s_minimumCR = minimumCR; }
+  static double GetMinimumCR() { return s_minimumCR; }
 
   bool IsFull1() const;
   // 检查自己是否拥有所有密钥贡献
@@ -51,12 +54,35 @@ public:
   std::string MatrixToString() const;
   // 将字符串转换为矩阵
   KeyMatrix StringToMatrix(const std::string& matrixString) const;
+  // 将第firstRow行起的count行转换为字符串，格式同MatrixToString
+  std::string RowsToString(uint32_t firstRow, uint32_t count) const;
+  // 合并从第firstRow行起的若干行，每行rowLength个字符（0为本矩阵的网络节点数量），
+  // 超出矩阵的行与列被忽略，skipColumns同MergeMatrix
+  void MergeRows(uint32_t firstRow, const std::string& rows, uint32_t rowLength = 0,
+                 const std::vector<bool>* skipColumns = NULL);
+  // 成员变化：槽位即节点ID，离开的成员保留槽位（墓碑），不再参与完成判断、补充率、转发度与转发
+  uint32_t GetNetworkSize() const { return m_networkSize; }
+  uint32_t GetActiveCount() const { return m_activeCount; }
+  bool IsActive(uint32_t slot) const { return slot < m_networkSize && m_active[slot]; }
+  // 扩大到networkSize个槽位，新槽位为未加入的成员
+  void Resize(uint32_t networkSize);
+  // 设置槽位是否为当前成员，超出时先扩大
+  void SetActive(uint32_t slot, bool active);
+  // 清除所有节点对contributorId贡献的拥有记录（贡献更新），只保留贡献者自己
+  void ResetContribution(uint32_t contributorId);
+  // 清除nodeId拥有的贡献记录（新加入的节点只拥有自己的贡献）
+  void ResetRow(uint32_t nodeId);
+  // 矩阵占用的堆内存字节数（按容量计）
+  uint64_t GetMemoryBytes() const;
 
 
 private:
   std::vector<std::vector<bool> > m_matrix; ///< 密钥贡献矩阵,是一个二维数组,m_matrix[i][j]表示节点i是否拥有节点j的密钥贡献
   uint32_t m_networkSize;                  ///< 网络节点数量
   uint32_t m_nodeId;                       ///< 当前节点ID
+  std::vector<bool> m_active;              ///< 槽位是否为当前成员
+  uint32_t m_activeCount;                  ///< 当前成员数
+  static double s_minimumCR;               ///< 转发概率的下限
 };
 
 #endif /* KEY_MATRIX_H */ 
\ No newline at end of file
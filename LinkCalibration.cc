@@ -0,0 +1,267 @@
+/*
+ * LinkCalibration.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "LinkCalibration.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+const double LinkCalibration::DISTANCE_BIN = 25.0;
+const uint32_t LinkCalibration::SIZE_BIN = 1024;
+const uint32_t LinkCalibration::MIN_SAMPLES = 30;
+
+LinkProfile::LinkProfile()
+  : quality("medium"),
+    txPowerDbm(18.0),
+    rxGainDb(3.0),
+    referenceLoss(40.05),
+    exponent(2.5),
+    shadowSigmaDb(5.0),
+    maxRange(700.0),
+    rxThresholdDbm(-88.0),
+    dataRate(12e6),
+    fragmentBytes(2276),
+    frameOverhead(115e-6),
+    maxRetries(7)
+{
+}
+
+// 参数与SetupLinkQuality保持一致；rxGainDb包含YansWifiPhy默认1 dB的TxGain
+LinkProfile LinkProfile::ForQuality(const std::string& quality)
+{
+  LinkProfile p;
+  p.quality = quality;
+  if (quality == "high") {
+    p.txPowerDbm = 20.0;
+    p.referenceLoss = 40.05;   // Friis, 2.4 GHz
+    p.exponent = 2.0;
+    p.shadowSigmaDb = 2.0;
+    p.maxRange = 1200.0;
+  } else if (quality == "medium") {
+    p.txPowerDbm = 18.0;
+    p.referenceLoss = 40.05;
+    p.exponent = 2.5;
+    p.shadowSigmaDb = 5.0;
+    p.maxRange = 700.0;
+  } else if (quality == "low") {
+    p.txPowerDbm = 14.0;
+    p.referenceLoss = 46.7;
+    p.exponent = 3.2;
+    p.shadowSigmaDb = 7.0;
+    p.maxRange = 600.0;
+  } else {
+    p.quality = "very_poor";
+    p.txPowerDbm = 10.0;
+    p.referenceLoss = 46.7;
+    p.exponent = 3.9;
+    p.shadowSigmaDb = 9.0;
+    p.maxRange = 400.0;
+  }
+  return p;
+}
+
+LinkCalibration::LinkCalibration()
+{
+}
+
+LinkCalibration::BinKey LinkCalibration::GetKey(double distance, uint32_t bytes, bool unicast) const
+{
+  return std::make_pair(unicast, std::make_pair(static_cast<uint32_t>(distance / DISTANCE_BIN), bytes / SIZE_BIN));
+}
+
+// 加上UDP与IP头后的分片数
+uint32_t LinkCalibration::GetFrames(uint32_t bytes) const
+{
+  uint32_t frames = (bytes + 28 + m_profile.fragmentBytes - 1) / m_profile.fragmentBytes;
+  return std::max<uint32_t>(frames, 1);
+}
+
+// 单帧成功率 Q((门限-接收功率)/σ)，单播帧失败后重传
+double LinkCalibration::GetModelProbability(double distance, uint32_t bytes, bool unicast) const
+{
+  if (distance > m_profile.maxRange) {
+    return 0;
+  }
+  double d = std::max(distance, 1.0);
+  double rxPower = m_profile.txPowerDbm + m_profile.rxGainDb
+                   - m_profile.referenceLoss - 10 * m_profile.exponent * std::log10(d);
+  double z = (m_profile.rxThresholdDbm - rxPower) / m_profile.shadowSigmaDb;
+  double frame = 0.5 * erfc(z / std::sqrt(2.0));
+  if (unicast) {
+    frame = 1 - std::pow(1 - frame, static_cast<double>(m_profile.maxRetries + 1));
+  }
+  return std::pow(frame, static_cast<double>(GetFrames(bytes)));
+}
+
+double LinkCalibration::GetModelDelay(double distance, uint32_t bytes, bool unicast) const
+{
+  uint32_t frames = GetFrames(bytes);
+  // 每帧另加36字节MAC头与FCS
+  double airtime = (bytes + 28 + 36.0 * frames) * 8 / m_profile.dataRate;
+  double delay = airtime + frames * m_profile.frameOverhead;
+  if (unicast) {
+    // 按单帧成功率估计平均发送次数
+    double frame = GetModelProbability(distance, m_profile.fragmentBytes - 28, false);
+    double attempts = (frame > 0) ? std::min(1 / frame, m_profile.maxRetries + 1.0) : m_profile.maxRetries + 1.0;
+    delay *= attempts;
+  }
+  return delay;
+}
+
+double LinkCalibration::GetDeliveryProbability(double distance, uint32_t bytes, bool unicast) const
+{
+  BinMap::const_iterator it = m_bins.find(GetKey(distance, bytes, unicast));
+  if (it != m_bins.end() && it->second.attempts >= MIN_SAMPLES) {
+    return static_cast<double>(it->second.deliveries) / it->second.attempts;
+  }
+  return GetModelProbability(distance, bytes, unicast);
+}
+
+double LinkCalibration::GetDelay(double distance, uint32_t bytes, bool unicast) const
+{
+  BinMap::const_iterator it = m_bins.find(GetKey(distance, bytes, unicast));
+  if (it != m_bins.end() && it->second.deliveries >= MIN_SAMPLES) {
+    return it->second.delaySum / it->second.deliveries;
+  }
+  return GetModelDelay(distance, bytes, unicast);
+}
+
+void LinkCalibration::AddSample(double distance, uint32_t bytes, bool unicast, bool delivered, double delay)
+{
+  Bin& bin = m_bins[GetKey(distance, bytes, unicast)];
+  bin.attempts++;
+  if (delivered) {
+    bin.deliveries++;
+    bin.delaySum += delay;
+  }
+}
+
+uint64_t LinkCalibration::GetSampleCount() const
+{
+  uint64_t count = 0;
+  for (BinMap::const_iterator it = m_bins.begin(); it != m_bins.end(); ++it) {
+    count += it->second.attempts;
+  }
+  return count;
+}
+
+// 文件格式：每行 链路质量 单播(u)/广播(b) 距离分箱 长度分箱 发送次数 收到次数 时延总和
+bool LinkCalibration::ParseLine(const std::string& line, std::string& quality, BinKey& key, Bin& bin)
+{
+  std::istringstream ss(line);
+  std::string cast;
+  if (!(ss >> quality >> cast >> key.second.first >> key.second.second >> bin.attempts >> bin.deliveries >> bin.delaySum)) {
+    return false;
+  }
+  key.first = (cast == "u");
+  return true;
+}
+
+bool LinkCalibration::Load(const std::string& file)
+{
+  std::ifstream in(file.c_str());
+  if (!in.is_open()) {
+    return false;
+  }
+  m_bins.clear();
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string quality;
+    BinKey key;
+    Bin bin;
+    if (!ParseLine(line, quality, key, bin)) {
+      std::cerr << "校准文件格式错误: " << line << std::endl;
+      return false;
+    }
+    if (quality == m_profile.quality) {
+      m_bins[key] = bin;
+    }
+  }
+  return true;
+}
+
+bool LinkCalibration::Save(const std::string& file) const
+{
+  int fd = open(file.c_str(), O_RDWR | O_CREAT, 0666);
+  if (fd < 0) {
+    std::cerr << "无法打开校准文件: " << file << " 错误: " << strerror(errno) << std::endl;
+    return false;
+  }
+  flock(fd, LOCK_EX);
+
+  // 读取已有内容，其他档位原样保留，本档位的分箱累加
+  std::string content;
+  char buf[4096];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) {
+    content.append(buf, n);
+  }
+  std::ostringstream out;
+  out << "# quality cast distanceBin(" << DISTANCE_BIN << "m) sizeBin(" << SIZE_BIN << "B) attempts deliveries delaySum\n";
+  BinMap merged = m_bins;
+  std::istringstream in(content);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string quality;
+    BinKey key;
+    Bin bin;
+    if (!ParseLine(line, quality, key, bin)) {
+      continue;
+    }
+    if (quality != m_profile.quality) {
+      out << line << "\n";
+      continue;
+    }
+    Bin& m = merged[key];
+    m.attempts += bin.attempts;
+    m.deliveries += bin.deliveries;
+    m.delaySum += bin.delaySum;
+  }
+  out << std::setprecision(12);
+  for (BinMap::const_iterator it = merged.begin(); it != merged.end(); ++it) {
+    out << m_profile.quality << " " << (it->first.first ? "u" : "b") << " "
+        << it->first.second.first << " " << it->first.second.second << " "
+        << it->second.attempts << " " << it->second.deliveries << " " << it->second.delaySum << "\n";
+  }
+
+  std::string data = out.str();
+  bool ok = (lseek(fd, 0, SEEK_SET) == 0 && ftruncate(fd, 0) == 0);
+  const char* p = data.c_str();
+  size_t left = data.size();
+  while (ok && left > 0) {
+    n = write(fd, p, left);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      ok = false;
+      break;
+    }
+    p += n;
+    left -= n;
+  }
+  if (!ok) {
+    std::cerr << "写入校准文件失败: " << file << " 错误: " << strerror(errno) << std::endl;
+  }
+  flock(fd, LOCK_UN);
+  close(fd);
+  return ok;
+}
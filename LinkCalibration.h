@@ -0,0 +1,98 @@
+/*
+ * LinkCalibration.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef LINK_CALIBRATION_H
+#define LINK_CALIBRATION_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 链路质量档位的物理参数，与SetupLinkQuality中的配置一一对应
+struct LinkProfile
+{
+  LinkProfile();
+
+  std::string quality;      ///< high/medium/low/very_poor
+  double txPowerDbm;        ///< 发射功率
+  double rxGainDb;          ///< 接收天线增益
+  double referenceLoss;     ///< 1 m处的路径损耗 (dB)，Friis按2.4 GHz计算
+  double exponent;          ///< 路径损耗指数
+  double shadowSigmaDb;     ///< RandomPropagationLossModel的标准差
+  double maxRange;          ///< RangePropagationLossModel的最大距离 (m)
+  double rxThresholdDbm;    ///< 可正确解码的接收功率：噪声底-94 dBm，低阶OFDM速率约需6 dB信噪比
+  double dataRate;          ///< 物理层速率 (bit/s)
+  uint32_t fragmentBytes;   ///< 单帧承载的最大IP字节数（WifiNetDevice MTU）
+  double frameOverhead;     ///< 每帧的前导、DIFS与平均退避时间 (s)
+  uint32_t maxRetries;      ///< 单播帧的MAC重传次数（MaxSlrc）
+
+  static LinkProfile ForQuality(const std::string& quality);
+};
+
+/**
+ * 抽象信道的链路模型：给定距离与消息长度，返回整条消息被收到的概率与时延
+ *
+ * 默认使用解析模型：按链路预算计算平均接收功率，叠加对数正态阴影衰落后
+ * 单帧成功率为 Q((门限-接收功率)/σ)，单播帧另有MAC重传，消息分片为k帧时成功率取其k次方；
+ * 时延为各帧的空口时间之和。
+ * 由完整WiFi仿真记录的样本（单播/广播、距离、长度、是否收到、时延）按距离和长度分箱统计，
+ * 样本足够的分箱优先使用统计值，不足时退回解析模型。
+ */
+class LinkCalibration
+{
+public:
+  LinkCalibration();
+
+  void SetProfile(const LinkProfile& profile) { m_profile = profile; }
+  const LinkProfile& GetProfile() const { return m_profile; }
+
+  // 整条消息被收到的概率
+  double GetDeliveryProbability(double distance, uint32_t bytes, bool unicast) const;
+  // 消息从发送到被收到的时延 (s)
+  double GetDelay(double distance, uint32_t bytes, bool unicast) const;
+
+  // 不计重传时发送一条消息占用信道的时间 (s)
+  double GetAirtime(uint32_t bytes) const { return GetModelDelay(0, bytes, false); }
+
+  // 添加一个实测样本
+  void AddSample(double distance, uint32_t bytes, bool unicast, bool delivered, double delay);
+  // 分箱中的样本数
+  uint64_t GetSampleCount() const;
+
+  // 读取校准文件中与当前档位匹配的分箱，文件不存在时返回false
+  bool Load(const std::string& file);
+  // 合并写回校准文件，保留其他档位的分箱；文件加锁，多个进程可以同时写入
+  bool Save(const std::string& file) const;
+
+  static const double DISTANCE_BIN;   ///< 距离分箱宽度 (m)
+  static const uint32_t SIZE_BIN;     ///< 长度分箱宽度 (byte)
+  static const uint32_t MIN_SAMPLES;  ///< 使用统计值所需的最少样本数
+
+private:
+  struct Bin
+  {
+    Bin() : attempts(0), deliveries(0), delaySum(0) {}
+    uint64_t attempts;
+    uint64_t deliveries;
+    double delaySum;
+  };
+  // 键为 (是否单播, 距离分箱, 长度分箱)
+  typedef std::pair<bool, std::pair<uint32_t, uint32_t> > BinKey;
+  typedef std::map<BinKey, Bin> BinMap;
+
+  BinKey GetKey(double distance, uint32_t bytes, bool unicast) const;
+  uint32_t GetFrames(uint32_t bytes) const;
+  double GetModelProbability(double distance, uint32_t bytes, bool unicast) const;
+  double GetModelDelay(double distance, uint32_t bytes, bool unicast) const;
+  static bool ParseLine(const std::string& line, std::string& quality, BinKey& key, Bin& bin);
+
+  LinkProfile m_profile;
+  BinMap m_bins;
+};
+
+#endif /* LINK_CALIBRATION_H */
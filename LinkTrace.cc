@@ -0,0 +1,156 @@
+/*
+ * LinkTrace.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "LinkTrace.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+const uint32_t LinkTrace::BROADCAST = 0xffffffff;
+const uint32_t LinkTrace::VERSION = 1;
+
+static const char TRACE_MAGIC[4] = { 'R', 'G', 'K', 'T' };
+
+template <class T>
+static void Put(std::ostream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T>
+static bool Get(std::istream& in, T& value)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+LinkTrace::LinkTrace()
+  : m_numNodes(0)
+{
+}
+
+const LinkTrace::Sample* LinkTrace::GetSample(double time) const
+{
+  if (m_samples.empty()) {
+    return NULL;
+  }
+  // 二分查找最后一个不晚于time的采样
+  uint32_t lo = 0;
+  uint32_t hi = m_samples.size();
+  while (hi - lo > 1) {
+    uint32_t mid = (lo + hi) / 2;
+    if (m_samples[mid].time <= time) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return &m_samples[lo];
+}
+
+bool LinkTrace::Write(const std::string& file) const
+{
+  // 先写临时文件再改名，并行写入时读者不会看到半个文件
+  std::string tmp = file + ".tmp";
+  std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "无法写入链路轨迹: " << file << std::endl;
+    return false;
+  }
+  out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  Put(out, VERSION);
+  Put(out, m_numNodes);
+  Put(out, static_cast<uint32_t>(m_label.size()));
+  out.write(m_label.data(), m_label.size());
+
+  Put(out, static_cast<uint32_t>(m_samples.size()));
+  for (uint32_t i = 0; i < m_samples.size(); i++) {
+    Put(out, m_samples[i].time);
+    if (m_numNodes > 0) {
+      out.write(reinterpret_cast<const char*>(&m_samples[i].positions[0]), m_numNodes * sizeof(Position));
+    }
+  }
+
+  Put(out, static_cast<uint32_t>(m_transmissions.size()));
+  for (uint32_t i = 0; i < m_transmissions.size(); i++) {
+    const Transmission& tx = m_transmissions[i];
+    Put(out, tx.time);
+    Put(out, tx.sender);
+    Put(out, tx.destination);
+    Put(out, tx.bytes);
+    Put(out, static_cast<uint32_t>(tx.receivers.size()));
+    for (uint32_t k = 0; k < tx.receivers.size(); k++) {
+      Put(out, tx.receivers[k].node);
+      Put(out, tx.receivers[k].distance);
+      Put(out, tx.receivers[k].delay);
+    }
+  }
+  out.close();
+  if (!out || std::rename(tmp.c_str(), file.c_str()) != 0) {
+    std::cerr << "写入链路轨迹失败: " << file << std::endl;
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool LinkTrace::Read(const std::string& file)
+{
+  std::ifstream in(file.c_str(), std::ios::binary);
+  if (!in.is_open()) {
+    std::cerr << "无法打开链路轨迹: " << file << std::endl;
+    return false;
+  }
+  char magic[4];
+  uint32_t version = 0;
+  uint32_t labelSize = 0;
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0
+      || !Get(in, version) || version != VERSION || !Get(in, m_numNodes) || !Get(in, labelSize)) {
+    std::cerr << "不是有效的链路轨迹文件: " << file << std::endl;
+    return false;
+  }
+  m_label.resize(labelSize);
+  if (labelSize > 0 && !in.read(&m_label[0], labelSize)) {
+    return false;
+  }
+
+  uint32_t count = 0;
+  if (!Get(in, count)) {
+    return false;
+  }
+  m_samples.resize(count);
+  for (uint32_t i = 0; i < count; i++) {
+    m_samples[i].positions.resize(m_numNodes);
+    if (!Get(in, m_samples[i].time)
+        || (m_numNodes > 0 && !in.read(reinterpret_cast<char*>(&m_samples[i].positions[0]), m_numNodes * sizeof(Position)))) {
+      std::cerr << "链路轨迹不完整: " << file << std::endl;
+      return false;
+    }
+  }
+
+  if (!Get(in, count)) {
+    return false;
+  }
+  m_transmissions.resize(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Transmission& tx = m_transmissions[i];
+    uint32_t receivers = 0;
+    if (!Get(in, tx.time) || !Get(in, tx.sender) || !Get(in, tx.destination) || !Get(in, tx.bytes)
+        || !Get(in, receivers)) {
+      std::cerr << "链路轨迹不完整: " << file << std::endl;
+      return false;
+    }
+    tx.receivers.resize(receivers);
+    for (uint32_t k = 0; k < receivers; k++) {
+      if (!Get(in, tx.receivers[k].node) || !Get(in, tx.receivers[k].distance) || !Get(in, tx.receivers[k].delay)) {
+        std::cerr << "链路轨迹不完整: " << file << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,83 @@
+/*
+ * LinkTrace.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef LINK_TRACE_H
+#define LINK_TRACE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * 一次完整WiFi仿真的信道实现：节点位置采样与每次发送的接收结果
+ *
+ * 由CalibrationRecorder在ns-3仿真中记录，standalone/regka-replay读取后
+ * 只重新执行协议逻辑，不再计算PHY/MAC，便于在相同的信道实现上成对比较协议参数。
+ *
+ * 二进制格式（本机字节序）：
+ *   "RGKT" uint32版本 uint32节点数 uint32标签长度 标签
+ *   uint32采样数，每个采样 double时刻 + 节点数*(float x,y,z)
+ *   uint32发送数，每次发送 double时刻 uint32发送方 uint32目的 uint32字节数 uint32接收方数，
+ *     每个接收方 uint32节点 float距离 float时延（小于0表示未收到）
+ */
+class LinkTrace
+{
+public:
+  static const uint32_t BROADCAST;   ///< 与RegkaProtocol::BROADCAST相同
+  static const uint32_t VERSION;
+
+  struct Position
+  {
+    float x, y, z;
+  };
+  struct Sample
+  {
+    double time;
+    std::vector<Position> positions;
+  };
+  struct Reception
+  {
+    uint32_t node;
+    float distance;
+    float delay;      ///< 小于0表示未收到
+  };
+  struct Transmission
+  {
+    double time;
+    uint32_t sender;
+    uint32_t destination;
+    uint32_t bytes;
+    std::vector<Reception> receivers;   ///< 所有目标接收方，包括未收到的
+  };
+
+  LinkTrace();
+
+  void SetNumNodes(uint32_t numNodes) { m_numNodes = numNodes; }
+  uint32_t GetNumNodes() const { return m_numNodes; }
+  // 场景标签，例如 500*500*100_5_medium_1
+  void SetLabel(const std::string& label) { m_label = label; }
+  const std::string& GetLabel() const { return m_label; }
+
+  void AddSample(const Sample& sample) { m_samples.push_back(sample); }
+  void AddTransmission(const Transmission& tx) { m_transmissions.push_back(tx); }
+  const std::vector<Sample>& GetSamples() const { return m_samples; }
+  const std::vector<Transmission>& GetTransmissions() const { return m_transmissions; }
+
+  // time时刻之前最近的位置采样，没有采样时返回NULL
+  const Sample* GetSample(double time) const;
+
+  bool Write(const std::string& file) const;
+  bool Read(const std::string& file);
+
+private:
+  uint32_t m_numNodes;
+  std::string m_label;
+  std::vector<Sample> m_samples;             ///< 按时间排序
+  std::vector<Transmission> m_transmissions; ///< 按时间排序
+};
+
+#endif /* LINK_TRACE_H */
@@ -0,0 +1,180 @@
+/*
+ * MemoryAccountant.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "MemoryAccountant.h"
+#include "AdhocUdpApplication.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+NodeMemory::NodeMemory()
+  : matrixBytes(0), neighborBytes(0), queuedSendBytes(0), queuedSends(0), packetBufferBytes(0)
+{
+}
+
+uint64_t NodeMemory::GetTotal() const
+{
+  return matrixBytes + neighborBytes + queuedSendBytes + packetBufferBytes;
+}
+
+void NodeMemory::Add(const NodeMemory& other)
+{
+  matrixBytes += other.matrixBytes;
+  neighborBytes += other.neighborBytes;
+  queuedSendBytes += other.queuedSendBytes;
+  queuedSends += other.queuedSends;
+  packetBufferBytes += other.packetBufferBytes;
+}
+
+void NodeMemory::Max(const NodeMemory& other)
+{
+  matrixBytes = std::max(matrixBytes, other.matrixBytes);
+  neighborBytes = std::max(neighborBytes, other.neighborBytes);
+  queuedSendBytes = std::max(queuedSendBytes, other.queuedSendBytes);
+  queuedSends = std::max(queuedSends, other.queuedSends);
+  packetBufferBytes = std::max(packetBufferBytes, other.packetBufferBytes);
+}
+
+MemoryAccountant::MemoryAccountant()
+  : m_interval(0.1),
+    m_peakRssKb(0),
+    m_endRssKb(0)
+{
+}
+
+void MemoryAccountant::Install(const NodeContainer& nodes)
+{
+  m_nodes = nodes;
+  m_peak.assign(nodes.GetN(), NodeMemory());
+  m_end.assign(nodes.GetN(), NodeMemory());
+}
+
+void MemoryAccountant::Start(double interval)
+{
+  m_interval = interval;
+  Sample();
+}
+
+void MemoryAccountant::Measure(std::vector<NodeMemory>& nodes, NodeMemory& total) const
+{
+  nodes.assign(m_nodes.GetN(), NodeMemory());
+  total = NodeMemory();
+  for (uint32_t i = 0; i < m_nodes.GetN(); i++) {
+    Ptr<AppSender> sender = DynamicCast<AppSender>(m_nodes.Get(i)->GetApplication(0));
+    Ptr<AppReceiver> receiver = DynamicCast<AppReceiver>(m_nodes.Get(i)->GetApplication(1));
+    const RegkaProtocol& protocol = receiver->GetProtocol();
+    nodes[i].matrixBytes = protocol.GetMatrixBytes();
+    nodes[i].neighborBytes = protocol.GetNeighborBytes();
+    if (receiver->GetSessions() != NULL) {
+      nodes[i].matrixBytes = receiver->GetSessions()->GetMatrixBytes();
+      nodes[i].neighborBytes = receiver->GetSessions()->GetNeighborBytes();
+    }
+    if (receiver->GetBaseline() != NULL) {
+      // 基线方案没有邻居表，已知条目记在矩阵一栏
+      nodes[i].matrixBytes = receiver->GetBaseline()->GetStateBytes();
+      nodes[i].neighborBytes = 0;
+    }
+    nodes[i].queuedSendBytes = sender->GetQueuedSendBytes();
+    nodes[i].queuedSends = sender->GetQueuedSends();
+    nodes[i].packetBufferBytes = receiver->GetPacketBufferBytes();
+    total.Add(nodes[i]);
+  }
+}
+
+void MemoryAccountant::Sample()
+{
+  std::vector<NodeMemory> nodes;
+  NodeMemory total;
+  Measure(nodes, total);
+  for (uint32_t i = 0; i < nodes.size(); i++) {
+    m_peak[i].Max(nodes[i]);
+  }
+  if (total.GetTotal() > m_totalPeak.GetTotal()) {
+    m_totalPeak = total;
+  }
+  m_peakRssKb = std::max(m_peakRssKb, GetProcessRssKb());
+  Simulator::Schedule(Seconds(m_interval), &MemoryAccountant::Sample, this);
+}
+
+void MemoryAccountant::Finish()
+{
+  Measure(m_end, m_totalEnd);
+  for (uint32_t i = 0; i < m_end.size(); i++) {
+    m_peak[i].Max(m_end[i]);
+  }
+  if (m_totalEnd.GetTotal() > m_totalPeak.GetTotal()) {
+    m_totalPeak = m_totalEnd;
+  }
+  m_endRssKb = GetProcessRssKb();
+  m_peakRssKb = std::max(m_peakRssKb, m_endRssKb);
+}
+
+// 一行统计：label,node,phase,各子系统字节数,总字节数,进程RSS
+static void WriteRow(std::ostream& out, const std::string& label, const std::string& node,
+                     const char* phase, const NodeMemory& memory, uint64_t rssKb)
+{
+  out << label << "," << node << "," << phase << "," << memory.matrixBytes << "," << memory.neighborBytes << ","
+      << memory.queuedSendBytes << "," << memory.queuedSends << "," << memory.packetBufferBytes << ","
+      << memory.GetTotal() << ",";
+  if (rssKb > 0) {
+    out << rssKb;
+  }
+  out << "\n";
+}
+
+bool MemoryAccountant::WriteReport(const std::string& file, const std::string& label) const
+{
+  std::ofstream out(file.c_str(), std::ios::app);
+  if (!out.is_open()) {
+    std::cerr << "无法写入内存统计: " << file << std::endl;
+    return false;
+  }
+  out.seekp(0, std::ios::end);
+  if (out.tellp() == 0) {
+    out << "label,node,phase,matrixBytes,neighborBytes,queuedSendBytes,queuedSends,packetBufferBytes,totalBytes,processRssKb"
+        << std::endl;
+  }
+  for (uint32_t i = 0; i < m_peak.size(); i++) {
+    std::ostringstream node;
+    node << i;
+    WriteRow(out, label, node.str(), "peak", m_peak[i], 0);
+    WriteRow(out, label, node.str(), "end", m_end[i], 0);
+  }
+  WriteRow(out, label, "all", "peak", m_totalPeak, m_peakRssKb);
+  WriteRow(out, label, "all", "end", m_totalEnd, m_endRssKb);
+  return static_cast<bool>(out);
+}
+
+uint64_t MemoryAccountant::GetProcessRssKb()
+{
+  // /proc/self/statm的第二列为常驻页数
+  std::ifstream in("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  if (!(in >> size >> resident)) {
+    return 0;
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+uint32_t MemoryAccountant::CheckForLeaks(const std::string& label)
+{
+  static uint64_t lastRssKb = 0;
+  uint32_t leaked = AppSender::GetLiveCount() + AppReceiver::GetLiveCount();
+  if (leaked > 0) {
+    std::cerr << label << " 结束后仍有" << AppSender::GetLiveCount() << "个AppSender和"
+              << AppReceiver::GetLiveCount() << "个AppReceiver未释放" << std::endl;
+  }
+  uint64_t rssKb = GetProcessRssKb();
+  if (lastRssKb > 0 && rssKb > lastRssKb) {
+    std::cerr << label << " 结束后进程RSS增长" << (rssKb - lastRssKb) << "KB" << std::endl;
+  }
+  lastRssKb = rssKb;
+  return leaked;
+}
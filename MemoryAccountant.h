@@ -0,0 +1,78 @@
+/*
+ * MemoryAccountant.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef MEMORY_ACCOUNTANT_H
+#define MEMORY_ACCOUNTANT_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace ns3;
+
+// 一个节点（或所有节点之和）按子系统划分的内存占用 (字节)
+struct NodeMemory
+{
+  NodeMemory();
+
+  uint64_t matrixBytes;        ///< 接收侧与发送侧两个KeyMatrix
+  uint64_t neighborBytes;      ///< 邻居表
+  uint64_t queuedSendBytes;    ///< 绑定在已调度的DoSendPacket事件中的消息内容
+  uint64_t queuedSends;        ///< 已调度未发出的消息数
+  uint64_t packetBufferBytes;  ///< AppReceiver的数据包缓冲区（重复消息缓存）
+
+  uint64_t GetTotal() const;
+  void Add(const NodeMemory& other);
+  // 各子系统分别取较大值
+  void Max(const NodeMemory& other);
+};
+
+/**
+ * 协议侧内存占用统计
+ *
+ * 按固定仿真时间间隔采样所有节点的AppSender/AppReceiver，记录每个节点各子系统的峰值、
+ * 所有节点之和的峰值以及进程RSS的峰值，仿真结束时再采样一次作为结束值。
+ * 只统计协议自己持有的数据，ns-3的数据包、socket缓冲与事件队列本身不在其中，
+ * 它们包含在进程RSS中。
+ */
+class MemoryAccountant
+{
+public:
+  MemoryAccountant();
+
+  // 节点的应用0为AppSender、应用1为AppReceiver
+  void Install(const NodeContainer& nodes);
+  // 每隔interval秒采样一次
+  void Start(double interval);
+  // 仿真结束后调用，记录结束值
+  void Finish();
+  // 写出每个节点与所有节点（node列为all）的峰值和结束值，文件已存在时追加
+  bool WriteReport(const std::string& file, const std::string& label) const;
+
+  // 当前进程的常驻内存 (KB)，读取失败时为0
+  static uint64_t GetProcessRssKb();
+  // 一次仿真的Simulator::Destroy之后调用：检查是否仍有未析构的应用对象，
+  // 并报告与上次检查相比进程RSS的增长；返回泄漏的对象数
+  static uint32_t CheckForLeaks(const std::string& label);
+
+private:
+  void Sample();
+  void Measure(std::vector<NodeMemory>& nodes, NodeMemory& total) const;
+
+  NodeContainer m_nodes;
+  double m_interval;
+  std::vector<NodeMemory> m_peak;
+  std::vector<NodeMemory> m_end;
+  NodeMemory m_totalPeak;          ///< 同一时刻所有节点之和的峰值（按总量取最大的那次采样）
+  NodeMemory m_totalEnd;
+  uint64_t m_peakRssKb;
+  uint64_t m_endRssKb;
+};
+
+#endif /* MEMORY_ACCOUNTANT_H */
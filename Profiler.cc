@@ -0,0 +1,170 @@
+/*
+ * Profiler.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "Profiler.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <time.h>
+
+const uint32_t Profiler::BUCKETS;
+
+std::vector<Profiler::SiteStats> Profiler::s_stats;
+
+static const char* const SITE_NAMES[PROFILE_SITE_COUNT] = {
+  "Receive",
+  "MergeMatrix",
+  "StringToMatrix",
+  "MatrixToString",
+  "GetForwardingContributions",
+  "DoSendPacket",
+  "PeriodicBroadcast",
+};
+
+Profiler::SiteStats::SiteStats()
+  : count(0), totalNs(0), maxNs(0)
+{
+  for (uint32_t i = 0; i < BUCKETS; i++) {
+    buckets[i] = 0;
+  }
+}
+
+void Profiler::SiteStats::Add(const SiteStats& other)
+{
+  count += other.count;
+  totalNs += other.totalNs;
+  if (other.maxNs > maxNs) {
+    maxNs = other.maxNs;
+  }
+  for (uint32_t i = 0; i < BUCKETS; i++) {
+    buckets[i] += other.buckets[i];
+  }
+}
+
+uint64_t Profiler::NowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+void Profiler::Record(ProfileSite site, uint32_t node, uint64_t ns)
+{
+  uint64_t index = static_cast<uint64_t>(node) * PROFILE_SITE_COUNT + site;
+  if (index >= s_stats.size()) {
+    s_stats.resize(index + 1);
+  }
+  SiteStats& stats = s_stats[index];
+  stats.count++;
+  stats.totalNs += ns;
+  if (ns > stats.maxNs) {
+    stats.maxNs = ns;
+  }
+  uint32_t bucket = 0;
+  while (bucket + 1 < BUCKETS && (ns >> (bucket + 1)) != 0) {
+    bucket++;
+  }
+  stats.buckets[bucket]++;
+}
+
+const char* Profiler::GetSiteName(ProfileSite site)
+{
+  return site < PROFILE_SITE_COUNT ? SITE_NAMES[site] : "?";
+}
+
+Profiler::SiteStats Profiler::GetGlobal(ProfileSite site)
+{
+  SiteStats global;
+  for (uint64_t i = site; i < s_stats.size(); i += PROFILE_SITE_COUNT) {
+    global.Add(s_stats[i]);
+  }
+  return global;
+}
+
+uint64_t Profiler::EstimatePercentile(const SiteStats& stats, double p)
+{
+  if (stats.count == 0) {
+    return 0;
+  }
+  uint64_t target = static_cast<uint64_t>(p * stats.count);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < BUCKETS; i++) {
+    seen += stats.buckets[i];
+    if (seen > target) {
+      uint64_t upper = 1ULL << (i + 1);
+      return upper < stats.maxNs ? upper : stats.maxNs;
+    }
+  }
+  return stats.maxNs;
+}
+
+void Profiler::PrintSummary(std::ostream& out, const std::string& label)
+{
+  out << "------------热点耗时统计 " << label << "------------" << std::endl;
+  out << std::left << std::setw(28) << "热点" << std::right
+      << std::setw(12) << "调用次数" << std::setw(14) << "总耗时(ms)"
+      << std::setw(12) << "平均(us)" << std::setw(12) << "P99(us)" << std::setw(12) << "最大(us)" << std::endl;
+  for (uint32_t s = 0; s < PROFILE_SITE_COUNT; s++) {
+    SiteStats global = GetGlobal(static_cast<ProfileSite>(s));
+    out << std::left << std::setw(28) << SITE_NAMES[s] << std::right << std::fixed << std::setprecision(3)
+        << std::setw(12) << global.count
+        << std::setw(14) << global.totalNs / 1e6
+        << std::setw(12) << (global.count > 0 ? global.totalNs / 1e3 / global.count : 0.0)
+        << std::setw(12) << EstimatePercentile(global, 0.99) / 1e3
+        << std::setw(12) << global.maxNs / 1e3 << std::endl;
+  }
+  out.unsetf(std::ios::fixed);
+}
+
+// 一行统计：label,node,site,count,totalNs,maxNs,p50Ns,p99Ns,直方图（分号分隔）
+static void WriteRow(std::ostream& out, const std::string& label, const std::string& node,
+                     uint32_t site, const Profiler::SiteStats& stats)
+{
+  out << label << "," << node << "," << Profiler::GetSiteName(static_cast<ProfileSite>(site)) << ","
+      << stats.count << "," << stats.totalNs << "," << stats.maxNs << ","
+      << Profiler::EstimatePercentile(stats, 0.5) << "," << Profiler::EstimatePercentile(stats, 0.99) << ",";
+  // 去掉末尾的空桶
+  uint32_t last = Profiler::BUCKETS;
+  while (last > 0 && stats.buckets[last - 1] == 0) {
+    last--;
+  }
+  for (uint32_t i = 0; i < last; i++) {
+    out << (i > 0 ? ";" : "") << stats.buckets[i];
+  }
+  out << "\n";
+}
+
+bool Profiler::WriteCsv(const std::string& file, const std::string& label)
+{
+  std::ofstream out(file.c_str(), std::ios::app);
+  if (!out.is_open()) {
+    std::cerr << "无法写入热点耗时统计: " << file << std::endl;
+    return false;
+  }
+  out.seekp(0, std::ios::end);
+  if (out.tellp() == 0) {
+    out << "label,node,site,count,totalNs,maxNs,p50Ns,p99Ns,histogramLog2Ns" << std::endl;
+  }
+  for (uint64_t i = 0; i < s_stats.size(); i++) {
+    if (s_stats[i].count == 0) {
+      continue;
+    }
+    std::ostringstream node;
+    node << i / PROFILE_SITE_COUNT;
+    WriteRow(out, label, node.str(), i % PROFILE_SITE_COUNT, s_stats[i]);
+  }
+  for (uint32_t s = 0; s < PROFILE_SITE_COUNT; s++) {
+    WriteRow(out, label, "all", s, GetGlobal(static_cast<ProfileSite>(s)));
+  }
+  return static_cast<bool>(out);
+}
+
+void Profiler::Reset()
+{
+  s_stats.clear();
+}
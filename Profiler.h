@@ -0,0 +1,93 @@
+/*
+ * Profiler.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 被计时的协议热点，新增时同时修改Profiler.cc中的名称表
+enum ProfileSite
+{
+  PROFILE_RECEIVE = 0,           ///< AppReceiver::Receive
+  PROFILE_MERGE_MATRIX,          ///< KeyMatrix::MergeMatrix
+  PROFILE_STRING_TO_MATRIX,      ///< KeyMatrix::StringToMatrix
+  PROFILE_MATRIX_TO_STRING,      ///< KeyMatrix::MatrixToString
+  PROFILE_FORWARDING,            ///< KeyMatrix::GetForwardingContributions
+  PROFILE_SEND_PACKET,           ///< AppSender::DoSendPacket
+  PROFILE_PERIODIC_BROADCAST,    ///< AppSender::PeriodicBroadcast
+  PROFILE_SITE_COUNT
+};
+
+/**
+ * 协议热点的计时统计
+ *
+ * 每个（节点，热点）记录调用次数、总耗时、最大耗时和按2的幂分桶的耗时直方图，
+ * 全局统计在输出时由各节点汇总。计时使用CLOCK_MONOTONIC，耗时包含嵌套调用
+ * （例如Receive包含其中的MergeMatrix）。统计是进程内的，工作进程各自统计。
+ *
+ * 只有定义了REGKA_PROFILING时REGKA_PROFILE_SCOPE才会计时，否则展开为空语句。
+ */
+class Profiler
+{
+public:
+  static const uint32_t BUCKETS = 32;   ///< 第i个桶为[2^i, 2^(i+1)) ns，最后一个桶不设上限
+
+  struct SiteStats
+  {
+    SiteStats();
+    void Add(const SiteStats& other);
+
+    uint64_t count;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t buckets[BUCKETS];
+  };
+
+  static uint64_t NowNs();
+  static void Record(ProfileSite site, uint32_t node, uint64_t ns);
+  static const char* GetSiteName(ProfileSite site);
+
+  // 所有节点汇总后的统计
+  static SiteStats GetGlobal(ProfileSite site);
+  // 从直方图估计的分位数 (ns)，取所在桶的上界
+  static uint64_t EstimatePercentile(const SiteStats& stats, double p);
+
+  // 输出全局汇总表
+  static void PrintSummary(std::ostream& out, const std::string& label);
+  // 写出每个节点及全局（node列为all）的统计，文件已存在时追加
+  static bool WriteCsv(const std::string& file, const std::string& label);
+  static void Reset();
+
+private:
+  static std::vector<SiteStats> s_stats;   ///< 下标为 node * PROFILE_SITE_COUNT + site
+};
+
+// 作用域计时器，析构时记录耗时
+class ProfileScope
+{
+public:
+  ProfileScope(ProfileSite site, uint32_t node)
+    : m_site(site), m_node(node), m_start(Profiler::NowNs()) {}
+  ~ProfileScope() { Profiler::Record(m_site, m_node, Profiler::NowNs() - m_start); }
+
+private:
+  ProfileSite m_site;
+  uint32_t m_node;
+  uint64_t m_start;
+};
+
+#ifdef REGKA_PROFILING
+#define REGKA_PROFILE_SCOPE(site, node) ProfileScope regkaProfileScope((site), (node))
+#else
+#define REGKA_PROFILE_SCOPE(site, node) do {} while (0)
+#endif
+
+#endif /* PROFILER_H */
@@ -0,0 +1,45 @@
+/*
+ * ProgressMonitor.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ProgressMonitor.h"
+#include <algorithm>
+
+ProgressMonitor::ProgressMonitor()
+  : m_stallWindow(0),
+    m_unreachableWindow(0)
+{
+  Reset();
+}
+
+void ProgressMonitor::Reset(double startTime)
+{
+  m_learned = 0;
+  m_lastProgressTime = startTime;
+  m_lastReachableTime = startTime;
+  m_stalled = false;
+  m_stallTime = 0;
+}
+
+bool ProgressMonitor::Update(double now, uint64_t learnedContributions, bool reachable)
+{
+  if (m_stalled) {
+    return true;
+  }
+  if (learnedContributions > m_learned) {
+    m_learned = learnedContributions;
+    m_lastProgressTime = std::max(m_lastProgressTime, now);
+  }
+  if (reachable) {
+    m_lastReachableTime = now;
+  }
+  if ((m_stallWindow > 0 && now - m_lastProgressTime >= m_stallWindow)
+      || (m_unreachableWindow > 0 && now - m_lastReachableTime >= m_unreachableWindow)) {
+    m_stalled = true;
+    m_stallTime = now;
+  }
+  return m_stalled;
+}
@@ -0,0 +1,55 @@
+/*
+ * ProgressMonitor.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef PROGRESS_MONITOR_H
+#define PROGRESS_MONITOR_H
+
+#include <stdint.h>
+
+/**
+ * 密钥协商的进展跟踪与停滞判断，不依赖ns-3
+ *
+ * 由仿真的完成检查定时调用，传入所有节点已知密钥贡献的总数以及
+ * 是否仍有未完成节点能从连通的节点获得缺少的贡献。满足任一条件即判定停滞：
+ * 总数在stallWindow秒内没有增加；或连续unreachableWindow秒没有未完成节点可达。
+ * 窗口为0时不检查对应条件。
+ */
+class ProgressMonitor
+{
+public:
+  ProgressMonitor();
+
+  void SetStallWindow(double window) { m_stallWindow = window; }
+  void SetUnreachableWindow(double window) { m_unreachableWindow = window; }
+  double GetStallWindow() const { return m_stallWindow; }
+  double GetUnreachableWindow() const { return m_unreachableWindow; }
+  // 两个窗口是否都为0
+  bool IsDisabled() const { return m_stallWindow <= 0 && m_unreachableWindow <= 0; }
+  // 是否需要调用方计算可达性
+  bool NeedsReachability() const { return m_unreachableWindow > 0; }
+
+  // 每个场景开始前调用，两个窗口都从startTime（节点开始发送的时刻）起算
+  void Reset(double startTime = 0);
+  // now时刻的检查，返回是否已停滞；停滞后一直返回true
+  bool Update(double now, uint64_t learnedContributions, bool reachable);
+
+  bool IsStalled() const { return m_stalled; }
+  double GetStallTime() const { return m_stallTime; }
+  // 最后一次有节点获得新贡献的时刻
+  double GetLastProgressTime() const { return m_lastProgressTime; }
+
+private:
+  double m_stallWindow;
+  double m_unreachableWindow;
+  uint64_t m_learned;
+  double m_lastProgressTime;
+  double m_lastReachableTime;
+  bool m_stalled;
+  double m_stallTime;
+};
+
+#endif /* PROGRESS_MONITOR_H */
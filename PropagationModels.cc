@@ -0,0 +1,191 @@
+/*
+ * PropagationModels.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "PropagationModels.h"
+#include "ns3/network-module.h"
+#include <algorithm>
+#include <cmath>
+
+NS_OBJECT_ENSURE_REGISTERED(PrunedPropagationLossModel);
+NS_OBJECT_ENSURE_REGISTERED(TabulatedPropagationLossModel);
+NS_OBJECT_ENSURE_REGISTERED(FaultPropagationLossModel);
+
+double GetChainMaxRange(Ptr<PropagationLossModel> chain)
+{
+  double maxRange = 0;
+  for (Ptr<PropagationLossModel> model = chain; model != 0; model = model->GetNext()) {
+    if (DynamicCast<RangePropagationLossModel>(model) != 0) {
+      DoubleValue range;
+      model->GetAttribute("MaxRange", range);
+      maxRange = range.Get();
+    }
+  }
+  return maxRange;
+}
+
+TypeId PrunedPropagationLossModel::GetTypeId(void) {
+  static TypeId tid = TypeId("PrunedPropagationLossModel")
+    .SetParent<PropagationLossModel>()
+    .AddConstructor<PrunedPropagationLossModel>();
+  return tid;
+}
+
+PrunedPropagationLossModel::PrunedPropagationLossModel()
+  : m_maxRange(0),
+    m_evaluated(0),
+    m_pruned(0)
+{
+}
+
+void PrunedPropagationLossModel::SetChain(Ptr<PropagationLossModel> chain)
+{
+  m_chain = chain;
+  m_maxRange = GetChainMaxRange(chain);
+}
+
+double PrunedPropagationLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a,
+                                                 Ptr<MobilityModel> b) const
+{
+  // 与RangePropagationLossModel的判断一致：距离等于MaxRange时仍可接收
+  if (m_maxRange > 0 && a->GetDistanceFrom(b) > m_maxRange) {
+    m_pruned++;
+    return -1000;
+  }
+  m_evaluated++;
+  return m_chain->CalcRxPower(txPowerDbm, a, b);
+}
+
+int64_t PrunedPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+  // 本模型没有next，信道的AssignStreams只会调用到这里，需转给被包装的链
+  return m_chain->AssignStreams(stream);
+}
+
+// -------------------------------------------------------------------
+
+TypeId TabulatedPropagationLossModel::GetTypeId(void) {
+  static TypeId tid = TypeId("TabulatedPropagationLossModel")
+    .SetParent<PropagationLossModel>()
+    .AddConstructor<TabulatedPropagationLossModel>();
+  return tid;
+}
+
+TabulatedPropagationLossModel::TabulatedPropagationLossModel()
+  : m_binWidth(1),
+    m_maxDistance(0),
+    m_maxError(0)
+{
+}
+
+void TabulatedPropagationLossModel::Tabulate(Ptr<PropagationLossModel> model, double maxDistance,
+                                             double binWidth)
+{
+  m_model = model;
+  m_binWidth = binWidth;
+  uint32_t bins = static_cast<uint32_t>(std::ceil(maxDistance / binWidth));
+  m_maxDistance = bins * binWidth;
+
+  // 发射功率取0 dBm，接收功率的相反数即为损失
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+  a->SetPosition(Vector(0, 0, 0));
+  m_loss.resize(bins + 1);
+  for (uint32_t i = 0; i <= bins; i++) {
+    b->SetPosition(Vector(i * binWidth, 0, 0));
+    m_loss[i] = -model->CalcRxPower(0, a, b);
+  }
+  m_maxError = 0;
+  for (uint32_t i = 0; i < bins; i++) {
+    double distance = (i + 0.5) * binWidth;
+    b->SetPosition(Vector(distance, 0, 0));
+    m_maxError = std::max(m_maxError, std::fabs(GetLoss(distance) + model->CalcRxPower(0, a, b)));
+  }
+}
+
+double TabulatedPropagationLossModel::GetLoss(double distance) const
+{
+  double position = distance / m_binWidth;
+  uint32_t i = static_cast<uint32_t>(position);
+  double fraction = position - i;
+  return m_loss[i] + fraction * (m_loss[i + 1] - m_loss[i]);
+}
+
+double TabulatedPropagationLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a,
+                                                    Ptr<MobilityModel> b) const
+{
+  double distance = a->GetDistanceFrom(b);
+  if (distance >= m_maxDistance) {
+    return m_model->CalcRxPower(txPowerDbm, a, b);
+  }
+  return txPowerDbm - GetLoss(distance);
+}
+
+int64_t TabulatedPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+  return 0;
+}
+
+// -------------------------------------------------------------------
+
+TypeId FaultPropagationLossModel::GetTypeId(void) {
+  static TypeId tid = TypeId("FaultPropagationLossModel")
+    .SetParent<PropagationLossModel>()
+    .AddConstructor<FaultPropagationLossModel>();
+  return tid;
+}
+
+FaultPropagationLossModel::FaultPropagationLossModel()
+  : m_faults(NULL),
+    m_blocked(0)
+{
+}
+
+void FaultPropagationLossModel::SetFaultPlan(const FaultPlan* plan, const std::string& baseQuality)
+{
+  m_faults = plan;
+  m_baseQuality = baseQuality;
+}
+
+void FaultPropagationLossModel::SetDegradedChain(const std::string& quality, Ptr<PropagationLossModel> chain,
+                                                 double txPowerOffsetDb)
+{
+  m_degraded[quality] = std::make_pair(chain, txPowerOffsetDb);
+}
+
+double FaultPropagationLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a,
+                                                Ptr<MobilityModel> b) const
+{
+  if (m_faults == NULL) {
+    return m_chain->CalcRxPower(txPowerDbm, a, b);
+  }
+  double now = Simulator::Now().GetSeconds();
+  Vector pa = a->GetPosition();
+  Vector pb = b->GetPosition();
+  double from[3] = { pa.x, pa.y, pa.z };
+  double to[3] = { pb.x, pb.y, pb.z };
+  if (m_faults->IsLinkBlocked(a->GetObject<Node>()->GetId(), b->GetObject<Node>()->GetId(), from, to, now)) {
+    m_blocked++;
+    return -1000;
+  }
+  std::map<std::string, std::pair<Ptr<PropagationLossModel>, double> >::const_iterator it =
+    m_degraded.find(m_faults->GetQuality(now, m_baseQuality));
+  if (it != m_degraded.end()) {
+    return it->second.first->CalcRxPower(txPowerDbm + it->second.second, a, b);
+  }
+  return m_chain->CalcRxPower(txPowerDbm, a, b);
+}
+
+int64_t FaultPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+  // 与PrunedPropagationLossModel相同，本模型没有next，需转给被包装的各条链
+  int64_t used = m_chain->AssignStreams(stream);
+  std::map<std::string, std::pair<Ptr<PropagationLossModel>, double> >::iterator it;
+  for (it = m_degraded.begin(); it != m_degraded.end(); ++it) {
+    used += it->second.first->AssignStreams(stream + used);
+  }
+  return used;
+}
@@ -0,0 +1,124 @@
+/*
+ * PropagationModels.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef PROPAGATION_MODELS_H
+#define PROPAGATION_MODELS_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+#include "FaultPlan.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace ns3;
+
+// 损失链中RangePropagationLossModel的MaxRange，链中没有时为0
+double GetChainMaxRange(Ptr<PropagationLossModel> chain);
+
+/**
+ * 超出最大通信距离时跳过整条传播损失链
+ *
+ * SetupLinkQuality中每条损失链都以RangePropagationLossModel结尾，超出MaxRange的接收功率
+ * 固定为-1000 dBm，但前面的Friis/LogDistance、Random与Nakagami仍会对每个节点对计算一遍。
+ * 本模型包装整条链：先按距离判断，超出链中RangePropagationLossModel的MaxRange时直接返回
+ * -1000 dBm，否则交给原链计算，范围内的接收功率与原链相同。
+ * 被跳过的节点对不再抽取Random与Nakagami的随机数，随机数序列因此与原链不同。
+ */
+class PrunedPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId(void);
+  PrunedPropagationLossModel();
+
+  // 设置被包装的损失链，并从中查找RangePropagationLossModel的MaxRange；链中没有时不剪枝
+  void SetChain(Ptr<PropagationLossModel> chain);
+  Ptr<PropagationLossModel> GetChain() const { return m_chain; }
+  double GetMaxRange() const { return m_maxRange; }
+
+  // 计算了整条链的节点对数与被跳过的节点对数
+  uint64_t GetEvaluatedCount() const { return m_evaluated; }
+  uint64_t GetPrunedCount() const { return m_pruned; }
+
+private:
+  virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams(int64_t stream);
+
+  Ptr<PropagationLossModel> m_chain;
+  double m_maxRange;           ///< 0表示不剪枝
+  mutable uint64_t m_evaluated;
+  mutable uint64_t m_pruned;
+};
+
+/**
+ * 按距离查表的确定性路径损失
+ *
+ * 把Friis或LogDistance这类只取决于距离的模型在[0, maxDistance]上按固定间隔采样一次，
+ * 计算时按距离线性插值，省去每个节点对的log10运算；超出表的距离仍由原模型计算。
+ * 表只替换损失链的第一个模型，其后的Random、Nakagami与Range照常计算，随机数序列不变。
+ */
+class TabulatedPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId(void);
+  TabulatedPropagationLossModel();
+
+  // 对model采样建表，model不能有next（否则后面的随机模型也会被采样）
+  void Tabulate(Ptr<PropagationLossModel> model, double maxDistance, double binWidth);
+  // 建表时在相邻采样点中点处插值与原模型的最大偏差 (dB)
+  double GetMaxError() const { return m_maxError; }
+
+private:
+  virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams(int64_t stream);
+
+  double GetLoss(double distance) const;
+
+  Ptr<PropagationLossModel> m_model;  ///< 原模型，用于表外的距离
+  std::vector<double> m_loss;         ///< m_loss[i]为距离i*m_binWidth处的损失 (dB)
+  double m_binWidth;
+  double m_maxDistance;               ///< 表覆盖的最大距离
+  double m_maxError;
+};
+
+/**
+ * 按故障计划注入链路故障的损失模型
+ *
+ * 包装整条损失链：被blackout、partition或崩溃隔断的节点对接收功率固定为-1000 dBm，
+ * 收发双方都无法解码，单播也就收不到ACK；degrade期间改用对应链路质量的损失链，
+ * 发射功率按两档的TxPower之差修正（CCA门限仍为原档位）。
+ * 节点编号取ns-3的节点ID，每次仿真最先创建的节点ID即为编号。
+ */
+class FaultPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId(void);
+  FaultPropagationLossModel();
+
+  void SetChain(Ptr<PropagationLossModel> chain) { m_chain = chain; }
+  // plan不属于本类
+  void SetFaultPlan(const FaultPlan* plan, const std::string& baseQuality);
+  // 链路质量变为quality时使用chain，txPowerOffsetDb为该档与原档的发射功率之差
+  void SetDegradedChain(const std::string& quality, Ptr<PropagationLossModel> chain, double txPowerOffsetDb);
+
+  // 被故障隔断的节点对数
+  uint64_t GetBlockedCount() const { return m_blocked; }
+
+private:
+  virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams(int64_t stream);
+
+  Ptr<PropagationLossModel> m_chain;
+  const FaultPlan* m_faults;
+  std::string m_baseQuality;
+  std::map<std::string, std::pair<Ptr<PropagationLossModel>, double> > m_degraded;
+  mutable uint64_t m_blocked;
+};
+
+#endif /* PROPAGATION_MODELS_H */
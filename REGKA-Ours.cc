@@ -40,8 +40,30 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <sstream>
+#include <set>
+#include <cstdlib>
+#include <ctime>
+#include <cerrno>
 
 #include "AdhocUdpApplication.h"
+#include "Scenario.h"
+#include "WorkerPool.h"
+#include "ReplicationController.h"
+#include "ResultCache.h"
+#include "SimulationDatabase.h"
+#include "LinkCalibration.h"
+#include "AbstractChannel.h"
+#include "CalibrationRecorder.h"
+#include "ScalingBenchmark.h"
+#include "Profiler.h"
+#include "MemoryAccountant.h"
+#include "PropagationModels.h"
+#include "GridWifiChannel.h"
+#include "ProgressMonitor.h"
+#include "CryptoBackend.h"
+#include "FaultPlan.h"
+#include "ChannelMonitor.h"
+#include "ResultAggregator.h"
 
 using namespace ns3;
 
@@ -63,9 +85,98 @@ uint32_t numNodes = 5;
 uint32_t simuTime = 60;
 double periodicInterval = 0.1;  
 double CompletionTime = 0;
+// 仿真结束的方式：completed、stalled或timeout
+std::string RunOutcome = "timeout";
 
 // ------------ End -----------------
 
+// 协议/代码版本，修改协议逻辑或信道模型后需要递增，使旧的缓存结果失效
+const std::string protocolVersion = "RE-GKA-1.1";
+// 结果缓存，为NULL时不查找也不保存
+ResultCache* resultCache = NULL;
+// 批量模式的流式汇总，为NULL时不汇总；缓存命中的结果同样计入
+ResultAggregator* resultAggregator = NULL;
+// 结果数据库文件，为空时不写数据库
+std::string dbFile;
+// 每个事务提交的模拟结果数
+uint32_t dbBatchSize = 32;
+// 当前进程的数据库连接；SQLite连接不能跨fork使用，工作进程各自打开
+SimulationDatabase* resultDatabase = NULL;
+pid_t resultDatabasePid = 0;
+
+// 信道模型：wifi为完整的802.11g PHY/MAC，abstract为按校准表投递消息的抽象信道
+std::string channelModel = "wifi";
+// 链路校准文件：abstract模式从中读取，recordCalibration时把WiFi仿真的样本合并写入
+std::string calibrationFile = "link_calibration.txt";
+bool recordCalibration = false;
+// 链路轨迹目录：非空时WiFi仿真把位置采样与每次发送的接收结果写入<目录>/<场景标签>.rgkt，供regka-replay重放
+std::string traceDir;
+// 信道剪枝：超出链路质量的最大通信距离时跳过整条传播损失链（不抽取随机衰落），
+// 并改用GridWifiChannel，发送时只遍历附近网格中的PHY
+bool pruneChannel = false;
+// 路径损失表的距离间隔 (m)：大于0时损失链的第一个确定性模型改为按距离查表插值，0为原模型
+double pathLossBin = 0;
+// 停滞判断：所有节点在stallWindow秒内都没有获得新的密钥贡献，或连续unreachableWindow秒
+// 没有未完成节点能从连通的节点获得缺少的贡献时提前结束，结果记为stalled；窗口为0时不检查
+ProgressMonitor progressMonitor;
+// 可达性判断使用的通信距离，取链路质量的MaxRange
+double reachRange = 0;
+// 重复消息缓存的时间窗口 (s)：窗口内同一发送方的相同消息在解析前丢弃，0为不丢弃
+double duplicateWindow = 0;
+// 每个节点上并发的会话数：大于0时每个会话覆盖全部节点，消息按会话ID装帧共用发送队列，0为单会话
+uint32_t sessions = 0;
+// 协商方案：regka为本文方案，flooding、tgdh、centralized为对照的基线方案（见BaselineProtocol）
+std::string strategyName = "regka";
+// 故障注入：fault为故障计划或faultFile中的计划名称（见FaultPlan），为空时没有故障；
+// faultPlan为当前场景的计划，startSimulation开始时按RngRun选取按比例指定的节点
+std::string faultName;
+std::string faultFile;
+FaultLibrary faultLibrary;
+FaultPlan faultPlan;
+// 密钥计算后端：none时只以填充表示密钥材料；否则执行真实计算，CPU时间计入发送时延与完成时刻
+std::string cryptoName = "none";
+// 每次可变基点标量乘的代价 (ms)，measured为本机测量；cpuScale为代价的倍数
+std::string cryptoCost = "measured";
+double cpuScale = 1;
+bool cryptoBatch = true;
+bool fixedBaseTable = true;
+CryptoBackend* cryptoBackend = NULL;
+CryptoCosts cryptoCosts;
+// 信道层指标：开启时安装FlowMonitor并连接WiFi MAC/PHY跟踪源，结果附在结果记录的信道列中
+bool channelMetrics = false;
+// 内存统计文件：非空时按0.1秒仿真时间采样协议侧内存，每个场景追加每个节点及全局的峰值与结束值
+std::string memoryReport;
+#ifdef REGKA_PROFILING
+// 协议热点耗时统计文件（编译时定义REGKA_PROFILING才启用），每个场景追加每个节点及全局的统计
+std::string profileOutput = "profile.csv";
+#endif
+
+SimulationDatabase* GetResultDatabase() {
+	if (dbFile.empty()) {
+		return NULL;
+	}
+	if (resultDatabase == NULL || resultDatabasePid != getpid()) {
+		// fork继承来的连接属于父进程，不能在子进程中使用或关闭，直接丢弃
+		resultDatabase = new SimulationDatabase(dbFile);
+		resultDatabase->SetBatchSize(dbBatchSize);
+		resultDatabasePid = getpid();
+		if (!resultDatabase->InitializeDatabase()) {
+			std::cerr << "结果数据库初始化失败，不再写入: " << dbFile << std::endl;
+			dbFile.clear();
+			return NULL;
+		}
+	}
+	return resultDatabase;
+}
+
+// 提交并关闭当前进程的数据库连接，工作进程退出前也会调用
+void CloseResultDatabase() {
+	if (resultDatabase != NULL && resultDatabasePid == getpid()) {
+		delete resultDatabase;
+	}
+	resultDatabase = NULL;
+}
+
 // ---------- 实验数据记录标签 ----------
 // 实验内容
 std::string experiment;
@@ -77,21 +188,168 @@ std::string input;
 std::string runId;
 // ------------- End -----------------
 
-// 检查是否所有节点都完成了密钥收集
+// 协商方案在实验记录与结果缓存键中的名称，RE-GKA保持原有名称以沿用已有缓存
+std::string StrategyLabel() {
+	if (strategyName == "flooding") {
+		return "盲泛洪";
+	} else if (strategyName == "tgdh") {
+		return "树形群DH";
+	} else if (strategyName == "centralized") {
+		return "集中式";
+	}
+	return "单轮通信";
+}
+
+// 故障计划（或faultFile中的名称）能否解析，空串为没有故障
+bool CheckFaultPlan(const std::string& name) {
+	FaultPlan plan;
+	if (!name.empty() && !faultLibrary.Find(name, plan)) {
+		std::cerr << "无法解析故障计划: " << name << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// 批量模式下每个场景开始前重置全局状态，保证与单进程运行结果一致
+void ResetScenarioState(const ScenarioConfig& scenario) {
+	areaLength = scenario.areaLength;
+	areaWidth = scenario.areaWidth;
+	areaHeight = scenario.areaHeight;
+	numNodes = scenario.numNodes;
+	CompletionTime = 0;
+
+	std::ostringstream ss;
+	ss << scenario.run;
+	runId = ss.str();
+	ss.str("");
+	ss << numNodes;
+	input = ss.str();
+	ss.str("");
+	ss << "numNodes:" << numNodes << ";areaLength:" << areaLength << ";areaWidth:" << areaWidth << ";areaHeight:" << areaHeight;
+	faultName = scenario.fault;
+	if (!faultName.empty()) {
+		ss << ";fault:" << faultName;
+	}
+	experiment = ss.str();
+	strategy = StrategyLabel();
+
+	// 独立进程中rand()的初始种子为1，KeyMatrix的随机转发依赖它
+	srand(1);
+	RngSeedManager::SetRun(scenario.run);
+}
+
+// 检查是否所有节点都完成了密钥收集（崩溃的节点不计）
 bool CheckAllNodesCompleted(const NodeContainer& nodes) {
 	for (uint32_t i = 0; i < nodes.GetN(); i++) {
 		Ptr<AppReceiver> receiver = DynamicCast<AppReceiver>(nodes.Get(i)->GetApplication(1));
-		if (!receiver->IsCompleted()) {
+		if (!receiver->IsCompleted() && !receiver->IsCrashed()) {
 			return false;
 		}
 	}
 	return true;
 }
 
+// 所有节点已知的密钥贡献总数
+uint64_t CountLearnedContributions(const NodeContainer& nodes) {
+	uint64_t learned = 0;
+	for (uint32_t i = 0; i < nodes.GetN(); i++) {
+		Ptr<AppReceiver> receiver = DynamicCast<AppReceiver>(nodes.Get(i)->GetApplication(1));
+		if (receiver->GetBaseline() != NULL) {
+			learned += receiver->GetBaseline()->CountLearnedContributions();
+			continue;
+		}
+		const KeyMatrix& keyMatrix = receiver->GetKeyMatrix();
+		for (uint32_t j = 0; j < nodes.GetN(); j++) {
+			if (keyMatrix.HasKeyContribution(i, j)) {
+				learned++;
+			}
+		}
+	}
+	return learned;
+}
+
+// 是否有未完成的节点仍可能获得新贡献：未崩溃的节点按通信范围连通，分量内有其他节点拥有它缺少的贡献。
+// 与MicroSimulator的FlatDriver::IsProgressExhausted相同；基线方案没有贡献矩阵，分量内有其他节点即算可达
+bool AnyIncompleteNodeReachable(const NodeContainer& nodes) {
+	uint32_t numNodes = nodes.GetN();
+	std::vector<Ptr<AppReceiver> > receivers(numNodes);
+	for (uint32_t i = 0; i < numNodes; i++) {
+		receivers[i] = DynamicCast<AppReceiver>(nodes.Get(i)->GetApplication(1));
+	}
+	// 按通信范围对未崩溃的节点广度优先划分连通分量
+	std::vector<int32_t> component(numNodes, -1);
+	int32_t components = 0;
+	for (uint32_t start = 0; start < numNodes; start++) {
+		if (component[start] >= 0 || receivers[start]->IsCrashed()) {
+			continue;
+		}
+		std::vector<uint32_t> queue(1, start);
+		component[start] = components;
+		for (uint32_t head = 0; head < queue.size(); head++) {
+			Ptr<MobilityModel> mobility = nodes.Get(queue[head])->GetObject<MobilityModel>();
+			for (uint32_t j = 0; j < numNodes; j++) {
+				if (component[j] < 0 && !receivers[j]->IsCrashed()
+						&& mobility->GetDistanceFrom(nodes.Get(j)->GetObject<MobilityModel>()) <= reachRange) {
+					component[j] = components;
+					queue.push_back(j);
+				}
+			}
+		}
+		components++;
+	}
+	for (uint32_t i = 0; i < numNodes; i++) {
+		if (receivers[i]->IsCompleted() || receivers[i]->IsCrashed()) {
+			continue;
+		}
+		for (uint32_t k = 0; k < numNodes; k++) {
+			if (k == i || component[k] != component[i]) {
+				continue;
+			}
+			if (receivers[i]->GetBaseline() != NULL) {
+				return true;
+			}
+			const KeyMatrix& own = receivers[i]->GetKeyMatrix();
+			const KeyMatrix& other = receivers[k]->GetKeyMatrix();
+			for (uint32_t j = 0; j < numNodes; j++) {
+				if (other.HasKeyContribution(k, j) && !own.HasKeyContribution(i, j)) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// 所有节点得到组密钥的最晚时刻，未启用密钥计算时为0
+double LatestKeyReadyTime(const NodeContainer& nodes) {
+	double latest = 0;
+	if (!GroupKeyComputation::IsEnabled()) {
+		return latest;
+	}
+	for (uint32_t i = 0; i < nodes.GetN(); i++) {
+		Ptr<AppReceiver> receiver = DynamicCast<AppReceiver>(nodes.Get(i)->GetApplication(1));
+		const BaselineProtocol* baseline = receiver->GetBaseline();
+		latest = std::max(latest, baseline != NULL ? baseline->GetKeyReadyTime() : receiver->GetProtocol().GetKeyReadyTime());
+	}
+	return latest;
+}
+
 void CheckCompletionAndStop(const NodeContainer& nodes) {
-	if (CheckAllNodesCompleted(nodes)) {
+	bool completed = CheckAllNodesCompleted(nodes);
+	double keyReady = completed ? LatestKeyReadyTime(nodes) : 0;
+	if (completed && keyReady > Simulator::Now().GetSeconds()) {
+		// 收齐贡献后还要等最后一个节点算完组密钥
+		Simulator::Schedule(Seconds(keyReady - Simulator::Now().GetSeconds()), &CheckCompletionAndStop, nodes);
+	} else if (completed) {
 		NS_LOG_INFO("所有节点都已收齐密钥贡献，提前结束仿真");
 		CompletionTime = Simulator::Now().GetSeconds()-1;	
+		RunOutcome = "completed";
+		Simulator::Stop();
+	} else if (!progressMonitor.IsDisabled()
+			&& progressMonitor.Update(Simulator::Now().GetSeconds(), CountLearnedContributions(nodes),
+					!progressMonitor.NeedsReachability() || AnyIncompleteNodeReachable(nodes))) {
+		NS_LOG_INFO("密钥协商自" << progressMonitor.GetLastProgressTime() << "秒起没有进展，判定停滞并提前结束仿真");
+		RunOutcome = "stalled";
 		Simulator::Stop();
 	} else {
 		// 获取当前模拟时间
@@ -106,21 +364,15 @@ void CheckCompletionAndStop(const NodeContainer& nodes) {
 
 
 
-void SetupLinkQuality (YansWifiPhyHelper &wifiPhy, std::string quality)
+// 链路质量对应的信道：传播时延与损失链，发射功率等PHY参数在SetupLinkQuality中设置
+YansWifiChannelHelper LinkQualityChannel (const std::string &quality)
 {
-  /* 硬件常量 */
-  wifiPhy.Set ("RxNoiseFigure", DoubleValue (7.0));   // 无人机常见 NF≈7 dB
-  wifiPhy.Set ("RxGain",        DoubleValue (2.0));   // +2 dBi 小型天线
+  YansWifiChannelHelper ch;
+  ch.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
 
   /* ========== HIGH ==========  (LoS 0-150 m) */
   if (quality == "high")
     {
-      wifiPhy.Set ("TxPowerStart", DoubleValue (20.0));   // 20 dBm
-      wifiPhy.Set ("TxPowerEnd",   DoubleValue (20.0));
-      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-82.0));   // RxSens-84 +2 dB
-
-      YansWifiChannelHelper ch;
-      ch.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
       ch.AddPropagationLoss ("ns3::FriisPropagationLossModel",
                              "Frequency", DoubleValue (2.4e9));
       ch.AddPropagationLoss ("ns3::RandomPropagationLossModel",
@@ -129,18 +381,11 @@ void SetupLinkQuality (YansWifiPhyHelper &wifiPhy, std::string quality)
                              "m0", DoubleValue (2.5));   // 轻微快衰落
       ch.AddPropagationLoss ("ns3::RangePropagationLossModel",
                              "MaxRange", DoubleValue (1200.0));   // 1.2 km
-      wifiPhy.SetChannel (ch.Create ());
     }
 
   /* ========== MEDIUM ==========  (轻遮挡 150-600 m) */
   else if (quality == "medium")
     {
-      wifiPhy.Set ("TxPowerStart", DoubleValue (18.0));
-      wifiPhy.Set ("TxPowerEnd",   DoubleValue (18.0));
-      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-81.0));
-
-      YansWifiChannelHelper ch;
-      ch.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
       ch.AddPropagationLoss ("ns3::LogDistancePropagationLossModel",
                              "Exponent",          DoubleValue (2.5),
                              "ReferenceDistance", DoubleValue (1.0),
@@ -155,18 +400,11 @@ void SetupLinkQuality (YansWifiPhyHelper &wifiPhy, std::string quality)
                              "Distance2", DoubleValue (400.0));
       ch.AddPropagationLoss ("ns3::RangePropagationLossModel",
                              "MaxRange", DoubleValue (700.0));
-      wifiPhy.SetChannel (ch.Create ());
     }
 
   /* ========== LOW ==========  (远距 / 频繁遮挡) */
   else if (quality == "low")
     {
-      wifiPhy.Set ("TxPowerStart", DoubleValue (14.0));
-      wifiPhy.Set ("TxPowerEnd",   DoubleValue (14.0));
-      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-78.0));
-
-      YansWifiChannelHelper ch;
-      ch.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
       ch.AddPropagationLoss ("ns3::LogDistancePropagationLossModel",
                              "Exponent",          DoubleValue (3.2),
                              "ReferenceDistance", DoubleValue (1.0),
@@ -181,18 +419,11 @@ void SetupLinkQuality (YansWifiPhyHelper &wifiPhy, std::string quality)
                              "Distance2", DoubleValue (500.0));
       ch.AddPropagationLoss ("ns3::RangePropagationLossModel",
                              "MaxRange", DoubleValue (600.0));
-      wifiPhy.SetChannel (ch.Create ());
     }
 
   /* ========== VERY POOR ==========  (NLoS / 密集遮挡) */
   else   /* very_poor */
     {
-      wifiPhy.Set ("TxPowerStart", DoubleValue (10.0));
-      wifiPhy.Set ("TxPowerEnd",   DoubleValue (10.0));
-      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-75.0));
-
-      YansWifiChannelHelper ch;
-      ch.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
 	  // 设置传播损失
       ch.AddPropagationLoss ("ns3::LogDistancePropagationLossModel",
                              "Exponent",          DoubleValue (3.9),
@@ -209,19 +440,117 @@ void SetupLinkQuality (YansWifiPhyHelper &wifiPhy, std::string quality)
                              "Distance2", DoubleValue (400.0));
       ch.AddPropagationLoss ("ns3::RangePropagationLossModel",
                              "MaxRange", DoubleValue (400.0));
-      wifiPhy.SetChannel (ch.Create ());
     }
+  return ch;
 }
 
+// 按信道选项创建信道：pathLossBin>0时把损失链的第一个模型换成查表模型，
+// pruneChannel时再用PrunedPropagationLossModel包装整条损失链，信道本身换成GridWifiChannel，
+// 有故障计划时最外层再包装FaultPropagationLossModel，degrade用到的链路质量各建一条损失链
+Ptr<YansWifiChannel> CreateChannel (YansWifiChannelHelper &ch, const std::string &quality)
+{
+  Ptr<YansWifiChannel> channel = ch.Create ();
+  PointerValue loss;
+  channel->GetAttribute ("PropagationLossModel", loss);
+  Ptr<PropagationLossModel> chain = loss.Get<PropagationLossModel> ();
+  double maxRange = GetChainMaxRange (chain);
+  if (pathLossBin > 0 && maxRange > 0)
+    {
+      // 第一个模型是只取决于距离的Friis或LogDistance，断开后单独建表
+      Ptr<PropagationLossModel> rest = chain->GetNext ();
+      chain->SetNext (0);
+      Ptr<TabulatedPropagationLossModel> table = CreateObject<TabulatedPropagationLossModel> ();
+      table->Tabulate (chain, maxRange, pathLossBin);
+      table->SetNext (rest);
+      NS_LOG_INFO ("路径损失表插值最大偏差 " << table->GetMaxError () << " dB");
+      chain = table;
+    }
+  // 网格按所有可能用到的损失链中最大的通信距离划分
+  double gridRange = maxRange;
+  if (pruneChannel)
+    {
+      Ptr<PrunedPropagationLossModel> pruned = CreateObject<PrunedPropagationLossModel> ();
+      pruned->SetChain (chain);
+      chain = pruned;
+      // 设备与移动模型安装之后由startSimulation启用
+      Ptr<GridWifiChannel> grid = CreateObject<GridWifiChannel> ();
+      PointerValue delay;
+      channel->GetAttribute ("PropagationDelayModel", delay);
+      grid->SetPropagationDelayModel (delay.Get<PropagationDelayModel> ());
+      channel = grid;
+    }
+  if (!faultPlan.IsEmpty ())
+    {
+      Ptr<FaultPropagationLossModel> fault = CreateObject<FaultPropagationLossModel> ();
+      fault->SetChain (chain);
+      fault->SetFaultPlan (&faultPlan, quality);
+      std::vector<std::string> qualities = faultPlan.GetDegradeQualities ();
+      for (uint32_t k = 0; k < qualities.size (); k++)
+        {
+          YansWifiChannelHelper degradedHelper = LinkQualityChannel (qualities[k]);
+          PointerValue degraded;
+          degradedHelper.Create ()->GetAttribute ("PropagationLossModel", degraded);
+          fault->SetDegradedChain (qualities[k], degraded.Get<PropagationLossModel> (),
+                                   LinkProfile::ForQuality (qualities[k]).txPowerDbm
+                                   - LinkProfile::ForQuality (quality).txPowerDbm);
+          gridRange = std::max (gridRange, GetChainMaxRange (degraded.Get<PropagationLossModel> ()));
+        }
+      chain = fault;
+    }
+  channel->SetPropagationLossModel (chain);
+  Ptr<GridWifiChannel> grid = DynamicCast<GridWifiChannel> (channel);
+  if (grid != 0)
+    {
+      grid->SetMaxRange (gridRange);
+    }
+  return channel;
+}
 
-void startSimulation(const std::string& linkQuality) {
-    
-	NodeContainer nodes;
-	nodes.Create(numNodes);
+void SetupLinkQuality (YansWifiPhyHelper &wifiPhy, std::string quality)
+{
+  /* 硬件常量 */
+  wifiPhy.Set ("RxNoiseFigure", DoubleValue (7.0));   // 无人机常见 NF≈7 dB
+  wifiPhy.Set ("RxGain",        DoubleValue (2.0));   // +2 dBi 小型天线
 
-	// --------------------------------------------------------------
-	// ---------- 设置物理层、数据链路层 ----------
-	// --------------------------------------------------------------
+  /* ========== HIGH ==========  (LoS 0-150 m) */
+  if (quality == "high")
+    {
+      wifiPhy.Set ("TxPowerStart", DoubleValue (20.0));   // 20 dBm
+      wifiPhy.Set ("TxPowerEnd",   DoubleValue (20.0));
+      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-82.0));   // RxSens-84 +2 dB
+    }
+
+  /* ========== MEDIUM ==========  (轻遮挡 150-600 m) */
+  else if (quality == "medium")
+    {
+      wifiPhy.Set ("TxPowerStart", DoubleValue (18.0));
+      wifiPhy.Set ("TxPowerEnd",   DoubleValue (18.0));
+      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-81.0));
+    }
+
+  /* ========== LOW ==========  (远距 / 频繁遮挡) */
+  else if (quality == "low")
+    {
+      wifiPhy.Set ("TxPowerStart", DoubleValue (14.0));
+      wifiPhy.Set ("TxPowerEnd",   DoubleValue (14.0));
+      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-78.0));
+    }
+
+  /* ========== VERY POOR ==========  (NLoS / 密集遮挡) */
+  else   /* very_poor */
+    {
+      wifiPhy.Set ("TxPowerStart", DoubleValue (10.0));
+      wifiPhy.Set ("TxPowerEnd",   DoubleValue (10.0));
+      wifiPhy.Set ("CcaMode1Threshold", DoubleValue (-75.0));
+    }
+
+  YansWifiChannelHelper ch = LinkQualityChannel (quality);
+  wifiPhy.SetChannel (CreateChannel (ch, quality));
+}
+
+
+// 安装802.11g Adhoc设备，信道按链路质量配置
+NetDeviceContainer InstallWifiDevices(NodeContainer& nodes, const std::string& linkQuality) {
 	// 设置wifi标准
 	WifiHelper wifi;
 	// wifi.SetStandard(WIFI_PHY_STANDARD_80211b);
@@ -242,7 +571,52 @@ void startSimulation(const std::string& linkQuality) {
 	wifiMac.SetType("ns3::AdhocWifiMac");
 
 	// 安装至设备
-	NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, nodes);
+	return wifi.Install(wifiPhy, wifiMac, nodes);
+}
+
+SimulationResult startSimulation(const std::string& linkQuality) {
+    
+	// 地址分配器是全局单例，同一进程内多次仿真需要重置，否则地址冲突
+	Ipv4AddressGenerator::Reset();
+	// 各节点的私钥按RngRun确定
+	GroupKeyComputation::Configure(cryptoBackend, cryptoCosts, cryptoBatch, RngSeedManager::GetRun());
+
+	NodeContainer nodes;
+	nodes.Create(numNodes);
+
+	// 故障计划：按RngRun选取按比例指定的节点，需在安装信道之前确定
+	faultPlan = FaultPlan();
+	if (!faultName.empty()) {
+		faultLibrary.Find(faultName, faultPlan);
+		faultPlan.Resolve(numNodes, areaLength, areaWidth, areaHeight, RngSeedManager::GetRun());
+	}
+
+	// --------------------------------------------------------------
+	// ---------- 设置物理层、数据链路层 ----------
+	// --------------------------------------------------------------
+	NetDeviceContainer devices;
+	if (channelModel == "abstract") {
+		// 抽象信道：不经过WiFi的PHY/MAC，按校准表决定是否收到及时延
+		LinkCalibration calibration;
+		calibration.SetProfile(LinkProfile::ForQuality(linkQuality));
+		if (!calibration.Load(calibrationFile)) {
+			NS_LOG_INFO("未找到校准文件" << calibrationFile << "，使用解析链路模型");
+		}
+		devices = InstallCalibratedChannel(nodes, calibration);
+		if (!faultPlan.IsEmpty()) {
+			Ptr<CalibratedChannel> channel = DynamicCast<CalibratedChannel>(devices.Get(0)->GetChannel());
+			channel->SetFaultPlan(&faultPlan, linkQuality);
+			std::vector<std::string> qualities = faultPlan.GetDegradeQualities();
+			for (uint32_t k = 0; k < qualities.size(); k++) {
+				LinkCalibration degraded;
+				degraded.SetProfile(LinkProfile::ForQuality(qualities[k]));
+				degraded.Load(calibrationFile);
+				channel->SetDegradedCalibration(qualities[k], degraded);
+			}
+		}
+	} else {
+		devices = InstallWifiDevices(nodes, linkQuality);
+	}
 	// -------------- End ----------------
 
 
@@ -288,6 +662,9 @@ void startSimulation(const std::string& linkQuality) {
         // 初始化KeyMatrix
         receiver->SetNetworkSize(numNodes);
         sender->SetNetworkSize(numNodes);
+        receiver->SetDuplicateWindow(duplicateWindow);
+        receiver->SetSessions(sessions);
+        receiver->SetStrategy(strategyName);
 
 		nodeToInstallApp->AddApplication(sender);
 		nodeToInstallApp->AddApplication(receiver);
@@ -299,6 +676,14 @@ void startSimulation(const std::string& linkQuality) {
 		receiver->SetStopTime(Seconds(simuTime));
 		sender->SetStopTime(Seconds(simuTime));
 	}
+	// 故障计划中的节点在崩溃时刻停止收发
+	std::vector<std::pair<double, uint32_t> > crashes = faultPlan.GetCrashes();
+	for (uint32_t k = 0; k < crashes.size(); k++) {
+		if (crashes[k].second < numNodes) {
+			Ptr<AppReceiver> receiver = DynamicCast<AppReceiver>(nodes.Get(crashes[k].second)->GetApplication(1));
+			Simulator::Schedule(Seconds(crashes[k].first), &AppReceiver::Crash, receiver);
+		}
+	}
 	// ------------- End -----------------
 
 
@@ -344,6 +729,17 @@ void startSimulation(const std::string& linkQuality) {
 	for (uint32_t i = 0; i < numNodes; ++i) {
 		mobility.Install(nodes.Get(i));
 	}
+	// 网格信道按节点位置建立子信道，需在设备与移动模型都安装之后启用
+	Ptr<GridWifiChannel> gridChannel;
+	if (pruneChannel && channelModel != "abstract" && devices.GetN() > 0) {
+		Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(devices.Get(0));
+		if (device != 0) {
+			gridChannel = DynamicCast<GridWifiChannel>(device->GetChannel());
+		}
+		if (gridChannel != 0) {
+			gridChannel->Activate();
+		}
+	}
 	// -------------- End ----------------
 
 
@@ -362,23 +758,90 @@ void startSimulation(const std::string& linkQuality) {
 	// ---------- 开始仿真 -------------
 	// ------------------------------------------------------------
     
+	// 记录WiFi仿真的链路样本，用于校准抽象信道
+	CalibrationRecorder calibrationRecorder;
+	bool recording = recordCalibration && channelModel != "abstract";
+	bool tracing = !traceDir.empty() && channelModel != "abstract";
+	if (recording || tracing) {
+		calibrationRecorder.Install(nodes);
+	}
+	if (tracing) {
+		calibrationRecorder.SamplePositions(0.1);
+	}
+	MemoryAccountant memoryAccountant;
+	if (!memoryReport.empty()) {
+		memoryAccountant.Install(nodes);
+		memoryAccountant.Start(0.1);
+	}
+	ChannelMonitor channelMonitor;
+	if (channelMetrics) {
+		channelMonitor.Install(nodes, 1.0);
+	}
+
 	// 设置仿真结束时间
 	Simulator::Stop(Seconds(simuTime));
+	RunOutcome = "timeout";
+	// 节点1秒后才开始发送，停滞窗口从此时起算
+	progressMonitor.Reset(1.0);
+	reachRange = LinkProfile::ForQuality(linkQuality).maxRange;
 	Simulator::Schedule(Seconds(0.001), &CheckCompletionAndStop, nodes);
 
 	// 仿真开始
 	Simulator::Run();
+
+	if (gridChannel != 0 && gridChannel->GetTransmissionCount() > 0) {
+		NS_LOG_INFO("网格信道平均每次发送遍历" << static_cast<double>(gridChannel->GetCandidateCount())
+				/ gridChannel->GetTransmissionCount() << "个接收方（共" << numNodes - 1 << "个），重建子信道"
+				<< gridChannel->GetRebuildCount() << "次，超出余量" << gridChannel->GetMarginViolations() << "次");
+	}
+
+	if (!memoryReport.empty()) {
+		memoryAccountant.Finish();
+	}
+	ChannelMetrics channel;
+	if (channelMetrics) {
+		channel = channelMonitor.Finish();
+	}
+
+	if (recording) {
+		LinkCalibration calibration;
+		calibration.SetProfile(LinkProfile::ForQuality(linkQuality));
+		calibrationRecorder.Finish(calibration);
+		calibration.Save(calibrationFile);
+	}
+	if (tracing) {
+		ScenarioConfig scenario;
+		scenario.areaLength = areaLength;
+		scenario.areaWidth = areaWidth;
+		scenario.areaHeight = areaHeight;
+		scenario.numNodes = numNodes;
+		scenario.linkQuality = linkQuality;
+		scenario.run = std::strtoul(runId.c_str(), NULL, 10);
+		scenario.fault = faultName;
+		LinkTrace trace;
+		trace.SetLabel(scenario.Label());
+		calibrationRecorder.Finish(trace);
+		if (mkdir(traceDir.c_str(), 0777) != 0 && errno != EEXIST) {
+			std::cerr << "无法创建链路轨迹目录: " << traceDir << std::endl;
+		} else {
+			trace.Write(traceDir + "/" + scenario.Label() + ".rgkt");
+		}
+	}
  
 
 	// 统计数据包数量
 	uint32_t totalSent = 0;
 	uint32_t totalReceived = 0;
 	uint32_t successfulNodes = 0; // 成功接收所有数据包的节点数
+	uint64_t learnedContributions = 0; // 所有节点已知的密钥贡献总数
+	uint32_t crashedNodes = 0; // 崩溃的节点数，不计入成功率与贡献比例
 
 	std::vector<uint32_t> sentPackets;
 	std::vector<uint32_t> receivedPackets;
 	sentPackets.reserve(numNodes);
 	receivedPackets.reserve(numNodes);
+	std::vector<bool> completedNodes;
+	completedNodes.reserve(numNodes);
 
 	for (uint32_t i = 0; i < numNodes; i++) {
 		// 获取接收方和发送方
@@ -393,25 +856,40 @@ void startSimulation(const std::string& linkQuality) {
 		// 保存每个节点的包数据（用于数据库记录）
 		sentPackets.push_back(packetsSent);
 		receivedPackets.push_back(packetsReceived);
+		totalSent += packetsSent;
+		totalReceived += packetsReceived;
+		if (receiver->IsCrashed()) {
+			crashedNodes++;
+			completedNodes.push_back(false);
+			NS_LOG_INFO("节点" << i << "已崩溃");
+			continue;
+		}
 		
 		// 获取KeyMatrix
 		const KeyMatrix& keyMatrix = receiver->GetKeyMatrix();
 		// 检查节点i是否收到所有密钥贡献
 		bool allContributionsReceived = true;
-		for (uint32_t j = 0; j < numNodes; j++) {
-			if (!keyMatrix.HasKeyContribution(i, j)) {
-				allContributionsReceived = false;
-				break;
-			}	
+		const BaselineProtocol* baseline = receiver->GetBaseline();
+		if (baseline != NULL) {
+			// 基线方案按本节点应知的条目折算为numNodes个贡献，与RE-GKA的贡献比例可比
+			allContributionsReceived = baseline->IsCompleted();
+			learnedContributions += numNodes * baseline->CountLearnedContributions()
+					/ std::max<uint64_t>(baseline->CountExpectedContributions(), 1);
+		} else {
+			for (uint32_t j = 0; j < numNodes; j++) {
+				if (!keyMatrix.HasKeyContribution(i, j)) {
+					allContributionsReceived = false;
+				} else {
+					learnedContributions++;
+				}
+			}
 		}
+		completedNodes.push_back(allContributionsReceived);
 		if (allContributionsReceived) {
 			successfulNodes++;
 			NS_LOG_INFO("节点" << i << "成功收集所有密钥贡献");
 			
 		}
-		totalSent += packetsSent;
-		totalReceived += packetsReceived;
-		
 	}
 		// 输出每个节点接收到的数据包信息
 	NS_LOG_INFO("------------节点数据包统计------------");
@@ -439,10 +917,20 @@ void startSimulation(const std::string& linkQuality) {
 	NS_LOG_INFO("  平均每节点接收数据包: " << std::fixed << std::setprecision(2) << avgReceived);
 	NS_LOG_INFO("  通信开销比(接收/发送): " << std::fixed << std::setprecision(2) << overheadRatio);
 	
-	// 计算成功率
-	double successRate = (double)successfulNodes / numNodes * 100;
-	NS_LOG_INFO("  成功接收所有数据包的节点比例: " << successfulNodes << "/" << numNodes 
-				<< " (" << successRate << "%)");
+	// 计算成功率，有节点崩溃时只统计未崩溃的节点
+	uint32_t survivingNodes = std::max<uint32_t>(numNodes - crashedNodes, 1);
+	double successRate = (double)successfulNodes / survivingNodes * 100;
+	NS_LOG_INFO("  成功接收所有数据包的节点比例: " << successfulNodes << "/" << survivingNodes 
+				<< " (" << successRate << "%)，崩溃节点数: " << crashedNodes);
+	double contributionRate = (double)learnedContributions / ((double)survivingNodes * numNodes) * 100;
+	NS_LOG_INFO("  已知密钥贡献比例: " << contributionRate << "%，结束方式: " << RunOutcome);
+	if (channel.collected) {
+		NS_LOG_INFO("信道层指标:");
+		NS_LOG_INFO("  单播流平均时延: " << channel.flowDelay << " 秒，抖动: " << channel.flowJitter
+				<< " 秒，丢失比例: " << channel.flowLoss << "%");
+		NS_LOG_INFO("  PHY丢帧: " << channel.phyRxDrops << "（冲突 " << channel.collisions
+				<< "），MAC重传: " << channel.macRetries << "，信道忙: " << channel.channelBusy << "%");
+	}
 	NS_LOG_INFO("----------------------------------------");
     
 	// 密钥协商完成的时延
@@ -458,26 +946,297 @@ void startSimulation(const std::string& linkQuality) {
 	if (output != 0)
 		output->Output(dataCollector);
 
-	const char* cacheDir = "/home/z/ns-allinone-3.25/ns-3.25/scratch/REGKA-Ours/results_cache";
-	struct stat st;
-	if (stat(cacheDir, &st) != 0) {
-		mkdir(cacheDir, 0777);
+	SimulationResult result;
+	result.scenario.areaLength = areaLength;
+	result.scenario.areaWidth = areaWidth;
+	result.scenario.areaHeight = areaHeight;
+	result.scenario.numNodes = numNodes;
+	result.scenario.linkQuality = linkQuality;
+	result.scenario.run = std::strtoul(runId.c_str(), NULL, 10);
+	result.scenario.fault = faultName;
+	result.scenario.strategy = strategyName;
+	result.completionTime = keyAgreementDelay;
+	result.totalSent = totalSent;
+	result.totalReceived = totalReceived;
+	result.overheadRatio = overheadRatio;
+	result.successRate = successRate;
+	result.outcome = RunOutcome;
+	result.contributionRate = contributionRate;
+	result.channel = channel;
+
+	// 写入结果数据库（每个进程使用自己的连接）
+	SimulationDatabase* database = GetResultDatabase();
+	if (database != NULL) {
+		int64_t resultId = 0;
+		if (database->RecordSimulationResult(areaLength, areaWidth, areaHeight, numNodes, linkQuality,
+				result.scenario.run, keyAgreementDelay, totalSent, totalReceived, overheadRatio, successRate,
+				RunOutcome, contributionRate, faultName, strategyName, &resultId)) {
+			for (uint32_t i = 0; i < numNodes; i++) {
+				database->RecordNodeResult(resultId, i, sentPackets[i], receivedPackets[i], completedNodes[i]);
+			}
+		}
 	}
-	std::ostringstream cacheFileName;
-	cacheFileName << cacheDir << "/" << areaLength << "*" << areaWidth << "*" << areaHeight << "_" << numNodes << "_" << linkQuality << "_" << runId << ".csv";
-	std::ofstream out(cacheFileName.str(), std::ios::app);
 
-	// 生成时间戳
-	std::time_t now = std::time(nullptr);
-	char buf[32];
-	std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+	if (!memoryReport.empty()) {
+		memoryAccountant.WriteReport(memoryReport, result.scenario.Label());
+	}
 
-	// 写入结果
-	out << buf << "," << areaLength << "," << areaWidth << "," << areaHeight << "," << numNodes << "," << linkQuality << "," << runId << "," << keyAgreementDelay << "," << totalSent << "," << totalReceived << "," << overheadRatio << "," << successRate << std::endl;
-	out.close();
+#ifdef REGKA_PROFILING
+	// 输出协议热点耗时，之后清零，批量模式下每个场景单独统计
+	Profiler::PrintSummary(std::cout, result.scenario.Label());
+	Profiler::WriteCsv(profileOutput, result.scenario.Label());
+	Profiler::Reset();
+#endif
 
 	// NS_LOG_INFO("-----------------仿真结束-------------------");
 	Simulator::Destroy();
+	return result;
+}
+
+// 影响仿真结果、但不属于ScenarioConfig的全局参数，作为结果缓存键的一部分
+// rngRunFollowsRun为true表示ns-3的RngRun等于场景的run（批量模式总是如此）
+std::string SimulationParameters(bool rngRunFollowsRun) {
+	std::ostringstream ss;
+	ss << "simuTime=" << simuTime
+	   << ";periodicInterval=" << periodicInterval
+	   << ";phyMode=" << phyMode
+	   << ";mobility=" << mobilityModel << "|" << mobilitySpeed
+	   << ";strategy=" << strategy;
+	if (channelModel == "abstract") {
+		// 校准表会随记录不断变化，按文件内容区分；wifi模式不写入，保持已有缓存键不变
+		std::ifstream in(calibrationFile.c_str());
+		std::ostringstream content;
+		if (in.is_open()) {
+			content << in.rdbuf();
+		}
+		ss << ";channel=abstract|" << std::hex << ResultCache::Hash(content.str()) << std::dec;
+	}
+	if (KeyMatrix::GetMinimumCR() != 0.8) {
+		ss << ";crFloor=" << KeyMatrix::GetMinimumCR();
+	}
+	if (pruneChannel && channelModel != "abstract") {
+		// 剪枝改变了随机衰落的抽样序列，网格信道不再统计超出距离的接收方的RxDrop
+		ss << ";pruneChannel=grid";
+	}
+	if (RegkaProtocol::GetMaxMessageBytes() > 0) {
+		ss << ";maxMessageBytes=" << RegkaProtocol::GetMaxMessageBytes();
+	}
+	if (duplicateWindow > 0) {
+		ss << ";duplicateWindow=" << duplicateWindow;
+	}
+	if (sessions > 0) {
+		ss << ";sessions=" << sessions << ";frameBytes=" << SessionMux::GetMaxFrameBytes();
+	}
+	if (!progressMonitor.IsDisabled()) {
+		ss << ";stallWindow=" << progressMonitor.GetStallWindow()
+		   << ";unreachableWindow=" << progressMonitor.GetUnreachableWindow();
+	}
+	if (pathLossBin > 0 && channelModel != "abstract") {
+		ss << ";pathLossBin=" << pathLossBin;
+	}
+	if (!faultFile.empty()) {
+		// 场景中的故障可能是文件中的名称，按文件内容区分
+		std::ifstream in(faultFile.c_str());
+		std::ostringstream content;
+		if (in.is_open()) {
+			content << in.rdbuf();
+		}
+		ss << ";faultFile=" << std::hex << ResultCache::Hash(content.str()) << std::dec;
+	}
+	if (channelMetrics) {
+		// 不影响仿真结果，但未统计时缓存的结果没有信道列
+		ss << ";channelMetrics=1";
+	}
+	if (cryptoBackend != NULL) {
+		// 测量的代价随机器变化，缓存只按设置区分
+		ss << ";crypto=" << cryptoName << "|" << cryptoCost << "|" << cpuScale
+		   << "|batch=" << cryptoBatch << "|table=" << fixedBaseTable;
+	}
+	ss << ";rngSeed=" << RngSeedManager::GetSeed()
+	   << ";rngRun=";
+	if (rngRunFollowsRun) {
+		ss << "run";
+	} else {
+		ss << RngSeedManager::GetRun();
+	}
+	return ss.str();
+}
+
+// 结果写入缓存后再交给下一级输出
+struct CachingSink {
+	ResultSink sink;
+	void* context;
+};
+
+void StoreAndForwardResult(const SimulationResult& result, void* context) {
+	CachingSink* caching = static_cast<CachingSink*>(context);
+	if (resultCache != NULL) {
+		resultCache->Store(result);
+	}
+	caching->sink(result, caching->context);
+}
+
+// 运行单个场景（批量模式与工作进程共用）
+bool RunScenario(const ScenarioConfig& scenario, SimulationResult& result) {
+	ResetScenarioState(scenario);
+	result = startSimulation(scenario.linkQuality);
+	result.scenario = scenario;
+	if (!memoryReport.empty()) {
+		// 批量模式下同一进程连续运行多个场景，上一个场景的应用对象应已全部释放
+		MemoryAccountant::CheckForLeaks(scenario.Label());
+	}
+	return true;
+}
+
+// 批量结果输出，所有结果按完成顺序写入同一个CSV文件
+struct BatchOutput {
+	std::ofstream out;
+	uint32_t done;
+	uint32_t total;
+};
+
+void WriteBatchResult(const SimulationResult& result, void* context) {
+	BatchOutput* batch = static_cast<BatchOutput*>(context);
+	batch->out << result.ToCsv() << std::endl;
+	if (resultAggregator != NULL) {
+		resultAggregator->Add(result);
+	}
+	batch->done++;
+	std::cout << "[" << batch->done;
+	if (batch->total > 0) {
+		std::cout << "/" << batch->total;
+	}
+	std::cout << "] " << result.scenario.Label() << " 成功" << std::endl;
+}
+
+bool OpenBatchOutput(BatchOutput& batch, const std::string& outputFile, uint32_t total) {
+	batch.out.open(outputFile.c_str(), std::ios::app);
+	if (!batch.out.is_open()) {
+		std::cerr << "无法打开批量结果文件: " << outputFile << std::endl;
+		return false;
+	}
+	batch.out.seekp(0, std::ios::end);
+	if (batch.out.tellp() == 0) {
+		batch.out << SimulationResult::CsvHeader() << std::endl;
+	}
+	batch.done = 0;
+	batch.total = total;
+	return true;
+}
+
+// 运行一组场景，已缓存的场景直接输出；workers为0时在本进程内顺序运行，否则交给工作进程池，返回失败的场景数
+uint32_t RunScenarios(const std::vector<ScenarioConfig>& scenarios, uint32_t workers, uint32_t maxRetries,
+		ResultSink sink, void* context) {
+	std::vector<ScenarioConfig> pending;
+	for (uint32_t k = 0; k < scenarios.size(); k++) {
+		SimulationResult cached;
+		if (resultCache != NULL && resultCache->Lookup(scenarios[k], cached)) {
+			sink(cached, context);
+		} else {
+			pending.push_back(scenarios[k]);
+		}
+	}
+
+	CachingSink caching;
+	caching.sink = sink;
+	caching.context = context;
+	if (workers == 0) {
+		for (uint32_t k = 0; k < pending.size(); k++) {
+			SimulationResult result;
+			RunScenario(pending[k], result);
+			StoreAndForwardResult(result, &caching);
+		}
+		return 0;
+	}
+	if (pending.empty()) {
+		return 0;
+	}
+	WorkerPool pool(workers, &RunScenario);
+	pool.SetMaxRetries(maxRetries);
+	pool.SetWorkerExitHook(&CloseResultDatabase);
+	return pool.Run(pending, &StoreAndForwardResult, &caching);
+}
+
+// 批量模式：workers为0时在本进程内依次运行所有场景，否则fork出workers个工作进程并行运行
+int RunBatch(const std::vector<ScenarioConfig>& scenarios, const std::string& outputFile,
+		uint32_t workers, uint32_t maxRetries) {
+	BatchOutput batch;
+	if (!OpenBatchOutput(batch, outputFile, scenarios.size())) {
+		return 1;
+	}
+	uint32_t failed = RunScenarios(scenarios, workers, maxRetries, &WriteBatchResult, &batch);
+	batch.out.close();
+	if (failed > 0) {
+		std::cerr << failed << "个场景运行失败" << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// 序贯停止模式下一批重复实验的运行参数
+struct ReplicationBatch {
+	BatchOutput* batch;
+	uint32_t workers;
+	uint32_t maxRetries;
+	std::vector<SimulationResult>* results;
+};
+
+void CollectReplicationResult(const SimulationResult& result, void* context) {
+	ReplicationBatch* replication = static_cast<ReplicationBatch*>(context);
+	replication->results->push_back(result);
+	WriteBatchResult(result, replication->batch);
+}
+
+void RunReplicationBatch(const std::vector<ScenarioConfig>& scenarios, std::vector<SimulationResult>& results, void* context) {
+	ReplicationBatch* replication = static_cast<ReplicationBatch*>(context);
+	replication->results = &results;
+	RunScenarios(scenarios, replication->workers, replication->maxRetries, &CollectReplicationResult, replication);
+}
+
+// 序贯停止模式：对扫描中的每个参数点（忽略run维度，以首个run为起始种子）不断增加重复次数，
+// 直到置信区间收敛或达到上限；每次运行写入batchOutput，每个参数点的汇总写入summaryFile
+int RunAdaptive(const std::vector<ScenarioConfig>& scenarios, const std::string& outputFile,
+		const std::string& summaryFile, uint32_t workers, uint32_t maxRetries,
+		ReplicationController& controller, ReplicationBatch& replication) {
+	std::vector<ScenarioConfig> points;
+	std::set<std::string> seen;
+	for (uint32_t k = 0; k < scenarios.size(); k++) {
+		ScenarioConfig key = scenarios[k];
+		key.run = 0;
+		if (seen.insert(key.Label()).second) {
+			points.push_back(scenarios[k]);
+		}
+	}
+
+	BatchOutput batch;
+	if (!OpenBatchOutput(batch, outputFile, 0)) {
+		return 1;
+	}
+	std::ofstream summary(summaryFile.c_str(), std::ios::app);
+	if (!summary.is_open()) {
+		std::cerr << "无法打开重复实验汇总文件: " << summaryFile << std::endl;
+		return 1;
+	}
+	summary.seekp(0, std::ios::end);
+	if (summary.tellp() == 0) {
+		summary << ReplicationSummary::CsvHeader(controller.GetMetrics()) << std::endl;
+	}
+
+	replication.batch = &batch;
+	replication.workers = workers;
+	replication.maxRetries = maxRetries;
+	replication.results = NULL;
+
+	for (uint32_t k = 0; k < points.size(); k++) {
+		std::vector<SimulationResult> results;
+		ReplicationSummary s = controller.Run(points[k], results);
+		summary << s.ToCsv() << std::endl;
+		std::cout << "参数点 " << points[k].AreaString() << "_" << points[k].numNodes << "_" << points[k].linkQuality
+				<< " 运行" << s.runs << "次，失败" << s.failed << "次" << (s.converged ? "，已收敛" : "，未收敛") << std::endl;
+	}
+	summary.close();
+	batch.out.close();
+	return 0;
 }
 
 int main(int argc, char *argv[]) {
@@ -489,8 +1248,220 @@ int main(int argc, char *argv[]) {
 	cmd.AddValue("run", "运行标识", runId);
 	std::string linkQuality = "medium";  // 默认中等链路质量
 	cmd.AddValue("linkQuality", "Link quality (high/medium/low/very_poor)", linkQuality);
+	std::string sweep;
+	std::string sweepFile;
+	std::string batchOutput = "batch_results.csv";
+	cmd.AddValue("sweep", "批量扫描规格，如 area=500*500*100;nodes=5:65:10;quality=high,low;run=1:10", sweep);
+	cmd.AddValue("sweepFile", "批量场景列表文件，每行: 长 宽 高 节点数 链路质量 运行序号", sweepFile);
+	cmd.AddValue("batchOutput", "批量模式的结果CSV文件", batchOutput);
+	uint32_t workers = 0;
+	uint32_t maxRetries = 2;
+	cmd.AddValue("workers", "批量模式的并行工作进程数，0表示在本进程内顺序运行", workers);
+	cmd.AddValue("maxRetries", "工作进程崩溃或场景失败后的最大重试次数", maxRetries);
+	bool adaptive = false;
+	double ciTarget = 0.05;
+	double ciAbsolute = 0;
+	double ciConfidence = 0.95;
+	uint32_t minRuns = 5;
+	uint32_t maxRuns = 200;
+	std::string ciMetrics = "delay,success,overhead";
+	std::string replicationOutput = "replication_summary.csv";
+	cmd.AddValue("adaptive", "序贯停止：重复运行直到置信区间收敛", adaptive);
+	cmd.AddValue("ciTarget", "置信区间半宽的相对精度目标（相对均值）", ciTarget);
+	cmd.AddValue("ciAbsolute", "置信区间半宽的绝对精度目标", ciAbsolute);
+	cmd.AddValue("ciConfidence", "置信水平", ciConfidence);
+	cmd.AddValue("minRuns", "每个参数点的最少重复次数", minRuns);
+	cmd.AddValue("maxRuns", "每个参数点的最多重复次数", maxRuns);
+	cmd.AddValue("ciMetrics", "参与收敛判断的指标: delay,success,overhead,ratio,contribution", ciMetrics);
+	cmd.AddValue("replicationOutput", "序贯停止模式的参数点汇总CSV文件", replicationOutput);
+	std::string aggregateOutput;
+	std::string aggregateMetrics = "delay,success,overhead,ratio";
+	uint32_t aggregateEvery = 20;
+	cmd.AddValue("aggregateOutput", "批量模式的流式汇总CSV文件（每个参数点的均值、标准差、最值与P50/P90/P99），为空时不汇总", aggregateOutput);
+	cmd.AddValue("aggregateMetrics", "流式汇总的指标: delay,success,overhead,ratio,contribution", aggregateMetrics);
+	cmd.AddValue("aggregateEvery", "每完成该数目的运行重写一次汇总文件", aggregateEvery);
+	std::string cacheDir = "results_cache";
+	bool useCache = true;
+	bool forceRefresh = false;
+	cmd.AddValue("cacheDir", "结果缓存目录，相对路径以当前工作目录为准", cacheDir);
+	cmd.AddValue("useCache", "运行前查找结果缓存，运行后保存结果", useCache);
+	cmd.AddValue("forceRefresh", "忽略已缓存的结果，重新仿真并覆盖缓存", forceRefresh);
+	cmd.AddValue("dbFile", "结果数据库文件（SQLite），为空时不写数据库", dbFile);
+	cmd.AddValue("dbBatchSize", "结果数据库每个事务提交的模拟结果数", dbBatchSize);
+	cmd.AddValue("channelModel", "信道模型: wifi（完整802.11g）或abstract（按校准表的快速抽象信道）", channelModel);
+	cmd.AddValue("calibrationFile", "链路校准文件", calibrationFile);
+	cmd.AddValue("recordCalibration", "WiFi仿真时记录链路样本并合并写入校准文件", recordCalibration);
+	cmd.AddValue("traceDir", "WiFi仿真时把链路轨迹写入该目录，供regka-replay离线重放", traceDir);
+	cmd.AddValue("pruneChannel", "WiFi信道中超出最大通信距离的节点对不再计算传播损失链，发送时只遍历附近网格中的PHY（随机数序列与原信道不同）", pruneChannel);
+	cmd.AddValue("pathLossBin", "WiFi信道的确定性路径损失按该距离间隔 (m) 查表插值，0为直接计算", pathLossBin);
+	uint32_t maxMessageBytes = RegkaProtocol::GetMaxMessageBytes();
+	cmd.AddValue("maxMessageBytes", "消息（含填充）长度上限，超过时拆成可独立合并的分片（如1472），0为不拆分", maxMessageBytes);
+	cmd.AddValue("duplicateWindow", "重复消息缓存的时间窗口 (s)，窗口内同一发送方的相同消息在解析前丢弃，0为不丢弃", duplicateWindow);
+	uint32_t frameBytes = SessionMux::GetMaxFrameBytes();
+	cmd.AddValue("sessions", "每个节点上并发的会话数（每个会话覆盖全部节点，结果按全部会话完成统计），0为单会话", sessions);
+	cmd.AddValue("frameBytes", "多会话时帧（含填充）的长度上限，0为不限制，1为每条消息单独成帧", frameBytes);
+	double stallWindow = 0;
+	double unreachableWindow = 0;
+	cmd.AddValue("stallWindow", "所有节点在该时间 (s) 内都没有获得新的密钥贡献时判定停滞并提前结束，0为不检查", stallWindow);
+	cmd.AddValue("unreachableWindow", "连续该时间 (s) 没有未完成节点能从通信范围连通的节点获得缺少的贡献时判定停滞，0为不检查", unreachableWindow);
+	double crFloor = KeyMatrix::GetMinimumCR();
+	cmd.AddValue("crFloor", "转发时贡献比例CR的下限", crFloor);
+	std::string benchmarkReport;
+	double maxScalingExponent = 0;
+	cmd.AddValue("benchmark", "扩展性基准测试：逐个在子进程中运行扫描中的场景，报告写入该文件", benchmarkReport);
+	cmd.AddValue("maxScalingExponent", "基准测试中耗时随节点数的增长指数上限，超过时返回2，0为不检查", maxScalingExponent);
+	cmd.AddValue("channelMetrics", "统计信道层指标：FlowMonitor单播流的时延、抖动、丢失，WiFi的PHY丢帧、冲突、MAC重传与信道忙比例", channelMetrics);
+	cmd.AddValue("memoryReport", "协议侧内存统计文件（每个节点及全局的峰值与结束值），为空时不统计", memoryReport);
+	cmd.AddValue("strategy", "协商方案: regka（本文方案）或基线方案flooding（盲泛洪）、tgdh（树形群DH）、centralized（集中式）", strategyName);
+	cmd.AddValue("fault", "故障计划，如crash@1.005:10%+partition@2-8:x<0.5（见FaultPlan.h），或faultFile中的名称；none为没有故障", faultName);
+	cmd.AddValue("faultFile", "命名故障计划文件，每行: 名称 计划", faultFile);
+	cmd.AddValue("crypto", "密钥计算后端: none（只以填充表示）、x25519（纯C++），定义REGKA_WITH_OPENSSL时另有openssl", cryptoName);
+	cmd.AddValue("cryptoCost", "每次可变基点标量乘的代价 (ms)，其余各项按本机测量的比例；measured为本机测量", cryptoCost);
+	cmd.AddValue("cpuScale", "密钥计算代价的倍数，用于估计较慢的机载处理器", cpuScale);
+	cmd.AddValue("cryptoBatch", "同一条消息带来的多个贡献批量处理（共用一次求逆）", cryptoBatch);
+	cmd.AddValue("fixedBaseTable", "x25519后端用固定基点的倍点表生成贡献", fixedBaseTable);
+#ifdef REGKA_PROFILING
+	cmd.AddValue("profileOutput", "协议热点耗时统计文件", profileOutput);
+#endif
 	cmd.Parse(argc, argv);
+	KeyMatrix::SetMinimumCR(crFloor);
+	RegkaProtocol::SetMaxMessageBytes(maxMessageBytes);
+	SessionMux::SetMaxFrameBytes(frameBytes);
+	progressMonitor.SetStallWindow(stallWindow);
+	progressMonitor.SetUnreachableWindow(unreachableWindow);
+	BaselineProtocol::Scheme scheme;
+	if (strategyName != "regka" && !BaselineProtocol::ParseScheme(strategyName, scheme)) {
+		std::cerr << "未知协商方案: " << strategyName << std::endl;
+		return 1;
+	}
+	if (strategyName != "regka" && sessions > 0) {
+		std::cerr << "基线方案不支持多会话" << std::endl;
+		return 1;
+	}
+	if (cryptoName != "none" && sessions > 0) {
+		// 多会话的完成检查不等待密钥计算
+		std::cerr << "多会话不支持密钥计算" << std::endl;
+		return 1;
+	}
+	if (faultName == "none") {
+		faultName.clear();
+	}
+	if (!faultFile.empty() && !faultLibrary.LoadFile(faultFile)) {
+		return 1;
+	}
+	if (!CheckFaultPlan(faultName)) {
+		return 1;
+	}
+	if (cryptoName != "none") {
+		cryptoBackend = CryptoBackend::Create(cryptoName);
+		if (cryptoBackend == NULL) {
+			std::cerr << "未知密钥计算后端: " << cryptoName << std::endl;
+			return 1;
+		}
+		if (cryptoName == "x25519") {
+			static_cast<X25519Backend*>(cryptoBackend)->SetFixedBaseTable(fixedBaseTable);
+		}
+		cryptoCosts = CryptoCosts::Measure(*cryptoBackend, 32);
+		if (cryptoCost != "measured") {
+			double milliseconds = std::atof(cryptoCost.c_str());
+			if (milliseconds <= 0 || cryptoCosts.variableBase <= 0) {
+				std::cerr << "密钥计算代价格式错误: " << cryptoCost << std::endl;
+				return 1;
+			}
+			cryptoCosts = cryptoCosts.Scaled(milliseconds / 1000 / cryptoCosts.variableBase);
+		}
+		cryptoCosts = cryptoCosts.Scaled(cpuScale);
+	}
+
+	strategy = StrategyLabel();
+	ResultCache cache(cacheDir, protocolVersion);
+	cache.SetForceRefresh(forceRefresh);
+	if (useCache) {
+		resultCache = &cache;
+	}
+
+	// 批量模式：一个进程依次运行所有场景，不再为每个场景单独建立日志文件
+	if (!sweep.empty() || !sweepFile.empty()) {
+		ScenarioConfig base;
+		base.areaLength = areaLength;
+		base.areaWidth = areaWidth;
+		base.areaHeight = areaHeight;
+		base.numNodes = numNodes;
+		base.linkQuality = linkQuality;
+		base.run = runId.empty() ? 1 : std::strtoul(runId.c_str(), NULL, 10);
+		base.fault = faultName;
+
+		cache.SetParameters(SimulationParameters(true));
+		SweepSpec spec;
+		if (!sweepFile.empty() && !spec.LoadFile(sweepFile)) {
+			return 1;
+		}
+		if (!sweep.empty() && !spec.Parse(sweep, base)) {
+			return 1;
+		}
+		for (uint32_t k = 0; k < spec.GetScenarios().size(); k++) {
+			if (!CheckFaultPlan(spec.GetScenarios()[k].fault)) {
+				return 1;
+			}
+		}
+		ResultAggregator aggregator;
+		if (!aggregateOutput.empty()) {
+			if (!aggregator.SetMetrics(aggregateMetrics)) {
+				return 1;
+			}
+			aggregator.SetOutput(aggregateOutput);
+			aggregator.SetFlushEvery(std::max<uint32_t>(aggregateEvery, 1));
+			resultAggregator = &aggregator;
+		}
+		int status = 0;
+		if (!benchmarkReport.empty()) {
+			// 基准测试总是实际运行，不查找也不写入缓存
+			resultCache = NULL;
+			CountingSimulatorImpl::Enable();
+			ScalingBenchmark benchmark(&RunScenario);
+			benchmark.SetExitHook(&CloseResultDatabase);
+			benchmark.SetMaxScalingExponent(maxScalingExponent);
+			status = benchmark.Run(spec.GetScenarios(), benchmarkReport);
+		} else if (adaptive) {
+			ReplicationBatch replication;
+			ReplicationController controller(&RunReplicationBatch, &replication);
+			controller.SetRelativePrecision(ciTarget);
+			controller.SetAbsolutePrecision(ciAbsolute);
+			controller.SetConfidence(ciConfidence);
+			controller.SetMinRuns(minRuns);
+			controller.SetMaxRuns(maxRuns);
+			controller.SetBatchSize(workers > 0 ? workers : 1);
+			if (!controller.SetMetrics(ciMetrics)) {
+				return 1;
+			}
+			status = RunAdaptive(spec.GetScenarios(), batchOutput, replicationOutput, workers, maxRetries, controller, replication);
+		} else {
+			status = RunBatch(spec.GetScenarios(), batchOutput, workers, maxRetries);
+		}
+		if (resultAggregator != NULL) {
+			resultAggregator->Write();
+			resultAggregator = NULL;
+		}
+		CloseResultDatabase();
+		return status;
+	}
 	
+	// 单次模式同样先查找缓存，便于run.sh中断后续跑
+	ScenarioConfig single;
+	single.areaLength = areaLength;
+	single.areaWidth = areaWidth;
+	single.areaHeight = areaHeight;
+	single.numNodes = numNodes;
+	single.linkQuality = linkQuality;
+	single.run = std::strtoul(runId.c_str(), NULL, 10);
+	single.fault = faultName;
+	cache.SetParameters(SimulationParameters(RngSeedManager::GetRun() == single.run));
+	SimulationResult cachedResult;
+	if (resultCache != NULL && resultCache->Lookup(single, cachedResult)) {
+		std::cout << single.Label() << " 已缓存，跳过" << std::endl;
+		return 0;
+	}
+
 	// 显式设置日志级别
 	LogComponentEnable("wifi-adhoc-UAV-experiment", LOG_LEVEL_INFO);
 	LogComponentEnable("wifi-adhoc-app", LOG_LEVEL_INFO);
@@ -524,16 +1495,25 @@ int main(int argc, char *argv[]) {
 		NS_LOG_INFO("=====================================");
 		
 		// 标注实验节点数目
-		input = numNodes;
-		// 标注实验信息
 		std::ostringstream ss;
+		ss << numNodes;
+		input = ss.str();
+		// 标注实验信息
+		ss.str("");
 		ss << "numNodes:" << numNodes << ";areaLength:" << areaLength << ";areaWidth:" << areaWidth << ";areaHeight:" << areaHeight;
+		if (!faultName.empty()) {
+			ss << ";fault:" << faultName;
+		}
 		experiment = ss.str();
 		ss.str("");
-		strategy = "单轮通信";
+		strategy = StrategyLabel();
 		
 		// 运行仿真
-		startSimulation(linkQuality);
+		SimulationResult result = startSimulation(linkQuality);
+		if (resultCache != NULL) {
+			resultCache->Store(result);
+		}
+		CloseResultDatabase();
 		
 		// 确保所有日志都写入文件
 		std::clog.flush();
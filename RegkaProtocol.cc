@@ -0,0 +1,660 @@
+/*
+ * RegkaProtocol.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "RegkaProtocol.h"
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+
+const uint32_t RegkaProtocol::BROADCAST = 0xffffffff;
+const double RegkaProtocol::SEND_DELAY = 0.005;
+const double RegkaProtocol::START_DELAY = 0.005;
+const double RegkaProtocol::PERIODIC_START = 1.1;
+uint32_t RegkaProtocol::s_maxMessageBytes = 0;
+
+// ---------------- SharedPayload ----------------
+
+SharedPayload::SharedPayload(const std::string& content)
+  : m_body(new Body)
+{
+  m_body->content = content;
+  m_body->references = 1;
+}
+
+SharedPayload::SharedPayload(const SharedPayload& other)
+  : m_body(other.m_body)
+{
+  if (m_body != NULL) {
+    m_body->references++;
+  }
+}
+
+SharedPayload& SharedPayload::operator=(const SharedPayload& other)
+{
+  if (other.m_body != NULL) {
+    other.m_body->references++;
+  }
+  Release();
+  m_body = other.m_body;
+  return *this;
+}
+
+SharedPayload::~SharedPayload()
+{
+  Release();
+}
+
+void SharedPayload::Release()
+{
+  if (m_body != NULL && --m_body->references == 0) {
+    delete m_body;
+  }
+  m_body = NULL;
+}
+
+const std::string& SharedPayload::Get() const
+{
+  static const std::string empty;
+  return m_body != NULL ? m_body->content : empty;
+}
+
+// ---------------- RegkaProtocol ----------------
+
+// 消息中节点ID字段携带的贡献版本号，没有时为0
+static uint32_t ParseSenderEpoch(const std::string& token)
+{
+  std::string::size_type colon = token.find(':');
+  return colon == std::string::npos ? 0 : std::strtoul(token.c_str() + colon + 1, NULL, 10);
+}
+
+RegkaProtocol::RegkaProtocol()
+  : m_host(NULL),
+    m_nodeId(0),
+    m_networkSize(0),
+    m_periodicInterval(0.1),
+    m_sentCount(0),
+    m_receivedCount(0),
+    m_isCompleted(false),
+    m_joining(false),
+    m_membershipRepeats(0),
+    m_fullRekey(false),
+    m_viewChanged(false),
+    m_sharedNeighbors(NULL)
+{
+}
+
+void RegkaProtocol::Initialize(uint32_t networkSize, uint32_t nodeId)
+{
+  m_networkSize = networkSize;
+  m_nodeId = nodeId;
+  m_keyMatrix.InitializeMatrix(networkSize, nodeId);
+  m_senderMatrix.InitializeMatrix(networkSize, nodeId);
+  m_senderBody = SharedPayload();
+  m_neighbors.clear();
+  m_sentCount = 0;
+  m_receivedCount = 0;
+  m_isCompleted = false;
+  m_incarnations.assign(networkSize, 1);
+  m_refreshEpochs.assign(networkSize, 0);
+  m_joining = false;
+  m_membershipRepeats = 0;
+  m_viewChanged = false;
+  m_computation.Initialize(nodeId);
+}
+
+uint32_t RegkaProtocol::GetEpoch() const
+{
+  // 完整重新协商时加入与离开都使所有贡献作废，按版本号之和计
+  uint32_t epoch = 0;
+  for (uint32_t slot = 0; slot < m_incarnations.size(); slot++) {
+    epoch += m_fullRekey ? m_incarnations[slot] : m_incarnations[slot] / 2;
+  }
+  return epoch;
+}
+
+std::string RegkaProtocol::GetSenderToken() const
+{
+  std::ostringstream token;
+  token << m_nodeId;
+  uint32_t epoch = GetEpoch();
+  if (epoch > 0) {
+    token << ":" << epoch;
+  }
+  return token.str();
+}
+
+std::string RegkaProtocol::BuildHeader(const std::string& contributions) const
+{
+  return GetSenderToken() + " " + contributions + " ";
+}
+
+SharedPayload& RegkaProtocol::SenderBody()
+{
+  if (m_senderBody.IsNull()) {
+    m_senderBody = SharedPayload(m_senderMatrix.MatrixToString());
+  }
+  return m_senderBody;
+}
+
+void RegkaProtocol::SendMessage(uint32_t destination, const std::string& contributions, const KeyMatrix& matrix,
+                                SharedPayload& body, double delay)
+{
+  if (s_maxMessageBytes == 0) {
+    if (body.IsNull()) {
+      body = SharedPayload(matrix.MatrixToString());
+    }
+    m_host->SendShared(destination, BuildHeader(contributions), body, delay);
+    return;
+  }
+  uint32_t padding = GetPaddingBytes(contributions, m_networkSize);
+  std::string sender = GetSenderToken();
+  if (sender.size() + contributions.size() + m_networkSize * m_networkSize + 2 + padding <= s_maxMessageBytes) {
+    if (body.IsNull()) {
+      body = SharedPayload(matrix.MatrixToString());
+    }
+    m_host->SendShared(destination, BuildHeader(contributions), body, delay);
+    return;
+  }
+
+  // 分片头部的长度上界：标记、贡献串、6个十进制数字段及分隔符，带版本号时再加 ":版本号"
+  uint32_t headerBytes = m_networkSize + 6 * 11 + 3 + (sender.find(':') != std::string::npos ? 11 : 0);
+  uint32_t space = s_maxMessageBytes > headerBytes ? s_maxMessageBytes - headerBytes : 0;
+  // 每个分片至少携带一行，上限过小时分片会超出上限
+  uint32_t rowsPerChunk = std::max<uint32_t>(space / std::max<uint32_t>(m_networkSize, 1), 1);
+  uint32_t rowChunks = (m_networkSize + rowsPerChunk - 1) / rowsPerChunk;
+  // 行分片的剩余空间先放填充，放不下的填充再单独成片
+  uint64_t rowChunkSpace = 0;
+  for (uint32_t k = 0; k < rowChunks; k++) {
+    uint32_t rows = std::min(rowsPerChunk, m_networkSize - k * rowsPerChunk);
+    rowChunkSpace += space > rows * m_networkSize ? space - rows * m_networkSize : 0;
+  }
+  uint32_t paddingChunks = 0;
+  if (padding > rowChunkSpace && space > 0) {
+    paddingChunks = (padding - rowChunkSpace + space - 1) / space;
+  }
+  uint32_t chunks = rowChunks + paddingChunks;
+
+  uint32_t remainingPadding = padding;
+  for (uint32_t k = 0; k < chunks; k++) {
+    uint32_t firstRow = std::min(k * rowsPerChunk, m_networkSize);
+    uint32_t rows = std::min(rowsPerChunk, m_networkSize - firstRow);
+    uint32_t rowBytes = rows * m_networkSize;
+    uint32_t chunkPadding = std::min(remainingPadding, space > rowBytes ? space - rowBytes : 0);
+    if (k + 1 == chunks) {
+      chunkPadding = remainingPadding;
+    }
+    remainingPadding -= chunkPadding;
+
+    std::ostringstream chunk;
+    chunk << "C " << sender << " " << k << " " << chunks << " " << contributions << " " << firstRow << " "
+          << rows << " " << chunkPadding << " " << matrix.RowsToString(firstRow, rows);
+    m_host->Send(destination, chunk.str(), delay);
+  }
+}
+
+void RegkaProtocol::Start()
+{
+  // 初始贡献串只有自己一位
+  std::string forwardingContributions = std::string(m_networkSize, '0');
+  forwardingContributions[m_nodeId] = '1';
+  if (GroupKeyComputation::IsEnabled()) {
+    m_computation.GenerateContribution(m_host->Now());
+  }
+  SendMessage(BROADCAST, forwardingContributions, m_senderMatrix, SenderBody(), START_DELAY + SEND_DELAY + ComputeDelay());
+  m_host->ScheduleTimer(PERIODIC_START);
+}
+
+void RegkaProtocol::OnTimer()
+{
+  if (m_joining) {
+    std::ostringstream join;
+    join << "J " << m_nodeId;
+    m_host->Send(BROADCAST, join.str(), SEND_DELAY);
+  }
+  if (m_membershipRepeats > 0) {
+    m_membershipRepeats--;
+    BroadcastMembership();
+  }
+
+  // 检查是否已经收齐所有密钥贡献
+  if (m_senderMatrix.IsFull1()) {
+    return;
+  }
+
+  // 已收到的贡献为1，以接收侧矩阵为准
+  std::string forwardingContributions = std::string(m_networkSize, '0');
+  for (uint32_t i = 0; i < m_networkSize; i++) {
+    if (m_keyMatrix.HasKeyContribution(m_nodeId, i)) {
+      forwardingContributions[i] = '1';
+    }
+  }
+  SendMessage(BROADCAST, forwardingContributions, m_senderMatrix, SenderBody(), SEND_DELAY + ComputeDelay());
+  m_host->ScheduleTimer(m_periodicInterval);
+}
+
+// 更新邻居列表，只保留最新的N/2个邻居,N为节点数量
+void RegkaProtocol::UpdateNeighborList(uint32_t neighbor)
+{
+  std::vector<uint32_t>& neighbors = Neighbors();
+  std::vector<uint32_t>::iterator it = std::find(neighbors.begin(), neighbors.end(), neighbor);
+  if (it != neighbors.end()) {
+    // 已在列表中，移动到末尾
+    neighbors.erase(it);
+    neighbors.push_back(neighbor);
+  } else {
+    neighbors.push_back(neighbor);
+    if (neighbors.size() > m_networkSize / 2) {
+      neighbors.erase(neighbors.begin());
+    }
+  }
+}
+
+void RegkaProtocol::AcceptContributions(const std::string& contributions, uint32_t senderEpoch)
+{
+  // 与原实现一致：贡献串中的每一位都被接受，不论该位是否为1
+  bool compute = GroupKeyComputation::IsEnabled();
+  std::vector<uint32_t> accepted;
+  for (uint32_t i = 0; i < contributions.size() && i < m_networkSize; i++) {
+    // 更新过的贡献：版本号较旧的发送方带的是更新前的贡献，0位表示发送方也没有
+    if (m_refreshEpochs[i] > 0 && (senderEpoch < m_refreshEpochs[i] || contributions[i] != '1')) {
+      continue;
+    }
+    if (!m_keyMatrix.HasKeyContribution(m_nodeId, i)) {
+      m_keyMatrix.ReceiveKeyContribution(i);
+      if (compute) {
+        accepted.push_back(i);
+      }
+    }
+  }
+  // 同一条消息带来的新贡献一起处理，批量时共用一次求逆
+  if (!accepted.empty()) {
+    m_computation.ProcessContributions(accepted, m_host->Now());
+  }
+}
+
+bool RegkaProtocol::GetStaleColumns(uint32_t senderEpoch, std::vector<bool>& stale) const
+{
+  bool any = false;
+  stale.assign(m_networkSize, false);
+  for (uint32_t i = 0; i < m_networkSize; i++) {
+    if (m_refreshEpochs[i] > senderEpoch) {
+      stale[i] = true;
+      any = true;
+    }
+  }
+  return any;
+}
+
+void RegkaProtocol::MarkCompleted()
+{
+  if (!m_isCompleted && GroupKeyComputation::IsEnabled()) {
+    std::vector<uint32_t> slots;
+    for (uint32_t i = 0; i < m_networkSize; i++) {
+      if (m_keyMatrix.IsActive(i)) {
+        slots.push_back(i);
+      }
+    }
+    m_computation.DeriveKey(slots, m_host->Now());
+  }
+  m_isCompleted = true;
+}
+
+double RegkaProtocol::ComputeDelay() const
+{
+  if (!GroupKeyComputation::IsEnabled()) {
+    return 0;
+  }
+  return m_computation.GetRemainingTime(m_host->Now());
+}
+
+void RegkaProtocol::ForwardToNeighbors()
+{
+  if (m_keyMatrix.SelfIsFull1()) {
+    MarkCompleted();
+  }
+
+  // 向每个邻居转发它可能缺少的贡献，这些消息共用同一个矩阵串
+  SharedPayload body;
+  const std::vector<uint32_t>& neighbors = Neighbors();
+  for (uint32_t i = 0; i < neighbors.size(); i++) {
+    uint32_t neighborId = neighbors[i];
+    // 共用邻居表中可能有不属于本会话的节点
+    if (!m_keyMatrix.IsActive(neighborId)) {
+      continue;
+    }
+    std::string forwardingContributions = m_keyMatrix.GetForwardingContributions(neighborId);
+    if (forwardingContributions != std::string(m_networkSize, '0')) {
+      SendMessage(neighborId, forwardingContributions, m_keyMatrix, body, SEND_DELAY + ComputeDelay());
+    }
+  }
+}
+
+void RegkaProtocol::OnReceive(uint32_t from, const std::string& msg)
+{
+  m_receivedCount++;
+  if (IsMembership(msg)) {
+    OnReceiveMembership(from, msg);
+    return;
+  }
+  UpdateNeighborList(from);
+
+  if (IsChunk(msg)) {
+    OnReceiveChunk(msg);
+    return;
+  }
+
+  std::string::size_type first = msg.find(" ");
+  std::string::size_type second = msg.find(" ", first + 1);
+  uint32_t senderEpoch = ParseSenderEpoch(msg.substr(0, first));
+  if (m_fullRekey && senderEpoch < GetEpoch()) {
+    // 发送方还在上一次协商中
+    return;
+  }
+  std::string receivedContributions = msg.substr(first + 1, second - first - 1);
+  // 贡献串长度即发送方的矩阵大小
+  uint32_t senderSize = receivedContributions.size();
+  Grow(senderSize);
+  AcceptContributions(receivedContributions, senderEpoch);
+  std::vector<bool> stale;
+  const std::vector<bool>* skipColumns = GetStaleColumns(senderEpoch, stale) ? &stale : NULL;
+  if (senderSize == m_networkSize) {
+    std::string receivedMatrixString = msg.substr(second + 1, m_networkSize * m_networkSize);
+    KeyMatrix receivedMatrix = m_keyMatrix.StringToMatrix(receivedMatrixString);
+    m_keyMatrix.MergeMatrix(receivedMatrix, skipColumns);
+  } else {
+    m_keyMatrix.MergeRows(0, msg.substr(second + 1, senderSize * senderSize), senderSize, skipColumns);
+  }
+  ForwardToNeighbors();
+}
+
+void RegkaProtocol::OnReceiveMembership(uint32_t from, const std::string& msg)
+{
+  std::istringstream in(msg);
+  std::string tag;
+  in >> tag;
+  bool changed = false;
+  if (tag == "J" || tag == "L") {
+    uint32_t slot = 0;
+    if (!(in >> slot)) {
+      return;
+    }
+    Grow(slot + 1);
+    bool active = m_incarnations[slot] % 2 == 1;
+    if (tag == "J") {
+      UpdateNeighborList(from);
+      if (active) {
+        // 已是成员时只回复一次视图，加入者可能还没有收到
+        BroadcastMembership();
+      } else {
+        changed = ApplyIncarnation(slot, m_incarnations[slot] + 1);
+      }
+    } else if (active) {
+      changed = ApplyIncarnation(slot, m_incarnations[slot] + 1);
+    }
+  } else {
+    UpdateNeighborList(from);
+    std::vector<uint32_t> incarnations;
+    uint32_t incarnation = 0;
+    while (in >> incarnation) {
+      incarnations.push_back(incarnation);
+    }
+    Grow(incarnations.size());
+    for (uint32_t slot = 0; slot < incarnations.size(); slot++) {
+      if (slot == m_nodeId) {
+        // 自己的成员状态以自己为准，视图中包含自己即加入完成
+        if (incarnations[slot] % 2 == 1) {
+          m_joining = false;
+          m_incarnations[slot] = std::max(m_incarnations[slot], incarnations[slot]);
+        }
+        continue;
+      }
+      changed = ApplyIncarnation(slot, incarnations[slot]) || changed;
+    }
+  }
+  if (changed) {
+    BroadcastMembership();
+    m_membershipRepeats = 2;
+  }
+  if (m_viewChanged) {
+    m_viewChanged = false;
+    ResetAgreement();
+  }
+}
+
+void RegkaProtocol::Grow(uint32_t networkSize)
+{
+  if (networkSize <= m_networkSize) {
+    return;
+  }
+  m_keyMatrix.Resize(networkSize);
+  m_senderMatrix.Resize(networkSize);
+  m_senderBody = SharedPayload();
+  m_incarnations.resize(networkSize, 0);
+  m_refreshEpochs.resize(networkSize, 0);
+  m_networkSize = networkSize;
+}
+
+bool RegkaProtocol::ApplyIncarnation(uint32_t slot, uint32_t incarnation)
+{
+  if (slot == m_nodeId || incarnation <= m_incarnations[slot]) {
+    return false;
+  }
+  bool wasActive = m_incarnations[slot] % 2 == 1;
+  bool active = incarnation % 2 == 1;
+  m_incarnations[slot] = incarnation;
+  if (active == wasActive) {
+    return true;
+  }
+  m_keyMatrix.SetActive(slot, active);
+  m_senderMatrix.SetActive(slot, active);
+  m_senderBody = SharedPayload();
+  if (!active) {
+    // 共用邻居表由转发时的成员检查过滤
+    std::vector<uint32_t>::iterator it = std::find(m_neighbors.begin(), m_neighbors.end(), slot);
+    if (it != m_neighbors.end()) {
+      m_neighbors.erase(it);
+    }
+  }
+  if (m_fullRekey) {
+    // 处理完这条成员消息后从头协商
+    m_viewChanged = true;
+    return true;
+  }
+  if (active) {
+    // 新成员：只有它自己拥有它的贡献，它也只拥有自己的贡献
+    m_keyMatrix.ResetContribution(slot);
+    m_keyMatrix.ResetRow(slot);
+  } else {
+    // 编号最小的成员更新自己的贡献，使离开的成员无法得到新的组密钥
+    uint32_t sponsor = 0;
+    while (sponsor < m_networkSize && !m_keyMatrix.IsActive(sponsor)) {
+      sponsor++;
+    }
+    if (sponsor < m_networkSize) {
+      m_keyMatrix.ResetContribution(sponsor);
+      m_refreshEpochs[sponsor] = GetEpoch();
+      if (sponsor == m_nodeId) {
+        std::string contributions(m_networkSize, '0');
+        contributions[m_nodeId] = '1';
+        SharedPayload body;
+        SendMessage(BROADCAST, contributions, m_keyMatrix, body, SEND_DELAY);
+      }
+    }
+  }
+  m_isCompleted = m_keyMatrix.SelfIsFull1();
+  return true;
+}
+
+void RegkaProtocol::BroadcastMembership()
+{
+  std::ostringstream view;
+  view << "M";
+  for (uint32_t slot = 0; slot < m_incarnations.size(); slot++) {
+    view << " " << m_incarnations[slot];
+  }
+  m_host->Send(BROADCAST, view.str(), SEND_DELAY);
+}
+
+void RegkaProtocol::SetMember(uint32_t slot, bool active)
+{
+  Grow(slot + 1);
+  // 初始视图没有历史：成员的版本号为1，从未加入的为0，之后的加入与离开依次加一
+  m_incarnations[slot] = active ? 1 : 0;
+  m_keyMatrix.SetActive(slot, active);
+  m_senderMatrix.SetActive(slot, active);
+  m_senderBody = SharedPayload();
+}
+
+void RegkaProtocol::Join()
+{
+  m_joining = true;
+  std::ostringstream join;
+  join << "J " << m_nodeId;
+  m_host->Send(BROADCAST, join.str(), START_DELAY);
+  Start();
+}
+
+void RegkaProtocol::Leave()
+{
+  // 没有确认机制，重复三次以应对丢包
+  std::ostringstream leave;
+  leave << "L " << m_nodeId;
+  for (int i = 0; i < 3; i++) {
+    m_host->Send(BROADCAST, leave.str(), SEND_DELAY * (i + 1));
+  }
+}
+
+void RegkaProtocol::ResetAgreement()
+{
+  std::vector<bool> active(m_networkSize);
+  for (uint32_t slot = 0; slot < m_networkSize; slot++) {
+    active[slot] = m_keyMatrix.IsActive(slot);
+  }
+  m_keyMatrix.InitializeMatrix(m_networkSize, m_nodeId);
+  m_senderMatrix.InitializeMatrix(m_networkSize, m_nodeId);
+  for (uint32_t slot = 0; slot < m_networkSize; slot++) {
+    if (!active[slot]) {
+      m_keyMatrix.SetActive(slot, false);
+      m_senderMatrix.SetActive(slot, false);
+    }
+  }
+  m_senderBody = SharedPayload();
+  m_isCompleted = m_keyMatrix.SelfIsFull1();
+  m_computation.ResetKey();
+  std::string contributions(m_networkSize, '0');
+  contributions[m_nodeId] = '1';
+  SendMessage(BROADCAST, contributions, m_senderMatrix, SenderBody(), SEND_DELAY);
+}
+
+void RegkaProtocol::OnReceiveChunk(const std::string& msg)
+{
+  std::istringstream in(msg);
+  std::string tag;
+  std::string sender;
+  uint32_t index = 0;
+  uint32_t chunks = 0;
+  std::string contributions;
+  uint32_t firstRow = 0;
+  uint32_t rows = 0;
+  uint32_t padding = 0;
+  if (!(in >> tag >> sender >> index >> chunks >> contributions >> firstRow >> rows >> padding)) {
+    return;
+  }
+  std::string::size_type start = static_cast<std::string::size_type>(in.tellg()) + 1;
+
+  uint32_t senderEpoch = ParseSenderEpoch(sender);
+  if (m_fullRekey && senderEpoch < GetEpoch()) {
+    return;
+  }
+  // 贡献串长度即发送方的矩阵大小
+  uint32_t senderSize = contributions.size();
+  Grow(senderSize);
+  AcceptContributions(contributions, senderEpoch);
+  if (rows > 0 && start < msg.size()) {
+    std::vector<bool> stale;
+    m_keyMatrix.MergeRows(firstRow, msg.substr(start, rows * senderSize), senderSize,
+                          GetStaleColumns(senderEpoch, stale) ? &stale : NULL);
+  }
+  // 每条消息只转发一次；最后一个分片丢失时，已收到的分片仍已合并
+  if (index + 1 == chunks) {
+    ForwardToNeighbors();
+  } else if (m_keyMatrix.SelfIsFull1()) {
+    MarkCompleted();
+  }
+}
+
+uint64_t RegkaProtocol::GetMatrixBytes() const
+{
+  return m_keyMatrix.GetMemoryBytes() + m_senderMatrix.GetMemoryBytes();
+}
+
+uint64_t RegkaProtocol::GetNeighborBytes() const
+{
+  // 共用邻居表时计入正在使用的共用表，自己的邻居表此时为空
+  return GetNeighbors().capacity() * sizeof(uint32_t);
+}
+
+std::string RegkaProtocol::GetContributions(const std::string& message)
+{
+  std::string::size_type first = message.find(" ");
+  if (IsChunk(message)) {
+    // 跳过节点ID、分片序号与分片数
+    for (int i = 0; i < 3; i++) {
+      first = message.find(" ", first + 1);
+    }
+  }
+  return message.substr(first + 1, message.find(" ", first + 1) - first - 1);
+}
+
+bool RegkaProtocol::IsChunk(const std::string& message)
+{
+  return !message.empty() && message[0] == 'C';
+}
+
+bool RegkaProtocol::IsMembership(const std::string& message)
+{
+  return !message.empty() && (message[0] == 'J' || message[0] == 'L' || message[0] == 'M');
+}
+
+uint32_t RegkaProtocol::GetPaddingBytes(const std::string& contributions, uint32_t networkSize)
+{
+  int numContributions = 0;
+  if (contributions == std::string(networkSize, '1')) {
+    numContributions = 1;
+  } else {
+    numContributions = std::count(contributions.begin(), contributions.end(), '1');
+  }
+  numContributions = std::max(numContributions, 1);
+  return 8 * (160 + 64 * (std::ceil(log2(numContributions)) + 1));
+}
+
+uint32_t RegkaProtocol::Transmit(const std::string& content)
+{
+  m_sentCount++;
+  return GetMessagePaddingBytes(content, m_networkSize);
+}
+
+uint32_t RegkaProtocol::GetMessagePaddingBytes(const std::string& content, uint32_t networkSize)
+{
+  if (IsMembership(content)) {
+    // 成员变化消息不携带密钥材料
+    return 0;
+  }
+  if (IsChunk(content)) {
+    // 分片的填充字节数由分片头部给出
+    std::istringstream in(content);
+    std::string field;
+    for (int i = 0; i < 7; i++) {
+      in >> field;
+    }
+    uint32_t padding = 0;
+    in >> padding;
+    return padding;
+  }
+  return GetPaddingBytes(GetContributions(content), networkSize);
+}
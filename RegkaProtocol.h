@@ -0,0 +1,225 @@
+/*
+ * RegkaProtocol.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef REGKA_PROTOCOL_H
+#define REGKA_PROTOCOL_H
+
+#include "KeyMatrix.h"
+#include "CryptoBackend.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * 引用计数的只读消息体
+ *
+ * 一次转发发给多个邻居的消息、以及同一节点的多次周期广播使用同一个矩阵串，
+ * 排队中的发送与接收事件只持有引用，不各自复制N×N字节的内容。
+ */
+class SharedPayload
+{
+public:
+  SharedPayload() : m_body(NULL) {}
+  explicit SharedPayload(const std::string& content);
+  SharedPayload(const SharedPayload& other);
+  SharedPayload& operator=(const SharedPayload& other);
+  ~SharedPayload();
+
+  bool IsNull() const { return m_body == NULL; }
+  // 为空时返回空串
+  const std::string& Get() const;
+  uint32_t GetSize() const { return m_body != NULL ? m_body->content.size() : 0; }
+
+private:
+  struct Body
+  {
+    std::string content;
+    uint32_t references;
+  };
+  void Release();
+
+  Body* m_body;
+};
+
+/**
+ * 协议引擎所需的传输与定时服务，由ns-3应用或独立的微型仿真器实现
+ */
+class RegkaHost
+{
+public:
+  virtual ~RegkaHost() {}
+  // delay秒后把消息发出，destination为节点ID或RegkaProtocol::BROADCAST
+  virtual void Send(uint32_t destination, const std::string& content, double delay) = 0;
+  // 发出消息头header后接消息体body组成的消息。默认拼接后调用Send；
+  // 能直接保存引用的实现（微型仿真器）重写它，消息体在排队期间不被复制
+  virtual void SendShared(uint32_t destination, const std::string& header, const SharedPayload& body, double delay)
+  {
+    Send(destination, header + body.Get(), delay);
+  }
+  // delay秒后调用RegkaProtocol::OnTimer
+  virtual void ScheduleTimer(double delay) = 0;
+  // 当前仿真时刻 (s)
+  virtual double Now() const = 0;
+};
+
+/**
+ * 单个节点的RE-GKA协议逻辑，不依赖ns-3
+ *
+ * 由原AppSender::PeriodicBroadcast与AppReceiver::Receive中的逻辑提取而来，行为保持一致：
+ * 节点持有两个密钥矩阵，接收侧矩阵随收到的消息更新，发送侧矩阵只在初始化时设置，
+ * 周期广播携带的是发送侧矩阵；收到消息时接受贡献串中的所有序号。
+ * 消息格式为 "节点ID 贡献串 矩阵串"，发出时再按贡献数附加填充。
+ *
+ * 设置了消息长度上限时，每条消息拆成若干个自包含的分片，格式为
+ * "C 节点ID 分片序号 分片数 贡献串 起始行 行数 填充字节数 行串"，
+ * 矩阵行与原消息的填充字节分摊到各分片，每个分片（含填充）不超过上限。
+ * 每个分片都携带完整贡献串并可单独合并，收到最后一个分片时才向邻居转发，
+ * 丢失部分分片时其余分片仍然有效。发送数与接收数按分片计。
+ *
+ * 成员变化：槽位即节点ID，每个槽位有一个成员版本号，奇数为成员、偶数为非成员，
+ * 各节点按槽位取较大的版本号合并，与消息到达顺序无关。
+ * 新节点广播 "J 节点ID"，离开的节点广播 "L 节点ID"，收到的节点把该槽位版本号加1，
+ * 再广播 "M 版本号0 版本号1 ..."；视图有变化的节点继续广播M，并在之后两次周期广播时重复。
+ * 加入时只清空新成员的贡献列与行，离开时编号最小的成员（发起者）更新自己的贡献，
+ * 其余贡献保持有效，协议只需传播变化的贡献；离开的成员保留槽位（墓碑）。
+ * 贡献版本号为各槽位离开次数之和，不为0时消息中的节点ID写成 "节点ID:版本号"。
+ * 更新过的贡献只接受版本号不低于更新时版本号的发送方在贡献串中标为1的位，
+ * 合并较旧发送方的矩阵时跳过这些列，旧消息不会把更新前的贡献重新标记为已拥有。
+ * 不同节点的矩阵大小可以不同，按贡献串长度识别发送方的大小，较大时扩大本地矩阵。
+ *
+ * 启用了GroupKeyComputation时，启动时生成自己的贡献，每次收到新贡献时处理这些贡献，
+ * 收齐时求组密钥；计算占用的CPU时间加到之后的发送时延上。
+ */
+class RegkaProtocol
+{
+public:
+  static const uint32_t BROADCAST;     ///< 广播目的地
+  static const double SEND_DELAY;      ///< 从决定发送到真正发出的处理时延 (s)
+  static const double START_DELAY;     ///< 启动后首次发送前的等待 (s)
+  static const double PERIODIC_START;  ///< 启动后开始周期广播的时刻 (s)
+
+  RegkaProtocol();
+
+  // 消息（含填充）的长度上限 (字节)，超过时拆成分片，0为不拆分；所有节点共用
+  static void SetMaxMessageBytes(uint32_t bytes) { s_maxMessageBytes = bytes; }
+  static uint32_t GetMaxMessageBytes() { return s_maxMessageBytes; }
+
+  // 初始化密钥矩阵
+  void Initialize(uint32_t networkSize, uint32_t nodeId);
+  void SetHost(RegkaHost* host) { m_host = host; }
+  void SetPeriodicInterval(double interval) { m_periodicInterval = interval; }
+  double GetPeriodicInterval() const { return m_periodicInterval; }
+
+  // 节点启动：广播自己的贡献，并安排周期广播
+  void Start();
+  // 设置初始成员视图（版本号回到初始值），超出矩阵大小时扩大
+  void SetMember(uint32_t slot, bool active);
+  // 中途加入：广播加入消息直到收到包含自己的成员视图，并按Start启动
+  void Join();
+  // 离开：广播离开消息，之后由调用者停止本节点
+  void Leave();
+  // 完整重新协商：保留成员视图与计数，清空密钥矩阵并重新广播自己的贡献
+  void ResetAgreement();
+  // true时成员变化不做增量处理：J/L/M消息照常传播，视图有变化的节点ResetAgreement，
+  // 贡献版本号为所有槽位的成员版本号之和，丢弃版本号较低（变化前）的消息；默认false
+  void SetFullRekey(bool full) { m_fullRekey = full; }
+  bool IsMember(uint32_t slot) const { return m_keyMatrix.IsActive(slot); }
+  uint32_t GetIncarnation(uint32_t slot) const { return slot < m_incarnations.size() ? m_incarnations[slot] : 0; }
+  // 贡献版本号：已知的离开次数之和，没有成员变化时为0
+  uint32_t GetEpoch() const;
+  // 周期广播定时器到期
+  void OnTimer();
+  // 收到from发来的消息（不含填充也可以）
+  void OnReceive(uint32_t from, const std::string& message);
+  // 消息真正发出时调用，计入发送数，返回需要附加的填充字节数
+  uint32_t Transmit(const std::string& content);
+
+  // 消息发出时需要附加的填充字节数，与Transmit的返回值相同但不计数
+  static uint32_t GetMessagePaddingBytes(const std::string& content, uint32_t networkSize);
+  // 按贡献串中1的个数计算填充字节数
+  static uint32_t GetPaddingBytes(const std::string& contributions, uint32_t networkSize);
+  // 从消息中取出贡献串
+  static std::string GetContributions(const std::string& message);
+  // 是否为分片消息
+  static bool IsChunk(const std::string& message);
+  // 是否为成员变化消息（J/L/M）
+  static bool IsMembership(const std::string& message);
+
+  uint32_t GetNodeId() const { return m_nodeId; }
+  uint32_t GetNetworkSize() const { return m_networkSize; }
+  uint32_t GetSentCount() const { return m_sentCount; }
+  uint32_t GetReceivedCount() const { return m_receivedCount; }
+  // 自己是否收齐所有密钥贡献
+  bool IsCompleted() const { return m_isCompleted; }
+  // 得到组密钥的时刻（含计算时间），未启用计算或尚未得到时为-1
+  double GetKeyReadyTime() const { return m_computation.GetKeyReadyTime(); }
+  const GroupKeyComputation& GetComputation() const { return m_computation; }
+  // 接收侧矩阵
+  const KeyMatrix& GetKeyMatrix() const { return m_keyMatrix; }
+  // 最近通信的邻居，最多保留N/2个
+  const std::vector<uint32_t>& GetNeighbors() const { return m_sharedNeighbors != NULL ? *m_sharedNeighbors : m_neighbors; }
+  // 与同一节点上的其他会话共用邻居表，NULL为使用自己的邻居表；转发时跳过不属于本会话的邻居
+  void SetNeighborTable(std::vector<uint32_t>* neighbors) { m_sharedNeighbors = neighbors; }
+  // 两个密钥矩阵与邻居表占用的堆内存字节数，共用邻居表时为共用表（同一节点的各会话都计入同一张表）
+  uint64_t GetMatrixBytes() const;
+  uint64_t GetNeighborBytes() const;
+
+private:
+  void UpdateNeighborList(uint32_t neighbor);
+  std::vector<uint32_t>& Neighbors() { return m_sharedNeighbors != NULL ? *m_sharedNeighbors : m_neighbors; }
+  // 消息中的节点ID，贡献版本号不为0时为 "节点ID:版本号"
+  std::string GetSenderToken() const;
+  // 消息头 "节点ID 贡献串 "，后接矩阵串即完整消息
+  std::string BuildHeader(const std::string& contributions) const;
+  // 构造消息并发出，需要时拆成分片；body为matrix的矩阵串，为空时在第一次需要时生成，
+  // 之后同一批发送共用
+  void SendMessage(uint32_t destination, const std::string& contributions, const KeyMatrix& matrix,
+                   SharedPayload& body, double delay);
+  // 发送侧矩阵的矩阵串，发送侧矩阵变化后重新生成
+  SharedPayload& SenderBody();
+  // 与原实现一致：贡献串中的每一位都被接受；更新过的贡献只接受senderEpoch足够新且为1的位
+  void AcceptContributions(const std::string& contributions, uint32_t senderEpoch);
+  // 发送方的版本号低于更新时版本号的列，合并矩阵时跳过；没有这样的列时返回false
+  bool GetStaleColumns(uint32_t senderEpoch, std::vector<bool>& stale) const;
+  // 收齐贡献，启用计算时求组密钥
+  void MarkCompleted();
+  // 计算尚未结束时发送还要等待的时间 (s)
+  double ComputeDelay() const;
+  // 收到一条完整消息或最后一个分片后，向每个邻居转发它可能缺少的贡献
+  void ForwardToNeighbors();
+  void OnReceiveChunk(const std::string& message);
+  void OnReceiveMembership(uint32_t from, const std::string& message);
+  // 扩大到networkSize个槽位
+  void Grow(uint32_t networkSize);
+  // 按合并规则采用slot的版本号，成员状态变化时更新矩阵，返回是否有变化
+  bool ApplyIncarnation(uint32_t slot, uint32_t incarnation);
+  void BroadcastMembership();
+
+  RegkaHost* m_host;
+  uint32_t m_nodeId;
+  uint32_t m_networkSize;
+  double m_periodicInterval;
+  KeyMatrix m_keyMatrix;       ///< 接收侧矩阵
+  KeyMatrix m_senderMatrix;    ///< 发送侧矩阵
+  SharedPayload m_senderBody;  ///< 发送侧矩阵的矩阵串，周期广播共用，为空表示需要重新生成
+  std::vector<uint32_t> m_neighbors;
+  uint32_t m_sentCount;
+  uint32_t m_receivedCount;
+  bool m_isCompleted;
+  std::vector<uint32_t> m_incarnations;  ///< 每个槽位的成员版本号
+  std::vector<uint32_t> m_refreshEpochs; ///< 每个槽位的贡献最近一次更新时的版本号，0为未更新
+  bool m_joining;                        ///< 尚未收到包含自己的成员视图
+  uint32_t m_membershipRepeats;          ///< 之后的周期广播中还要重复M消息的次数
+  bool m_fullRekey;                      ///< 成员变化时完整重新协商
+  bool m_viewChanged;                    ///< 完整重新协商时本条成员消息改变了成员视图
+  std::vector<uint32_t>* m_sharedNeighbors; ///< 多会话时共用的邻居表，不属于本对象
+  GroupKeyComputation m_computation;     ///< 未启用时不使用
+
+  static uint32_t s_maxMessageBytes;
+};
+
+#endif /* REGKA_PROTOCOL_H */
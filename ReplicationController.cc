@@ -0,0 +1,275 @@
+/*
+ * ReplicationController.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ReplicationController.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+RunningStat::RunningStat()
+  : m_count(0), m_mean(0), m_m2(0),
+    m_min(std::numeric_limits<double>::max()),
+    m_max(-std::numeric_limits<double>::max())
+{
+}
+
+void RunningStat::Add(double x)
+{
+  m_count++;
+  double delta = x - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (x - m_mean);
+  m_min = std::min(m_min, x);
+  m_max = std::max(m_max, x);
+}
+
+double RunningStat::GetVariance() const
+{
+  return (m_count > 1) ? m_m2 / (m_count - 1) : 0;
+}
+
+double RunningStat::GetStdDev() const
+{
+  return std::sqrt(GetVariance());
+}
+
+double RunningStat::GetHalfWidth(double confidence) const
+{
+  if (m_count < 2) {
+    return std::numeric_limits<double>::infinity();
+  }
+  double t = StudentTQuantile(0.5 + confidence / 2, m_count - 1);
+  return t * GetStdDev() / std::sqrt(static_cast<double>(m_count));
+}
+
+// Acklam的有理函数近似，相对误差约1e-9
+double NormalQuantile(double p)
+{
+  static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                              1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+  static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                              6.680131188771972e+01, -1.328068155288572e+01 };
+  static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                              -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+  static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                              3.754408661907416e+00 };
+  const double low = 0.02425;
+
+  if (p <= 0) {
+    return -std::numeric_limits<double>::infinity();
+  }
+  if (p >= 1) {
+    return std::numeric_limits<double>::infinity();
+  }
+  if (p < low) {
+    double q = std::sqrt(-2 * std::log(p));
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+  if (p > 1 - low) {
+    double q = std::sqrt(-2 * std::log(1 - p));
+    return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  }
+  double q = p - 0.5;
+  double r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+         (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// 自由度1、2使用闭式解，其余使用Cornish-Fisher展开
+double StudentTQuantile(double p, uint32_t dof)
+{
+  if (dof == 0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  if (dof == 1) {
+    return std::tan(M_PI * (p - 0.5));
+  }
+  if (dof == 2) {
+    return (2 * p - 1) / std::sqrt(2 * p * (1 - p));
+  }
+  double z = NormalQuantile(p);
+  double n = dof;
+  double z2 = z * z;
+  double z3 = z2 * z;
+  double z5 = z3 * z2;
+  double z7 = z5 * z2;
+  double z9 = z7 * z2;
+  return z
+         + (z3 + z) / (4 * n)
+         + (5 * z5 + 16 * z3 + 3 * z) / (96 * n * n)
+         + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * n * n * n)
+         + (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) / (92160 * n * n * n * n);
+}
+
+std::string ReplicationSummary::CsvHeader(const std::vector<std::string>& metrics)
+{
+  std::ostringstream ss;
+  ss << "areaLength,areaWidth,areaHeight,numNodes,linkQuality,firstRun,runs,completed,converged";
+  for (uint32_t k = 0; k < metrics.size(); k++) {
+    ss << "," << metrics[k] << "Mean," << metrics[k] << "StdDev," << metrics[k] << "HalfWidth";
+  }
+  ss << ",fault,failed";
+  return ss.str();
+}
+
+std::string ReplicationSummary::ToCsv() const
+{
+  std::ostringstream ss;
+  ss << std::setprecision(10)
+     << point.areaLength << "," << point.areaWidth << "," << point.areaHeight << ","
+     << point.numNodes << "," << point.linkQuality << "," << point.run << ","
+     << runs << "," << completed << "," << (converged ? 1 : 0);
+  for (uint32_t k = 0; k < stats.size(); k++) {
+    if (stats[k].GetCount() == 0) {
+      // 没有样本（如没有完成的运行时的delay）时各列为空
+      ss << ",,,";
+      continue;
+    }
+    ss << "," << stats[k].GetMean() << "," << stats[k].GetStdDev() << "," << halfWidths[k];
+  }
+  ss << "," << (point.fault.empty() ? "none" : point.fault) << "," << failed;
+  return ss.str();
+}
+
+ReplicationController::ReplicationController(ReplicationBatchRunner runner, void* context)
+  : m_runner(runner),
+    m_context(context),
+    m_confidence(0.95),
+    m_relativePrecision(0.05),
+    m_absolutePrecision(0),
+    m_minRuns(5),
+    m_maxRuns(200),
+    m_batchSize(1)
+{
+  SetMetrics("delay,success,overhead");
+}
+
+bool ReplicationController::SetMetrics(const std::string& metrics)
+{
+  std::vector<std::string> names;
+  std::istringstream ss(metrics);
+  std::string name;
+  SimulationResult probe;
+  double value;
+  while (std::getline(ss, name, ',')) {
+    if (name.empty()) {
+      continue;
+    }
+    if (!GetMetric(probe, name, value)) {
+      std::cerr << "未知的统计指标: " << name << std::endl;
+      return false;
+    }
+    names.push_back(name);
+  }
+  if (names.empty()) {
+    return false;
+  }
+  m_metrics = names;
+  return true;
+}
+
+bool ReplicationController::GetMetric(const SimulationResult& result, const std::string& metric, double& value)
+{
+  if (metric == "delay") {
+    value = result.completionTime;
+  } else if (metric == "success") {
+    value = result.successRate;
+  } else if (metric == "overhead") {
+    value = result.totalSent;
+  } else if (metric == "ratio") {
+    value = result.overheadRatio;
+  } else if (metric == "contribution") {
+    value = result.contributionRate;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ReplicationController::HasSample(const SimulationResult& result, const std::string& metric)
+{
+  return metric != "delay" || result.outcome == "completed";
+}
+
+bool ReplicationController::IsConverged(const ReplicationSummary& summary) const
+{
+  for (uint32_t k = 0; k < summary.stats.size(); k++) {
+    if (summary.stats[k].GetCount() == 0) {
+      continue;
+    }
+    double target = std::max(m_absolutePrecision, m_relativePrecision * std::fabs(summary.stats[k].GetMean()));
+    if (!(summary.halfWidths[k] <= target)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ReplicationSummary ReplicationController::Run(const ScenarioConfig& point, std::vector<SimulationResult>& results)
+{
+  ReplicationSummary summary;
+  summary.point = point;
+  summary.runs = 0;
+  summary.completed = 0;
+  summary.failed = 0;
+  summary.converged = false;
+  summary.metrics = m_metrics;
+  summary.stats.assign(m_metrics.size(), RunningStat());
+  summary.halfWidths.assign(m_metrics.size(), std::numeric_limits<double>::infinity());
+
+  uint32_t minRuns = std::max<uint32_t>(m_minRuns, 2);
+  // 失败的运行不计入样本，种子按已下发的次数递增；失败次数达到maxRuns时放弃该参数点
+  while (summary.runs < m_maxRuns && summary.failed < m_maxRuns) {
+    // 首批至少运行minRuns次，之后每批运行m_batchSize次
+    uint32_t count = (summary.runs < minRuns) ? minRuns - summary.runs : std::max<uint32_t>(m_batchSize, 1);
+    count = std::min(count, m_maxRuns - summary.runs);
+
+    std::vector<ScenarioConfig> batch;
+    for (uint32_t k = 0; k < count; k++) {
+      ScenarioConfig s = point;
+      s.run = point.run + summary.runs + summary.failed + k;
+      batch.push_back(s);
+    }
+    std::vector<SimulationResult> batchResults;
+    m_runner(batch, batchResults, m_context);
+
+    for (uint32_t r = 0; r < batchResults.size(); r++) {
+      if (batchResults[r].outcome == "completed") {
+        summary.completed++;
+      }
+      for (uint32_t k = 0; k < m_metrics.size(); k++) {
+        double value = 0;
+        if (HasSample(batchResults[r], m_metrics[k]) && GetMetric(batchResults[r], m_metrics[k], value)) {
+          summary.stats[k].Add(value);
+        }
+      }
+      results.push_back(batchResults[r]);
+    }
+    summary.runs += batchResults.size();
+    if (batchResults.size() < count) {
+      summary.failed += count - batchResults.size();
+      if (summary.failed >= m_maxRuns) {
+        std::cerr << "参数点" << point.Label() << "失败" << summary.failed << "次，放弃" << std::endl;
+        break;
+      }
+    }
+
+    for (uint32_t k = 0; k < m_metrics.size(); k++) {
+      summary.halfWidths[k] = summary.stats[k].GetHalfWidth(m_confidence);
+    }
+    if (summary.runs >= minRuns && IsConverged(summary)) {
+      summary.converged = true;
+      break;
+    }
+  }
+  return summary;
+}
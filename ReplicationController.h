@@ -0,0 +1,113 @@
+/*
+ * ReplicationController.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef REPLICATION_CONTROLLER_H
+#define REPLICATION_CONTROLLER_H
+
+#include "Scenario.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 在线统计均值与方差（Welford算法）
+class RunningStat
+{
+public:
+  RunningStat();
+
+  void Add(double x);
+  uint32_t GetCount() const { return m_count; }
+  double GetMean() const { return m_mean; }
+  // 样本方差（n-1）
+  double GetVariance() const;
+  double GetStdDev() const;
+  double GetMin() const { return m_min; }
+  double GetMax() const { return m_max; }
+  // 均值的置信区间半宽
+  double GetHalfWidth(double confidence) const;
+
+private:
+  uint32_t m_count;
+  double m_mean;
+  double m_m2;
+  double m_min;
+  double m_max;
+};
+
+// 标准正态分布的分位数
+double NormalQuantile(double p);
+// 自由度为dof的t分布的分位数
+double StudentTQuantile(double p, uint32_t dof);
+
+// 一次下发一批场景并取回结果，场景可以串行或并行运行
+typedef void (*ReplicationBatchRunner)(const std::vector<ScenarioConfig>& scenarios,
+                                       std::vector<SimulationResult>& results, void* context);
+
+// 一个参数点的重复实验汇总
+struct ReplicationSummary
+{
+  ScenarioConfig point;               ///< 参数点（run为起始种子）
+  uint32_t runs;                      ///< 成功的运行次数，即统计的样本数（delay只计completed）
+  uint32_t completed;                 ///< outcome为completed的次数，即delay的样本数
+  uint32_t failed;                    ///< 失败（未返回结果）的运行次数
+  bool converged;                     ///< 是否所有指标都达到精度要求
+  std::vector<std::string> metrics;   ///< 指标名
+  std::vector<RunningStat> stats;     ///< 各指标的在线统计
+  std::vector<double> halfWidths;     ///< 各指标达到的置信区间半宽
+
+  static std::string CsvHeader(const std::vector<std::string>& metrics);
+  std::string ToCsv() const;
+};
+
+/**
+ * 序贯停止的重复实验控制器
+ *
+ * 对一个参数点不断使用新的RngRun运行独立重复实验，直到所有指标均值的置信区间半宽
+ * 都不超过 max(绝对精度, 相对精度*|均值|)，或者达到最大运行次数。
+ * 支持的指标: delay（协商时延）、success（成功率）、overhead（发送数据包总数）、
+ * ratio（收发比）、contribution（贡献比例）。停滞与超时的运行没有完成时延（记为0），
+ * delay只取completed的运行；一个样本都没有的指标不影响停止判断。
+ */
+class ReplicationController
+{
+public:
+  ReplicationController(ReplicationBatchRunner runner, void* context);
+
+  void SetConfidence(double confidence) { m_confidence = confidence; }
+  void SetRelativePrecision(double precision) { m_relativePrecision = precision; }
+  void SetAbsolutePrecision(double precision) { m_absolutePrecision = precision; }
+  void SetMinRuns(uint32_t runs) { m_minRuns = runs; }
+  void SetMaxRuns(uint32_t runs) { m_maxRuns = runs; }
+  // 每批下发的重复次数，并行运行时取工作进程数
+  void SetBatchSize(uint32_t size) { m_batchSize = size; }
+  // 逗号分隔的指标列表
+  bool SetMetrics(const std::string& metrics);
+  const std::vector<std::string>& GetMetrics() const { return m_metrics; }
+
+  // 对参数点运行重复实验，每个结果追加到results
+  ReplicationSummary Run(const ScenarioConfig& point, std::vector<SimulationResult>& results);
+
+  // 从结果中取出指标值
+  static bool GetMetric(const SimulationResult& result, const std::string& metric, double& value);
+  // 该结果是否计入指标的样本：delay只计completed的运行，其他指标计入所有运行
+  static bool HasSample(const SimulationResult& result, const std::string& metric);
+
+private:
+  bool IsConverged(const ReplicationSummary& summary) const;
+
+  ReplicationBatchRunner m_runner;
+  void* m_context;
+  double m_confidence;
+  double m_relativePrecision;
+  double m_absolutePrecision;
+  uint32_t m_minRuns;
+  uint32_t m_maxRuns;
+  uint32_t m_batchSize;
+  std::vector<std::string> m_metrics;
+};
+
+#endif /* REPLICATION_CONTROLLER_H */
@@ -0,0 +1,240 @@
+/*
+ * ResultAggregator.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ResultAggregator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <unistd.h>
+
+// 汇总中输出的分位数
+static const double QUANTILES[] = { 0.5, 0.9, 0.99 };
+static const char* QUANTILE_NAMES[] = { "P50", "P90", "P99" };
+static const uint32_t NUM_QUANTILES = 3;
+
+TDigest::TDigest(double compression)
+  : m_compression(compression),
+    m_count(0),
+    m_min(std::numeric_limits<double>::max()),
+    m_max(-std::numeric_limits<double>::max())
+{
+}
+
+void TDigest::Add(double x)
+{
+  Centroid c;
+  c.mean = x;
+  c.weight = 1;
+  m_buffer.push_back(c);
+  m_count++;
+  m_min = std::min(m_min, x);
+  m_max = std::max(m_max, x);
+  if (m_buffer.size() >= 5 * m_compression) {
+    Compress();
+  }
+}
+
+void TDigest::Compress() const
+{
+  if (m_buffer.empty()) {
+    return;
+  }
+  std::vector<Centroid> all(m_centroids);
+  all.insert(all.end(), m_buffer.begin(), m_buffer.end());
+  m_buffer.clear();
+  std::sort(all.begin(), all.end());
+
+  double total = static_cast<double>(m_count);
+  m_centroids.clear();
+  Centroid current = all[0];
+  double before = 0;  // current之前所有质心的权重
+  for (uint32_t k = 1; k < all.size(); k++) {
+    double merged = current.weight + all[k].weight;
+    double q0 = before / total;
+    double q2 = (before + merged) / total;
+    double limit = total * std::min(4 * q0 * (1 - q0), 4 * q2 * (1 - q2)) / m_compression;
+    if (merged <= limit) {
+      current.mean += (all[k].mean - current.mean) * all[k].weight / merged;
+      current.weight = merged;
+    } else {
+      before += current.weight;
+      m_centroids.push_back(current);
+      current = all[k];
+    }
+  }
+  m_centroids.push_back(current);
+}
+
+uint32_t TDigest::GetCentroidCount() const
+{
+  Compress();
+  return m_centroids.size();
+}
+
+double TDigest::Quantile(double q) const
+{
+  if (m_count == 0) {
+    return 0;
+  }
+  Compress();
+  q = std::min(std::max(q, 0.0), 1.0);
+  double target = q * m_count;
+  // 每个质心的样本视为以其均值为中心均匀分布
+  const Centroid& first = m_centroids.front();
+  if (target <= first.weight / 2) {
+    if (first.weight <= 1) {
+      return first.mean;
+    }
+    return m_min + (first.mean - m_min) * target / (first.weight / 2);
+  }
+  double cumulative = 0;
+  for (uint32_t k = 0; k + 1 < m_centroids.size(); k++) {
+    const Centroid& a = m_centroids[k];
+    const Centroid& b = m_centroids[k + 1];
+    double left = cumulative + a.weight / 2;
+    double right = cumulative + a.weight + b.weight / 2;
+    if (target <= right) {
+      return a.mean + (b.mean - a.mean) * (target - left) / (right - left);
+    }
+    cumulative += a.weight;
+  }
+  const Centroid& last = m_centroids.back();
+  if (last.weight <= 1) {
+    return last.mean;
+  }
+  double left = m_count - last.weight / 2;
+  return last.mean + (m_max - last.mean) * std::min((target - left) / (last.weight / 2), 1.0);
+}
+
+// -------------------------------------------------------------------
+
+ResultAggregator::ResultAggregator()
+  : m_flushEvery(20),
+    m_pending(0)
+{
+  SetMetrics("delay,success,overhead,ratio");
+}
+
+bool ResultAggregator::SetMetrics(const std::string& metrics)
+{
+  std::vector<std::string> names;
+  std::istringstream ss(metrics);
+  std::string name;
+  SimulationResult probe;
+  double value;
+  while (std::getline(ss, name, ',')) {
+    if (name.empty()) {
+      continue;
+    }
+    if (!ReplicationController::GetMetric(probe, name, value)) {
+      std::cerr << "未知的统计指标: " << name << std::endl;
+      return false;
+    }
+    names.push_back(name);
+  }
+  if (names.empty()) {
+    return false;
+  }
+  m_metrics = names;
+  return true;
+}
+
+void ResultAggregator::Add(const SimulationResult& result)
+{
+  ScenarioConfig scenario = result.scenario;
+  scenario.run = 0;
+  // 不同方案的结果属于不同的参数点
+  std::string key = scenario.Label() + "_" + scenario.strategy;
+  std::map<std::string, Point>::iterator it = m_points.find(key);
+  if (it == m_points.end()) {
+    Point point;
+    point.scenario = result.scenario;
+    point.runs = 0;
+    point.completed = 0;
+    point.stats.resize(m_metrics.size());
+    point.digests.resize(m_metrics.size());
+    it = m_points.insert(std::make_pair(key, point)).first;
+  }
+  Point& point = it->second;
+  point.runs++;
+  if (result.outcome == "completed") {
+    point.completed++;
+  }
+  // 停滞与超时的运行没有完成时延，delay只取completed的运行
+  for (uint32_t k = 0; k < m_metrics.size(); k++) {
+    double value = 0;
+    if (!ReplicationController::HasSample(result, m_metrics[k])) {
+      continue;
+    }
+    ReplicationController::GetMetric(result, m_metrics[k], value);
+    point.stats[k].Add(value);
+    point.digests[k].Add(value);
+  }
+  m_pending++;
+  if (!m_path.empty() && m_pending >= m_flushEvery) {
+    Write();
+  }
+}
+
+std::string ResultAggregator::CsvHeader(const std::vector<std::string>& metrics)
+{
+  std::ostringstream ss;
+  ss << "areaLength,areaWidth,areaHeight,numNodes,linkQuality,fault,strategy,firstRun,runs,completed";
+  for (uint32_t k = 0; k < metrics.size(); k++) {
+    ss << "," << metrics[k] << "Mean," << metrics[k] << "StdDev," << metrics[k] << "Min," << metrics[k] << "Max";
+    for (uint32_t q = 0; q < NUM_QUANTILES; q++) {
+      ss << "," << metrics[k] << QUANTILE_NAMES[q];
+    }
+  }
+  return ss.str();
+}
+
+bool ResultAggregator::Write()
+{
+  m_pending = 0;
+  std::ostringstream tmp;
+  tmp << m_path << ".tmp" << getpid();
+  std::ofstream out(tmp.str().c_str());
+  if (!out.is_open()) {
+    std::cerr << "无法写入汇总文件: " << tmp.str() << std::endl;
+    return false;
+  }
+  out << CsvHeader(m_metrics) << "\n" << std::setprecision(10);
+  for (std::map<std::string, Point>::const_iterator it = m_points.begin(); it != m_points.end(); ++it) {
+    const Point& point = it->second;
+    const ScenarioConfig& s = point.scenario;
+    out << s.areaLength << "," << s.areaWidth << "," << s.areaHeight << "," << s.numNodes << ","
+        << s.linkQuality << "," << (s.fault.empty() ? "none" : s.fault) << "," << s.strategy << ","
+        << s.run << "," << point.runs << "," << point.completed;
+    for (uint32_t k = 0; k < m_metrics.size(); k++) {
+      const RunningStat& stat = point.stats[k];
+      if (stat.GetCount() == 0) {
+        // 没有样本时各列为空
+        out << std::string(4 + NUM_QUANTILES, ',');
+        continue;
+      }
+      out << "," << stat.GetMean() << "," << stat.GetStdDev() << "," << stat.GetMin() << "," << stat.GetMax();
+      for (uint32_t q = 0; q < NUM_QUANTILES; q++) {
+        out << "," << point.digests[k].Quantile(QUANTILES[q]);
+      }
+    }
+    out << "\n";
+  }
+  out.close();
+  if (std::rename(tmp.str().c_str(), m_path.c_str()) != 0) {
+    std::cerr << "无法写入汇总文件: " << m_path << " 错误: " << strerror(errno) << std::endl;
+    std::remove(tmp.str().c_str());
+    return false;
+  }
+  return true;
+}
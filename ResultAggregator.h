@@ -0,0 +1,99 @@
+/*
+ * ResultAggregator.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef RESULT_AGGREGATOR_H
+#define RESULT_AGGREGATOR_H
+
+#include "Scenario.h"
+#include "ReplicationController.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * 近似分位数（合并式t-digest）
+ *
+ * 样本先放入缓冲区，缓冲区满时与已有质心一起按均值排序，相邻质心在权重不超过
+ * 4*总数*q*(1-q)/compression 时合并，两端的质心因此很小，尾部分位数更准确。
+ * 质心数约为compression的量级，与样本数无关。分位数在相邻质心中心之间线性插值，
+ * 两端插值到最小值与最大值。
+ */
+class TDigest
+{
+public:
+  explicit TDigest(double compression = 100);
+
+  void Add(double x);
+  // q在[0,1]之间，没有样本时为0
+  double Quantile(double q) const;
+  uint64_t GetCount() const { return m_count; }
+  // 压缩后的质心数
+  uint32_t GetCentroidCount() const;
+
+private:
+  struct Centroid
+  {
+    double mean;
+    double weight;
+    bool operator<(const Centroid& other) const { return mean < other.mean; }
+  };
+
+  // 把缓冲区并入质心
+  void Compress() const;
+
+  double m_compression;
+  uint64_t m_count;
+  double m_min;
+  double m_max;
+  mutable std::vector<Centroid> m_centroids;  ///< 按均值排序
+  mutable std::vector<Centroid> m_buffer;
+};
+
+/**
+ * 跨重复实验的流式汇总
+ *
+ * 结果按参数点（忽略run的场景加协商方案）分组，每个指标用RunningStat保存均值、方差、最小与最大值，
+ * 用TDigest保存近似分位数；delay只取completed的运行，completed列即其样本数。内存只与参数点数有关，与运行次数无关。
+ * 每收到flushEvery个结果把汇总整体重写一次（先写临时文件再rename），运行中随时可读，
+ * 不必再在仿真结束后逐个解析结果文件。
+ */
+class ResultAggregator
+{
+public:
+  ResultAggregator();
+
+  // 逗号分隔的指标列表，名称同ReplicationController
+  bool SetMetrics(const std::string& metrics);
+  void SetFlushEvery(uint32_t results) { m_flushEvery = results; }
+  void SetOutput(const std::string& path) { m_path = path; }
+
+  void Add(const SimulationResult& result);
+  // 写出汇总，结束时调用
+  bool Write();
+
+  static std::string CsvHeader(const std::vector<std::string>& metrics);
+  uint32_t GetPointCount() const { return m_points.size(); }
+
+private:
+  struct Point
+  {
+    ScenarioConfig scenario;              ///< run为该参数点收到的第一个run
+    uint32_t runs;
+    uint32_t completed;                   ///< outcome为completed的次数
+    std::vector<RunningStat> stats;
+    std::vector<TDigest> digests;
+  };
+
+  std::string m_path;
+  std::vector<std::string> m_metrics;
+  uint32_t m_flushEvery;
+  uint32_t m_pending;                     ///< 上次写出后收到的结果数
+  std::map<std::string, Point> m_points;  ///< 以忽略run的场景标签加方案为键
+};
+
+#endif /* RESULT_AGGREGATOR_H */
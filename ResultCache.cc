@@ -0,0 +1,123 @@
+/*
+ * ResultCache.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ResultCache.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+ResultCache::ResultCache(const std::string& dir, const std::string& version)
+  : m_dir(dir), m_version(version), m_forceRefresh(false)
+{
+  struct stat st;
+  if (stat(m_dir.c_str(), &st) != 0) {
+    if (mkdir(m_dir.c_str(), 0777) != 0 && errno != EEXIST) {
+      std::cerr << "无法创建结果缓存目录: " << m_dir << " 错误: " << strerror(errno) << std::endl;
+    }
+  }
+}
+
+// 64位FNV-1a
+uint64_t ResultCache::Hash(const std::string& data)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (std::string::size_type i = 0; i < data.size(); i++) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string ResultCache::MakeKey(const ScenarioConfig& scenario) const
+{
+  std::ostringstream ss;
+  ss << std::setprecision(10)
+     << "version=" << m_version
+     << ";" << m_parameters
+     << ";area=" << scenario.AreaString()
+     << ";nodes=" << scenario.numNodes
+     << ";quality=" << scenario.linkQuality
+     << ";run=" << scenario.run;
+  // 没有故障时不写入，保持已有缓存键不变
+  if (!scenario.fault.empty()) {
+    ss << ";fault=" << scenario.fault;
+  }
+  return ss.str();
+}
+
+std::string ResultCache::GetPath(const ScenarioConfig& scenario, std::string& hash) const
+{
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << Hash(MakeKey(scenario));
+  hash = hex.str();
+  return m_dir + "/" + hash + ".csv";
+}
+
+bool ResultCache::Lookup(const ScenarioConfig& scenario, SimulationResult& result) const
+{
+  if (m_forceRefresh) {
+    return false;
+  }
+  std::string hash;
+  std::ifstream in(GetPath(scenario, hash).c_str());
+  if (!in.is_open()) {
+    return false;
+  }
+  std::string key;
+  std::string line;
+  if (!std::getline(in, key) || key != MakeKey(scenario) || !std::getline(in, line)) {
+    return false;
+  }
+  // 去掉时间戳和行尾的哈希
+  std::string::size_type first = line.find(',');
+  std::string::size_type last = line.rfind(',');
+  if (first == std::string::npos || last <= first || line.substr(last + 1) != hash) {
+    return false;
+  }
+  if (!result.FromCsv(line.substr(first + 1, last - first - 1))) {
+    return false;
+  }
+  // 方案不在ScenarioConfig的查找参数中，取文件里的值（已由键行中的全局参数确认）
+  std::string strategy = result.scenario.strategy;
+  result.scenario = scenario;
+  result.scenario.strategy = strategy;
+  return true;
+}
+
+bool ResultCache::Store(const SimulationResult& result) const
+{
+  std::string hash;
+  std::string path = GetPath(result.scenario, hash);
+  std::ostringstream tmp;
+  tmp << path << ".tmp" << getpid();
+
+  std::ofstream out(tmp.str().c_str());
+  if (!out.is_open()) {
+    std::cerr << "无法写入结果缓存: " << tmp.str() << std::endl;
+    return false;
+  }
+  std::time_t now = std::time(NULL);
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+  out << MakeKey(result.scenario) << "\n"
+      << buf << "," << result.ToCsv() << "," << hash << std::endl;
+  out.close();
+
+  if (std::rename(tmp.str().c_str(), path.c_str()) != 0) {
+    std::cerr << "无法写入结果缓存: " << path << " 错误: " << strerror(errno) << std::endl;
+    std::remove(tmp.str().c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * ResultCache.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "Scenario.h"
+#include <string>
+#include <stdint.h>
+
+/**
+ * 按内容寻址的仿真结果缓存
+ *
+ * 键为 协议版本 + 全局仿真参数 + 场景参数 拼接成的规范字符串，文件名为其64位FNV-1a哈希。
+ * 每个文件两行：第一行是完整的键，第二行是 时间戳,SimulationResult::ToCsv的各列,哈希。
+ * 查找时第一行必须与键完全一致，哈希冲突与旧格式（没有键行）的文件都按未命中处理，
+ * 缓存目录也可以直接按键审查。写入时先写临时文件再rename，多个工作进程并发写入也不会读到半行。
+ */
+class ResultCache
+{
+public:
+  ResultCache(const std::string& dir, const std::string& version);
+
+  // 不属于ScenarioConfig但影响结果的全局参数（仿真时长、移动模型、协议选项等）
+  void SetParameters(const std::string& parameters) { m_parameters = parameters; }
+  // 强制刷新：忽略已有结果，重新仿真后覆盖
+  void SetForceRefresh(bool force) { m_forceRefresh = force; }
+
+  // 规范键字符串
+  std::string MakeKey(const ScenarioConfig& scenario) const;
+  // 查找已完成的场景
+  bool Lookup(const ScenarioConfig& scenario, SimulationResult& result) const;
+  // 保存场景结果
+  bool Store(const SimulationResult& result) const;
+
+  static uint64_t Hash(const std::string& data);
+
+private:
+  std::string GetPath(const ScenarioConfig& scenario, std::string& hash) const;
+
+  std::string m_dir;
+  std::string m_version;
+  std::string m_parameters;
+  bool m_forceRefresh;
+};
+
+#endif /* RESULT_CACHE_H */
@@ -0,0 +1,300 @@
+/*
+ * ScalingBenchmark.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ScalingBenchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+NS_OBJECT_ENSURE_REGISTERED(CountingSimulatorImpl);
+
+static uint64_t s_eventCount = 0;
+static double s_lastEventTime = 0;
+
+// 包在原事件外的计数事件，取消时原事件随之不再执行
+class CountedEvent : public EventImpl
+{
+public:
+  explicit CountedEvent(EventImpl* event) : m_event(event, false) {}
+
+protected:
+  virtual void Notify(void)
+  {
+    s_eventCount++;
+    s_lastEventTime = Simulator::Now().GetSeconds();
+    m_event->Invoke();
+  }
+
+private:
+  Ptr<EventImpl> m_event;
+};
+
+TypeId CountingSimulatorImpl::GetTypeId(void) {
+  static TypeId tid = TypeId("CountingSimulatorImpl")
+    .SetParent<DefaultSimulatorImpl>()
+    .AddConstructor<CountingSimulatorImpl>();
+  return tid;
+}
+
+EventId CountingSimulatorImpl::Schedule(Time const& delay, EventImpl* event)
+{
+  return DefaultSimulatorImpl::Schedule(delay, new CountedEvent(event));
+}
+
+void CountingSimulatorImpl::ScheduleWithContext(uint32_t context, Time const& delay, EventImpl* event)
+{
+  DefaultSimulatorImpl::ScheduleWithContext(context, delay, new CountedEvent(event));
+}
+
+EventId CountingSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+  return DefaultSimulatorImpl::ScheduleNow(new CountedEvent(event));
+}
+
+uint64_t CountingSimulatorImpl::GetEventCount(void)
+{
+  return s_eventCount;
+}
+
+double CountingSimulatorImpl::GetLastEventTime(void)
+{
+  return s_lastEventTime;
+}
+
+void CountingSimulatorImpl::ResetCounters(void)
+{
+  s_eventCount = 0;
+  s_lastEventTime = 0;
+}
+
+void CountingSimulatorImpl::Enable(void)
+{
+  GlobalValue::Bind("SimulatorImplementationType", StringValue("CountingSimulatorImpl"));
+}
+
+// ---------------- BenchmarkSample ----------------
+
+BenchmarkSample::BenchmarkSample()
+  : wallSeconds(0), events(0), simulatedSeconds(0), peakRssKb(0), scalingExponent(-1)
+{
+}
+
+double BenchmarkSample::GetEventsPerSecond() const
+{
+  return wallSeconds > 0 ? events / wallSeconds : 0;
+}
+
+double BenchmarkSample::GetPacketsPerSimSecond() const
+{
+  return simulatedSeconds > 0 ? result.totalSent / simulatedSeconds : 0;
+}
+
+std::string BenchmarkSample::CsvHeader()
+{
+  return SimulationResult::CsvHeader()
+    + ",wallSeconds,events,eventsPerSecond,peakRssKb,simulatedSeconds,packetsPerSimSecond,scalingExponent";
+}
+
+std::string BenchmarkSample::ToCsv() const
+{
+  std::ostringstream ss;
+  ss << result.ToCsv() << "," << wallSeconds << "," << events << "," << GetEventsPerSecond() << ","
+     << peakRssKb << "," << simulatedSeconds << "," << GetPacketsPerSimSecond() << ",";
+  if (scalingExponent >= 0) {
+    ss << scalingExponent;
+  }
+  return ss.str();
+}
+
+// ---------------- ScalingBenchmark ----------------
+
+static double WallSeconds()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+ScalingBenchmark::ScalingBenchmark(ScenarioRunner runner)
+  : m_runner(runner),
+    m_exitHook(NULL),
+    m_maxExponent(0)
+{
+}
+
+bool ScalingBenchmark::RunOne(const ScenarioConfig& scenario, BenchmarkSample& sample)
+{
+  int fds[2];
+  if (pipe(fds) != 0) {
+    std::cerr << "创建管道失败" << std::endl;
+    return false;
+  }
+  // 避免缓冲区中尚未输出的内容在子进程中再输出一次
+  std::cout.flush();
+  std::cerr.flush();
+  pid_t pid = fork();
+  if (pid < 0) {
+    std::cerr << "fork失败" << std::endl;
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    CountingSimulatorImpl::ResetCounters();
+    SimulationResult result;
+    double start = WallSeconds();
+    bool ok = m_runner(scenario, result);
+    double elapsed = WallSeconds() - start;
+    if (m_exitHook != NULL) {
+      m_exitHook();
+    }
+    if (ok) {
+      std::ostringstream ss;
+      ss.precision(10);
+      ss << result.ToCsv() << "\n" << elapsed << " " << CountingSimulatorImpl::GetEventCount() << " "
+         << CountingSimulatorImpl::GetLastEventTime() << "\n";
+      std::string data = ss.str();
+      const char* p = data.c_str();
+      size_t left = data.size();
+      while (left > 0) {
+        ssize_t n = write(fds[1], p, left);
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          break;
+        }
+        p += n;
+        left -= n;
+      }
+    }
+    close(fds[1]);
+    _exit(ok ? 0 : 1);
+  }
+
+  close(fds[1]);
+  std::string data;
+  char buffer[4096];
+  while (true) {
+    ssize_t n = read(fds[0], buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    data.append(buffer, n);
+  }
+  close(fds[0]);
+
+  int status = 0;
+  struct rusage usage;
+  while (wait4(pid, &status, 0, &usage) < 0) {
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    std::cerr << scenario.Label() << " 运行失败" << std::endl;
+    return false;
+  }
+
+  std::istringstream in(data);
+  std::string line;
+  if (!std::getline(in, line) || !sample.result.FromCsv(line)) {
+    return false;
+  }
+  if (!(in >> sample.wallSeconds >> sample.events >> sample.simulatedSeconds)) {
+    return false;
+  }
+  // Linux上ru_maxrss的单位为KB
+  sample.peakRssKb = usage.ru_maxrss;
+  return true;
+}
+
+uint32_t ScalingBenchmark::ComputeScaling(std::vector<BenchmarkSample>& samples) const
+{
+  // 面积、链路质量与run相同的场景为一组，组内按节点数排序
+  std::map<std::string, std::vector<uint32_t> > groups;
+  for (uint32_t i = 0; i < samples.size(); i++) {
+    ScenarioConfig key = samples[i].result.scenario;
+    key.numNodes = 0;
+    groups[key.Label()].push_back(i);
+  }
+  uint32_t violations = 0;
+  for (std::map<std::string, std::vector<uint32_t> >::iterator it = groups.begin(); it != groups.end(); ++it) {
+    std::vector<std::pair<uint32_t, uint32_t> > order;
+    for (uint32_t k = 0; k < it->second.size(); k++) {
+      order.push_back(std::make_pair(samples[it->second[k]].result.scenario.numNodes, it->second[k]));
+    }
+    std::sort(order.begin(), order.end());
+    for (uint32_t k = 1; k < order.size(); k++) {
+      const BenchmarkSample& previous = samples[order[k - 1].second];
+      BenchmarkSample& current = samples[order[k].second];
+      if (order[k].first == order[k - 1].first || previous.wallSeconds <= 0 || current.wallSeconds <= 0) {
+        continue;
+      }
+      current.scalingExponent = std::log(current.wallSeconds / previous.wallSeconds)
+        / std::log(static_cast<double>(order[k].first) / order[k - 1].first);
+      if (current.scalingExponent < 0) {
+        current.scalingExponent = 0;
+      }
+      if (m_maxExponent > 0 && current.scalingExponent > m_maxExponent) {
+        std::cerr << "扩展性回归: " << current.result.scenario.Label() << " 耗时增长指数 "
+                  << current.scalingExponent << " > " << m_maxExponent << std::endl;
+        violations++;
+      }
+    }
+  }
+  return violations;
+}
+
+int ScalingBenchmark::Run(const std::vector<ScenarioConfig>& scenarios, const std::string& reportFile)
+{
+  std::vector<BenchmarkSample> samples;
+  uint32_t failed = 0;
+  for (uint32_t i = 0; i < scenarios.size(); i++) {
+    BenchmarkSample sample;
+    if (!RunOne(scenarios[i], sample)) {
+      failed++;
+      continue;
+    }
+    std::cout << "[" << (i + 1) << "/" << scenarios.size() << "] " << scenarios[i].Label()
+              << " 耗时" << sample.wallSeconds << "s 事件" << sample.events
+              << " 峰值内存" << sample.peakRssKb << "KB" << std::endl;
+    samples.push_back(sample);
+  }
+  uint32_t violations = ComputeScaling(samples);
+
+  std::ofstream out(reportFile.c_str(), std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "无法写入基准测试报告: " << reportFile << std::endl;
+    return 1;
+  }
+  out << BenchmarkSample::CsvHeader() << std::endl;
+  for (uint32_t i = 0; i < samples.size(); i++) {
+    out << samples[i].ToCsv() << std::endl;
+  }
+  out.close();
+
+  if (failed > 0) {
+    std::cerr << failed << "个场景运行失败" << std::endl;
+    return 1;
+  }
+  return violations > 0 ? 2 : 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * ScalingBenchmark.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef SCALING_BENCHMARK_H
+#define SCALING_BENCHMARK_H
+
+#include "Scenario.h"
+#include "WorkerPool.h"
+#include "ns3/core-module.h"
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * 统计已执行事件数的仿真器实现
+ *
+ * 每个调度的事件外包一层计数事件，事件被执行时计数；取消的事件不计入。
+ * 只在基准测试模式下通过SimulatorImplementationType启用。
+ */
+class CountingSimulatorImpl : public DefaultSimulatorImpl
+{
+public:
+  static TypeId GetTypeId(void);
+
+  virtual EventId Schedule(Time const& delay, EventImpl* event);
+  virtual void ScheduleWithContext(uint32_t context, Time const& delay, EventImpl* event);
+  virtual EventId ScheduleNow(EventImpl* event);
+
+  // 当前进程自上次Reset以来执行的事件数与最后一个事件的仿真时刻 (s)
+  static uint64_t GetEventCount(void);
+  static double GetLastEventTime(void);
+  static void ResetCounters(void);
+  // 之后创建的仿真器使用本实现
+  static void Enable(void);
+};
+
+// 一个场景的基准测试测量值
+struct BenchmarkSample
+{
+  BenchmarkSample();
+
+  SimulationResult result;
+  double wallSeconds;        ///< 仿真（含场景搭建）的墙钟时间
+  uint64_t events;           ///< 执行的仿真器事件数
+  double simulatedSeconds;   ///< 最后一个事件的仿真时刻
+  long peakRssKb;            ///< 运行该场景的子进程的峰值常驻内存
+  double scalingExponent;    ///< 相对同组上一个节点数的耗时增长指数，没有上一个点时小于0
+
+  double GetEventsPerSecond() const;
+  double GetPacketsPerSimSecond() const;
+
+  static std::string CsvHeader();
+  std::string ToCsv() const;
+};
+
+/**
+ * 端到端扩展性基准测试
+ *
+ * 每个场景在单独的子进程中顺序运行（不并行，避免相互干扰），
+ * 子进程测量墙钟时间与事件数，父进程通过wait4取得子进程的峰值RSS。
+ * 全部场景结束后，对面积、链路质量、run相同的一组场景按节点数排序，
+ * 计算相邻两点的耗时增长指数 log(t2/t1)/log(n2/n1)，写入同一份报告。
+ */
+class ScalingBenchmark
+{
+public:
+  explicit ScalingBenchmark(ScenarioRunner runner);
+
+  // 子进程退出前的回调，用于提交数据库等进程内的缓冲
+  void SetExitHook(WorkerExitHook hook) { m_exitHook = hook; }
+  // 增长指数超过该值时报告并使Run返回2，0表示不检查
+  void SetMaxScalingExponent(double exponent) { m_maxExponent = exponent; }
+
+  // 运行所有场景并写出报告，成功返回0
+  int Run(const std::vector<ScenarioConfig>& scenarios, const std::string& reportFile);
+
+private:
+  bool RunOne(const ScenarioConfig& scenario, BenchmarkSample& sample);
+  uint32_t ComputeScaling(std::vector<BenchmarkSample>& samples) const;
+
+  ScenarioRunner m_runner;
+  WorkerExitHook m_exitHook;
+  double m_maxExponent;
+};
+
+#endif /* SCALING_BENCHMARK_H */
@@ -0,0 +1,301 @@
+/*
+ * Scenario.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "Scenario.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <algorithm>
+
+// 去掉首尾空白
+static std::string Trim(const std::string& s)
+{
+  std::string::size_type begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  std::string::size_type end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+// 按分隔符切分
+static std::vector<std::string> Split(const std::string& s, char sep)
+{
+  std::vector<std::string> parts;
+  std::string item;
+  std::istringstream ss(s);
+  while (std::getline(ss, item, sep)) {
+    parts.push_back(Trim(item));
+  }
+  return parts;
+}
+
+ScenarioConfig::ScenarioConfig()
+  : areaLength(500), areaWidth(500), areaHeight(100),
+    numNodes(5), linkQuality("medium"), run(1), strategy("regka")
+{
+}
+
+std::string ScenarioConfig::AreaString() const
+{
+  std::ostringstream ss;
+  ss << areaLength << "*" << areaWidth << "*" << areaHeight;
+  return ss.str();
+}
+
+std::string ScenarioConfig::Label() const
+{
+  std::ostringstream ss;
+  ss << AreaString() << "_" << numNodes << "_" << linkQuality << "_" << run;
+  if (!fault.empty()) {
+    ss << "_" << fault;
+  }
+  return ss.str();
+}
+
+ChannelMetrics::ChannelMetrics()
+  : collected(false), flowDelay(0), flowJitter(0), flowLoss(0),
+    phyRxDrops(0), macRetries(0), collisions(0), channelBusy(0)
+{
+}
+
+SimulationResult::SimulationResult()
+  : completionTime(0), totalSent(0), totalReceived(0),
+    overheadRatio(0), successRate(0), outcome("timeout"), contributionRate(0)
+{
+}
+
+std::string SimulationResult::CsvHeader()
+{
+  return "areaLength,areaWidth,areaHeight,numNodes,linkQuality,run,"
+         "completionTime,totalSent,totalReceived,overheadRatio,successRate,outcome,contributionRate,fault,strategy,"
+         "flowDelay,flowJitter,flowLoss,phyRxDrops,macRetries,collisions,channelBusy";
+}
+
+std::string SimulationResult::ToCsv() const
+{
+  std::ostringstream ss;
+  ss << std::setprecision(10)
+     << scenario.areaLength << "," << scenario.areaWidth << "," << scenario.areaHeight << ","
+     << scenario.numNodes << "," << scenario.linkQuality << "," << scenario.run << ","
+     << completionTime << "," << totalSent << "," << totalReceived << ","
+     << overheadRatio << "," << successRate << "," << outcome << "," << contributionRate << ","
+     << (scenario.fault.empty() ? "none" : scenario.fault) << "," << scenario.strategy << ",";
+  if (channel.collected) {
+    ss << channel.flowDelay << "," << channel.flowJitter << "," << channel.flowLoss << ","
+       << channel.phyRxDrops << "," << channel.macRetries << "," << channel.collisions << ","
+       << channel.channelBusy;
+  } else {
+    ss << ",,,,,,";
+  }
+  return ss.str();
+}
+
+bool SimulationResult::FromCsv(const std::string& line)
+{
+  std::vector<std::string> f = Split(line, ',');
+  // getline不产生最后一个逗号之后的空列，按逗号数补齐，未统计信道层指标的行也能按列数区分格式
+  f.resize(std::count(line.begin(), line.end(), ',') + 1);
+  if (f.size() < 11) {
+    return false;
+  }
+  scenario.areaLength = std::atof(f[0].c_str());
+  scenario.areaWidth = std::atof(f[1].c_str());
+  scenario.areaHeight = std::atof(f[2].c_str());
+  scenario.numNodes = std::strtoul(f[3].c_str(), NULL, 10);
+  scenario.linkQuality = f[4];
+  scenario.run = std::strtoul(f[5].c_str(), NULL, 10);
+  completionTime = std::atof(f[6].c_str());
+  totalSent = std::strtoul(f[7].c_str(), NULL, 10);
+  totalReceived = std::strtoul(f[8].c_str(), NULL, 10);
+  overheadRatio = std::atof(f[9].c_str());
+  successRate = std::atof(f[10].c_str());
+  if (f.size() >= 13) {
+    outcome = f[11];
+    contributionRate = std::atof(f[12].c_str());
+  } else {
+    // 旧格式（缓存）没有这两列：成功率为100%即完成，否则按到达仿真时间处理；
+    // 每个完成节点贡献100%，贡献比例不低于成功率，以成功率代替
+    outcome = successRate >= 100 ? "completed" : "timeout";
+    contributionRate = successRate;
+  }
+  // 没有故障列的旧格式即没有故障
+  scenario.fault = f.size() >= 14 && f[13] != "none" ? f[13] : "";
+  // 方案列在故障列之后，没有方案列的旧格式共21列
+  uint32_t channelColumn = 14;
+  scenario.strategy = "regka";
+  if (f.size() >= 22) {
+    scenario.strategy = f[14];
+    channelColumn = 15;
+  }
+  // 信道层指标各列为空即未统计
+  channel = ChannelMetrics();
+  if (f.size() >= channelColumn + 7 && !f[channelColumn].empty()) {
+    const std::string* c = &f[channelColumn];
+    channel.collected = true;
+    channel.flowDelay = std::atof(c[0].c_str());
+    channel.flowJitter = std::atof(c[1].c_str());
+    channel.flowLoss = std::atof(c[2].c_str());
+    channel.phyRxDrops = std::strtoull(c[3].c_str(), NULL, 10);
+    channel.macRetries = std::strtoull(c[4].c_str(), NULL, 10);
+    channel.collisions = std::strtoull(c[5].c_str(), NULL, 10);
+    channel.channelBusy = std::atof(c[6].c_str());
+  }
+  return true;
+}
+
+SweepSpec::SweepSpec()
+{
+}
+
+// 解析 "5:65:10" 或 "5,10,20" 形式的非负整数列表
+bool SweepSpec::ParseUintList(const std::string& value, std::vector<uint32_t>& out) const
+{
+  std::vector<std::string> items = Split(value, ',');
+  for (uint32_t k = 0; k < items.size(); k++) {
+    std::vector<std::string> range = Split(items[k], ':');
+    if (range.size() == 1) {
+      out.push_back(std::strtoul(range[0].c_str(), NULL, 10));
+      continue;
+    }
+    if (range.size() > 3) {
+      std::cerr << "无法解析区间: " << items[k] << std::endl;
+      return false;
+    }
+    uint32_t first = std::strtoul(range[0].c_str(), NULL, 10);
+    uint32_t last = std::strtoul(range[1].c_str(), NULL, 10);
+    uint32_t step = (range.size() == 3) ? std::strtoul(range[2].c_str(), NULL, 10) : 1;
+    if (step == 0 || last < first) {
+      std::cerr << "无效区间: " << items[k] << std::endl;
+      return false;
+    }
+    for (uint32_t v = first; v <= last; v += step) {
+      out.push_back(v);
+    }
+  }
+  return !out.empty();
+}
+
+// 解析 "300*300*80,500*500*100" 形式的区域列表
+bool SweepSpec::ParseAreaList(const std::string& value, std::vector<ScenarioConfig>& out) const
+{
+  std::vector<std::string> items = Split(value, ',');
+  for (uint32_t k = 0; k < items.size(); k++) {
+    std::vector<std::string> dims = Split(items[k], '*');
+    if (dims.size() != 3) {
+      std::cerr << "无法解析区域: " << items[k] << std::endl;
+      return false;
+    }
+    ScenarioConfig area;
+    area.areaLength = std::atof(dims[0].c_str());
+    area.areaWidth = std::atof(dims[1].c_str());
+    area.areaHeight = std::atof(dims[2].c_str());
+    out.push_back(area);
+  }
+  return !out.empty();
+}
+
+bool SweepSpec::Parse(const std::string& spec, const ScenarioConfig& base)
+{
+  std::vector<ScenarioConfig> areas(1, base);
+  std::vector<uint32_t> nodes(1, base.numNodes);
+  std::vector<std::string> qualities(1, base.linkQuality);
+  std::vector<uint32_t> runs(1, base.run);
+  std::vector<std::string> faults(1, base.fault);
+
+  std::vector<std::string> fields = Split(spec, ';');
+  for (uint32_t k = 0; k < fields.size(); k++) {
+    if (fields[k].empty()) {
+      continue;
+    }
+    std::string::size_type eq = fields[k].find('=');
+    if (eq == std::string::npos) {
+      std::cerr << "扫描规格缺少'=': " << fields[k] << std::endl;
+      return false;
+    }
+    std::string key = Trim(fields[k].substr(0, eq));
+    std::string value = Trim(fields[k].substr(eq + 1));
+    bool ok = true;
+    if (key == "area") {
+      areas.clear();
+      ok = ParseAreaList(value, areas);
+    } else if (key == "nodes") {
+      nodes.clear();
+      ok = ParseUintList(value, nodes);
+    } else if (key == "quality") {
+      qualities = Split(value, ',');
+      ok = !qualities.empty();
+    } else if (key == "fault") {
+      faults = Split(value, ',');
+      for (uint32_t f = 0; f < faults.size(); f++) {
+        if (faults[f] == "none") {
+          faults[f] = "";
+        }
+      }
+      ok = !faults.empty();
+    } else if (key == "run") {
+      runs.clear();
+      ok = ParseUintList(value, runs);
+    } else {
+      std::cerr << "未知的扫描维度: " << key << std::endl;
+      ok = false;
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+
+  // 与run.sh的循环顺序一致：区域 -> 节点数 -> 链路质量 -> 运行序号，故障计划在链路质量之后
+  for (uint32_t a = 0; a < areas.size(); a++) {
+    for (uint32_t n = 0; n < nodes.size(); n++) {
+      for (uint32_t q = 0; q < qualities.size(); q++) {
+        for (uint32_t f = 0; f < faults.size(); f++) {
+          for (uint32_t r = 0; r < runs.size(); r++) {
+            ScenarioConfig s = areas[a];
+            s.numNodes = nodes[n];
+            s.linkQuality = qualities[q];
+            s.fault = faults[f];
+            s.run = runs[r];
+            m_scenarios.push_back(s);
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool SweepSpec::LoadFile(const std::string& path)
+{
+  std::ifstream in(path.c_str());
+  if (!in.is_open()) {
+    std::cerr << "无法打开场景列表文件: " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  uint32_t lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    line = Trim(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream ss(line);
+    ScenarioConfig s;
+    if (!(ss >> s.areaLength >> s.areaWidth >> s.areaHeight >> s.numNodes >> s.linkQuality >> s.run)) {
+      std::cerr << "场景列表第" << lineNo << "行格式错误: " << line << std::endl;
+      return false;
+    }
+    if (ss >> s.fault && s.fault == "none") {
+      s.fault = "";
+    }
+    m_scenarios.push_back(s);
+  }
+  return true;
+}
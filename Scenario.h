@@ -0,0 +1,96 @@
+/*
+ * Scenario.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 单个仿真场景的参数（区域、节点数、链路质量、运行序号）
+struct ScenarioConfig
+{
+  ScenarioConfig();
+
+  double areaLength;        ///< 活动区域长度 (m)
+  double areaWidth;         ///< 活动区域宽度 (m)
+  double areaHeight;        ///< 活动区域高度 (m)
+  uint32_t numNodes;        ///< 节点个数
+  std::string linkQuality;  ///< 链路质量 high/medium/low/very_poor
+  uint32_t run;             ///< 运行序号，同时作为ns-3的RngRun
+  std::string fault;        ///< 故障计划的名称或文本（见FaultPlan），空串为没有故障
+  std::string strategy;     ///< 协商方案 regka/flooding/tgdh/centralized，不计入Label
+
+  // 区域描述，例如 500*500*100
+  std::string AreaString() const;
+  // 场景标签，例如 500*500*100_5_medium_1，有故障计划时再附 _计划
+  std::string Label() const;
+};
+
+// 信道层指标（ns-3的FlowMonitor与WiFi MAC/PHY跟踪源），用于区分协议本身慢与信道饱和
+struct ChannelMetrics
+{
+  ChannelMetrics();
+
+  bool collected;             ///< 是否统计了信道层指标，未统计时CSV中各列为空
+  double flowDelay;           ///< FlowMonitor各流收到的数据包的平均时延 (s)
+  double flowJitter;          ///< 各流相邻数据包时延差的平均值 (s)
+  double flowLoss;            ///< 各流丢失的数据包占发出的比例 (%)
+  uint64_t phyRxDrops;        ///< PHY丢弃的接收帧数
+  uint64_t macRetries;        ///< 单播数据帧未收到ACK而重传的次数
+  uint64_t collisions;        ///< 到达时PHY正在收发其他帧而丢弃的帧数（PHY丢帧的一部分）
+  double channelBusy;         ///< 节点开始发送后信道忙（收、发或CCA忙）的时间比例，各节点平均 (%)
+};
+
+// 单个场景的仿真结果
+struct SimulationResult
+{
+  SimulationResult();
+
+  ScenarioConfig scenario;
+  double completionTime;      ///< 密钥协商完成时延 (s)
+  uint32_t totalSent;         ///< 总发送数据包
+  uint32_t totalReceived;     ///< 总接收数据包
+  double overheadRatio;       ///< 通信开销比(接收/发送)
+  double successRate;         ///< 成功率 (%)
+  std::string outcome;        ///< completed（全部完成）、stalled（判定停滞提前结束）或timeout（到达仿真时间）
+  double contributionRate;    ///< 所有节点已知密钥贡献占N*N的比例 (%)，未完成时的部分成功程度
+  ChannelMetrics channel;     ///< 只有完整WiFi仿真开启channelMetrics时统计
+
+  // CSV表头
+  static std::string CsvHeader();
+  // 转换为一行CSV（不含换行）
+  std::string ToCsv() const;
+  // 从一行CSV解析，格式与ToCsv一致；没有方案列的旧格式为regka
+  bool FromCsv(const std::string& line);
+};
+
+// 扫描配置：由若干维度的取值组合出场景列表
+// 规格字符串形如 "area=300*300*80,500*500*100;nodes=5:65:10;quality=high,low;fault=none,crash10;run=1:10"
+// 数值维度支持 a:b[:step] 形式的闭区间以及逗号分隔的列表
+class SweepSpec
+{
+public:
+  SweepSpec();
+
+  // 解析规格字符串，未指定的维度取base中的值
+  bool Parse(const std::string& spec, const ScenarioConfig& base);
+  // 读取场景列表文件，每行: areaLength areaWidth areaHeight numNodes linkQuality run [fault]
+  // 允许以#开头的注释行和空行
+  bool LoadFile(const std::string& path);
+
+  const std::vector<ScenarioConfig>& GetScenarios() const { return m_scenarios; }
+
+private:
+  bool ParseUintList(const std::string& value, std::vector<uint32_t>& out) const;
+  bool ParseAreaList(const std::string& value, std::vector<ScenarioConfig>& out) const;
+
+  std::vector<ScenarioConfig> m_scenarios;
+};
+
+#endif /* SCENARIO_H */
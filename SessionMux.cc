@@ -0,0 +1,372 @@
+/*
+ * SessionMux.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "SessionMux.h"
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+uint32_t SessionMux::s_maxFrameBytes = 0;
+
+// 同一时刻的判断精度 (s)
+static const double TIME_EPSILON = 1e-9;
+
+// ---------------- SessionPool ----------------
+
+RegkaProtocol* SessionPool::Acquire()
+{
+  if (!m_free.empty()) {
+    RegkaProtocol* protocol = m_free.back();
+    m_free.pop_back();
+    return protocol;
+  }
+  m_engines.push_back(RegkaProtocol());
+  return &m_engines.back();
+}
+
+void SessionPool::Release(RegkaProtocol* protocol)
+{
+  protocol->SetHost(NULL);
+  protocol->SetNeighborTable(NULL);
+  m_free.push_back(protocol);
+}
+
+SessionPool& SessionPool::Global()
+{
+  static SessionPool pool;
+  return pool;
+}
+
+// ---------------- SessionMux ----------------
+
+void SessionMux::SessionHost::Send(uint32_t destination, const std::string& content, double delay)
+{
+  Pending pending;
+  pending.destination = destination;
+  pending.delay = delay;
+  pending.session = m_session;
+  pending.content = content;
+  m_mux->m_pending.push_back(pending);
+}
+
+void SessionMux::SessionHost::ScheduleTimer(double delay)
+{
+  m_mux->ScheduleSessionTimer(m_session, delay);
+}
+
+SessionMux::SessionMux()
+  : m_host(NULL),
+    m_networkSize(0),
+    m_nodeId(0),
+    m_periodicInterval(0.1),
+    m_framesSent(0),
+    m_framesReceived(0)
+{
+}
+
+SessionMux::~SessionMux()
+{
+  Initialize(0, 0);
+}
+
+void SessionMux::Initialize(uint32_t networkSize, uint32_t nodeId)
+{
+  for (std::map<uint32_t, Session>::iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    SessionPool::Global().Release(it->second.protocol);
+  }
+  m_sessions.clear();
+  m_networkSize = networkSize;
+  m_nodeId = nodeId;
+  m_neighbors.clear();
+  m_pending.clear();
+  m_timers.clear();
+  m_framesSent = 0;
+  m_framesReceived = 0;
+}
+
+RegkaProtocol* SessionMux::AddSession(uint32_t sessionId, const std::vector<bool>& members)
+{
+  if (m_nodeId >= members.size() || !members[m_nodeId]) {
+    return NULL;
+  }
+  RemoveSession(sessionId);
+  Session& session = m_sessions[sessionId];
+  session.protocol = SessionPool::Global().Acquire();
+  session.host.Attach(this, sessionId);
+  session.timerDue = -1;
+  session.completionTime = -1;
+
+  RegkaProtocol* protocol = session.protocol;
+  protocol->Initialize(m_networkSize, m_nodeId);
+  for (uint32_t j = 0; j < m_networkSize; j++) {
+    if (j >= members.size() || !members[j]) {
+      protocol->SetMember(j, false);
+    }
+  }
+  protocol->SetHost(&session.host);
+  protocol->SetNeighborTable(&m_neighbors);
+  protocol->SetPeriodicInterval(m_periodicInterval);
+  return protocol;
+}
+
+void SessionMux::RemoveSession(uint32_t sessionId)
+{
+  std::map<uint32_t, Session>::iterator it = m_sessions.find(sessionId);
+  if (it == m_sessions.end()) {
+    return;
+  }
+  SessionPool::Global().Release(it->second.protocol);
+  m_sessions.erase(it);
+}
+
+RegkaProtocol* SessionMux::GetSession(uint32_t sessionId)
+{
+  std::map<uint32_t, Session>::iterator it = m_sessions.find(sessionId);
+  return it != m_sessions.end() ? it->second.protocol : NULL;
+}
+
+const RegkaProtocol* SessionMux::GetSession(uint32_t sessionId) const
+{
+  std::map<uint32_t, Session>::const_iterator it = m_sessions.find(sessionId);
+  return it != m_sessions.end() ? it->second.protocol : NULL;
+}
+
+double SessionMux::GetCompletionTime(uint32_t sessionId) const
+{
+  std::map<uint32_t, Session>::const_iterator it = m_sessions.find(sessionId);
+  return it != m_sessions.end() ? it->second.completionTime : -1;
+}
+
+void SessionMux::SetPeriodicInterval(double interval)
+{
+  m_periodicInterval = interval;
+  for (std::map<uint32_t, Session>::iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    it->second.protocol->SetPeriodicInterval(interval);
+  }
+}
+
+void SessionMux::Start()
+{
+  for (std::map<uint32_t, Session>::iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    it->second.protocol->Start();
+    RecordCompletion(it->second);
+  }
+  Flush();
+}
+
+void SessionMux::ScheduleSessionTimer(uint32_t session, double delay)
+{
+  double due = m_host->Now() + delay;
+  m_sessions[session].timerDue = due;
+  // 已有同一时刻的宿主定时器时不再安排
+  for (uint32_t i = 0; i < m_timers.size(); i++) {
+    if (std::fabs(m_timers[i] - due) < TIME_EPSILON) {
+      return;
+    }
+  }
+  m_timers.push_back(due);
+  m_host->ScheduleTimer(delay);
+}
+
+void SessionMux::OnTimer()
+{
+  double now = m_host->Now();
+  for (uint32_t i = 0; i < m_timers.size();) {
+    if (m_timers[i] <= now + TIME_EPSILON) {
+      m_timers[i] = m_timers.back();
+      m_timers.pop_back();
+    } else {
+      i++;
+    }
+  }
+  for (std::map<uint32_t, Session>::iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    Session& session = it->second;
+    if (session.timerDue >= 0 && session.timerDue <= now + TIME_EPSILON) {
+      session.timerDue = -1;
+      session.protocol->OnTimer();
+    }
+  }
+  Flush();
+}
+
+void SessionMux::OnReceive(uint32_t from, const std::string& frame)
+{
+  m_framesReceived++;
+  std::vector<std::pair<uint32_t, std::string> > records;
+  ParseFrame(frame, records);
+  for (uint32_t k = 0; k < records.size(); k++) {
+    std::map<uint32_t, Session>::iterator it = m_sessions.find(records[k].first);
+    // 不属于的会话的消息直接忽略
+    if (it == m_sessions.end()) {
+      continue;
+    }
+    it->second.protocol->OnReceive(from, records[k].second);
+    RecordCompletion(it->second);
+  }
+  Flush();
+}
+
+uint32_t SessionMux::Transmit(const std::string& frame)
+{
+  m_framesSent++;
+  std::vector<std::pair<uint32_t, std::string> > records;
+  ParseFrame(frame, records);
+  uint32_t padding = 0;
+  for (uint32_t k = 0; k < records.size(); k++) {
+    RegkaProtocol* protocol = GetSession(records[k].first);
+    if (protocol != NULL) {
+      padding += protocol->Transmit(records[k].second);
+    } else {
+      // 排队期间会话已结束
+      padding += RegkaProtocol::GetMessagePaddingBytes(records[k].second, m_networkSize);
+    }
+  }
+  return padding;
+}
+
+void SessionMux::RecordCompletion(Session& session)
+{
+  if (session.completionTime < 0 && session.protocol->IsCompleted()) {
+    session.completionTime = m_host->Now();
+  }
+}
+
+void SessionMux::Flush()
+{
+  if (m_pending.empty()) {
+    return;
+  }
+  // 同一目的地与时延的消息依次装入当前帧，放不下时先发出当前帧
+  std::vector<Frame> frames;
+  for (uint32_t i = 0; i < m_pending.size(); i++) {
+    const Pending& pending = m_pending[i];
+    std::ostringstream record;
+    record << " " << pending.session << " " << pending.content.size() << " " << pending.content;
+    uint32_t bytes = record.str().size() + RegkaProtocol::GetMessagePaddingBytes(pending.content, m_networkSize);
+
+    Frame* frame = NULL;
+    for (uint32_t k = 0; k < frames.size(); k++) {
+      if (frames[k].destination == pending.destination && frames[k].delay == pending.delay) {
+        frame = &frames[k];
+      }
+    }
+    // 帧头 "F 记录数" 不超过12字节
+    if (frame != NULL && s_maxFrameBytes > 0 && frame->bytes + bytes + 12 > s_maxFrameBytes) {
+      std::ostringstream content;
+      content << "F " << frame->count << frame->records;
+      m_host->Send(frame->destination, content.str(), frame->delay);
+      frame->count = 0;
+      frame->bytes = 0;
+      frame->records.clear();
+    }
+    if (frame == NULL) {
+      Frame empty;
+      empty.destination = pending.destination;
+      empty.delay = pending.delay;
+      empty.count = 0;
+      empty.bytes = 0;
+      frames.push_back(empty);
+      frame = &frames.back();
+    }
+    frame->count++;
+    frame->bytes += bytes;
+    frame->records += record.str();
+  }
+  m_pending.clear();
+
+  for (uint32_t k = 0; k < frames.size(); k++) {
+    std::ostringstream content;
+    content << "F " << frames[k].count << frames[k].records;
+    m_host->Send(frames[k].destination, content.str(), frames[k].delay);
+  }
+}
+
+bool SessionMux::ParseFrame(const std::string& frame, std::vector<std::pair<uint32_t, std::string> >& records)
+{
+  if (frame.size() < 2 || frame[0] != 'F') {
+    return false;
+  }
+  const char* begin = frame.c_str();
+  char* end = NULL;
+  uint32_t count = std::strtoul(begin + 2, &end, 10);
+  std::string::size_type position = end - begin;
+  for (uint32_t k = 0; k < count; k++) {
+    if (position >= frame.size()) {
+      return false;
+    }
+    uint32_t session = std::strtoul(begin + position, &end, 10);
+    uint32_t length = std::strtoul(end, &end, 10);
+    // 长度字段后是一个空格
+    position = end - begin + 1;
+    if (position + length > frame.size()) {
+      return false;
+    }
+    records.push_back(std::make_pair(session, frame.substr(position, length)));
+    position += length;
+  }
+  return true;
+}
+
+uint64_t SessionMux::GetMatrixBytes() const
+{
+  uint64_t bytes = 0;
+  for (std::map<uint32_t, Session>::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    bytes += it->second.protocol->GetMatrixBytes();
+  }
+  return bytes;
+}
+
+bool SessionMux::IsCompleted() const
+{
+  for (std::map<uint32_t, Session>::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    if (!it->second.protocol->IsCompleted()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t SessionMux::CountLearnedContributions() const
+{
+  uint64_t learned = 0;
+  for (std::map<uint32_t, Session>::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    const KeyMatrix& matrix = it->second.protocol->GetKeyMatrix();
+    for (uint32_t j = 0; j < matrix.GetNetworkSize(); j++) {
+      if (matrix.IsActive(j) && matrix.HasKeyContribution(m_nodeId, j)) {
+        learned++;
+      }
+    }
+  }
+  return learned;
+}
+
+uint64_t SessionMux::CountExpectedContributions() const
+{
+  uint64_t expected = 0;
+  for (std::map<uint32_t, Session>::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    expected += it->second.protocol->GetKeyMatrix().GetActiveCount();
+  }
+  return expected;
+}
+
+uint32_t SessionMux::GetSentCount() const
+{
+  uint32_t sent = 0;
+  for (std::map<uint32_t, Session>::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    sent += it->second.protocol->GetSentCount();
+  }
+  return sent;
+}
+
+uint32_t SessionMux::GetReceivedCount() const
+{
+  uint32_t received = 0;
+  for (std::map<uint32_t, Session>::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+    received += it->second.protocol->GetReceivedCount();
+  }
+  return received;
+}
@@ -0,0 +1,157 @@
+/*
+ * SessionMux.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef SESSION_MUX_H
+#define SESSION_MUX_H
+
+#include "RegkaProtocol.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * 协议引擎池：会话结束后引擎归还到池中，下一个会话重新初始化时复用其矩阵的存储，
+ * 避免会话频繁建立与结束时反复分配N×N的矩阵。池中的引擎直到进程结束才释放。
+ */
+class SessionPool
+{
+public:
+  RegkaProtocol* Acquire();
+  void Release(RegkaProtocol* protocol);
+  // 已分配的引擎数与其中空闲的个数
+  uint32_t GetAllocatedCount() const { return m_engines.size(); }
+  uint32_t GetFreeCount() const { return m_free.size(); }
+  // 进程内共用的池
+  static SessionPool& Global();
+
+private:
+  std::deque<RegkaProtocol> m_engines;  ///< deque扩充时已有元素的地址不变
+  std::vector<RegkaProtocol*> m_free;
+};
+
+/**
+ * 一个节点上的多个并发密钥协商会话，不依赖ns-3
+ *
+ * 每个会话是一个独立的RegkaProtocol，槽位仍为节点ID，不属于会话的节点在该会话中为非成员。
+ * 同一节点的所有会话共用一张邻居表与一个发送队列：在一次收包、定时或启动的处理中，
+ * 各会话要发出的消息先进入队列，处理结束时按目的地与发送时延分组，
+ * 装入不超过帧长度上限的帧，格式为 "F 记录数( 会话ID 长度 消息)*"，帧尾附加各消息填充之和。
+ * 上限为0时不限制；填充通常已超过一个MTU，上限小于单条消息时每条消息单独成帧（不共用帧）。
+ * 发送数与接收数按会话消息计，帧数另计。
+ * 各会话的周期定时由本对象合并：同一时刻到期的会话只占用宿主的一个定时器。
+ */
+class SessionMux
+{
+public:
+  SessionMux();
+  ~SessionMux();
+
+  // 帧（含填充）的长度上限 (字节)，0（默认）为不限制；所有节点共用
+  static void SetMaxFrameBytes(uint32_t bytes) { s_maxFrameBytes = bytes; }
+  static uint32_t GetMaxFrameBytes() { return s_maxFrameBytes; }
+
+  // 清空所有会话并设置节点，会话引擎归还到池中
+  void Initialize(uint32_t networkSize, uint32_t nodeId);
+  void SetHost(RegkaHost* host) { m_host = host; }
+  // 设置所有会话（含之后加入的会话）的周期广播间隔
+  void SetPeriodicInterval(double interval);
+
+  // 加入会话，members[j]为节点j是否属于该会话；本节点不属于该会话时返回NULL
+  RegkaProtocol* AddSession(uint32_t sessionId, const std::vector<bool>& members);
+  // 结束会话并把引擎归还到池中
+  void RemoveSession(uint32_t sessionId);
+  RegkaProtocol* GetSession(uint32_t sessionId);
+  const RegkaProtocol* GetSession(uint32_t sessionId) const;
+  uint32_t GetSessionCount() const { return m_sessions.size(); }
+  // 本节点在会话中收齐贡献的时刻，未完成或不属于该会话时为-1
+  double GetCompletionTime(uint32_t sessionId) const;
+
+  // 与RegkaProtocol相同的宿主接口
+  void Start();
+  void OnTimer();
+  void OnReceive(uint32_t from, const std::string& frame);
+  uint32_t Transmit(const std::string& frame);
+
+  // 所有会话都已收齐贡献
+  bool IsCompleted() const;
+  // 各会话中本节点已知与应知的贡献数之和
+  uint64_t CountLearnedContributions() const;
+  uint64_t CountExpectedContributions() const;
+  uint32_t GetSentCount() const;
+  uint32_t GetReceivedCount() const;
+  uint32_t GetFramesSent() const { return m_framesSent; }
+  uint32_t GetFramesReceived() const { return m_framesReceived; }
+  // 各会话的矩阵与共用邻居表（只计一次）占用的堆内存字节数
+  uint64_t GetMatrixBytes() const;
+  uint64_t GetNeighborBytes() const { return m_neighbors.capacity() * sizeof(uint32_t); }
+
+private:
+  // 为单个会话转接宿主服务
+  class SessionHost : public RegkaHost
+  {
+  public:
+    SessionHost() : m_mux(NULL), m_session(0) {}
+    void Attach(SessionMux* mux, uint32_t session) { m_mux = mux; m_session = session; }
+    virtual void Send(uint32_t destination, const std::string& content, double delay);
+    virtual void ScheduleTimer(double delay);
+    virtual double Now() const { return m_mux->m_host->Now(); }
+
+  private:
+    SessionMux* m_mux;
+    uint32_t m_session;
+  };
+
+  struct Session
+  {
+    RegkaProtocol* protocol;
+    SessionHost host;
+    double timerDue;         ///< 周期定时到期时刻，-1为没有定时
+    double completionTime;
+  };
+
+  struct Pending
+  {
+    uint32_t destination;
+    double delay;
+    uint32_t session;
+    std::string content;
+  };
+
+  // 装帧中的消息
+  struct Frame
+  {
+    uint32_t destination;
+    double delay;
+    uint32_t count;
+    uint32_t bytes;          ///< 记录与填充的字节数
+    std::string records;
+  };
+
+  void ScheduleSessionTimer(uint32_t session, double delay);
+  // 把队列中的消息装帧发出
+  void Flush();
+  void RecordCompletion(Session& session);
+  // 解析帧，取出每条记录的会话ID与消息，格式错误时返回false
+  static bool ParseFrame(const std::string& frame, std::vector<std::pair<uint32_t, std::string> >& records);
+
+  RegkaHost* m_host;
+  uint32_t m_networkSize;
+  uint32_t m_nodeId;
+  double m_periodicInterval;
+  std::map<uint32_t, Session> m_sessions;  ///< map的节点地址不变，SessionHost可以安全引用
+  std::vector<uint32_t> m_neighbors;       ///< 所有会话共用的邻居表
+  std::vector<Pending> m_pending;          ///< 共用的发送队列
+  std::vector<double> m_timers;            ///< 已向宿主安排、尚未到期的定时时刻
+  uint32_t m_framesSent;
+  uint32_t m_framesReceived;
+
+  static uint32_t s_maxFrameBytes;
+};
+
+#endif /* SESSION_MUX_H */
@@ -3,84 +3,65 @@
 #include <sstream>
 #include <ctime>
 #include <iomanip>
-#include <sys/stat.h>  
-#include <errno.h>  
-#include <unistd.h> 
-// 数据库路径
-std::string dbPath = "/home/z/ns-allinone-3.25/ns-3.25/scratch/REGKA-Ours/DB/";
+#include <cstring>
+#include <sys/stat.h>
+#include <errno.h>
+#include <unistd.h>
 
 SimulationDatabase::SimulationDatabase(const std::string& dbFile)
-  : m_db(NULL)
+  : m_db(NULL),
+    m_dbFilename(dbFile),
+    m_insertResult(NULL),
+    m_insertNode(NULL),
+    m_batchSize(1)
 {
-  // 如果dbFile已经包含完整路径，直接使用
-  if (dbFile.find('/') != std::string::npos) {
-    m_dbFilename = dbFile;
-  } else {
-    // 否则，将文件名添加到dbPath
-    m_dbFilename = dbPath + dbFile;
-  }
-
   // 确保数据库目录存在
-  struct stat st;
-  if (stat(dbPath.c_str(), &st) != 0) {
-    // 创建目录，权限为可读可写可执行
-    if (mkdir(dbPath.c_str(), 0777) != 0) {
-      std::cerr << "无法创建数据库目录: " << dbPath << " 错误: " << strerror(errno) << std::endl;
+  std::string::size_type pos = m_dbFilename.find_last_of('/');
+  if (pos != std::string::npos && pos > 0) {
+    std::string dir = m_dbFilename.substr(0, pos);
+    struct stat st;
+    if (stat(dir.c_str(), &st) != 0) {
+      // 创建目录，权限为可读可写可执行
+      if (mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST) {
+        std::cerr << "无法创建数据库目录: " << dir << " 错误: " << strerror(errno) << std::endl;
+        return;
+      }
+    }
+    // 检查目录权限
+    if (access(dir.c_str(), W_OK) != 0) {
+      std::cerr << "数据库目录没有写入权限: " << dir << " 错误: " << strerror(errno) << std::endl;
       return;
     }
-    std::cerr << "创建数据库目录: " << dbPath << std::endl;
   }
 
-  // 检查目录权限
-  if (access(dbPath.c_str(), W_OK) != 0) {
-    std::cerr << "数据库目录没有写入权限: " << dbPath << " 错误: " << strerror(errno) << std::endl;
-    return;
-  }
-
-  std::cerr << "尝试创建数据库文件: " << m_dbFilename << std::endl;
-
   // 打开或创建数据库
   int rc = sqlite3_open(m_dbFilename.c_str(), &m_db);
-  if (rc) {
-    std::cerr << "SQLite错误代码: " << rc << std::endl;
-    std::cerr << "SQLite错误信息: " << sqlite3_errmsg(m_db) << std::endl;
-    
-    // 如果数据库文件不存在，则创建数据库文件
-    if (rc == SQLITE_CANTOPEN) {
-      std::cerr << "数据库文件不存在，尝试创建数据库文件" << std::endl;
-      
-      // 确保父目录存在
-      std::string::size_type pos = m_dbFilename.find_last_of('/');
-      if (pos != std::string::npos) {
-        std::string dir = m_dbFilename.substr(0, pos);
-        if (stat(dir.c_str(), &st) != 0) {
-          if (mkdir(dir.c_str(), 0777) != 0) {
-            std::cerr << "无法创建数据库文件目录: " << dir << " 错误: " << strerror(errno) << std::endl;
-            return;
-          }
-        }
-      }
-
-      // 再次尝试打开数据库
-      rc = sqlite3_open(m_dbFilename.c_str(), &m_db);
-      if (rc) {
-        std::cerr << "无法打开数据库: " << sqlite3_errmsg(m_db) << std::endl;
-        std::cerr << "错误代码: " << rc << std::endl;
-        std::cerr << "系统错误: " << strerror(errno) << std::endl;
-        sqlite3_close(m_db);
-        m_db = NULL;
-        return;
-      }
-    }
+  if (rc != SQLITE_OK) {
+    std::cerr << "无法打开数据库: " << m_dbFilename << " SQLite错误: " << sqlite3_errmsg(m_db) << std::endl;
+    sqlite3_close(m_db);
+    m_db = NULL;
+    return;
   }
 
-  if (m_db) {
-    std::cerr << "成功打开数据库文件: " << m_dbFilename << std::endl;
-  }
+  // 并行运行的多个进程同时写入时，等待锁而不是立即返回SQLITE_BUSY；
+  // 每个进程只在Flush的短事务中持有写锁，等待时间通常只有几毫秒
+  sqlite3_busy_timeout(m_db, 60000);
+  // WAL模式下读写互不阻塞，写入只追加日志；配合批量写入，每批只需一次fsync
+  Execute("PRAGMA journal_mode=WAL", "设置WAL模式");
+  Execute("PRAGMA synchronous=NORMAL", "设置同步模式");
 }
 
 SimulationDatabase::~SimulationDatabase()
 {
+  Flush();
+  if (m_insertResult) {
+    sqlite3_finalize(m_insertResult);
+    m_insertResult = NULL;
+  }
+  if (m_insertNode) {
+    sqlite3_finalize(m_insertNode);
+    m_insertNode = NULL;
+  }
   if (m_db) {
     sqlite3_close(m_db);
     m_db = NULL;
@@ -92,27 +73,64 @@ std::string SimulationDatabase::GetCurrentTimestamp() const
 {
   std::time_t now = std::time(NULL);
   std::tm* timeinfo = std::localtime(&now);
-  
+
   std::ostringstream oss;
-  oss << std::setfill('0') 
+  oss << std::setfill('0')
       << std::setw(2) << timeinfo->tm_mon + 1 << "-"
       << std::setw(2) << timeinfo->tm_mday << "-"
       << std::setw(2) << timeinfo->tm_hour
       << std::setw(2) << timeinfo->tm_min
       << std::setw(2) << timeinfo->tm_sec;
-  
+
   return oss.str();
 }
 
+bool SimulationDatabase::Execute(const char* sql, const char* what)
+{
+  char* errMsg = NULL;
+  if (sqlite3_exec(m_db, sql, NULL, NULL, &errMsg) != SQLITE_OK) {
+    std::cerr << what << "失败: " << (errMsg ? errMsg : "") << std::endl;
+    sqlite3_free(errMsg);
+    return false;
+  }
+  return true;
+}
+
+bool SimulationDatabase::AddMissingColumn(const char* table, const char* column, const char* type, bool& added)
+{
+  std::string query = std::string("PRAGMA table_info(") + table + ")";
+  sqlite3_stmt* stmt = NULL;
+  if (sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK) {
+    std::cerr << "读取表结构失败: " << sqlite3_errmsg(m_db) << std::endl;
+    return false;
+  }
+  bool found = false;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    const unsigned char* name = sqlite3_column_text(stmt, 1);
+    if (name != NULL && std::strcmp(reinterpret_cast<const char*>(name), column) == 0) {
+      found = true;
+    }
+  }
+  sqlite3_finalize(stmt);
+  if (found) {
+    return true;
+  }
+  std::string alter = std::string("ALTER TABLE ") + table + " ADD COLUMN " + column + " " + type;
+  if (!Execute(alter.c_str(), "添加列")) {
+    return false;
+  }
+  added = true;
+  return true;
+}
+
 bool SimulationDatabase::InitializeDatabase()
 {
   if (!m_db) {
     std::cerr << "数据库未打开" << std::endl;
     return false;
   }
-  
-  char* errMsg = NULL;
-  std::string sql = 
+
+  const char* sql =
     "CREATE TABLE IF NOT EXISTS SimulationResults ("
     "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
     "  timestamp TEXT,"
@@ -126,17 +144,137 @@ bool SimulationDatabase::InitializeDatabase()
     "  totalSentPackets INTEGER,"
     "  totalReceivedPackets INTEGER,"
     "  overheadRatio REAL,"
-    "  successRate REAL"
+    "  successRate REAL,"
+    "  outcome TEXT,"
+    "  contributionRate REAL,"
+    "  fault TEXT,"
+    "  strategy TEXT"
+    ");"
+    "CREATE TABLE IF NOT EXISTS NodeResults ("
+    "  resultId INTEGER REFERENCES SimulationResults(id),"
+    "  nodeId INTEGER,"
+    "  sentPackets INTEGER,"
+    "  receivedPackets INTEGER,"
+    "  completed INTEGER"
     ");";
-  
-  int rc = sqlite3_exec(m_db, sql.c_str(), NULL, NULL, &errMsg);
-  
-  if (rc != SQLITE_OK) {
-    std::cerr << "SQL错误: " << errMsg << std::endl;
-    sqlite3_free(errMsg);
+  if (!Execute(sql, "创建数据表")) {
+    return false;
+  }
+  // 旧数据库没有结束方式、贡献比例、故障与方案列，补上后重建包含故障与方案的场景索引；旧行的这些列为NULL
+  bool added = false;
+  bool addedKey = false;
+  if (!AddMissingColumn("SimulationResults", "outcome", "TEXT", added) ||
+      !AddMissingColumn("SimulationResults", "contributionRate", "REAL", added) ||
+      !AddMissingColumn("SimulationResults", "fault", "TEXT", addedKey) ||
+      !AddMissingColumn("SimulationResults", "strategy", "TEXT", addedKey)) {
+    return false;
+  }
+  if (addedKey && !Execute("DROP INDEX IF EXISTS idx_results_scenario", "删除旧索引")) {
     return false;
   }
-  
+  const char* indexes =
+    "CREATE INDEX IF NOT EXISTS idx_results_scenario ON SimulationResults "
+    "  (numNodes, linkQuality, areaLength, areaWidth, areaHeight, fault, strategy, simulationRun);"
+    "CREATE INDEX IF NOT EXISTS idx_node_results ON NodeResults (resultId, nodeId);";
+  if (!Execute(indexes, "创建索引")) {
+    return false;
+  }
+
+  if (!m_insertResult) {
+    const char* insertResult =
+      "INSERT INTO SimulationResults "
+      "(timestamp, areaLength, areaWidth, areaHeight, numNodes, linkQuality, simulationRun, completionTime, totalSentPackets, totalReceivedPackets, overheadRatio, successRate, "
+      "outcome, contributionRate, fault, strategy) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+    if (sqlite3_prepare_v2(m_db, insertResult, -1, &m_insertResult, NULL) != SQLITE_OK) {
+      std::cerr << "预编译插入语句失败: " << sqlite3_errmsg(m_db) << std::endl;
+      return false;
+    }
+  }
+  if (!m_insertNode) {
+    const char* insertNode =
+      "INSERT INTO NodeResults (resultId, nodeId, sentPackets, receivedPackets, completed) "
+      "VALUES (?, ?, ?, ?, ?);";
+    if (sqlite3_prepare_v2(m_db, insertNode, -1, &m_insertNode, NULL) != SQLITE_OK) {
+      std::cerr << "预编译插入语句失败: " << sqlite3_errmsg(m_db) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// 写锁只在这里持有：仿真期间结果缓冲在内存中，攒满一批后用一个短的
+// BEGIN IMMEDIATE … COMMIT写入，其他进程的写入最多等待这一批的插入时间
+bool SimulationDatabase::Flush()
+{
+  if (m_pending.empty()) {
+    return true;
+  }
+  if (!m_db || !m_insertResult || !m_insertNode) {
+    std::cerr << "数据库未初始化" << std::endl;
+    return false;
+  }
+  if (!Execute("BEGIN IMMEDIATE", "开始事务")) {
+    return false;
+  }
+  for (uint32_t i = 0; i < m_pending.size(); i++) {
+    if (!WriteResult(m_pending[i])) {
+      sqlite3_exec(m_db, "ROLLBACK", NULL, NULL, NULL);
+      return false;
+    }
+  }
+  if (!Execute("COMMIT", "提交事务")) {
+    sqlite3_exec(m_db, "ROLLBACK", NULL, NULL, NULL);
+    return false;
+  }
+  m_pending.clear();
+  return true;
+}
+
+bool SimulationDatabase::WriteResult(const PendingResult& pending)
+{
+  sqlite3_bind_text(m_insertResult, 1, pending.timestamp.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_double(m_insertResult, 2, pending.areaLength);
+  sqlite3_bind_double(m_insertResult, 3, pending.areaWidth);
+  sqlite3_bind_double(m_insertResult, 4, pending.areaHeight);
+  sqlite3_bind_int64(m_insertResult, 5, pending.numNodes);
+  sqlite3_bind_text(m_insertResult, 6, pending.linkQuality.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(m_insertResult, 7, pending.simulationRun);
+  sqlite3_bind_double(m_insertResult, 8, pending.completionTime);
+  sqlite3_bind_int64(m_insertResult, 9, pending.totalSentPackets);
+  sqlite3_bind_int64(m_insertResult, 10, pending.totalReceivedPackets);
+  sqlite3_bind_double(m_insertResult, 11, pending.overheadRatio);
+  sqlite3_bind_double(m_insertResult, 12, pending.successRate);
+  sqlite3_bind_text(m_insertResult, 13, pending.outcome.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_double(m_insertResult, 14, pending.contributionRate);
+  sqlite3_bind_text(m_insertResult, 15, pending.fault.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(m_insertResult, 16, pending.strategy.c_str(), -1, SQLITE_TRANSIENT);
+
+  int rc = sqlite3_step(m_insertResult);
+  sqlite3_reset(m_insertResult);
+  sqlite3_clear_bindings(m_insertResult);
+  if (rc != SQLITE_DONE) {
+    std::cerr << "插入模拟结果失败: " << sqlite3_errmsg(m_db) << std::endl;
+    return false;
+  }
+  int64_t resultId = sqlite3_last_insert_rowid(m_db);
+
+  for (uint32_t i = 0; i < pending.nodes.size(); i++) {
+    const PendingNode& node = pending.nodes[i];
+    sqlite3_bind_int64(m_insertNode, 1, resultId);
+    sqlite3_bind_int64(m_insertNode, 2, node.nodeId);
+    sqlite3_bind_int64(m_insertNode, 3, node.sentPackets);
+    sqlite3_bind_int64(m_insertNode, 4, node.receivedPackets);
+    sqlite3_bind_int(m_insertNode, 5, node.completed ? 1 : 0);
+
+    rc = sqlite3_step(m_insertNode);
+    sqlite3_reset(m_insertNode);
+    sqlite3_clear_bindings(m_insertNode);
+    if (rc != SQLITE_DONE) {
+      std::cerr << "插入节点结果失败: " << sqlite3_errmsg(m_db) << std::endl;
+      return false;
+    }
+  }
   return true;
 }
 
@@ -151,51 +289,64 @@ bool SimulationDatabase::RecordSimulationResult(
   uint32_t totalSentPackets,
   uint32_t totalReceivedPackets,
   double overheadRatio,
-  double successRate)
+  double successRate,
+  const std::string& outcome,
+  double contributionRate,
+  const std::string& fault,
+  const std::string& strategy,
+  int64_t* resultId)
 {
-  if (!m_db) {
-    std::cerr << "数据库未打开" << std::endl;
+  if (!m_db || !m_insertResult || !m_insertNode) {
+    std::cerr << "数据库未初始化" << std::endl;
     return false;
   }
-  
-  // 获取当前时间戳
-  std::string timestamp = GetCurrentTimestamp();
-  
-  // 开始事务
-  char* errMsg = NULL;
-  if (sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, &errMsg) != SQLITE_OK) {
-    std::cerr << "开始事务失败: " << errMsg << std::endl;
-    sqlite3_free(errMsg);
-    return false;
+  // 攒满一批后先写入，写入失败时缓冲保留，本条结果仍然加入
+  if (m_pending.size() >= m_batchSize) {
+    Flush();
   }
-  
-  // 插入模拟结果
-  std::stringstream ss;
-  ss << "INSERT INTO SimulationResults "
-     << "(timestamp, areaLength, areaWidth, areaHeight, numNodes, linkQuality, simulationRun, completionTime, totalSentPackets, totalReceivedPackets, overheadRatio, successRate) "
-     << "VALUES ('" << timestamp << "', " 
-     << areaLength << ", " << areaWidth << ", " << areaHeight << ", "
-     << numNodes << ", '" << linkQuality << "', " << simulationRun << ", " 
-     << completionTime << ", " << totalSentPackets << ", " << totalReceivedPackets << ", "
-     << overheadRatio << ", " << successRate << ");";
-  
-  std::string sql = ss.str();
-  int rc = sqlite3_exec(m_db, sql.c_str(), NULL, NULL, &errMsg);
-  
-  if (rc != SQLITE_OK) {
-    std::cerr << "插入模拟结果失败: " << errMsg << std::endl;
-    sqlite3_free(errMsg);
-    sqlite3_exec(m_db, "ROLLBACK", NULL, NULL, NULL);
-    return false;
+
+  PendingResult pending;
+  // 获取当前时间戳
+  pending.timestamp = GetCurrentTimestamp();
+  pending.areaLength = areaLength;
+  pending.areaWidth = areaWidth;
+  pending.areaHeight = areaHeight;
+  pending.numNodes = numNodes;
+  pending.linkQuality = linkQuality;
+  pending.simulationRun = simulationRun;
+  pending.completionTime = completionTime;
+  pending.totalSentPackets = totalSentPackets;
+  pending.totalReceivedPackets = totalReceivedPackets;
+  pending.overheadRatio = overheadRatio;
+  pending.successRate = successRate;
+  pending.outcome = outcome;
+  pending.contributionRate = contributionRate;
+  // 与CSV一致，没有故障记为none
+  pending.fault = fault.empty() ? "none" : fault;
+  pending.strategy = strategy;
+  m_pending.push_back(pending);
+  if (resultId != NULL) {
+    *resultId = m_pending.size() - 1;
   }
-  
-  // 提交事务
-  if (sqlite3_exec(m_db, "COMMIT", NULL, NULL, &errMsg) != SQLITE_OK) {
-    std::cerr << "提交事务失败: " << errMsg << std::endl;
-    sqlite3_free(errMsg);
-    sqlite3_exec(m_db, "ROLLBACK", NULL, NULL, NULL);
+  return true;
+}
+
+bool SimulationDatabase::RecordNodeResult(
+  int64_t resultId,
+  uint32_t nodeId,
+  uint32_t sentPackets,
+  uint32_t receivedPackets,
+  bool completed)
+{
+  if (resultId < 0 || resultId >= (int64_t)m_pending.size()) {
+    std::cerr << "节点结果所属的模拟结果已经写入或不存在: " << resultId << std::endl;
     return false;
   }
-  
+  PendingNode node;
+  node.nodeId = nodeId;
+  node.sentPackets = sentPackets;
+  node.receivedPackets = receivedPackets;
+  node.completed = completed;
+  m_pending[resultId].nodes.push_back(node);
   return true;
-} 
\ No newline at end of file
+}
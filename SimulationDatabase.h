@@ -2,6 +2,7 @@
 #define SIMULATION_DATABASE_H
 
 #include <string>
+#include <vector>
 #include <sqlite3.h>
 #include "ns3/core-module.h"
 
@@ -10,15 +11,18 @@ using namespace ns3;
 class SimulationDatabase
 {
 public:
-  // 构造函数
+  // 构造函数，dbFile为数据库文件路径，所在目录不存在时自动创建
   SimulationDatabase(const std::string& dbFile);
-  // 析构函数
+  // 析构函数，提交未写入的数据
   ~SimulationDatabase();
-  
-  // 初始化数据库表结构
+
+  // 初始化数据库表结构、索引和预编译语句
   bool InitializeDatabase();
-  
-  // 记录模拟结果
+
+  // 内存中缓冲的模拟结果数，攒满后在一个短事务中一次写入；节点结果随所属的模拟结果一起写入
+  void SetBatchSize(uint32_t batchSize) { m_batchSize = batchSize > 0 ? batchSize : 1; }
+
+  // 记录模拟结果，resultId返回该结果在当前批中的序号，用于关联节点结果（写入时换成行id）
   bool RecordSimulationResult(
     double areaLength,
     double areaWidth,
@@ -30,15 +34,68 @@ public:
     uint32_t totalSentPackets,
     uint32_t totalReceivedPackets,
     double overheadRatio,
-    double successRate
+    double successRate,
+    const std::string& outcome,
+    double contributionRate,
+    const std::string& fault,
+    const std::string& strategy,
+    int64_t* resultId = NULL
+  );
+
+  // 记录单个节点的结果
+  bool RecordNodeResult(
+    int64_t resultId,
+    uint32_t nodeId,
+    uint32_t sentPackets,
+    uint32_t receivedPackets,
+    bool completed
   );
-  
+
+  // 在一个事务中写入缓冲的全部结果；失败时保留缓冲，下次再试
+  bool Flush();
+
 private:
   // 获取当前时间戳（月-日-时分秒）
   std::string GetCurrentTimestamp() const;
-  
+  // 执行一条不带结果的SQL
+  bool Execute(const char* sql, const char* what);
+  // 旧数据库的表中没有column时补上，added返回是否补了
+  bool AddMissingColumn(const char* table, const char* column, const char* type, bool& added);
+  struct PendingNode {
+    uint32_t nodeId;
+    uint32_t sentPackets;
+    uint32_t receivedPackets;
+    bool completed;
+  };
+  struct PendingResult {
+    std::string timestamp;
+    double areaLength;
+    double areaWidth;
+    double areaHeight;
+    uint32_t numNodes;
+    std::string linkQuality;
+    uint32_t simulationRun;
+    double completionTime;
+    uint32_t totalSentPackets;
+    uint32_t totalReceivedPackets;
+    double overheadRatio;
+    double successRate;
+    std::string outcome;
+    double contributionRate;
+    std::string fault;
+    std::string strategy;
+    std::vector<PendingNode> nodes;
+  };
+
+  // 写入一个缓冲的结果及其节点结果，调用时处于事务中
+  bool WriteResult(const PendingResult& pending);
+
   sqlite3* m_db;               // SQLite数据库连接
   std::string m_dbFilename;    // 数据库文件名
+  sqlite3_stmt* m_insertResult; // 插入模拟结果的预编译语句
+  sqlite3_stmt* m_insertNode;   // 插入节点结果的预编译语句
+  uint32_t m_batchSize;        // 每个事务的模拟结果数
+  std::vector<PendingResult> m_pending; // 尚未写入的模拟结果
 };
 
-#endif /* SIMULATION_DATABASE_H */ 
\ No newline at end of file
+#endif /* SIMULATION_DATABASE_H */
@@ -0,0 +1,349 @@
+/*
+ * WorkerPool.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "WorkerPool.h"
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// 向管道完整写入一段数据
+static bool WriteAll(int fd, const std::string& data)
+{
+  const char* p = data.c_str();
+  size_t left = data.size();
+  while (left > 0) {
+    ssize_t n = write(fd, p, left);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    p += n;
+    left -= n;
+  }
+  return true;
+}
+
+WorkerPool::WorkerPool(uint32_t numWorkers, ScenarioRunner runner)
+  : m_numWorkers(numWorkers > 0 ? numWorkers : 1),
+    m_maxRetries(2),
+    m_runner(runner),
+    m_exitHook(NULL),
+    m_scenarios(NULL),
+    m_finished(0),
+    m_failed(0)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+  for (uint32_t i = 0; i < m_workers.size(); i++) {
+    CloseWorker(m_workers[i]);
+  }
+}
+
+// 工作进程主循环：逐行读取场景序号，运行后把结果写回父进程
+void WorkerPool::WorkerLoop(int taskFd, int resultFd)
+{
+  FILE* tasks = fdopen(taskFd, "r");
+  if (tasks == NULL) {
+    return;
+  }
+  char line[64];
+  while (fgets(line, sizeof(line), tasks) != NULL) {
+    uint32_t index = std::strtoul(line, NULL, 10);
+    if (index >= m_scenarios->size()) {
+      continue;
+    }
+    SimulationResult result;
+    std::ostringstream reply;
+    if (m_runner((*m_scenarios)[index], result)) {
+      reply << "OK " << index << " " << result.ToCsv() << "\n";
+    } else {
+      reply << "FAIL " << index << "\n";
+    }
+    if (!WriteAll(resultFd, reply.str())) {
+      break;
+    }
+  }
+  fclose(tasks);
+}
+
+bool WorkerPool::SpawnWorker(Worker& worker)
+{
+  int taskPipe[2];
+  int resultPipe[2];
+  if (pipe(taskPipe) != 0) {
+    std::cerr << "创建任务管道失败: " << strerror(errno) << std::endl;
+    return false;
+  }
+  if (pipe(resultPipe) != 0) {
+    std::cerr << "创建结果管道失败: " << strerror(errno) << std::endl;
+    close(taskPipe[0]);
+    close(taskPipe[1]);
+    return false;
+  }
+
+  // fork前刷新缓冲区，避免子进程重复输出
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(NULL);
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    std::cerr << "fork失败: " << strerror(errno) << std::endl;
+    close(taskPipe[0]);
+    close(taskPipe[1]);
+    close(resultPipe[0]);
+    close(resultPipe[1]);
+    return false;
+  }
+
+  if (pid == 0) {
+    // 子进程：关闭其他工作进程的管道，否则父进程无法通过EOF发现工作进程退出
+    for (uint32_t i = 0; i < m_workers.size(); i++) {
+      if (m_workers[i].taskFd >= 0) {
+        close(m_workers[i].taskFd);
+      }
+      if (m_workers[i].resultFd >= 0) {
+        close(m_workers[i].resultFd);
+      }
+    }
+    close(taskPipe[1]);
+    close(resultPipe[0]);
+    signal(SIGPIPE, SIG_DFL);
+    WorkerLoop(taskPipe[0], resultPipe[1]);
+    if (m_exitHook != NULL) {
+      m_exitHook();
+    }
+    close(resultPipe[1]);
+    std::cout.flush();
+    _exit(0);
+  }
+
+  close(taskPipe[0]);
+  close(resultPipe[1]);
+  worker.pid = pid;
+  worker.taskFd = taskPipe[1];
+  worker.resultFd = resultPipe[0];
+  worker.task = -1;
+  worker.buffer.clear();
+  return true;
+}
+
+// 向空闲工作进程下发一个场景
+bool WorkerPool::Dispatch(Worker& worker)
+{
+  if (worker.pid <= 0 || worker.task >= 0 || m_pending.empty()) {
+    return false;
+  }
+  uint32_t index = m_pending.front();
+  m_pending.pop_front();
+  std::ostringstream ss;
+  ss << index << "\n";
+  if (!WriteAll(worker.taskFd, ss.str())) {
+    // 工作进程已经退出，场景放回队首，等待EOF时回收
+    m_pending.push_front(index);
+    return false;
+  }
+  worker.task = index;
+  return true;
+}
+
+void WorkerPool::HandleResultLine(Worker& worker, const std::string& line, ResultSink sink, void* context)
+{
+  std::istringstream ss(line);
+  std::string status;
+  int32_t index = -1;
+  ss >> status >> index;
+  if ((status != "OK" && status != "FAIL") || index < 0 || index != worker.task) {
+    // 工作进程的输出已经不可信，按崩溃处理：结束并回收它，正在执行的场景重新排队，
+    // 下一轮循环补充新的工作进程
+    std::cerr << "工作进程" << worker.pid << "返回了无法识别的结果: " << line << std::endl;
+    kill(worker.pid, SIGKILL);
+    ReapWorker(worker);
+    return;
+  }
+  worker.task = -1;
+
+  if (status == "OK") {
+    std::string csv;
+    std::getline(ss, csv);
+    SimulationResult result;
+    if (result.FromCsv(csv.substr(csv.find_first_not_of(' ')))) {
+      result.scenario = (*m_scenarios)[index];
+      sink(result, context);
+      m_finished++;
+      return;
+    }
+  }
+
+  // 场景执行失败，重新排队
+  m_attempts[index]++;
+  if (m_attempts[index] > m_maxRetries) {
+    std::cerr << "场景" << (*m_scenarios)[index].Label() << "失败" << m_attempts[index] << "次，放弃" << std::endl;
+    m_failed++;
+    m_finished++;
+  } else {
+    m_pending.push_back(index);
+  }
+}
+
+// 回收已退出的工作进程，正在执行的场景视为失败并重试
+void WorkerPool::ReapWorker(Worker& worker)
+{
+  int status = 0;
+  waitpid(worker.pid, &status, 0);
+  if (worker.task >= 0) {
+    uint32_t index = worker.task;
+    std::cerr << "工作进程" << worker.pid << "在运行场景" << (*m_scenarios)[index].Label() << "时异常退出";
+    if (WIFSIGNALED(status)) {
+      std::cerr << " (信号" << WTERMSIG(status) << ")";
+    } else if (WIFEXITED(status)) {
+      std::cerr << " (退出码" << WEXITSTATUS(status) << ")";
+    }
+    std::cerr << std::endl;
+
+    m_attempts[index]++;
+    if (m_attempts[index] > m_maxRetries) {
+      std::cerr << "场景" << (*m_scenarios)[index].Label() << "失败" << m_attempts[index] << "次，放弃" << std::endl;
+      m_failed++;
+      m_finished++;
+    } else {
+      m_pending.push_back(index);
+    }
+  }
+  worker.pid = -1;
+  worker.task = -1;
+  if (worker.taskFd >= 0) {
+    close(worker.taskFd);
+    worker.taskFd = -1;
+  }
+  if (worker.resultFd >= 0) {
+    close(worker.resultFd);
+    worker.resultFd = -1;
+  }
+}
+
+void WorkerPool::CloseWorker(Worker& worker)
+{
+  if (worker.taskFd >= 0) {
+    close(worker.taskFd);
+    worker.taskFd = -1;
+  }
+  if (worker.resultFd >= 0) {
+    close(worker.resultFd);
+    worker.resultFd = -1;
+  }
+  if (worker.pid > 0) {
+    int status = 0;
+    waitpid(worker.pid, &status, 0);
+    worker.pid = -1;
+  }
+}
+
+uint32_t WorkerPool::Run(const std::vector<ScenarioConfig>& scenarios, ResultSink sink, void* context)
+{
+  m_scenarios = &scenarios;
+  m_pending.clear();
+  for (uint32_t i = 0; i < scenarios.size(); i++) {
+    m_pending.push_back(i);
+  }
+  m_attempts.assign(scenarios.size(), 0);
+  m_finished = 0;
+  m_failed = 0;
+
+  // 工作进程崩溃后写任务管道会触发SIGPIPE，父进程改为检查返回值
+  void (*oldHandler)(int) = signal(SIGPIPE, SIG_IGN);
+
+  uint32_t numWorkers = m_numWorkers;
+  if (numWorkers > scenarios.size()) {
+    numWorkers = scenarios.size();
+  }
+  Worker empty;
+  empty.pid = -1;
+  empty.taskFd = -1;
+  empty.resultFd = -1;
+  empty.task = -1;
+  m_workers.assign(numWorkers, empty);
+
+  while (m_finished < scenarios.size()) {
+    // 补充退出的工作进程，并给空闲的工作进程派发任务
+    for (uint32_t i = 0; i < m_workers.size(); i++) {
+      if (m_workers[i].pid <= 0 && !m_pending.empty()) {
+        SpawnWorker(m_workers[i]);
+      }
+      Dispatch(m_workers[i]);
+    }
+
+    std::vector<struct pollfd> fds;
+    std::vector<uint32_t> owners;
+    for (uint32_t i = 0; i < m_workers.size(); i++) {
+      if (m_workers[i].pid > 0) {
+        struct pollfd p;
+        p.fd = m_workers[i].resultFd;
+        p.events = POLLIN;
+        p.revents = 0;
+        fds.push_back(p);
+        owners.push_back(i);
+      }
+    }
+    if (fds.empty()) {
+      std::cerr << "没有可用的工作进程，剩余" << m_pending.size() << "个场景未运行" << std::endl;
+      m_failed += m_pending.size();
+      break;
+    }
+
+    int ready = poll(&fds[0], fds.size(), 1000);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "poll失败: " << strerror(errno) << std::endl;
+      break;
+    }
+
+    for (uint32_t k = 0; k < fds.size(); k++) {
+      if (fds[k].revents == 0) {
+        continue;
+      }
+      Worker& worker = m_workers[owners[k]];
+      char buf[4096];
+      ssize_t n = read(worker.resultFd, buf, sizeof(buf));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        ReapWorker(worker);
+        continue;
+      }
+      worker.buffer.append(buf, n);
+      std::string::size_type nl;
+      while (worker.pid > 0 && (nl = worker.buffer.find('\n')) != std::string::npos) {
+        std::string line = worker.buffer.substr(0, nl);
+        worker.buffer.erase(0, nl + 1);
+        HandleResultLine(worker, line, sink, context);
+      }
+    }
+  }
+
+  // 关闭任务管道，工作进程读到EOF后退出
+  for (uint32_t i = 0; i < m_workers.size(); i++) {
+    CloseWorker(m_workers[i]);
+  }
+  m_workers.clear();
+  signal(SIGPIPE, oldHandler);
+  return m_failed;
+}
@@ -0,0 +1,76 @@
+/*
+ * WorkerPool.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "Scenario.h"
+#include <deque>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <stdint.h>
+
+// 在子进程中运行单个场景，成功返回true
+typedef bool (*ScenarioRunner)(const ScenarioConfig& scenario, SimulationResult& result);
+// 父进程收到一个结果时调用，所有结果在父进程中串行写出
+typedef void (*ResultSink)(const SimulationResult& result, void* context);
+// 工作进程正常退出前调用，用于提交数据库等进程内的缓冲
+typedef void (*WorkerExitHook)();
+
+/**
+ * 基于fork的多进程场景执行池
+ *
+ * ns-3的仿真器是单线程的，父进程fork出若干工作进程，通过管道逐个下发场景序号，
+ * 工作进程运行完毕后把结果以CSV行的形式写回。工作进程崩溃时父进程回收它，
+ * 把它正在执行的场景重新排队（最多重试maxRetries次），并补充新的工作进程。
+ */
+class WorkerPool
+{
+public:
+  WorkerPool(uint32_t numWorkers, ScenarioRunner runner);
+  ~WorkerPool();
+
+  // 单个场景失败后的最大重试次数
+  void SetMaxRetries(uint32_t retries) { m_maxRetries = retries; }
+  // 工作进程退出前的回调
+  void SetWorkerExitHook(WorkerExitHook hook) { m_exitHook = hook; }
+
+  // 运行所有场景，返回最终失败的场景数
+  uint32_t Run(const std::vector<ScenarioConfig>& scenarios, ResultSink sink, void* context);
+
+private:
+  struct Worker
+  {
+    pid_t pid;
+    int taskFd;         ///< 父进程写入场景序号
+    int resultFd;       ///< 父进程读取结果
+    int32_t task;       ///< 正在执行的场景序号，-1表示空闲
+    std::string buffer; ///< 未读完整的结果行
+  };
+
+  bool SpawnWorker(Worker& worker);
+  void WorkerLoop(int taskFd, int resultFd);
+  bool Dispatch(Worker& worker);
+  void HandleResultLine(Worker& worker, const std::string& line, ResultSink sink, void* context);
+  void ReapWorker(Worker& worker);
+  void CloseWorker(Worker& worker);
+
+  uint32_t m_numWorkers;
+  uint32_t m_maxRetries;
+  ScenarioRunner m_runner;
+  WorkerExitHook m_exitHook;
+
+  const std::vector<ScenarioConfig>* m_scenarios;
+  std::vector<Worker> m_workers;
+  std::deque<uint32_t> m_pending;   ///< 待执行的场景序号
+  std::vector<uint32_t> m_attempts; ///< 每个场景已失败的次数
+  uint32_t m_finished;              ///< 已经结束（成功或放弃）的场景数
+  uint32_t m_failed;                ///< 放弃的场景数
+};
+
+#endif /* WORKER_POOL_H */
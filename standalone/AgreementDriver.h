@@ -0,0 +1,88 @@
+/*
+ * AgreementDriver.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef AGREEMENT_DRIVER_H
+#define AGREEMENT_DRIVER_H
+
+#include "RegkaProtocol.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * 仿真器提供给协商驱动的操作
+ */
+class DriverContext
+{
+public:
+  virtual ~DriverContext() {}
+  virtual double Now() const = 0;
+  // 不在运行的节点不收包、不处理定时，初始时全部节点都在运行
+  virtual void SetRunning(uint32_t node, bool running) = 0;
+  // delay秒后以tag调用驱动的OnEvent
+  virtual void ScheduleEvent(double delay, uint32_t tag) = 0;
+};
+
+/**
+ * 协商驱动：MicroSimulator每个节点上运行的协议对象（RegkaProtocol、SessionMux、ClusterAgreement、
+ * BaselineProtocol等）按模式各由一个驱动持有，仿真器只负责事件、发送队列与链路，
+ * 通过本接口启动节点、转交定时与收到的消息，并查询完成情况与统计。
+ * 协议对象经RegkaHost（每个节点一个）发送消息与安排定时。
+ */
+class AgreementDriver
+{
+public:
+  enum CheckResult
+  {
+    CHECK_NODES,     ///< 按所有存活节点IsCompleted判断完成
+    CHECK_CONTINUE,  ///< 由驱动判断，尚未结束
+    CHECK_FINISHED   ///< 由驱动判断，已结束
+  };
+
+  virtual ~AgreementDriver() {}
+
+  // 为每个节点建立协议对象，hosts[i]为节点i的宿主；Run开始时调用一次
+  virtual void Initialize(DriverContext* context, const std::vector<RegkaHost*>& hosts, double periodicInterval) = 0;
+  virtual void Start(uint32_t node) = 0;
+  virtual void OnTimer(uint32_t node) = 0;
+  virtual void OnReceive(uint32_t node, uint32_t from, const std::string& content) = 0;
+  // 节点交给发送队列的消息，返回附加的填充字节数
+  virtual uint32_t Transmit(uint32_t node, const std::string& content) = 0;
+  virtual bool IsCompleted(uint32_t node) const = 0;
+  virtual uint32_t GetSentCount(uint32_t node) const = 0;
+  virtual uint32_t GetReceivedCount(uint32_t node) const = 0;
+  // 节点已知与应知的密钥贡献数，未崩溃节点的总和之比为contributionRate
+  virtual uint64_t CountLearnedContributions(uint32_t node) const = 0;
+  virtual uint64_t CountExpectedContributions(uint32_t node) const = 0;
+  // 节点协议状态（矩阵等）占用的堆内存字节数
+  virtual uint64_t GetStateBytes(uint32_t node) const = 0;
+
+  // 节点的密钥计算，不执行密钥计算的模式返回NULL
+  virtual const GroupKeyComputation* GetComputation(uint32_t /*node*/) const { return NULL; }
+  // 节点得到组密钥（计算结束）的时刻，启用密钥计算时仿真器等到所有节点的这一时刻才结束
+  virtual double GetKeyReadyTime(uint32_t /*node*/) const { return 0; }
+  // 链路给出静态可达关系neighbors时，running中的节点已不可能再获得新贡献；不能判断时返回false
+  virtual bool IsProgressExhausted(const std::vector<std::vector<uint32_t> >& /*neighbors*/,
+                                   const std::vector<bool>& /*running*/) const { return false; }
+  // 每次检查时调用；由驱动判断时，首次达成一致的检查把completionTime设为该时刻减1秒
+  virtual CheckResult Check(double& /*completionTime*/) { return CHECK_NODES; }
+  // 下次检查的间隔，默认2秒前为0.01秒、之后为0.1秒
+  virtual double GetCheckInterval(double now) const { return now < 2.0 ? 0.01 : 0.1; }
+  // 成功率 (%)，默认为完成的存活节点占存活节点的比例
+  virtual double GetSuccessRate(uint32_t completed, uint32_t survivors) const
+  {
+    return survivors == 0 ? 0 : static_cast<double>(completed) / survivors * 100;
+  }
+  // ScheduleEvent安排的事件到时调用
+  virtual void OnEvent(uint32_t /*tag*/) {}
+  // 节点崩溃时调用，之后该节点不再收发与定时
+  virtual void OnCrash(uint32_t /*node*/) {}
+  // 运行结束时调用
+  virtual void Finish() {}
+};
+
+#endif /* AGREEMENT_DRIVER_H */
@@ -0,0 +1,24 @@
+/*
+ * BaselineDriver.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "BaselineDriver.h"
+
+BaselineDriver::BaselineDriver(BaselineProtocol::Scheme scheme)
+  : m_scheme(scheme)
+{
+}
+
+void BaselineDriver::Initialize(DriverContext* /*context*/, const std::vector<RegkaHost*>& hosts,
+                                double periodicInterval)
+{
+  m_nodes.resize(hosts.size());
+  for (uint32_t i = 0; i < m_nodes.size(); i++) {
+    m_nodes[i].Initialize(m_scheme, m_nodes.size(), i);
+    m_nodes[i].SetHost(hosts[i]);
+    m_nodes[i].SetPeriodicInterval(periodicInterval);
+  }
+}
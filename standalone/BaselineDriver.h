@@ -0,0 +1,46 @@
+/*
+ * BaselineDriver.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef BASELINE_DRIVER_H
+#define BASELINE_DRIVER_H
+
+#include "AgreementDriver.h"
+#include "BaselineProtocol.h"
+#include <vector>
+
+/**
+ * 基线方案：每个节点运行一个BaselineProtocol代替RE-GKA，作为对照。
+ * 不支持成员变化；启用密钥计算时等到所有节点得到组密钥才结束。
+ */
+class BaselineDriver : public AgreementDriver
+{
+public:
+  explicit BaselineDriver(BaselineProtocol::Scheme scheme);
+
+  virtual void Initialize(DriverContext* context, const std::vector<RegkaHost*>& hosts, double periodicInterval);
+  virtual void Start(uint32_t node) { m_nodes[node].Start(); }
+  virtual void OnTimer(uint32_t node) { m_nodes[node].OnTimer(); }
+  virtual void OnReceive(uint32_t node, uint32_t from, const std::string& content)
+  {
+    m_nodes[node].OnReceive(from, content);
+  }
+  virtual uint32_t Transmit(uint32_t node, const std::string& content) { return m_nodes[node].Transmit(content); }
+  virtual bool IsCompleted(uint32_t node) const { return m_nodes[node].IsCompleted(); }
+  virtual uint32_t GetSentCount(uint32_t node) const { return m_nodes[node].GetSentCount(); }
+  virtual uint32_t GetReceivedCount(uint32_t node) const { return m_nodes[node].GetReceivedCount(); }
+  virtual uint64_t CountLearnedContributions(uint32_t node) const { return m_nodes[node].CountLearnedContributions(); }
+  virtual uint64_t CountExpectedContributions(uint32_t node) const { return m_nodes[node].CountExpectedContributions(); }
+  virtual uint64_t GetStateBytes(uint32_t node) const { return m_nodes[node].GetStateBytes(); }
+  virtual const GroupKeyComputation* GetComputation(uint32_t node) const { return &m_nodes[node].GetComputation(); }
+  virtual double GetKeyReadyTime(uint32_t node) const { return m_nodes[node].GetKeyReadyTime(); }
+
+private:
+  BaselineProtocol::Scheme m_scheme;
+  std::vector<BaselineProtocol> m_nodes;
+};
+
+#endif /* BASELINE_DRIVER_H */
@@ -0,0 +1,24 @@
+/*
+ * ClusterDriver.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "ClusterDriver.h"
+
+ClusterDriver::ClusterDriver(const ClusterPlan& plan)
+  : m_plan(plan)
+{
+}
+
+void ClusterDriver::Initialize(DriverContext* /*context*/, const std::vector<RegkaHost*>& hosts,
+                               double periodicInterval)
+{
+  m_nodes.resize(hosts.size());
+  for (uint32_t i = 0; i < m_nodes.size(); i++) {
+    m_nodes[i].Initialize(m_plan, i);
+    m_nodes[i].SetHost(hosts[i]);
+    m_nodes[i].SetPeriodicInterval(periodicInterval);
+  }
+}
@@ -0,0 +1,44 @@
+/*
+ * ClusterDriver.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef CLUSTER_DRIVER_H
+#define CLUSTER_DRIVER_H
+
+#include "AgreementDriver.h"
+#include "ClusterAgreement.h"
+#include <vector>
+
+/**
+ * 分簇：每个节点运行一个ClusterAgreement（两级协商），所有节点两级都完成时结束。
+ * 不支持成员变化与密钥计算。
+ */
+class ClusterDriver : public AgreementDriver
+{
+public:
+  explicit ClusterDriver(const ClusterPlan& plan);
+
+  virtual void Initialize(DriverContext* context, const std::vector<RegkaHost*>& hosts, double periodicInterval);
+  virtual void Start(uint32_t node) { m_nodes[node].Start(); }
+  virtual void OnTimer(uint32_t node) { m_nodes[node].OnTimer(); }
+  virtual void OnReceive(uint32_t node, uint32_t from, const std::string& content)
+  {
+    m_nodes[node].OnReceive(from, content);
+  }
+  virtual uint32_t Transmit(uint32_t node, const std::string& content) { return m_nodes[node].Transmit(content); }
+  virtual bool IsCompleted(uint32_t node) const { return m_nodes[node].IsCompleted(); }
+  virtual uint32_t GetSentCount(uint32_t node) const { return m_nodes[node].GetSentCount(); }
+  virtual uint32_t GetReceivedCount(uint32_t node) const { return m_nodes[node].GetReceivedCount(); }
+  virtual uint64_t CountLearnedContributions(uint32_t node) const { return m_nodes[node].CountLearnedContributions(); }
+  virtual uint64_t CountExpectedContributions(uint32_t node) const { return m_nodes[node].CountExpectedContributions(); }
+  virtual uint64_t GetStateBytes(uint32_t node) const { return m_nodes[node].GetMatrixBytes(); }
+
+private:
+  ClusterPlan m_plan;
+  std::vector<ClusterAgreement> m_nodes;
+};
+
+#endif /* CLUSTER_DRIVER_H */
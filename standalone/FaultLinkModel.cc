@@ -0,0 +1,56 @@
+/*
+ * FaultLinkModel.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "FaultLinkModel.h"
+
+FaultLinkModel::FaultLinkModel(LinkModel* base, const FaultPlan& plan, const std::vector<MicroPosition>& positions,
+                               const std::string& baseQuality)
+  : m_base(base),
+    m_plan(plan),
+    m_positions(positions),
+    m_baseQuality(baseQuality),
+    m_blocked(0)
+{
+}
+
+void FaultLinkModel::Transmit(uint32_t from, uint32_t destination, uint32_t bytes, double time,
+                              std::vector<std::pair<uint32_t, double> >& deliveries)
+{
+  LinkModel* model = m_base;
+  std::string quality = m_plan.GetQuality(time, m_baseQuality);
+  if (quality != m_baseQuality) {
+    std::map<std::string, LinkModel*>::const_iterator it = m_degraded.find(quality);
+    if (it != m_degraded.end()) {
+      model = it->second;
+    }
+  }
+  m_candidates.clear();
+  model->Transmit(from, destination, bytes, time, m_candidates);
+
+  const MicroPosition& sender = m_positions[from];
+  double fromPosition[3] = { sender.x, sender.y, sender.z };
+  for (uint32_t k = 0; k < m_candidates.size(); k++) {
+    const MicroPosition& receiver = m_positions[m_candidates[k].first];
+    double toPosition[3] = { receiver.x, receiver.y, receiver.z };
+    if (m_plan.IsLinkBlocked(from, m_candidates[k].first, fromPosition, toPosition, time)) {
+      m_blocked++;
+    } else {
+      deliveries.push_back(m_candidates[k]);
+    }
+  }
+}
+
+const std::vector<std::vector<uint32_t> >* FaultLinkModel::GetStaticNeighbors(double time) const
+{
+  const std::vector<FaultEvent>& events = m_plan.GetEvents();
+  for (uint32_t k = 0; k < events.size(); k++) {
+    if (events[k].type == FaultEvent::DEGRADE && (events[k].end < 0 || events[k].end > time)) {
+      return NULL;
+    }
+  }
+  return m_base->GetStaticNeighbors(time);
+}
@@ -0,0 +1,53 @@
+/*
+ * FaultLinkModel.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef FAULT_LINK_MODEL_H
+#define FAULT_LINK_MODEL_H
+
+#include "MicroSimulator.h"
+#include "FaultPlan.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * 在另一个链路模型上按故障计划注入链路故障
+ *
+ * degrade生效时改用对应链路质量的模型决定收到与否及时延，没有设置该质量的模型时沿用原模型；
+ * 之后丢弃被blackout、partition或崩溃隔断的接收方。节点位置是静态的，partition按初始位置分组。
+ * 节点崩溃本身（停止收发与定时）由MicroSimulator::AddCrash安排。
+ */
+class FaultLinkModel : public LinkModel
+{
+public:
+  // base与之后设置的模型都不属于本类
+  FaultLinkModel(LinkModel* base, const FaultPlan& plan, const std::vector<MicroPosition>& positions,
+                 const std::string& baseQuality);
+
+  // 链路质量变为quality时使用model
+  void SetDegradedModel(const std::string& quality, LinkModel* model) { m_degraded[quality] = model; }
+
+  virtual void Transmit(uint32_t from, uint32_t destination, uint32_t bytes, double time,
+                        std::vector<std::pair<uint32_t, double> >& deliveries);
+  virtual double GetAirtime(uint32_t bytes) const { return m_base->GetAirtime(bytes); }
+  // 故障只会隔断链路，沿用原模型的可达关系；之后还有degrade生效时换用的模型可能更远，返回NULL
+  virtual const std::vector<std::vector<uint32_t> >* GetStaticNeighbors(double time) const;
+
+  // 因链路故障丢弃的接收数
+  uint64_t GetBlockedCount() const { return m_blocked; }
+
+private:
+  LinkModel* m_base;
+  const FaultPlan& m_plan;
+  std::vector<MicroPosition> m_positions;
+  std::string m_baseQuality;
+  std::map<std::string, LinkModel*> m_degraded;
+  std::vector<std::pair<uint32_t, double> > m_candidates;
+  uint64_t m_blocked;
+};
+
+#endif /* FAULT_LINK_MODEL_H */
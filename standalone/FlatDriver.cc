@@ -0,0 +1,286 @@
+/*
+ * FlatDriver.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "FlatDriver.h"
+#include <algorithm>
+#include <map>
+
+FlatDriver::FlatDriver(uint32_t numNodes)
+  : m_nodes(numNodes),
+    m_context(NULL),
+    m_members(numNodes, true),
+    m_fullRekey(false),
+    m_pendingEvents(0),
+    m_rekeying(false),
+    m_fastCheckUntil(0)
+{
+}
+
+void FlatDriver::AddMembershipEvent(double time, uint32_t node, bool join)
+{
+  MembershipEvent event;
+  event.time = time;
+  event.node = node;
+  event.join = join;
+  m_membershipEvents.push_back(event);
+}
+
+void FlatDriver::Initialize(DriverContext* context, const std::vector<RegkaHost*>& hosts, double periodicInterval)
+{
+  m_context = context;
+  uint32_t numNodes = m_nodes.size();
+  for (uint32_t i = 0; i < numNodes; i++) {
+    m_nodes[i].SetHost(hosts[i]);
+    m_nodes[i].Initialize(numNodes, i);
+  }
+
+  // 第一次变化为加入的节点不在初始成员中
+  std::vector<bool> seen(numNodes, false);
+  for (uint32_t k = 0; k < m_membershipEvents.size(); k++) {
+    const MembershipEvent& event = m_membershipEvents[k];
+    if (event.node >= numNodes) {
+      continue;
+    }
+    if (!seen[event.node]) {
+      seen[event.node] = true;
+      m_members[event.node] = !event.join;
+      m_context->SetRunning(event.node, !event.join);
+    }
+    m_context->ScheduleEvent(event.time - m_context->Now(), k);
+    m_pendingEvents++;
+  }
+  // 初始成员的矩阵覆盖所有槽位；后加入的节点只知道编号不大于自己的槽位，收到更大的矩阵时再扩大
+  for (uint32_t i = 0; i < numNodes; i++) {
+    if (!m_members[i]) {
+      m_nodes[i].Initialize(i + 1, i);
+      for (uint32_t j = 0; j < i; j++) {
+        m_nodes[i].SetMember(j, false);
+      }
+      continue;
+    }
+    for (uint32_t j = 0; j < numNodes; j++) {
+      if (!m_members[j]) {
+        m_nodes[i].SetMember(j, false);
+      }
+    }
+  }
+  for (uint32_t i = 0; i < numNodes; i++) {
+    m_nodes[i].SetPeriodicInterval(periodicInterval);
+    m_nodes[i].SetFullRekey(m_fullRekey);
+  }
+}
+
+uint64_t FlatDriver::CountLearnedContributions(uint32_t node) const
+{
+  // 只统计实际成员；后加入的节点的矩阵可能还没有扩大到所有槽位
+  if (!m_members[node]) {
+    return 0;
+  }
+  const KeyMatrix& matrix = m_nodes[node].GetKeyMatrix();
+  uint64_t learned = 0;
+  for (uint32_t j = 0; j < matrix.GetNetworkSize(); j++) {
+    if (m_members[j] && matrix.IsActive(j) && matrix.HasKeyContribution(node, j)) {
+      learned++;
+    }
+  }
+  return learned;
+}
+
+uint64_t FlatDriver::CountExpectedContributions(uint32_t node) const
+{
+  return m_members[node] ? std::count(m_members.begin(), m_members.end(), true) : 0;
+}
+
+bool FlatDriver::IsProgressExhausted(const std::vector<std::vector<uint32_t> >& neighbors,
+                                     const std::vector<bool>& running) const
+{
+  // 存活节点按可达关系划分连通分量（并查集）
+  uint32_t numNodes = m_nodes.size();
+  std::vector<uint32_t> parent(numNodes);
+  for (uint32_t i = 0; i < numNodes; i++) {
+    parent[i] = i;
+  }
+  for (uint32_t i = 0; i < numNodes; i++) {
+    if (!running[i]) {
+      continue;
+    }
+    const std::vector<uint32_t>& reachable = neighbors[i];
+    for (uint32_t k = 0; k < reachable.size(); k++) {
+      uint32_t j = reachable[k];
+      if (!running[j]) {
+        continue;
+      }
+      uint32_t a = i;
+      while (parent[a] != a) {
+        a = parent[a] = parent[parent[a]];
+      }
+      uint32_t b = j;
+      while (parent[b] != b) {
+        b = parent[b] = parent[parent[b]];
+      }
+      parent[std::max(a, b)] = std::min(a, b);
+    }
+  }
+  // 每个分量内拥有的贡献的并集
+  std::map<uint32_t, std::vector<bool> > known;
+  std::vector<uint32_t> roots(numNodes);
+  for (uint32_t i = 0; i < numNodes; i++) {
+    if (!running[i]) {
+      continue;
+    }
+    uint32_t root = i;
+    while (parent[root] != root) {
+      root = parent[root];
+    }
+    roots[i] = root;
+    std::vector<bool>& contributions = known[root];
+    contributions.resize(numNodes, false);
+    const KeyMatrix& matrix = m_nodes[i].GetKeyMatrix();
+    for (uint32_t j = 0; j < numNodes; j++) {
+      if (matrix.HasKeyContribution(i, j)) {
+        contributions[j] = true;
+      }
+    }
+  }
+  for (uint32_t i = 0; i < numNodes; i++) {
+    if (!running[i]) {
+      continue;
+    }
+    const std::vector<bool>& contributions = known[roots[i]];
+    const KeyMatrix& matrix = m_nodes[i].GetKeyMatrix();
+    for (uint32_t j = 0; j < numNodes; j++) {
+      if (contributions[j] && !matrix.HasKeyContribution(i, j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+AgreementDriver::CheckResult FlatDriver::Check(double& completionTime)
+{
+  if (m_membershipEvents.empty()) {
+    return CHECK_NODES;
+  }
+  bool agree = MembersAgree();
+  if (agree && completionTime == 0 && m_rekeys.empty() && !m_rekeying) {
+    completionTime = m_context->Now() - 1;
+  }
+  if (agree && m_rekeying) {
+    FinishRekey(true);
+  }
+  return agree && m_pendingEvents == 0 ? CHECK_FINISHED : CHECK_CONTINUE;
+}
+
+double FlatDriver::GetCheckInterval(double now) const
+{
+  return now < 2.0 || now < m_fastCheckUntil ? 0.01 : 0.1;
+}
+
+double FlatDriver::GetSuccessRate(uint32_t completed, uint32_t survivors) const
+{
+  if (m_membershipEvents.empty()) {
+    return AgreementDriver::GetSuccessRate(completed, survivors);
+  }
+  // 有成员变化时按结束时的实际成员统计
+  uint32_t members = 0;
+  uint32_t agreed = 0;
+  for (uint32_t i = 0; i < m_nodes.size(); i++) {
+    if (m_members[i]) {
+      members++;
+      agreed += m_nodes[i].GetKeyMatrix().SelfIsFull1() ? 1 : 0;
+    }
+  }
+  return members == 0 ? 0 : static_cast<double>(agreed) / members * 100;
+}
+
+void FlatDriver::OnEvent(uint32_t tag)
+{
+  const MembershipEvent& event = m_membershipEvents[tag];
+  double now = m_context->Now();
+  m_pendingEvents--;
+  if (m_members[event.node] == event.join) {
+    return;
+  }
+  if (m_rekeying) {
+    FinishRekey(false);
+  }
+  m_rekeying = true;
+  m_rekey.time = now;
+  m_rekey.node = event.node;
+  m_rekey.join = event.join;
+  m_rekey.sent = GetTotalSent();
+  m_rekey.received = GetTotalReceived();
+  m_fastCheckUntil = now + 1;
+
+  // 两种方式都经链路发出加入/离开消息，完整重新协商只在节点收到变化后的处理上不同
+  m_members[event.node] = event.join;
+  RegkaProtocol& changed = m_nodes[event.node];
+  if (event.join) {
+    m_context->SetRunning(event.node, true);
+    changed.Join();
+  } else {
+    // 离开消息发出后不再收包与定时
+    changed.Leave();
+    m_context->SetRunning(event.node, false);
+  }
+}
+
+void FlatDriver::Finish()
+{
+  if (m_rekeying) {
+    FinishRekey(false);
+  }
+}
+
+bool FlatDriver::MembersAgree() const
+{
+  for (uint32_t i = 0; i < m_nodes.size(); i++) {
+    if (!m_members[i]) {
+      continue;
+    }
+    const RegkaProtocol& node = m_nodes[i];
+    for (uint32_t j = 0; j < m_nodes.size(); j++) {
+      if (node.IsMember(j) != m_members[j]) {
+        return false;
+      }
+    }
+    if (!node.GetKeyMatrix().SelfIsFull1()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FlatDriver::FinishRekey(bool completed)
+{
+  double now = m_context->Now();
+  m_rekey.completed = completed;
+  m_rekey.latency = completed ? now - m_rekey.time : -1;
+  m_rekey.sent = GetTotalSent() - m_rekey.sent;
+  m_rekey.received = GetTotalReceived() - m_rekey.received;
+  m_rekeys.push_back(m_rekey);
+  m_rekeying = false;
+}
+
+uint32_t FlatDriver::GetTotalSent() const
+{
+  uint32_t sent = 0;
+  for (uint32_t i = 0; i < m_nodes.size(); i++) {
+    sent += m_nodes[i].GetSentCount();
+  }
+  return sent;
+}
+
+uint32_t FlatDriver::GetTotalReceived() const
+{
+  uint32_t received = 0;
+  for (uint32_t i = 0; i < m_nodes.size(); i++) {
+    received += m_nodes[i].GetReceivedCount();
+  }
+  return received;
+}
@@ -0,0 +1,97 @@
+/*
+ * FlatDriver.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef FLAT_DRIVER_H
+#define FLAT_DRIVER_H
+
+#include "AgreementDriver.h"
+#include <vector>
+
+// 一次成员变化的重新协商结果
+struct RekeyRecord
+{
+  double time;          ///< 成员变化时刻 (s)
+  uint32_t node;        ///< 加入或离开的节点
+  bool join;
+  bool completed;       ///< 下一次变化或仿真结束前所有成员是否完成
+  double latency;       ///< 从变化到所有成员视图一致且收齐贡献的时间 (s)，未完成时为-1
+  uint32_t sent;        ///< 这段时间内所有节点的发送数
+  uint32_t received;    ///< 这段时间内所有节点的接收数
+};
+
+/**
+ * 平面RE-GKA：每个节点运行一个RegkaProtocol，可以安排成员变化
+ *
+ * 有加入事件的节点不在初始成员中，到时调用Join（增量）启动；离开的节点调用Leave后不再收包与定时。
+ * 完整重新协商模式下，成员消息同样经发送队列与链路传播，视图有变化的节点ResetAgreement从头协商
+ * （见RegkaProtocol::SetFullRekey），作为增量方式的对照。每次变化记录到所有成员的视图与实际成员一致且收齐贡献的时延及期间的发送、接收数。
+ * 有成员变化时完成与成功率按实际成员判断，变化后1秒内按0.01秒检查。
+ */
+class FlatDriver : public AgreementDriver
+{
+public:
+  explicit FlatDriver(uint32_t numNodes);
+
+  // 在time时刻节点node加入（join为true）或离开，需在Run之前调用
+  void AddMembershipEvent(double time, uint32_t node, bool join);
+  // true为完整重新协商，false（默认）为增量的加入/离开消息
+  void SetFullRekey(bool full) { m_fullRekey = full; }
+  const std::vector<RekeyRecord>& GetRekeyRecords() const { return m_rekeys; }
+  const RegkaProtocol& GetProtocol(uint32_t node) const { return m_nodes[node]; }
+
+  virtual void Initialize(DriverContext* context, const std::vector<RegkaHost*>& hosts, double periodicInterval);
+  virtual void Start(uint32_t node) { m_nodes[node].Start(); }
+  virtual void OnTimer(uint32_t node) { m_nodes[node].OnTimer(); }
+  virtual void OnReceive(uint32_t node, uint32_t from, const std::string& content)
+  {
+    m_nodes[node].OnReceive(from, content);
+  }
+  virtual uint32_t Transmit(uint32_t node, const std::string& content) { return m_nodes[node].Transmit(content); }
+  virtual bool IsCompleted(uint32_t node) const { return m_nodes[node].IsCompleted(); }
+  virtual uint32_t GetSentCount(uint32_t node) const { return m_nodes[node].GetSentCount(); }
+  virtual uint32_t GetReceivedCount(uint32_t node) const { return m_nodes[node].GetReceivedCount(); }
+  virtual uint64_t CountLearnedContributions(uint32_t node) const;
+  // 非成员（尚未加入或已离开）的节点不计入，成员应知所有实际成员的贡献
+  virtual uint64_t CountExpectedContributions(uint32_t node) const;
+  virtual uint64_t GetStateBytes(uint32_t node) const { return m_nodes[node].GetMatrixBytes(); }
+  virtual const GroupKeyComputation* GetComputation(uint32_t node) const { return &m_nodes[node].GetComputation(); }
+  virtual double GetKeyReadyTime(uint32_t node) const { return m_nodes[node].GetKeyReadyTime(); }
+  virtual bool IsProgressExhausted(const std::vector<std::vector<uint32_t> >& neighbors,
+                                   const std::vector<bool>& running) const;
+  virtual CheckResult Check(double& completionTime);
+  virtual double GetCheckInterval(double now) const;
+  virtual double GetSuccessRate(uint32_t completed, uint32_t survivors) const;
+  virtual void OnEvent(uint32_t tag);
+  virtual void Finish();
+
+private:
+  struct MembershipEvent
+  {
+    double time;
+    uint32_t node;
+    bool join;
+  };
+
+  // 所有实际成员的视图与实际成员一致且都收齐贡献
+  bool MembersAgree() const;
+  void FinishRekey(bool completed);
+  uint32_t GetTotalSent() const;
+  uint32_t GetTotalReceived() const;
+
+  std::vector<RegkaProtocol> m_nodes;
+  DriverContext* m_context;
+  std::vector<MembershipEvent> m_membershipEvents;
+  std::vector<bool> m_members;      ///< 实际成员
+  bool m_fullRekey;
+  uint32_t m_pendingEvents;         ///< 尚未发生的成员变化数
+  bool m_rekeying;
+  double m_fastCheckUntil;          ///< 变化后1秒内按0.01秒检查
+  RekeyRecord m_rekey;
+  std::vector<RekeyRecord> m_rekeys;
+};
+
+#endif /* FLAT_DRIVER_H */
@@ -0,0 +1,470 @@
+/*
+ * MicroSimulator.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "MicroSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+// ---------------- MicroRng ----------------
+
+MicroRng::MicroRng(uint64_t seed)
+{
+  Seed(seed);
+}
+
+void MicroRng::Seed(uint64_t seed)
+{
+  m_state = seed * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+double MicroRng::Uniform()
+{
+  m_state ^= m_state >> 12;
+  m_state ^= m_state << 25;
+  m_state ^= m_state >> 27;
+  return ((m_state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ---------------- 链路模型 ----------------
+
+PositionLinkModel::PositionLinkModel(const std::vector<MicroPosition>& positions, double maxRange, uint64_t seed)
+  : m_positions(positions),
+    m_candidates(positions.size()),
+    m_rng(seed)
+{
+  // 按最大通信距离划分网格，只比较相邻格子里的节点
+  double cell = maxRange > 0 ? maxRange : 1;
+  std::map<std::pair<int64_t, int64_t>, std::vector<uint32_t> > grid;
+  for (uint32_t i = 0; i < positions.size(); i++) {
+    grid[std::make_pair(static_cast<int64_t>(std::floor(positions[i].x / cell)),
+                        static_cast<int64_t>(std::floor(positions[i].y / cell)))].push_back(i);
+  }
+  for (uint32_t i = 0; i < positions.size(); i++) {
+    int64_t cx = static_cast<int64_t>(std::floor(positions[i].x / cell));
+    int64_t cy = static_cast<int64_t>(std::floor(positions[i].y / cell));
+    for (int64_t dx = -1; dx <= 1; dx++) {
+      for (int64_t dy = -1; dy <= 1; dy++) {
+        std::map<std::pair<int64_t, int64_t>, std::vector<uint32_t> >::const_iterator it =
+            grid.find(std::make_pair(cx + dx, cy + dy));
+        if (it == grid.end()) {
+          continue;
+        }
+        for (uint32_t k = 0; k < it->second.size(); k++) {
+          uint32_t j = it->second[k];
+          if (j != i && GetDistance(i, j) <= maxRange) {
+            m_candidates[i].push_back(j);
+          }
+        }
+      }
+    }
+    std::sort(m_candidates[i].begin(), m_candidates[i].end());
+  }
+}
+
+double PositionLinkModel::GetDistance(uint32_t a, uint32_t b) const
+{
+  double dx = m_positions[a].x - m_positions[b].x;
+  double dy = m_positions[a].y - m_positions[b].y;
+  double dz = m_positions[a].z - m_positions[b].z;
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+void PositionLinkModel::Transmit(uint32_t from, uint32_t destination, uint32_t bytes, double /*time*/,
+                                 std::vector<std::pair<uint32_t, double> >& deliveries)
+{
+  bool unicast = (destination != RegkaProtocol::BROADCAST);
+  const std::vector<uint32_t>& candidates = m_candidates[from];
+  for (uint32_t k = 0; k < candidates.size(); k++) {
+    uint32_t to = candidates[k];
+    if (unicast && to != destination) {
+      continue;
+    }
+    double distance = GetDistance(from, to);
+    if (m_rng.Uniform() < GetProbability(distance, bytes, unicast)) {
+      deliveries.push_back(std::make_pair(to, GetDelay(distance, bytes, unicast)));
+    }
+  }
+}
+
+std::vector<MicroPosition> PositionLinkModel::RandomPositions(const ScenarioConfig& scenario, MicroRng& rng)
+{
+  std::vector<MicroPosition> positions(scenario.numNodes);
+  for (uint32_t i = 0; i < scenario.numNodes; i++) {
+    positions[i].x = rng.Uniform() * scenario.areaLength;
+    positions[i].y = rng.Uniform() * scenario.areaWidth;
+    positions[i].z = rng.Uniform() * scenario.areaHeight;
+  }
+  return positions;
+}
+
+DiskLinkModel::DiskLinkModel(const std::vector<MicroPosition>& positions, double range, double lossRate,
+                             double delay, uint64_t seed)
+  : PositionLinkModel(positions, range, seed),
+    m_lossRate(lossRate),
+    m_delay(delay)
+{
+}
+
+double DiskLinkModel::GetProbability(double /*distance*/, uint32_t /*bytes*/, bool /*unicast*/) const
+{
+  return 1 - m_lossRate;
+}
+
+double DiskLinkModel::GetDelay(double /*distance*/, uint32_t /*bytes*/, bool /*unicast*/) const
+{
+  return m_delay;
+}
+
+CalibratedLinkModel::CalibratedLinkModel(const std::vector<MicroPosition>& positions,
+                                         const LinkCalibration& calibration, uint64_t seed)
+  : PositionLinkModel(positions, calibration.GetProfile().maxRange, seed),
+    m_calibration(calibration)
+{
+}
+
+double CalibratedLinkModel::GetProbability(double distance, uint32_t bytes, bool unicast) const
+{
+  return m_calibration.GetDeliveryProbability(distance, bytes, unicast);
+}
+
+double CalibratedLinkModel::GetDelay(double distance, uint32_t bytes, bool unicast) const
+{
+  return m_calibration.GetDelay(distance, bytes, unicast);
+}
+
+double CalibratedLinkModel::GetAirtime(uint32_t bytes) const
+{
+  return m_calibration.GetAirtime(bytes);
+}
+
+// ---------------- MicroSimulator ----------------
+
+void MicroSimulator::NodeHost::Send(uint32_t destination, const std::string& content, double delay)
+{
+  m_sim->Schedule(delay, EVENT_TRANSMIT, m_node, destination, m_sim->StoreMessage(content, SharedPayload(), 1));
+}
+
+void MicroSimulator::NodeHost::SendShared(uint32_t destination, const std::string& header, const SharedPayload& body,
+                                          double delay)
+{
+  m_sim->Schedule(delay, EVENT_TRANSMIT, m_node, destination, m_sim->StoreMessage(header, body, 1));
+}
+
+void MicroSimulator::NodeHost::ScheduleTimer(double delay)
+{
+  m_sim->Schedule(delay, EVENT_TIMER, m_node, 0, 0);
+}
+
+MicroSimulator::MicroSimulator(uint32_t numNodes, LinkModel* link, AgreementDriver* driver)
+  : m_hosts(numNodes),
+    m_link(link),
+    m_driver(driver),
+    m_context(this),
+    m_now(0),
+    m_stopTime(60),
+    m_periodicInterval(0.1),
+    m_completionTime(0),
+    m_seq(0),
+    m_eventCount(0),
+    m_maxEvents(0),
+    m_completed(0),
+    m_counted(numNodes, false),
+    m_queueLimit(400),
+    m_txQueues(numNodes),
+    m_queueDrops(0),
+    m_outcome("timeout"),
+    m_running(numNodes, true),
+    m_crashed(numNodes, false),
+    m_crashedCount(0)
+{
+  // 协议对象由驱动在Run中建立
+  for (uint32_t i = 0; i < numNodes; i++) {
+    m_hosts[i].Attach(this, i);
+  }
+}
+
+MicroSimulator::~MicroSimulator()
+{
+}
+
+void MicroSimulator::Schedule(double delay, uint8_t type, uint32_t node, uint32_t peer, uint32_t message)
+{
+  Event event;
+  event.time = m_now + delay;
+  event.seq = m_seq++;
+  event.type = type;
+  event.node = node;
+  event.peer = peer;
+  event.message = message;
+  m_events.push(event);
+}
+
+uint32_t MicroSimulator::StoreMessage(const std::string& header, const SharedPayload& body, uint32_t references)
+{
+  uint32_t index;
+  if (!m_freeMessages.empty()) {
+    index = m_freeMessages.back();
+    m_freeMessages.pop_back();
+    m_messages[index] = header;
+    m_bodies[index] = body;
+    m_references[index] = references;
+  } else {
+    index = m_messages.size();
+    m_messages.push_back(header);
+    m_bodies.push_back(body);
+    m_references.push_back(references);
+  }
+  return index;
+}
+
+void MicroSimulator::ReleaseMessage(uint32_t message)
+{
+  if (--m_references[message] == 0) {
+    std::string().swap(m_messages[message]);
+    m_bodies[message] = SharedPayload();
+    m_freeMessages.push_back(message);
+  }
+}
+
+void MicroSimulator::HandleTransmit(const Event& event)
+{
+  if (m_crashed[event.node]) {
+    ReleaseMessage(event.message);
+    return;
+  }
+  // 与ns-3一致，交给发送队列即计入发送数。带消息体的只有RegkaProtocol的完整消息，
+  // 填充只取决于消息头中的贡献串，不必拼接
+  const std::string& header = m_messages[event.message];
+  uint32_t bytes = header.size() + m_bodies[event.message].GetSize() + m_driver->Transmit(event.node, header);
+
+  std::deque<double>& queue = m_txQueues[event.node];
+  while (!queue.empty() && queue.front() <= m_now) {
+    queue.pop_front();
+  }
+  if (queue.size() >= m_queueLimit) {
+    m_queueDrops++;
+    ReleaseMessage(event.message);
+    return;
+  }
+  double start = queue.empty() ? m_now : queue.back();
+  queue.push_back(start + m_link->GetAirtime(bytes));
+
+  m_deliveries.clear();
+  m_link->Transmit(event.node, event.peer, bytes, start, m_deliveries);
+  // 发送事件持有的引用转给接收事件
+  m_references[event.message] += m_deliveries.size();
+  for (uint32_t k = 0; k < m_deliveries.size(); k++) {
+    Schedule(start - m_now + m_deliveries[k].second, EVENT_DELIVER, m_deliveries[k].first, event.node, event.message);
+  }
+  ReleaseMessage(event.message);
+}
+
+bool MicroSimulator::HandleCheck()
+{
+  AgreementDriver::CheckResult check = m_driver->Check(m_completionTime);
+  if (check == AgreementDriver::CHECK_FINISHED) {
+    m_outcome = "completed";
+    return true;
+  }
+  if (check == AgreementDriver::CHECK_CONTINUE) {
+    Schedule(m_driver->GetCheckInterval(m_now), EVENT_CHECK, 0, 0, 0);
+    return false;
+  }
+  if (m_completed + m_crashedCount == m_hosts.size()) {
+    // 启用密钥计算时，等到最后一个节点得到组密钥（含计算时间）才结束
+    if (GroupKeyComputation::IsEnabled()) {
+      double ready = GetLatestKeyReadyTime();
+      if (ready > m_now) {
+        Schedule(ready - m_now, EVENT_CHECK, 0, 0, 0);
+        return false;
+      }
+    }
+    m_completionTime = m_now - 1;
+    m_outcome = "completed";
+    return true;
+  }
+  const std::vector<std::vector<uint32_t> >* neighbors = m_link->GetStaticNeighbors(m_now);
+  if (neighbors != NULL && m_driver->IsProgressExhausted(*neighbors, m_running)) {
+    m_outcome = "stalled";
+    return true;
+  }
+  // 微型仿真器不区分节点位置，只按进展判断停滞
+  if (m_progress.GetStallWindow() > 0 && m_progress.Update(m_now, CountLearnedContributions(false), true)) {
+    m_outcome = "stalled";
+    return true;
+  }
+  Schedule(m_driver->GetCheckInterval(m_now), EVENT_CHECK, 0, 0, 0);
+  return false;
+}
+
+void MicroSimulator::AddCrash(double time, uint32_t node)
+{
+  if (node < m_hosts.size()) {
+    m_crashEvents.push_back(std::make_pair(time, node));
+  }
+}
+
+void MicroSimulator::HandleCrash(uint32_t node)
+{
+  if (m_crashed[node]) {
+    return;
+  }
+  m_crashed[node] = true;
+  m_running[node] = false;
+  m_crashedCount++;
+  // 崩溃的节点不再计入完成数，之后也不会再被计入
+  if (m_counted[node]) {
+    m_completed--;
+  }
+  m_counted[node] = true;
+  m_driver->OnCrash(node);
+}
+
+uint64_t MicroSimulator::CountLearnedContributions(bool survivors) const
+{
+  // 停滞判断按所有节点统计，避免崩溃使总数下降
+  uint64_t learned = 0;
+  for (uint32_t i = 0; i < m_hosts.size(); i++) {
+    if (!survivors || !m_crashed[i]) {
+      learned += m_driver->CountLearnedContributions(i);
+    }
+  }
+  return learned;
+}
+
+uint64_t MicroSimulator::CountExpectedContributions() const
+{
+  uint64_t expected = 0;
+  for (uint32_t i = 0; i < m_hosts.size(); i++) {
+    if (!m_crashed[i]) {
+      expected += m_driver->CountExpectedContributions(i);
+    }
+  }
+  return expected;
+}
+
+double MicroSimulator::GetLatestKeyReadyTime() const
+{
+  double ready = 0;
+  for (uint32_t i = 0; i < m_hosts.size(); i++) {
+    if (!m_crashed[i]) {
+      ready = std::max(ready, m_driver->GetKeyReadyTime(i));
+    }
+  }
+  return ready;
+}
+
+double MicroSimulator::GetMatrixBytesPerNode() const
+{
+  if (m_hosts.empty()) {
+    return 0;
+  }
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < m_hosts.size(); i++) {
+    bytes += m_driver->GetStateBytes(i);
+  }
+  return static_cast<double>(bytes) / m_hosts.size();
+}
+
+SimulationResult MicroSimulator::Run()
+{
+  m_progress.Reset(1.0);
+  std::vector<RegkaHost*> hosts(m_hosts.size());
+  for (uint32_t i = 0; i < m_hosts.size(); i++) {
+    hosts[i] = &m_hosts[i];
+  }
+  m_driver->Initialize(&m_context, hosts, m_periodicInterval);
+  for (uint32_t i = 0; i < m_hosts.size(); i++) {
+    if (m_running[i]) {
+      Schedule(1 + 0.00001 * i, EVENT_START, i, 0, 0);
+    }
+  }
+  for (uint32_t k = 0; k < m_crashEvents.size(); k++) {
+    Schedule(m_crashEvents[k].first, EVENT_CRASH, m_crashEvents[k].second, 0, 0);
+  }
+  Schedule(0.001, EVENT_CHECK, 0, 0, 0);
+
+  while (!m_events.empty()) {
+    Event event = m_events.top();
+    if (event.time >= m_stopTime) {
+      break;
+    }
+    if (m_maxEvents > 0 && m_eventCount >= m_maxEvents) {
+      break;
+    }
+    m_events.pop();
+    m_now = event.time;
+    m_eventCount++;
+
+    bool stop = false;
+    switch (event.type) {
+      case EVENT_START:
+        if (!m_crashed[event.node]) {
+          m_driver->Start(event.node);
+        }
+        break;
+      case EVENT_TIMER:
+        if (m_running[event.node]) {
+          m_driver->OnTimer(event.node);
+        }
+        break;
+      case EVENT_TRANSMIT:
+        HandleTransmit(event);
+        break;
+      case EVENT_DELIVER:
+        if (!m_running[event.node]) {
+          ReleaseMessage(event.message);
+          break;
+        }
+        if (m_bodies[event.message].IsNull()) {
+          m_driver->OnReceive(event.node, event.peer, m_messages[event.message]);
+        } else {
+          m_content.assign(m_messages[event.message]);
+          m_content += m_bodies[event.message].Get();
+          m_driver->OnReceive(event.node, event.peer, m_content);
+        }
+        ReleaseMessage(event.message);
+        if (!m_counted[event.node] && m_driver->IsCompleted(event.node)) {
+          m_counted[event.node] = true;
+          m_completed++;
+        }
+        break;
+      case EVENT_CHECK:
+        stop = HandleCheck();
+        break;
+      case EVENT_DRIVER:
+        m_driver->OnEvent(event.peer);
+        break;
+      case EVENT_CRASH:
+        HandleCrash(event.node);
+        break;
+    }
+    if (stop) {
+      break;
+    }
+  }
+
+  m_driver->Finish();
+
+  SimulationResult result;
+  result.completionTime = m_completionTime;
+  result.totalSent = 0;
+  result.totalReceived = 0;
+  for (uint32_t i = 0; i < m_hosts.size(); i++) {
+    result.totalSent += m_driver->GetSentCount(i);
+    result.totalReceived += m_driver->GetReceivedCount(i);
+  }
+  result.overheadRatio = result.totalSent > 0 ? static_cast<double>(result.totalReceived) / result.totalSent : 0;
+  uint32_t survivors = m_hosts.size() - m_crashedCount;
+  result.successRate = m_driver->GetSuccessRate(m_completed, survivors);
+  result.outcome = m_outcome;
+  uint64_t expected = CountExpectedContributions();
+  result.contributionRate = expected == 0 ? 0
+      : static_cast<double>(CountLearnedContributions(true)) / expected * 100;
+  return result;
+}
@@ -0,0 +1,270 @@
+/*
+ * MicroSimulator.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef MICRO_SIMULATOR_H
+#define MICRO_SIMULATOR_H
+
+#include "RegkaProtocol.h"
+#include "LinkCalibration.h"
+#include "Scenario.h"
+#include "ProgressMonitor.h"
+#include "AgreementDriver.h"
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// 可复现的伪随机数（xorshift64*），与KeyMatrix使用的rand()相互独立
+class MicroRng
+{
+public:
+  explicit MicroRng(uint64_t seed = 1);
+  void Seed(uint64_t seed);
+  // [0,1)均匀分布
+  double Uniform();
+
+private:
+  uint64_t m_state;
+};
+
+struct MicroPosition
+{
+  double x, y, z;
+};
+
+/**
+ * 链路模型：决定一次发送被哪些节点收到以及各自的时延
+ */
+class LinkModel
+{
+public:
+  virtual ~LinkModel() {}
+  // 节点from在time时刻发出bytes字节的消息，destination为节点ID或RegkaProtocol::BROADCAST，
+  // 把收到的节点及时延追加到deliveries
+  virtual void Transmit(uint32_t from, uint32_t destination, uint32_t bytes, double time,
+                        std::vector<std::pair<uint32_t, double> >& deliveries) = 0;
+  // 发送一条消息占用发送方的时间 (s)，默认按12 Mbit/s计算
+  virtual double GetAirtime(uint32_t bytes) const { return bytes * 8 / 12e6; }
+  // 从time起每个节点的消息可能到达的节点（可以多于实际），链路会随时间增加时返回NULL；
+  // 仿真器据此判断是否还可能有进展
+  virtual const std::vector<std::vector<uint32_t> >* GetStaticNeighbors(double /*time*/) const { return NULL; }
+};
+
+/**
+ * 基于静态节点位置的链路模型，构造时按最大通信距离预先计算每个节点的候选接收方
+ */
+class PositionLinkModel : public LinkModel
+{
+public:
+  PositionLinkModel(const std::vector<MicroPosition>& positions, double maxRange, uint64_t seed);
+
+  virtual void Transmit(uint32_t from, uint32_t destination, uint32_t bytes, double time,
+                        std::vector<std::pair<uint32_t, double> >& deliveries);
+  // 节点静止，候选接收方不随时间变化
+  virtual const std::vector<std::vector<uint32_t> >* GetStaticNeighbors(double /*time*/) const { return &m_candidates; }
+
+  // 最大通信距离内的其他节点（按编号排序），即分簇使用的邻居表
+  const std::vector<std::vector<uint32_t> >& GetCandidates() const { return m_candidates; }
+  const std::vector<MicroPosition>& GetPositions() const { return m_positions; }
+
+  // 在区域内均匀随机放置节点
+  static std::vector<MicroPosition> RandomPositions(const ScenarioConfig& scenario, MicroRng& rng);
+
+protected:
+  // 距离为distance的一次发送被收到的概率与时延
+  virtual double GetProbability(double distance, uint32_t bytes, bool unicast) const = 0;
+  virtual double GetDelay(double distance, uint32_t bytes, bool unicast) const = 0;
+
+  double GetDistance(uint32_t a, uint32_t b) const;
+
+  std::vector<MicroPosition> m_positions;
+  std::vector<std::vector<uint32_t> > m_candidates; ///< 每个节点最大通信距离内的其他节点
+  MicroRng m_rng;
+};
+
+// 单位圆盘图：通信距离内以固定丢包率独立丢包，时延固定
+class DiskLinkModel : public PositionLinkModel
+{
+public:
+  DiskLinkModel(const std::vector<MicroPosition>& positions, double range, double lossRate,
+                double delay, uint64_t seed);
+
+protected:
+  virtual double GetProbability(double distance, uint32_t bytes, bool unicast) const;
+  virtual double GetDelay(double distance, uint32_t bytes, bool unicast) const;
+
+private:
+  double m_lossRate;
+  double m_delay;
+};
+
+// 使用抽象信道的校准表（或其解析模型）
+class CalibratedLinkModel : public PositionLinkModel
+{
+public:
+  CalibratedLinkModel(const std::vector<MicroPosition>& positions, const LinkCalibration& calibration,
+                      uint64_t seed);
+
+protected:
+  virtual double GetProbability(double distance, uint32_t bytes, bool unicast) const;
+  virtual double GetDelay(double distance, uint32_t bytes, bool unicast) const;
+  virtual double GetAirtime(uint32_t bytes) const;
+
+private:
+  LinkCalibration m_calibration;
+};
+
+/**
+ * 不依赖ns-3的离散事件驱动器，各节点上的协议对象由协商驱动（AgreementDriver）持有
+ *
+ * 启动时刻、周期广播与完成检查的节奏与REGKA-Ours.cc中的ns-3仿真一致：
+ * 节点i在1+0.00001*i秒启动，检查间隔在2秒前为0.01秒、之后为0.1秒，
+ * 完成时延为全部节点收齐贡献时的检查时刻减1秒。
+ * 每个节点的发送按链路模型给出的占用时间串行排队，队列满（默认400条，同WifiMacQueue）时丢弃，
+ * 否则转发风暴会无限增长；节点之间的信道竞争不模拟。
+ * 同一批转发与周期广播共用矩阵串（SharedPayload），排队中的事件不各自复制N×N字节的内容。
+ *
+ * 链路模型给出静态的可达关系时，每次检查时由驱动判断是否还可能有进展（平面协商：在存活节点按
+ * 可达关系划分的每个连通分量内，每个节点都已拥有分量内任一节点拥有的全部贡献时，之后不会再有新贡献），
+ * 不可能时提前结束并记为stalled（图不连通时不必再模拟到结束时间的转发风暴）。
+ * 另外可以按事件数限制运行，达到上限时记为timeout。
+ *
+ * 平面协商与成员变化见FlatDriver，多会话见SessionDriver，分簇见ClusterDriver，基线方案见BaselineDriver。
+ *
+ * 可以安排节点崩溃：到时节点不再收发与定时，排队中的消息也不再发出，其他节点不会得到通知，
+ * 驱动经OnCrash得知；完成、成功率、贡献比例与密钥就绪时刻都只按未崩溃的节点统计，与模式无关。链路故障由链路模型（FaultLinkModel）注入。
+ *
+ * 启用了GroupKeyComputation时计算时间体现在各节点的发送时延中；所有节点完成后再等到驱动给出的
+ * 最晚密钥就绪时刻（平面协商与基线方案为得到组密钥、计算结束的时刻）才算完成。
+ */
+class MicroSimulator
+{
+public:
+  // link与driver都不属于本类
+  MicroSimulator(uint32_t numNodes, LinkModel* link, AgreementDriver* driver);
+  ~MicroSimulator();
+
+  void SetPeriodicInterval(double interval) { m_periodicInterval = interval; }
+  void SetStopTime(double stopTime) { m_stopTime = stopTime; }
+  // 所有节点在window秒内都没有获得新的密钥贡献时提前结束，结果记为stalled，0为不检查
+  void SetStallWindow(double window) { m_progress.SetStallWindow(window); }
+  void SetQueueLimit(uint32_t limit) { m_queueLimit = limit; }
+  // 处理的事件数达到maxEvents时结束，结果记为timeout，0为不限制
+  void SetMaxEvents(uint64_t maxEvents) { m_maxEvents = maxEvents; }
+  // 在time时刻节点node崩溃，需在Run之前调用
+  void AddCrash(double time, uint32_t node);
+  // 每个节点协议状态（矩阵等，见AgreementDriver::GetStateBytes）占用的平均堆内存字节数
+  double GetMatrixBytesPerNode() const;
+
+  // 运行到全部节点完成或到达结束时间，结果中的场景字段由调用者填写
+  SimulationResult Run();
+
+  uint64_t GetEventCount() const { return m_eventCount; }
+  uint64_t GetQueueDrops() const { return m_queueDrops; }
+  double GetNow() const { return m_now; }
+
+private:
+  enum EventType { EVENT_START, EVENT_TIMER, EVENT_TRANSMIT, EVENT_DELIVER, EVENT_CHECK, EVENT_DRIVER, EVENT_CRASH };
+
+  struct Event
+  {
+    double time;
+    uint64_t seq;       ///< 同一时刻按安排的先后执行
+    uint8_t type;
+    uint32_t node;
+    uint32_t peer;      ///< TRANSMIT为目的地，DELIVER为发送方，DRIVER为驱动给出的标记
+    uint32_t message;   ///< 消息表中的序号
+  };
+  struct Later
+  {
+    bool operator()(const Event& a, const Event& b) const
+    {
+      return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+    }
+  };
+
+  // 把节点的发送与定时请求转成事件
+  class NodeHost : public RegkaHost
+  {
+  public:
+    NodeHost() : m_sim(NULL), m_node(0) {}
+    void Attach(MicroSimulator* sim, uint32_t node) { m_sim = sim; m_node = node; }
+    virtual void Send(uint32_t destination, const std::string& content, double delay);
+    virtual void SendShared(uint32_t destination, const std::string& header, const SharedPayload& body, double delay);
+    virtual void ScheduleTimer(double delay);
+    virtual double Now() const { return m_sim->m_now; }
+
+  private:
+    MicroSimulator* m_sim;
+    uint32_t m_node;
+  };
+
+  // 把驱动的请求转给仿真器
+  class Context : public DriverContext
+  {
+  public:
+    explicit Context(MicroSimulator* sim) : m_sim(sim) {}
+    virtual double Now() const { return m_sim->m_now; }
+    // 崩溃的节点不会再运行
+    virtual void SetRunning(uint32_t node, bool running) { m_sim->m_running[node] = running && !m_sim->m_crashed[node]; }
+    virtual void ScheduleEvent(double delay, uint32_t tag) { m_sim->Schedule(delay, EVENT_DRIVER, 0, tag, 0); }
+
+  private:
+    MicroSimulator* m_sim;
+  };
+
+  void Schedule(double delay, uint8_t type, uint32_t node, uint32_t peer, uint32_t message);
+  uint32_t StoreMessage(const std::string& header, const SharedPayload& body, uint32_t references);
+  void ReleaseMessage(uint32_t message);
+  void HandleTransmit(const Event& event);
+  bool HandleCheck();
+  void HandleCrash(uint32_t node);
+  // 节点已知与应知的密钥贡献总数，survivors为true时只计未崩溃的节点
+  uint64_t CountLearnedContributions(bool survivors) const;
+  uint64_t CountExpectedContributions() const;
+  // 未崩溃节点得到组密钥的最晚时刻
+  double GetLatestKeyReadyTime() const;
+
+  std::vector<NodeHost> m_hosts;
+  LinkModel* m_link;
+  AgreementDriver* m_driver;
+  Context m_context;
+  std::priority_queue<Event, std::vector<Event>, Later> m_events;
+  // 消息表：同一条消息的多个接收事件共享内容，引用数为0时回收；
+  // 消息为消息头后接共用的消息体，不同消息的消息体（矩阵串）可以是同一个
+  std::deque<std::string> m_messages;
+  std::deque<SharedPayload> m_bodies;
+  std::string m_content;            ///< 投递时拼接完整消息的缓冲
+  std::vector<uint32_t> m_references;
+  std::vector<uint32_t> m_freeMessages;
+  std::vector<std::pair<uint32_t, double> > m_deliveries;
+
+  double m_now;
+  double m_stopTime;
+  double m_periodicInterval;
+  double m_completionTime;
+  uint64_t m_seq;
+  uint64_t m_eventCount;
+  uint64_t m_maxEvents;
+  uint32_t m_completed;
+  std::vector<bool> m_counted;
+  uint32_t m_queueLimit;
+  std::vector<std::deque<double> > m_txQueues; ///< 每个节点排队中消息的发送结束时刻
+  uint64_t m_queueDrops;
+  ProgressMonitor m_progress;
+  std::string m_outcome;
+
+  std::vector<bool> m_running;      ///< 已启动且未离开，不在运行的节点不收包、不处理定时
+
+  std::vector<std::pair<double, uint32_t> > m_crashEvents;
+  std::vector<bool> m_crashed;
+  uint32_t m_crashedCount;
+
+};
+
+#endif /* MICRO_SIMULATOR_H */
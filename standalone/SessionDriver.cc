@@ -0,0 +1,76 @@
+/*
+ * SessionDriver.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "SessionDriver.h"
+#include "MicroSimulator.h"
+#include <algorithm>
+
+SessionDriver::SessionDriver(uint32_t numNodes, uint32_t count, uint32_t size, uint64_t seed)
+  : m_numNodes(numNodes),
+    m_count(count),
+    m_size(size),
+    m_seed(seed)
+{
+}
+
+void SessionDriver::Initialize(DriverContext* /*context*/, const std::vector<RegkaHost*>& hosts,
+                               double periodicInterval)
+{
+  m_members.assign(m_count, std::vector<bool>(m_numNodes, true));
+  if (m_size > 0 && m_size < m_numNodes) {
+    // 每个会话按部分Fisher-Yates洗牌选取成员
+    MicroRng rng(m_seed);
+    std::vector<uint32_t> order(m_numNodes);
+    for (uint32_t k = 0; k < m_count; k++) {
+      for (uint32_t i = 0; i < m_numNodes; i++) {
+        order[i] = i;
+      }
+      m_members[k].assign(m_numNodes, false);
+      for (uint32_t i = 0; i < m_size; i++) {
+        uint32_t j = i + static_cast<uint32_t>(rng.Uniform() * (m_numNodes - i));
+        std::swap(order[i], order[j]);
+        m_members[k][order[i]] = true;
+      }
+    }
+  }
+
+  m_crashed.assign(m_numNodes, false);
+  m_muxes.resize(m_numNodes);
+  for (uint32_t i = 0; i < m_numNodes; i++) {
+    m_muxes[i].Initialize(m_numNodes, i);
+    m_muxes[i].SetHost(hosts[i]);
+    m_muxes[i].SetPeriodicInterval(periodicInterval);
+    for (uint32_t k = 0; k < m_count; k++) {
+      m_muxes[i].AddSession(k, m_members[k]);
+    }
+  }
+}
+
+std::vector<double> SessionDriver::GetSessionDelays() const
+{
+  std::vector<double> delays(m_count, -1);
+  for (uint32_t k = 0; k < m_count; k++) {
+    double last = 0;
+    for (uint32_t i = 0; i < m_muxes.size() && last >= 0; i++) {
+      if (m_members[k][i] && !m_crashed[i]) {
+        double time = m_muxes[i].GetCompletionTime(k);
+        last = time < 0 ? -1 : std::max(last, time);
+      }
+    }
+    delays[k] = last < 0 ? -1 : last - 1;
+  }
+  return delays;
+}
+
+uint64_t SessionDriver::GetFramesSent() const
+{
+  uint64_t frames = 0;
+  for (uint32_t i = 0; i < m_muxes.size(); i++) {
+    frames += m_muxes[i].GetFramesSent();
+  }
+  return frames;
+}
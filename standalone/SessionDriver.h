@@ -0,0 +1,57 @@
+/*
+ * SessionDriver.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef SESSION_DRIVER_H
+#define SESSION_DRIVER_H
+
+#include "AgreementDriver.h"
+#include "SessionMux.h"
+#include <vector>
+
+/**
+ * 多会话：每个节点运行一个SessionMux，多个会话共用邻居表与发送队列，消息按帧发出，
+ * 发送队列与链路模型按帧处理；全部会话在所有成员处完成时结束。
+ * 不支持成员变化；密钥计算只推迟发送，不参与完成判断。
+ */
+class SessionDriver : public AgreementDriver
+{
+public:
+  // count个并发会话，每个会话用seed随机选取size个节点（0或不小于节点数时为全部节点）
+  SessionDriver(uint32_t numNodes, uint32_t count, uint32_t size, uint64_t seed);
+
+  // 每个会话的完成时延（所有未崩溃的成员收齐贡献的时刻减1秒），未完成为-1
+  std::vector<double> GetSessionDelays() const;
+  // 所有节点发出的帧数
+  uint64_t GetFramesSent() const;
+
+  virtual void Initialize(DriverContext* context, const std::vector<RegkaHost*>& hosts, double periodicInterval);
+  virtual void Start(uint32_t node) { m_muxes[node].Start(); }
+  virtual void OnTimer(uint32_t node) { m_muxes[node].OnTimer(); }
+  virtual void OnReceive(uint32_t node, uint32_t from, const std::string& content)
+  {
+    m_muxes[node].OnReceive(from, content);
+  }
+  virtual uint32_t Transmit(uint32_t node, const std::string& content) { return m_muxes[node].Transmit(content); }
+  virtual bool IsCompleted(uint32_t node) const { return m_muxes[node].IsCompleted(); }
+  virtual uint32_t GetSentCount(uint32_t node) const { return m_muxes[node].GetSentCount(); }
+  virtual uint32_t GetReceivedCount(uint32_t node) const { return m_muxes[node].GetReceivedCount(); }
+  virtual uint64_t CountLearnedContributions(uint32_t node) const { return m_muxes[node].CountLearnedContributions(); }
+  virtual uint64_t CountExpectedContributions(uint32_t node) const { return m_muxes[node].CountExpectedContributions(); }
+  virtual uint64_t GetStateBytes(uint32_t node) const { return m_muxes[node].GetMatrixBytes(); }
+  virtual void OnCrash(uint32_t node) { m_crashed[node] = true; }
+
+private:
+  uint32_t m_numNodes;
+  uint32_t m_count;
+  uint32_t m_size;
+  uint64_t m_seed;
+  std::vector<std::vector<bool> > m_members;  ///< 每个会话的成员
+  std::vector<SessionMux> m_muxes;
+  std::vector<bool> m_crashed;
+};
+
+#endif /* SESSION_DRIVER_H */
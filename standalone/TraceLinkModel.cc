@@ -0,0 +1,111 @@
+/*
+ * TraceLinkModel.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#include "TraceLinkModel.h"
+#include <cmath>
+
+TraceLinkModel::TraceLinkModel(const LinkTrace& trace, const LinkCalibration& fallback, uint64_t seed)
+  : m_trace(trace),
+    m_fallback(fallback),
+    m_rng(seed),
+    m_window(0.5),
+    m_bySender(trace.GetNumNodes()),
+    m_hits(0),
+    m_fallbacks(0)
+{
+  const std::vector<LinkTrace::Transmission>& txs = trace.GetTransmissions();
+  for (uint32_t i = 0; i < txs.size(); i++) {
+    if (txs[i].sender < m_bySender.size()) {
+      m_bySender[txs[i].sender].push_back(i);
+    }
+  }
+}
+
+bool TraceLinkModel::Lookup(uint32_t from, uint32_t to, bool unicast, double time, float& delay) const
+{
+  const std::vector<LinkTrace::Transmission>& txs = m_trace.GetTransmissions();
+  const std::vector<uint32_t>& records = m_bySender[from];
+
+  // 二分找到第一个不早于time的记录，再向两侧交替扩展
+  uint32_t lo = 0;
+  uint32_t hi = records.size();
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (txs[records[mid]].time < time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  int64_t after = lo;
+  int64_t before = static_cast<int64_t>(lo) - 1;
+  while (before >= 0 || after < static_cast<int64_t>(records.size())) {
+    int64_t index;
+    if (after >= static_cast<int64_t>(records.size())
+        || (before >= 0 && time - txs[records[before]].time <= txs[records[after]].time - time)) {
+      index = before--;
+    } else {
+      index = after++;
+    }
+    const LinkTrace::Transmission& tx = txs[records[index]];
+    // 候选按时间距离递增取出，第一个超出窗口即可停止
+    if (std::fabs(tx.time - time) > m_window) {
+      return false;
+    }
+    if ((tx.destination != LinkTrace::BROADCAST) != unicast) {
+      continue;
+    }
+    for (uint32_t k = 0; k < tx.receivers.size(); k++) {
+      if (tx.receivers[k].node == to) {
+        delay = tx.receivers[k].delay;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+double TraceLinkModel::GetDistance(uint32_t a, uint32_t b, double time) const
+{
+  const LinkTrace::Sample* sample = m_trace.GetSample(time);
+  if (sample == NULL) {
+    return 0;
+  }
+  double dx = sample->positions[a].x - sample->positions[b].x;
+  double dy = sample->positions[a].y - sample->positions[b].y;
+  double dz = sample->positions[a].z - sample->positions[b].z;
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+void TraceLinkModel::Transmit(uint32_t from, uint32_t destination, uint32_t bytes, double time,
+                              std::vector<std::pair<uint32_t, double> >& deliveries)
+{
+  bool unicast = (destination != RegkaProtocol::BROADCAST);
+  for (uint32_t to = 0; to < m_trace.GetNumNodes(); to++) {
+    if (to == from || (unicast && to != destination)) {
+      continue;
+    }
+    float delay;
+    if (Lookup(from, to, unicast, time, delay)) {
+      m_hits++;
+      if (delay >= 0) {
+        deliveries.push_back(std::make_pair(to, static_cast<double>(delay)));
+      }
+      continue;
+    }
+    m_fallbacks++;
+    double distance = GetDistance(from, to, time);
+    if (m_rng.Uniform() < m_fallback.GetDeliveryProbability(distance, bytes, unicast)) {
+      deliveries.push_back(std::make_pair(to, m_fallback.GetDelay(distance, bytes, unicast)));
+    }
+  }
+}
+
+double TraceLinkModel::GetAirtime(uint32_t bytes) const
+{
+  return m_fallback.GetAirtime(bytes);
+}
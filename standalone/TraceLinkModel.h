@@ -0,0 +1,53 @@
+/*
+ * TraceLinkModel.h
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ */
+
+#ifndef TRACE_LINK_MODEL_H
+#define TRACE_LINK_MODEL_H
+
+#include "MicroSimulator.h"
+#include "LinkTrace.h"
+#include "LinkCalibration.h"
+#include <vector>
+
+/**
+ * 按记录的链路轨迹决定发送结果
+ *
+ * 重放中的协议变体产生的发送与记录时不同，因此对每个（发送方，接收方）取时间上最接近、
+ * 单播/广播类型相同且包含该接收方的记录，沿用它的收到与否和时延；
+ * window秒内没有可用记录时，按轨迹中的节点位置用校准模型抽样。
+ * 查找是确定性的，同一轨迹上的不同变体看到相同的信道实现。
+ */
+class TraceLinkModel : public LinkModel
+{
+public:
+  TraceLinkModel(const LinkTrace& trace, const LinkCalibration& fallback, uint64_t seed);
+
+  void SetWindow(double window) { m_window = window; }
+
+  virtual void Transmit(uint32_t from, uint32_t destination, uint32_t bytes, double time,
+                        std::vector<std::pair<uint32_t, double> >& deliveries);
+  virtual double GetAirtime(uint32_t bytes) const;
+
+  uint64_t GetTraceHits() const { return m_hits; }
+  uint64_t GetFallbacks() const { return m_fallbacks; }
+
+private:
+  // 查找from发给to的最近记录，返回是否找到；delay小于0表示记录中未收到
+  bool Lookup(uint32_t from, uint32_t to, bool unicast, double time, float& delay) const;
+  double GetDistance(uint32_t a, uint32_t b, double time) const;
+
+  const LinkTrace& m_trace;
+  LinkCalibration m_fallback;
+  MicroRng m_rng;
+  double m_window;
+  // 按发送方分组的记录序号，组内按时间排序
+  std::vector<std::vector<uint32_t> > m_bySender;
+  uint64_t m_hits;
+  uint64_t m_fallbacks;
+};
+
+#endif /* TRACE_LINK_MODEL_H */
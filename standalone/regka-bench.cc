@@ -0,0 +1,420 @@
+/*
+ * regka-bench.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ *
+ * KeyMatrix逐包操作的微基准测试，不依赖ns-3
+ *
+ * 对每个操作、节点数N与矩阵填充密度，重复执行直到耗时超过minTime，
+ * 输出每次操作的纳秒数、内存分配次数与分配字节数（CSV）。
+ * 指定--baseline时与之前的输出比较，ns/op超过容差的组合视为回归，返回码为2。
+ */
+
+#include "KeyMatrix.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <time.h>
+
+// ---------------- 内存分配计数 ----------------
+// 替换全局operator new/delete，统计基准循环内的分配次数与字节数。
+// 分配与释放都经过下面两个不内联的函数：gcc会把内联后的new表达式与free配对检查
+// (-Wmismatched-new-delete)，经过同一对函数后new/delete两侧看到的是同一个分配路径
+
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_NO_THROW noexcept
+#else
+#define BENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BENCH_NO_THROW throw()
+#endif
+
+static uint64_t g_allocCount = 0;
+static uint64_t g_allocBytes = 0;
+
+__attribute__((noinline)) static void* CountedAllocate(std::size_t size)
+{
+  g_allocCount++;
+  g_allocBytes += size;
+  void* p = std::malloc(size > 0 ? size : 1);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+__attribute__((noinline)) static void CountedRelease(void* p)
+{
+  std::free(p);
+}
+
+void* operator new(std::size_t size) BENCH_THROW_BAD_ALLOC
+{
+  return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size) BENCH_THROW_BAD_ALLOC
+{
+  return CountedAllocate(size);
+}
+
+void operator delete(void* p) BENCH_NO_THROW
+{
+  CountedRelease(p);
+}
+
+void operator delete[](void* p) BENCH_NO_THROW
+{
+  CountedRelease(p);
+}
+
+#if __cpp_sized_deallocation
+void operator delete(void* p, std::size_t) BENCH_NO_THROW
+{
+  CountedRelease(p);
+}
+
+void operator delete[](void* p, std::size_t) BENCH_NO_THROW
+{
+  CountedRelease(p);
+}
+#endif
+
+// ---------------- 计时 ----------------
+
+static uint64_t NowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// 防止编译器把结果未使用的调用优化掉
+static volatile uint64_t g_sink = 0;
+
+// ---------------- 基准用例 ----------------
+
+struct BenchContext
+{
+  uint32_t n;
+  KeyMatrix local;      ///< 按密度填充的本地矩阵，节点ID为0
+  KeyMatrix received;   ///< 按密度独立填充的另一个矩阵
+  KeyMatrix scratch;    ///< merge的目标矩阵，在计时外准备好
+  std::string matrixString;
+  uint32_t cursor;      ///< 轮换邻居/贡献者，避免总是访问同一行列
+};
+
+typedef void (*BenchFunction)(BenchContext& ctx, uint64_t iterations);
+
+static void BenchConstruct(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    KeyMatrix matrix(ctx.n, 0);
+    g_sink += matrix.HasKeyContribution(0, 0);
+  }
+}
+
+static void BenchInitialize(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    KeyMatrix matrix;
+    matrix.InitializeMatrix(ctx.n, 0);
+    g_sink += matrix.HasKeyContribution(0, 0);
+  }
+}
+
+static void BenchMerge(BenchContext& ctx, uint64_t iterations)
+{
+  // 合并会逐渐填满矩阵，但MergeMatrix总是遍历全部N*N个元素，耗时与内容无关
+  for (uint64_t i = 0; i < iterations; i++) {
+    ctx.scratch.MergeMatrix(ctx.received);
+  }
+  g_sink += ctx.scratch.HasKeyContribution(0, ctx.n - 1);
+}
+
+static void BenchCalculateCR(BenchContext& ctx, uint64_t iterations)
+{
+  double sum = 0;
+  for (uint64_t i = 0; i < iterations; i++) {
+    ctx.cursor = ctx.cursor + 1 < ctx.n ? ctx.cursor + 1 : 1;
+    sum += ctx.local.CalculateCR(ctx.cursor);
+  }
+  g_sink += static_cast<uint64_t>(sum);
+}
+
+static void BenchCalculateFD(BenchContext& ctx, uint64_t iterations)
+{
+  double sum = 0;
+  for (uint64_t i = 0; i < iterations; i++) {
+    ctx.cursor = ctx.cursor + 1 < ctx.n ? ctx.cursor + 1 : 0;
+    sum += ctx.local.CalculateFD(ctx.cursor);
+  }
+  g_sink += static_cast<uint64_t>(sum);
+}
+
+static void BenchForwarding(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    ctx.cursor = ctx.cursor + 1 < ctx.n ? ctx.cursor + 1 : 1;
+    g_sink += ctx.local.GetForwardingContributions(ctx.cursor).size();
+  }
+}
+
+static void BenchSelfIsFull1(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    g_sink += ctx.local.SelfIsFull1();
+  }
+}
+
+static void BenchIsFull1(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    g_sink += ctx.local.IsFull1();
+  }
+}
+
+static void BenchMatrixToString(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    g_sink += ctx.local.MatrixToString().size();
+  }
+}
+
+static void BenchStringToMatrix(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    KeyMatrix matrix = ctx.local.StringToMatrix(ctx.matrixString);
+    g_sink += matrix.HasKeyContribution(0, ctx.n - 1);
+  }
+}
+
+static void BenchRoundTrip(BenchContext& ctx, uint64_t iterations)
+{
+  for (uint64_t i = 0; i < iterations; i++) {
+    KeyMatrix matrix = ctx.local.StringToMatrix(ctx.local.MatrixToString());
+    g_sink += matrix.HasKeyContribution(0, ctx.n - 1);
+  }
+}
+
+struct BenchCase
+{
+  const char* name;
+  BenchFunction function;
+  bool usesDensity;     ///< 耗时是否与矩阵内容有关，无关的只在第一个密度下运行
+};
+
+static const BenchCase BENCH_CASES[] = {
+  { "construct", &BenchConstruct, false },
+  { "initialize", &BenchInitialize, false },
+  { "merge", &BenchMerge, false },
+  { "calculateCR", &BenchCalculateCR, true },
+  { "calculateFD", &BenchCalculateFD, true },
+  { "forwarding", &BenchForwarding, true },
+  { "selfIsFull1", &BenchSelfIsFull1, true },
+  { "isFull1", &BenchIsFull1, true },
+  { "matrixToString", &BenchMatrixToString, true },
+  { "stringToMatrix", &BenchStringToMatrix, true },
+  { "roundTrip", &BenchRoundTrip, true },
+};
+
+// 生成矩阵内容用的伪随机数，与KeyMatrix使用的rand()相互独立
+static double Uniform(uint64_t& state)
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return ((state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// 生成对角线为1、其余元素以density概率为1的矩阵字符串
+static std::string RandomMatrixString(uint32_t n, double density, uint64_t& rng)
+{
+  std::string s(static_cast<std::string::size_type>(n) * n, '0');
+  for (uint32_t i = 0; i < n; i++) {
+    for (uint32_t j = 0; j < n; j++) {
+      if (i == j || Uniform(rng) < density) {
+        s[static_cast<std::string::size_type>(i) * n + j] = '1';
+      }
+    }
+  }
+  return s;
+}
+
+struct BenchResult
+{
+  uint64_t iterations;
+  double nsPerOp;
+  double allocsPerOp;
+  double bytesPerOp;
+};
+
+// 迭代次数从1开始逐轮增加，直到一轮耗时不少于minTime，报告最后一轮
+static BenchResult Measure(BenchFunction function, BenchContext& ctx, double minTime)
+{
+  BenchResult result;
+  uint64_t iterations = 1;
+  while (true) {
+    srand(1);
+    uint64_t allocCount = g_allocCount;
+    uint64_t allocBytes = g_allocBytes;
+    uint64_t start = NowNs();
+    function(ctx, iterations);
+    uint64_t elapsed = NowNs() - start;
+    if (elapsed >= minTime * 1e9 || iterations >= (1ULL << 40)) {
+      result.iterations = iterations;
+      result.nsPerOp = static_cast<double>(elapsed) / iterations;
+      result.allocsPerOp = static_cast<double>(g_allocCount - allocCount) / iterations;
+      result.bytesPerOp = static_cast<double>(g_allocBytes - allocBytes) / iterations;
+      return result;
+    }
+    // 按本轮耗时估计达到minTime所需的次数，最多放大10倍
+    uint64_t next = iterations * 10;
+    if (elapsed > 0) {
+      double estimate = minTime * 1e9 / elapsed * iterations * 1.2;
+      if (estimate < next) {
+        next = static_cast<uint64_t>(estimate) + 1;
+      }
+    }
+    iterations = next > iterations ? next : iterations + 1;
+  }
+}
+
+static std::vector<std::string> SplitList(const std::string& value)
+{
+  std::vector<std::string> items;
+  std::stringstream ss(value);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+// 读取之前的输出，键为"操作,N,密度"，值为ns/op
+static bool LoadBaseline(const std::string& file, std::map<std::string, double>& baseline)
+{
+  std::ifstream in(file.c_str());
+  if (!in.is_open()) {
+    std::cerr << "无法打开基准文件: " << file << std::endl;
+    return false;
+  }
+  std::string line;
+  std::getline(in, line);   // 表头
+  while (std::getline(in, line)) {
+    std::vector<std::string> fields = SplitList(line);
+    if (fields.size() >= 5) {
+      baseline[fields[0] + "," + fields[1] + "," + fields[2]] = std::atof(fields[4].c_str());
+    }
+  }
+  return true;
+}
+
+static void Usage()
+{
+  std::cerr << "用法: regka-bench [--key=value ...]\n"
+            << "  --sizes=5,16,64,256,1024,2048   节点数N\n"
+            << "  --densities=0.1,0.5,0.9         矩阵非对角元素为1的比例\n"
+            << "  --ops=NAME,...                  只运行指定操作，默认全部\n"
+            << "  --minTime=0.2                   每个组合的最短测量时间 (s)\n"
+            << "  --baseline=FILE --tolerance=0.2 与之前的输出比较，ns/op增加超过容差时返回2\n"
+            << "输出CSV: op,n,density,iterations,nsPerOp,allocsPerOp,bytesPerOp" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> sizes = SplitList("5,16,64,256,1024,2048");
+  std::vector<std::string> densities = SplitList("0.1,0.5,0.9");
+  std::vector<std::string> ops;
+  double minTime = 0.2;
+  std::string baselineFile;
+  double tolerance = 0.2;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    std::string::size_type eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+      Usage();
+      return 1;
+    }
+    std::string key = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+    if (key == "sizes") sizes = SplitList(value);
+    else if (key == "densities") densities = SplitList(value);
+    else if (key == "ops") ops = SplitList(value);
+    else if (key == "minTime") minTime = std::atof(value.c_str());
+    else if (key == "baseline") baselineFile = value;
+    else if (key == "tolerance") tolerance = std::atof(value.c_str());
+    else {
+      std::cerr << "未知参数: " << key << std::endl;
+      Usage();
+      return 1;
+    }
+  }
+  if (sizes.empty() || densities.empty()) {
+    Usage();
+    return 1;
+  }
+
+  std::map<std::string, double> baseline;
+  if (!baselineFile.empty() && !LoadBaseline(baselineFile, baseline)) {
+    return 1;
+  }
+
+  uint32_t regressions = 0;
+  std::cout << "op,n,density,iterations,nsPerOp,allocsPerOp,bytesPerOp" << std::endl;
+  for (uint32_t s = 0; s < sizes.size(); s++) {
+    uint32_t n = std::strtoul(sizes[s].c_str(), NULL, 10);
+    if (n < 2) {
+      std::cerr << "节点数至少为2: " << sizes[s] << std::endl;
+      return 1;
+    }
+    for (uint32_t d = 0; d < densities.size(); d++) {
+      double density = std::atof(densities[d].c_str());
+      uint64_t rng = (n * 1000ULL + d + 1) * 0x9E3779B97F4A7C15ULL;
+      BenchContext ctx;
+      ctx.n = n;
+      ctx.cursor = 0;
+      KeyMatrix shape(n, 0);
+      ctx.matrixString = RandomMatrixString(n, density, rng);
+      ctx.local = shape.StringToMatrix(ctx.matrixString);
+      ctx.received = shape.StringToMatrix(RandomMatrixString(n, density, rng));
+      ctx.scratch = ctx.local;
+
+      for (uint32_t c = 0; c < sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]); c++) {
+        const BenchCase& bench = BENCH_CASES[c];
+        if (!bench.usesDensity && d > 0) {
+          continue;
+        }
+        bool selected = ops.empty();
+        for (uint32_t k = 0; k < ops.size(); k++) {
+          selected = selected || ops[k] == bench.name;
+        }
+        if (!selected) {
+          continue;
+        }
+
+        BenchResult result = Measure(bench.function, ctx, minTime);
+        std::ostringstream key;
+        key << bench.name << "," << n << "," << (bench.usesDensity ? densities[d] : "-");
+        std::cout << key.str() << "," << result.iterations << "," << result.nsPerOp << ","
+                  << result.allocsPerOp << "," << result.bytesPerOp << std::endl;
+
+        std::map<std::string, double>::const_iterator it = baseline.find(key.str());
+        if (it != baseline.end() && it->second > 0 && result.nsPerOp > it->second * (1 + tolerance)) {
+          std::cerr << "性能回归: " << key.str() << " " << it->second << " -> " << result.nsPerOp
+                    << " ns/op" << std::endl;
+          regressions++;
+        }
+      }
+    }
+  }
+  return regressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,467 @@
+/*
+ * regka-microsim.cc
+ *
+ *  Created on: 2026年10月19日
+ *      Author: Zhang Zhan
+ *
+ * 不依赖ns-3的RE-GKA微型仿真器，用于大规模节点的协议基准测试与随机测试
+ */
+
+#include "MicroSimulator.h"
+#include "FlatDriver.h"
+#include "SessionDriver.h"
+#include "ClusterDriver.h"
+#include "BaselineDriver.h"
+#include "FaultLinkModel.h"
+#include "ResultAggregator.h"
+#include "Scenario.h"
+#include "Profiler.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+static void Usage()
+{
+  std::cerr << "用法: regka-microsim [--key=value ...]\n"
+            << "  --numNodes=5 --areaLength=500 --areaWidth=500 --areaHeight=100\n"
+            << "  --linkQuality=medium --run=1\n"
+            << "  --linkModel=calibrated|disk   链路模型，默认calibrated\n"
+            << "  --calibrationFile=FILE        calibrated模型的校准表，不存在时使用解析模型\n"
+            << "  --range=250 --loss=0 --delay=0.002   disk模型的通信距离、丢包率与时延\n"
+            << "  --simuTime=60 --periodicInterval=0.1\n"
+            << "  --stallWindow=0               所有节点在该时间 (s) 内没有新进展时提前结束，0为不检查\n"
+            << "  --maxEvents=0                 每次运行最多处理的事件数，达到时记为timeout，0为不限制\n"
+            << "  --maxMessageBytes=0           消息长度上限，超过时拆成分片，0为不拆分\n"
+            << "  --join=T:ID,... --leave=T:ID,...   在T秒时节点ID加入或离开\n"
+            << "  --rekey=delta|full            成员变化的处理方式：增量加入/离开消息或完整重新协商，默认delta\n"
+            << "  --rekeyReport=FILE            每次成员变化的重新协商时延与消息数\n"
+            << "  --aggregateOutput=FILE --aggregateMetrics=delay,success,overhead,ratio --aggregateEvery=20\n"
+            << "                                按参数点流式汇总重复运行（均值、标准差、最值与P50/P90/P99）\n"
+            << "  --sessions=0 --sessionSize=0  每个节点上并发的会话数与每个会话的节点数（0为全部节点），0为单会话\n"
+            << "  --frameBytes=0                多会话时帧（含填充）的长度上限，0为不限制，1为每条消息单独成帧\n"
+            << "  --agreement=flat|cluster|both --clusterSize=16   平面协商、两级分簇协商或两者依次运行\n"
+            << "  --crypto=none|x25519          执行真实的密钥计算并把CPU时间计入时延，定义REGKA_WITH_OPENSSL时另有openssl\n"
+            << "  --cryptoCost=measured|MS      每次可变基点标量乘的代价 (ms)，其余各项按本机测量的比例，默认本机测量\n"
+            << "  --cpuScale=1                  测量代价的倍数，用于估计较慢的机载处理器\n"
+            << "  --cryptoBatch=1 --fixedBaseTable=1   批量处理收到的贡献、用倍点表生成贡献\n"
+            << "  --strategy=regka|flooding|tgdh|centralized   协商方案：RE-GKA或基线方案（盲泛洪、树形群DH、集中式）\n"
+            << "  --fault=none|NAME|PLAN --faultFile=FILE   故障计划（见FaultPlan.h）或故障计划文件中的名称，\n"
+            << "                                如crash@1.005:10%+partition@2-8:x<0.5；disk模型忽略degrade\n"
+            << "  --sweep=SPEC | --sweepFile=FILE   批量运行，格式与REGKA-Ours相同，fault维度为故障计划\n"
+            << "输出为CSV，列与批量模式的结果文件相同，另附事件数、发送队列丢弃数与耗时；\n"
+            << "多会话时再附会话数、完成的会话数、会话平均与最大完成时延、每秒完成的会话数与帧数；\n"
+            << "agreement不为flat时再附协商方式、簇数与每个节点的矩阵字节数；\n"
+            << "crypto不为none时再附后端、每个节点的平均标量乘次数与计算时间 (s)" << std::endl;
+}
+
+struct MembershipOption
+{
+  double time;
+  uint32_t node;
+  bool join;
+};
+
+// 解析"T:ID,T:ID"
+static bool ParseMembership(const std::string& text, bool join, std::vector<MembershipOption>& events)
+{
+  std::istringstream in(text);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    std::string::size_type colon = item.find(':');
+    if (colon == std::string::npos) {
+      std::cerr << "成员变化格式错误: " << item << std::endl;
+      return false;
+    }
+    MembershipOption event;
+    event.time = std::atof(item.substr(0, colon).c_str());
+    event.node = std::strtoul(item.substr(colon + 1).c_str(), NULL, 10);
+    event.join = join;
+    events.push_back(event);
+  }
+  return true;
+}
+
+static double WallSeconds()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int main(int argc, char* argv[])
+{
+  std::map<std::string, std::string> options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    std::string::size_type eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+      Usage();
+      return 1;
+    }
+    options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+  }
+
+  ScenarioConfig base;
+  std::string linkModel = "calibrated";
+  std::string calibrationFile;
+  double range = 250;
+  double loss = 0;
+  double delay = 0.002;
+  double simuTime = 60;
+  double periodicInterval = 0.1;
+  double stallWindow = 0;
+  uint64_t maxEvents = 0;
+  std::vector<MembershipOption> membership;
+  std::string rekey = "delta";
+  std::string rekeyReport;
+  std::string aggregateOutput;
+  std::string aggregateMetrics = "delay,success,overhead,ratio";
+  uint32_t aggregateEvery = 20;
+  std::string agreement = "flat";
+  std::string strategy = "regka";
+  std::string faultFile;
+  uint32_t clusterSize = 16;
+  uint32_t sessions = 0;
+  uint32_t sessionSize = 0;
+  std::string crypto = "none";
+  std::string cryptoCost = "measured";
+  double cpuScale = 1;
+  bool cryptoBatch = true;
+  bool fixedBaseTable = true;
+  std::string sweep;
+  std::string sweepFile;
+  for (std::map<std::string, std::string>::const_iterator it = options.begin(); it != options.end(); ++it) {
+    const std::string& key = it->first;
+    const char* value = it->second.c_str();
+    if (key == "numNodes") base.numNodes = std::strtoul(value, NULL, 10);
+    else if (key == "areaLength") base.areaLength = std::atof(value);
+    else if (key == "areaWidth") base.areaWidth = std::atof(value);
+    else if (key == "areaHeight") base.areaHeight = std::atof(value);
+    else if (key == "linkQuality") base.linkQuality = it->second;
+    else if (key == "run") base.run = std::strtoul(value, NULL, 10);
+    else if (key == "linkModel") linkModel = it->second;
+    else if (key == "calibrationFile") calibrationFile = it->second;
+    else if (key == "range") range = std::atof(value);
+    else if (key == "loss") loss = std::atof(value);
+    else if (key == "delay") delay = std::atof(value);
+    else if (key == "simuTime") simuTime = std::atof(value);
+    else if (key == "periodicInterval") periodicInterval = std::atof(value);
+    else if (key == "stallWindow") stallWindow = std::atof(value);
+    else if (key == "maxEvents") maxEvents = std::strtoull(value, NULL, 10);
+    else if (key == "maxMessageBytes") RegkaProtocol::SetMaxMessageBytes(std::strtoul(value, NULL, 10));
+    else if (key == "join" || key == "leave") {
+      if (!ParseMembership(it->second, key == "join", membership)) {
+        return 1;
+      }
+    }
+    else if (key == "rekey") rekey = it->second;
+    else if (key == "rekeyReport") rekeyReport = it->second;
+    else if (key == "aggregateOutput") aggregateOutput = it->second;
+    else if (key == "aggregateMetrics") aggregateMetrics = it->second;
+    else if (key == "aggregateEvery") aggregateEvery = std::strtoul(value, NULL, 10);
+    else if (key == "agreement") agreement = it->second;
+    else if (key == "strategy") strategy = it->second;
+    else if (key == "fault") base.fault = it->second == "none" ? "" : it->second;
+    else if (key == "faultFile") faultFile = it->second;
+    else if (key == "clusterSize") clusterSize = std::strtoul(value, NULL, 10);
+    else if (key == "sessions") sessions = std::strtoul(value, NULL, 10);
+    else if (key == "sessionSize") sessionSize = std::strtoul(value, NULL, 10);
+    else if (key == "frameBytes") SessionMux::SetMaxFrameBytes(std::strtoul(value, NULL, 10));
+    else if (key == "crypto") crypto = it->second;
+    else if (key == "cryptoCost") cryptoCost = it->second;
+    else if (key == "cpuScale") cpuScale = std::atof(value);
+    else if (key == "cryptoBatch") cryptoBatch = std::atoi(value) != 0;
+    else if (key == "fixedBaseTable") fixedBaseTable = std::atoi(value) != 0;
+    else if (key == "sweep") sweep = it->second;
+    else if (key == "sweepFile") sweepFile = it->second;
+    else {
+      std::cerr << "未知参数: " << key << std::endl;
+      Usage();
+      return 1;
+    }
+  }
+  if (linkModel != "calibrated" && linkModel != "disk") {
+    std::cerr << "未知链路模型: " << linkModel << std::endl;
+    return 1;
+  }
+  if (rekey != "delta" && rekey != "full") {
+    std::cerr << "未知重新协商方式: " << rekey << std::endl;
+    return 1;
+  }
+  if (sessions > 0 && !membership.empty()) {
+    std::cerr << "多会话时不支持成员变化" << std::endl;
+    return 1;
+  }
+  if (agreement != "flat" && agreement != "cluster" && agreement != "both") {
+    std::cerr << "未知协商方式: " << agreement << std::endl;
+    return 1;
+  }
+  if (agreement != "flat" && (sessions > 0 || !membership.empty() || crypto != "none")) {
+    std::cerr << "分簇协商不支持多会话、成员变化与密钥计算" << std::endl;
+    return 1;
+  }
+  if (crypto != "none" && (sessions > 0 || !membership.empty())) {
+    // 多会话与成员变化的完成判断不等待密钥计算，也不统计计算量
+    std::cerr << "多会话与成员变化不支持密钥计算" << std::endl;
+    return 1;
+  }
+  BaselineProtocol::Scheme scheme = BaselineProtocol::FLOODING;
+  bool baseline = strategy != "regka";
+  if (baseline && !BaselineProtocol::ParseScheme(strategy, scheme)) {
+    std::cerr << "未知协商方案: " << strategy << std::endl;
+    return 1;
+  }
+  if (baseline && (agreement != "flat" || sessions > 0 || !membership.empty())) {
+    std::cerr << "基线方案不支持分簇、多会话与成员变化" << std::endl;
+    return 1;
+  }
+  CryptoBackend* backend = NULL;
+  CryptoCosts costs;
+  if (crypto != "none") {
+    backend = CryptoBackend::Create(crypto);
+    if (backend == NULL) {
+      std::cerr << "未知密钥计算后端: " << crypto << std::endl;
+      return 1;
+    }
+    if (crypto == "x25519") {
+      static_cast<X25519Backend*>(backend)->SetFixedBaseTable(fixedBaseTable);
+    }
+    costs = CryptoCosts::Measure(*backend, 32);
+    if (cryptoCost != "measured") {
+      double milliseconds = std::atof(cryptoCost.c_str());
+      if (milliseconds <= 0 || costs.variableBase <= 0) {
+        std::cerr << "密钥计算代价格式错误: " << cryptoCost << std::endl;
+        return 1;
+      }
+      costs = costs.Scaled(milliseconds / 1000 / costs.variableBase);
+    }
+    costs = costs.Scaled(cpuScale);
+    std::cerr << "密钥计算代价 (s): 生成贡献 " << costs.fixedBase << "，处理贡献 " << costs.variableBase
+              << "，批量 " << costs.batchSetup << " + " << costs.batchPerOp << "/个，哈希 " << costs.hashPerByte
+              << "/字节" << std::endl;
+  }
+  std::vector<bool> modes;  // 依次运行的方式，true为分簇
+  if (agreement != "cluster") {
+    modes.push_back(false);
+  }
+  if (agreement != "flat") {
+    modes.push_back(true);
+  }
+  ResultAggregator aggregator;
+  if (!aggregateOutput.empty()) {
+    if (modes.size() > 1) {
+      std::cerr << "流式汇总不能与agreement=both同时使用" << std::endl;
+      return 1;
+    }
+    if (!aggregator.SetMetrics(aggregateMetrics)) {
+      return 1;
+    }
+    aggregator.SetOutput(aggregateOutput);
+    aggregator.SetFlushEvery(std::max<uint32_t>(aggregateEvery, 1));
+  }
+  std::ofstream report;
+  if (!rekeyReport.empty()) {
+    report.open(rekeyReport.c_str());
+    if (!report) {
+      std::cerr << "无法写入" << rekeyReport << std::endl;
+      return 1;
+    }
+    report << "label,mode,event,node,time,latency,sent,received,completed" << std::endl;
+  }
+
+  std::vector<ScenarioConfig> scenarios;
+  if (!sweep.empty() || !sweepFile.empty()) {
+    SweepSpec spec;
+    if (!sweepFile.empty() && !spec.LoadFile(sweepFile)) {
+      return 1;
+    }
+    if (!sweep.empty() && !spec.Parse(sweep, base)) {
+      return 1;
+    }
+    scenarios = spec.GetScenarios();
+  } else {
+    scenarios.push_back(base);
+  }
+  FaultLibrary faults;
+  if (!faultFile.empty() && !faults.LoadFile(faultFile)) {
+    return 1;
+  }
+  for (uint32_t k = 0; k < scenarios.size(); k++) {
+    FaultPlan plan;
+    if (!faults.Find(scenarios[k].fault, plan)) {
+      return 1;
+    }
+    if (!plan.GetCrashes().empty() && !membership.empty()) {
+      std::cerr << "节点崩溃不能与成员变化同时使用" << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << SimulationResult::CsvHeader() << ",events,queueDrops,wallSeconds";
+  if (sessions > 0) {
+    std::cout << ",sessions,completedSessions,meanSessionDelay,maxSessionDelay,sessionThroughput,framesSent";
+  }
+  if (agreement != "flat") {
+    std::cout << ",agreement,clusters,matrixBytesPerNode";
+  }
+  if (backend != NULL) {
+    std::cout << ",crypto,scalarMultsPerNode,computeSecondsPerNode";
+  }
+  std::cout << std::endl;
+  for (uint32_t run = 0; run < scenarios.size() * modes.size(); run++) {
+    const ScenarioConfig& scenario = scenarios[run / modes.size()];
+    bool clustered = modes[run % modes.size()];
+    // KeyMatrix的转发选择使用rand()，与ns-3仿真一样每个场景重新播种
+    srand(1);
+    GroupKeyComputation::Configure(backend, costs, cryptoBatch, scenario.run);
+    MicroRng rng(scenario.run);
+    std::vector<MicroPosition> positions = PositionLinkModel::RandomPositions(scenario, rng);
+
+    LinkModel* link = NULL;
+    if (linkModel == "disk") {
+      link = new DiskLinkModel(positions, range, loss, delay, scenario.run);
+    } else {
+      LinkCalibration calibration;
+      calibration.SetProfile(LinkProfile::ForQuality(scenario.linkQuality));
+      if (!calibrationFile.empty() && !calibration.Load(calibrationFile)) {
+        std::cerr << "未找到校准文件" << calibrationFile << "，使用解析链路模型" << std::endl;
+      }
+      link = new CalibratedLinkModel(positions, calibration, scenario.run);
+    }
+    // 有故障时在链路模型外包装一层，degrade的各链路质量另建校准模型
+    FaultPlan plan;
+    faults.Find(scenario.fault, plan);
+    plan.Resolve(scenario.numNodes, scenario.areaLength, scenario.areaWidth, scenario.areaHeight, scenario.run);
+    LinkModel* baseLink = link;
+    std::vector<LinkModel*> degradedLinks;
+    if (!plan.IsEmpty()) {
+      FaultLinkModel* faultLink = new FaultLinkModel(baseLink, plan, positions, scenario.linkQuality);
+      std::vector<std::string> qualities = plan.GetDegradeQualities();
+      for (uint32_t k = 0; linkModel == "calibrated" && k < qualities.size(); k++) {
+        LinkCalibration calibration;
+        calibration.SetProfile(LinkProfile::ForQuality(qualities[k]));
+        if (!calibrationFile.empty()) {
+          calibration.Load(calibrationFile);
+        }
+        degradedLinks.push_back(new CalibratedLinkModel(positions, calibration, scenario.run + k + 1));
+        faultLink->SetDegradedModel(qualities[k], degradedLinks.back());
+      }
+      link = faultLink;
+    }
+
+    double start = WallSeconds();
+    FlatDriver* flat = NULL;
+    SessionDriver* multi = NULL;
+    AgreementDriver* driver = NULL;
+    uint32_t clusters = 0;
+    if (clustered) {
+      // 分簇使用链路模型的邻居表（最大通信距离内的节点）与位置
+      const PositionLinkModel* positionLink = static_cast<const PositionLinkModel*>(baseLink);
+      std::vector<double> x(positions.size()), y(positions.size()), z(positions.size());
+      for (uint32_t k = 0; k < positions.size(); k++) {
+        x[k] = positions[k].x;
+        y[k] = positions[k].y;
+        z[k] = positions[k].z;
+      }
+      ClusterPlan clusterPlan = ClusterAgreement::FormClusters(positionLink->GetCandidates(), x, y, z, clusterSize);
+      clusters = clusterPlan.GetClusterCount();
+      driver = new ClusterDriver(clusterPlan);
+    } else if (baseline) {
+      driver = new BaselineDriver(scheme);
+    } else if (sessions > 0) {
+      multi = new SessionDriver(scenario.numNodes, sessions, sessionSize, scenario.run);
+      driver = multi;
+    } else {
+      flat = new FlatDriver(scenario.numNodes);
+      flat->SetFullRekey(rekey == "full");
+      for (uint32_t k = 0; k < membership.size(); k++) {
+        flat->AddMembershipEvent(membership[k].time, membership[k].node, membership[k].join);
+      }
+      driver = flat;
+    }
+    MicroSimulator simulator(scenario.numNodes, link, driver);
+    simulator.SetStopTime(simuTime);
+    simulator.SetPeriodicInterval(periodicInterval);
+    simulator.SetStallWindow(stallWindow);
+    simulator.SetMaxEvents(maxEvents);
+    std::vector<std::pair<double, uint32_t> > crashes = plan.GetCrashes();
+    for (uint32_t k = 0; k < crashes.size(); k++) {
+      simulator.AddCrash(crashes[k].first, crashes[k].second);
+    }
+    SimulationResult result = simulator.Run();
+    double elapsed = WallSeconds() - start;
+    if (link != baseLink) {
+      delete link;
+    }
+    delete baseLink;
+    for (uint32_t k = 0; k < degradedLinks.size(); k++) {
+      delete degradedLinks[k];
+    }
+
+    result.scenario = scenario;
+    result.scenario.strategy = strategy;
+    std::cout << result.ToCsv() << "," << simulator.GetEventCount() << ","
+              << simulator.GetQueueDrops() << "," << elapsed;
+    if (sessions > 0) {
+      std::vector<double> delays = multi->GetSessionDelays();
+      uint32_t completed = 0;
+      double total = 0;
+      double longest = 0;
+      for (uint32_t k = 0; k < delays.size(); k++) {
+        if (delays[k] >= 0) {
+          completed++;
+          total += delays[k];
+          longest = std::max(longest, delays[k]);
+        }
+      }
+      // 吞吐量：完成的会话数除以最后一个会话完成的时延
+      std::cout << "," << sessions << "," << completed << "," << (completed > 0 ? total / completed : -1) << ","
+                << (completed > 0 ? longest : -1) << "," << (longest > 0 ? completed / longest : 0) << ","
+                << multi->GetFramesSent();
+    }
+    if (agreement != "flat") {
+      std::cout << "," << (clustered ? "cluster" : "flat") << "," << clusters << "," << simulator.GetMatrixBytesPerNode();
+    }
+    if (backend != NULL) {
+      // 参数检查保证只有平面协商或基线方案启用密钥计算，驱动都提供计算统计
+      double mults = 0;
+      double seconds = 0;
+      for (uint32_t k = 0; k < scenario.numNodes; k++) {
+        mults += driver->GetComputation(k)->GetScalarMultCount();
+        seconds += driver->GetComputation(k)->GetBusyTime();
+      }
+      std::cout << "," << backend->GetName() << "," << mults / scenario.numNodes << ","
+                << seconds / scenario.numNodes;
+    }
+    std::cout << std::endl;
+    if (!aggregateOutput.empty()) {
+      aggregator.Add(result);
+    }
+    if (report.is_open() && flat != NULL) {
+      const std::vector<RekeyRecord>& records = flat->GetRekeyRecords();
+      for (uint32_t k = 0; k < records.size(); k++) {
+        const RekeyRecord& record = records[k];
+        report << scenario.Label() << "," << rekey << "," << (record.join ? "join" : "leave") << ","
+               << record.node << "," << record.time << "," << record.latency << "," << record.sent << ","
+               << record.received << "," << (record.completed ? 1 : 0) << std::endl;
+      }
+    }
+#ifdef REGKA_PROFILING
+    // 标准输出保留给CSV
+    Profiler::PrintSummary(std::cerr, scenario.Label());
+    Profiler::Reset();
+#endif
+    delete driver;
+  }
+  if (!aggregateOutput.empty()) {
+    aggregator.Write();
+  }
+  GroupKeyComputation::Configure(NULL, costs, false, 0);
+  delete backend;
+  return 0;
+}